@@ -0,0 +1,158 @@
+/****************************************************************************
+** Benchmarks main()
+**  - runs BenchVgLog, writes its results as json; or just makes a log
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include <QApplication>
+#include <QDir>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_vglog.h"
+#include "benchresults.h"
+#include "vgloggen.h"
+#include "objects/valkyrie_object.h"
+#include "utils/vk_config.h"
+#include "utils/vk_utils.h"
+
+
+VkCfgGlbl* vkCfgGlbl = NULL;  // Singleton VkCfgGlbl (non-project config)
+VkCfgProj* vkCfgProj = NULL;  // Singleton VkCfgProj (project config)
+
+
+
+static void usage( const char* prog )
+{
+   fprintf( stderr,
+            "usage: %s [--json <file>|-] [<QtTest args>]\n"
+            "       %s --generate <log> [srcdir=<dir>] [tool=memcheck|helgrind]\n"
+            "             [errors=N] [depth=N] [symbols=N] [leaks=N] [threads=N]\n"
+            "             [srcfiles=N] [srclines=N] [seed=N]\n",
+            prog, prog );
+}
+
+
+/*!
+  --generate: write one log (and its sources, given a srcdir), and exit.
+*/
+static int generate( int argc, char* argv[] )
+{
+   if ( argc < 3 ) {
+      usage( argv[0] );
+      return EXIT_FAILURE;
+   }
+
+   VgLogGenParams params;
+   QString errMsg;
+   for ( int i = 3; i < argc; ++i ) {
+      if ( !params.set( QString::fromLocal8Bit( argv[i] ), errMsg ) ) {
+         vkPrintErr( "%s", qPrintable( errMsg ) );
+         return EXIT_FAILURE;
+      }
+   }
+
+   VgLogGen gen( params );
+   if ( !gen.write( QString::fromLocal8Bit( argv[2] ), errMsg ) ||
+        ( !params.srcDir.isEmpty() && !gen.writeSources( errMsg ) ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
+
+
+/*!
+  Benchmarks entry point.
+  Runs headless, against a throw-away config dir: the user's own is
+  never touched, and the config's defaults are always the same.
+*/
+int main( int argc, char* argv[] )
+{
+   if ( argc > 1 && strcmp( argv[1], "--generate" ) == 0 ) {
+      return generate( argc, argv );
+   }
+
+   // our args; the rest go to QtTest
+   QString jsonFile = "vk_bench.json";
+   QStringList testArgs( argv[0] );
+   for ( int i = 1; i < argc; i++ ) {
+      if ( strcmp( argv[i], "--json" ) == 0 && i + 1 < argc ) {
+         jsonFile = QString::fromLocal8Bit( argv[++i] );
+      }
+      else if ( strcmp( argv[i], "--help" ) == 0 ) {
+         usage( argv[0] );
+         return EXIT_SUCCESS;
+      }
+      else {
+         testArgs << QString::fromLocal8Bit( argv[i] );
+      }
+   }
+
+   QTemporaryDir workDir;
+   if ( !workDir.isValid() ) {
+      vkPrintErr( "Failed to create a temporary dir." );
+      return EXIT_FAILURE;
+   }
+   qputenv( "HOME", QFile::encodeName( workDir.path() ) );
+   if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() ) {
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+   }
+
+   int exit_status = EXIT_SUCCESS;
+   QString xmlFile = workDir.path() + "/results.xml";
+   QString errMsg;
+
+   // as main.cpp: VkObjects, then the app, then the config
+   Valkyrie valkyrie;
+   QApplication app( argc, argv );
+   QCoreApplication::setOrganizationName( "OpenWorks" );
+   QCoreApplication::setOrganizationDomain( "openworks.co.uk" );
+   QCoreApplication::setApplicationName( "Valkyrie" );
+   QLocale::setDefault( QLocale( QLocale::English, QLocale::UnitedKingdom ) );
+
+   if ( !VkCfgProj::createConfig( &valkyrie ) || vkCfgProj == NULL ||
+        !VkCfgGlbl::createConfig() || vkCfgGlbl == NULL ) {
+      vkPrintErr( "Failed to initialise config in '%s'.", qPrintable( VkCfg::cfgDir() ) );
+      exit_status = EXIT_FAILURE;
+   }
+   else {
+      BenchVgLog bench( workDir.path() );
+      testArgs << "-o" << xmlFile + ",xml" << "-o" << "-,txt";
+      if ( QTest::qExec( &bench, testArgs ) != 0 ) {
+         exit_status = EXIT_FAILURE;
+      }
+
+      // failures are in the json too: write it regardless
+      if ( !BenchResults::write( xmlFile, bench.inputs(), jsonFile, errMsg ) ) {
+         vkPrintErr( "%s", qPrintable( errMsg ) );
+         exit_status = EXIT_FAILURE;
+      }
+   }
+
+   if ( vkCfgProj ) {
+      delete vkCfgProj;
+   }
+   if ( vkCfgGlbl ) {
+      delete vkCfgGlbl;
+   }
+   return exit_status;
+}
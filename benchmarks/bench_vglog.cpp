@@ -0,0 +1,371 @@
+/****************************************************************************
+** BenchVgLog implementation
+**  - benchmarks of log ingest, and of the logview model and filter
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "bench_vglog.h"
+
+#include "toolview/helgrind_logview.h"
+#include "toolview/logviewfilter_mc.h"
+#include "toolview/memcheck_logview.h"
+#include "utils/vglogreader.h"
+#include "utils/vk_config.h"
+#include "utils/vk_procsampler.h"
+
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QLineEdit>
+#include <QtTest>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+
+BenchVgLog::BenchVgLog( const QString& workDir )
+   : QObject( 0 ), m_workDir( workDir )
+{
+   this->setObjectName( "BenchVgLog" );
+
+   // the logs: sizes typical of a small, and a big, program's run
+   VgLogGenParams params;
+   params.srcDir = m_workDir + "/src";
+
+   params.numErrors  = 1000;
+   params.stackDepth = 12;
+   params.numSymbols = 500;
+   params.numLeaks   = 100;
+   addLog( "mc-small", params );
+
+   params.numErrors  = 10000;
+   params.numSymbols = 2000;
+   params.numLeaks   = 1000;
+   addLog( "mc-large", params );
+
+   params.numErrors  = 2000;
+   params.stackDepth = 50;
+   params.numSymbols = 5000;
+   params.numLeaks   = 200;
+   addLog( "mc-deep", params );
+
+   params.tool       = "helgrind";
+   params.numErrors  = 5000;
+   params.stackDepth = 12;
+   params.numSymbols = 1000;
+   params.numThreads = 32;
+   addLog( "hg-threads", params );
+}
+
+
+void BenchVgLog::addLog( const QString& name, const VgLogGenParams& params )
+{
+   m_names << name;
+   m_params[name] = params;
+   m_logs[name] = m_workDir + "/" + name + ".xml";
+}
+
+
+/*!
+  Generate the logs, and the sources their frames refer to.
+*/
+void BenchVgLog::initTestCase()
+{
+   QString errMsg;
+   foreach ( QString name, m_names ) {
+      VgLogGen gen( m_params[name] );
+      QVERIFY2( gen.write( m_logs[name], errMsg ), qPrintable( errMsg ) );
+
+      QJsonObject input = m_params[name].toJson();
+      input["bytes"] = QFileInfo( m_logs[name] ).size();
+      m_inputs[name] = input;
+   }
+
+   // all the logs share the one source dir
+   VgLogGen gen( m_params[m_names.first()] );
+   QVERIFY2( gen.writeSources( errMsg ), qPrintable( errMsg ) );
+}
+
+
+void BenchVgLog::addLogRows( bool memcheckOnly/*=false*/ )
+{
+   QTest::addColumn<QString>( "log" );
+   foreach ( QString name, m_names ) {
+      if ( !memcheckOnly || m_params[name].tool == "memcheck" ) {
+         QTest::newRow( qPrintable( name ) ) << name;
+      }
+   }
+}
+
+
+/*!
+  Parse a log into a new logview on view, as ToolObject::parseLogFile() does.
+  The caller owns the logview.
+*/
+bool BenchVgLog::loadLog( const QString& name, QTreeWidget* view,
+                          VgLogView*& logview, QString& errMsg )
+{
+   if ( m_params[name].tool == "helgrind" ) {
+      logview = new HelgrindLogView( view );
+   }
+   else {
+      logview = new MemcheckLogView( view );
+   }
+
+   VgLogReader reader( logview );
+   if ( !reader.parse( m_logs[name] ) ) {
+      errMsg = reader.handler()->fatalMsg();
+      return false;
+   }
+   return true;
+}
+
+
+/*!
+  Open item's children, and theirs: as the user opening every item
+  of the view, so every child item is made, source snippets too.
+*/
+void BenchVgLog::openAll( QTreeWidgetItem* item )
+{
+   for ( int i = 0; i < item->childCount(); ++i ) {
+      VgOutputItem* child = ( VgOutputItem* )item->child( i );
+      child->openChildren();
+      openAll( child );
+   }
+}
+
+
+/*!
+  As openAll(), but leave the frames shut: gather them instead.
+*/
+void BenchVgLog::openAllButFrames( QTreeWidgetItem* item,
+                                   QList<VgOutputItem*>& frames )
+{
+   for ( int i = 0; i < item->childCount(); ++i ) {
+      VgOutputItem* child = ( VgOutputItem* )item->child( i );
+      if ( child->elemType() == VG_ELEM::FRAME ) {
+         frames << child;
+         continue;
+      }
+      child->openChildren();
+      openAllButFrames( child, frames );
+   }
+}
+
+
+
+/***************************************************************************/
+/*!
+  Parse a log, building the model and the top-level view items.
+*/
+void BenchVgLog::ingest_data()
+{
+   addLogRows();
+}
+
+void BenchVgLog::ingest()
+{
+   QFETCH( QString, log );
+
+   QBENCHMARK {
+      QTreeWidget view;
+      VgLogView* logview = 0;
+      QString errMsg;
+      bool ok = loadLog( log, &view, logview, errMsg );
+      delete logview;
+      QVERIFY2( ok, qPrintable( errMsg ) );
+   }
+}
+
+
+/*!
+  Peak resident memory while loading a log, over that before.
+  The kernel's peak is reset first (linux >= 4.0), and freed heap
+  handed back, so earlier benchmarks don't hide this one's peak.
+*/
+void BenchVgLog::peakMemory_data()
+{
+   addLogRows();
+}
+
+void BenchVgLog::peakMemory()
+{
+   QFETCH( QString, log );
+
+#if defined(__GLIBC__)
+   malloc_trim( 0 );
+#endif
+   QFile clearRefs( "/proc/self/clear_refs" );
+   if ( !clearRefs.open( QIODevice::WriteOnly ) || clearRefs.write( "5" ) != 1 ) {
+      QSKIP( "Can't reset the peak RSS: /proc/self/clear_refs" );
+   }
+   clearRefs.close();
+
+   qint64 pid = QCoreApplication::applicationPid();
+   qint64 baseKB = VkProcSampler::peakRssKB( pid );
+
+   QTreeWidget view;
+   VgLogView* logview = 0;
+   QString errMsg;
+   bool ok = loadLog( log, &view, logview, errMsg );
+   qint64 peakKB = VkProcSampler::peakRssKB( pid );
+   delete logview;
+   QVERIFY2( ok, qPrintable( errMsg ) );
+   QVERIFY( baseKB > 0 && peakKB >= baseKB );
+
+   QTest::setBenchmarkResult( ( peakKB - baseKB ) * 1024.0, QTest::BytesAllocated );
+}
+
+
+/*!
+  Refresh the memcheck filter, with a function filter that keeps
+  some errors and hides the rest.
+*/
+void BenchVgLog::filterRefresh_data()
+{
+   addLogRows( true/*memcheckOnly*/ );
+}
+
+void BenchVgLog::filterRefresh()
+{
+   QFETCH( QString, log );
+
+   QTreeWidget view;
+   VgLogView* logview = 0;
+   QString errMsg;
+   QVERIFY2( loadLog( log, &view, logview, errMsg ), qPrintable( errMsg ) );
+
+   // default filter: function 'contains' ...
+   LogViewFilterMC filter( 0, &view );
+   foreach ( QLineEdit* ledit, filter.findChildren<QLineEdit*>() ) {
+      if ( ledit->validator() == 0 ) {   // ... the string, not the int, one
+         ledit->setText( "bench_fn_1" );
+      }
+   }
+   filter.enableFilter( true );
+
+   QBENCHMARK {
+      QMetaObject::invokeMethod( &filter, "refresh", Qt::DirectConnection );
+   }
+
+   delete logview;
+}
+
+
+/*!
+  Reconcile the view's error items with an errorcounts element:
+  as valgrind sends, at exit and on each leak check.
+*/
+void BenchVgLog::errorCounts_data()
+{
+   addLogRows();
+}
+
+void BenchVgLog::errorCounts()
+{
+   QFETCH( QString, log );
+
+   QFile file( m_logs[log] );
+   QDomDocument doc;
+   QVERIFY( file.open( QIODevice::ReadOnly ) && doc.setContent( &file ) );
+   QDomElement counts = doc.documentElement().lastChildElement( "errorcounts" );
+   QVERIFY( !counts.isNull() );
+
+   QTreeWidget view;
+   VgLogView* logview = 0;
+   QString errMsg;
+   QVERIFY2( loadLog( log, &view, logview, errMsg ), qPrintable( errMsg ) );
+
+   QBENCHMARK {
+      bool ok = logview->appendNode( counts.cloneNode( true ), errMsg );
+      QVERIFY2( ok, qPrintable( errMsg ) );
+   }
+
+   delete logview;
+}
+
+
+/*!
+  Open every item of a freshly loaded log. Once only: after that,
+  there are no children left to make.
+*/
+void BenchVgLog::expandAll_data()
+{
+   addLogRows();
+}
+
+void BenchVgLog::expandAll()
+{
+   QFETCH( QString, log );
+
+   QTreeWidget view;
+   VgLogView* logview = 0;
+   QString errMsg;
+   QVERIFY2( loadLog( log, &view, logview, errMsg ), qPrintable( errMsg ) );
+   QVERIFY( view.topLevelItem( 0 ) != 0 );
+
+   QBENCHMARK_ONCE {
+      openAll( view.topLevelItem( 0 ) );
+   }
+
+   delete logview;
+}
+
+
+/*!
+  Open every frame of a log, reading its source snippet, for two
+  values of [valkyrie::src-lines].
+*/
+void BenchVgLog::srcSnippets_data()
+{
+   QTest::addColumn<QString>( "log" );
+   QTest::addColumn<int>( "srcLines" );
+   QTest::newRow( "mc-small, src-lines=2" )  << "mc-small" << 2;
+   QTest::newRow( "mc-small, src-lines=20" ) << "mc-small" << 20;
+   QTest::newRow( "mc-deep, src-lines=2" )   << "mc-deep"  << 2;
+}
+
+void BenchVgLog::srcSnippets()
+{
+   QFETCH( QString, log );
+   QFETCH( int, srcLines );
+
+   QTreeWidget view;
+   VgLogView* logview = 0;
+   QString errMsg;
+   QVERIFY2( loadLog( log, &view, logview, errMsg ), qPrintable( errMsg ) );
+   QVERIFY( view.topLevelItem( 0 ) != 0 );
+
+   QList<VgOutputItem*> frames;
+   openAllButFrames( view.topLevelItem( 0 ), frames );
+   QVERIFY( !frames.isEmpty() );
+
+   QString srcLinesKey = "valkyrie/src-lines";
+   QVariant savedSrcLines = vkCfgProj->value( srcLinesKey );
+   vkCfgProj->setValue( srcLinesKey, srcLines );
+
+   QBENCHMARK_ONCE {
+      foreach ( VgOutputItem* frame, frames ) {
+         frame->openChildren();
+      }
+   }
+
+   vkCfgProj->setValue( srcLinesKey, savedSrcLines );
+   delete logview;
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+** BenchVgLog definition
+**  - benchmarks of log ingest, and of the logview model and filter
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __BENCH_VGLOG_H
+#define __BENCH_VGLOG_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QTreeWidget>
+
+#include "toolview/vglogview.h"
+#include "vgloggen.h"
+
+
+// ============================================================
+/*!
+  BenchVgLog: QtTest benchmarks over logs from VgLogGen.
+
+  Each benchmark runs over the logs named in its data rows (the row
+  tag is the log's name), all generated once, in initTestCase().
+  inputs() describes them, for the results file.
+*/
+class BenchVgLog : public QObject
+{
+   Q_OBJECT
+public:
+   BenchVgLog( const QString& workDir );
+
+   QJsonObject inputs() const {
+      return m_inputs;
+   }
+
+private slots:
+   void initTestCase();
+
+   void ingest_data();
+   void ingest();
+   void peakMemory_data();
+   void peakMemory();
+   void filterRefresh_data();
+   void filterRefresh();
+   void errorCounts_data();
+   void errorCounts();
+   void expandAll_data();
+   void expandAll();
+   void srcSnippets_data();
+   void srcSnippets();
+
+private:
+   void addLog( const QString& name, const VgLogGenParams& params );
+   void addLogRows( bool memcheckOnly = false );
+   bool loadLog( const QString& name, QTreeWidget* view,
+                 VgLogView*& logview, QString& errMsg );
+   void openAll( QTreeWidgetItem* item );
+   void openAllButFrames( QTreeWidgetItem* item, QList<VgOutputItem*>& frames );
+
+private:
+   QString m_workDir;
+   QStringList m_names;                    // of the logs, in order
+   QMap<QString, VgLogGenParams> m_params; // name -> how to generate
+   QMap<QString, QString> m_logs;          // name -> log file
+   QJsonObject m_inputs;
+};
+
+#endif // #ifndef __BENCH_VGLOG_H
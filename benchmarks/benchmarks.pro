@@ -0,0 +1,37 @@
+######################################################################
+# Valkyrie qmake project file: build the benchmarks
+#
+# Headless, and against a throw-away config dir:
+#   ../bin/vk_bench [--json <file>|-] [<QtTest args>]
+# writes the results to vk_bench.json (default), or '-' for stdout.
+# 'make check' runs them. Or just generate a log to play with:
+#   ../bin/vk_bench --generate big.xml errors=100000 depth=24 srcdir=src
+######################################################################
+
+QT       += core gui printsupport widgets testlib
+
+VK_ROOT = ..
+
+include( $${VK_ROOT}/vk_config.pri )
+include( $${VK_ROOT}/src/src.pri )
+
+TARGET        = vk_bench
+TEMPLATE      = app
+CONFIG       += console testcase no_testcase_installs
+
+MOC_DIR       = moc
+OBJECTS_DIR   = obj
+DESTDIR       = $${VK_ROOT}/bin
+
+
+######################################################################
+SOURCES += \
+    bench_main.cpp \
+    bench_vglog.cpp \
+    benchresults.cpp \
+    vgloggen.cpp
+
+HEADERS += \
+    bench_vglog.h \
+    benchresults.h \
+    vgloggen.h
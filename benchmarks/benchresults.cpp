@@ -0,0 +1,142 @@
+/****************************************************************************
+** BenchResults implementation
+**  - benchmark results as json, for tracking them across releases
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "benchresults.h"
+#include "utils/vk_config.h"
+
+#include <QDateTime>
+#include <QDomDocument>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSysInfo>
+
+
+/*!
+  The json is:
+  { "suite", "valkyrie", "qt", "date", "host",
+    "results":  [ { "benchmark", "input", "tag", "metric",
+                    "value" (per iteration), "iterations",
+                    "params" (of the input log), ["mbPerSec"] } ],
+    "failures": [ { "benchmark", "tag", "message" } ] }
+*/
+bool BenchResults::toJson( const QString& testlibXml, const QJsonObject& inputs,
+                           QJsonObject& json, QString& errMsg )
+{
+   QFile file( testlibXml );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      errMsg = "Failed to open QtTest results: '" + testlibXml + "'";
+      return false;
+   }
+   QDomDocument doc;
+   QString parseErr;
+   if ( !doc.setContent( &file, &parseErr ) ) {
+      errMsg = "Failed to parse QtTest results: '" + testlibXml + "': " + parseErr;
+      return false;
+   }
+
+   QDomElement testCase = doc.documentElement();
+   json = QJsonObject();
+   json["suite"]    = testCase.attribute( "name" );
+   json["valkyrie"] = VkCfg::appVersion();
+   json["qt"]       = QString( qVersion() );
+   json["date"]     = QDateTime::currentDateTimeUtc().toString( Qt::ISODate );
+   json["host"]     = QSysInfo::machineHostName();
+
+   QJsonArray results, failures;
+   QDomElement func = testCase.firstChildElement( "TestFunction" );
+   for ( ; !func.isNull(); func = func.nextSiblingElement( "TestFunction" ) ) {
+      QString bench = func.attribute( "name" );
+
+      QDomElement res = func.firstChildElement( "BenchmarkResult" );
+      for ( ; !res.isNull(); res = res.nextSiblingElement( "BenchmarkResult" ) ) {
+         QString tag = res.attribute( "tag" );
+         QString input = tag.section( ", ", 0, 0 );
+         double value = res.attribute( "value" ).toDouble();
+
+         QJsonObject result;
+         result["benchmark"]  = bench;
+         result["input"]      = input;
+         result["tag"]        = tag;
+         result["metric"]     = res.attribute( "metric" );
+         result["value"]      = value;
+         result["iterations"] = res.attribute( "iterations" ).toInt();
+         if ( inputs.contains( input ) ) {
+            QJsonObject params = inputs[input].toObject();
+            result["params"] = params;
+
+            double bytes = params["bytes"].toDouble();
+            if ( bench == "ingest" && value > 0 &&
+                 res.attribute( "metric" ) == "WalltimeMilliseconds" ) {
+               result["mbPerSec"] = ( bytes / ( 1024 * 1024 ) ) / ( value / 1000 );
+            }
+         }
+         results.append( result );
+      }
+
+      QDomElement inc = func.firstChildElement( "Incident" );
+      for ( ; !inc.isNull(); inc = inc.nextSiblingElement( "Incident" ) ) {
+         QString type = inc.attribute( "type" );
+         if ( type != "fail" && type != "xpass" ) {
+            continue;
+         }
+         QJsonObject failure;
+         failure["benchmark"] = bench;
+         failure["tag"]       = inc.firstChildElement( "DataTag" ).text();
+         failure["message"]   = inc.firstChildElement( "Description" ).text();
+         failures.append( failure );
+      }
+   }
+   json["results"]  = results;
+   json["failures"] = failures;
+   return true;
+}
+
+
+/*!
+  Write the json to jsonFile, or stdout if "-".
+*/
+bool BenchResults::write( const QString& testlibXml, const QJsonObject& inputs,
+                          const QString& jsonFile, QString& errMsg )
+{
+   QJsonObject json;
+   if ( !toJson( testlibXml, inputs, json, errMsg ) ) {
+      return false;
+   }
+   QByteArray bytes = QJsonDocument( json ).toJson( QJsonDocument::Indented );
+
+   if ( jsonFile == "-" ) {
+      QFile out;
+      if ( !out.open( stdout, QIODevice::WriteOnly ) || out.write( bytes ) != bytes.size() ) {
+         errMsg = "Failed to write results to stdout";
+         return false;
+      }
+      return true;
+   }
+
+   QSaveFile out( jsonFile );
+   if ( !out.open( QIODevice::WriteOnly ) ||
+        out.write( bytes ) != bytes.size() || !out.commit() ) {
+      errMsg = "Failed to write results file: '" + jsonFile + "'";
+      return false;
+   }
+   return true;
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+** BenchResults definition
+**  - benchmark results as json, for tracking them across releases
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __BENCHRESULTS_H
+#define __BENCHRESULTS_H
+
+#include <QJsonObject>
+#include <QString>
+
+
+// ============================================================
+/*!
+  BenchResults: turns QtTest's xml output into json.
+
+  QtTest has no json output of its own, so the benchmarks are run
+  with '-o <file>,xml' and that's converted. Each result gets the
+  description of its input log (a result's data tag is the log's
+  name, maybe followed by ", <variant>"), and ingest results get
+  their throughput.
+*/
+class BenchResults
+{
+public:
+   static bool toJson( const QString& testlibXml, const QJsonObject& inputs,
+                       QJsonObject& json, QString& errMsg );
+   static bool write( const QString& testlibXml, const QJsonObject& inputs,
+                      const QString& jsonFile, QString& errMsg );
+};
+
+#endif // #ifndef __BENCHRESULTS_H
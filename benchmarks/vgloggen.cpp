@@ -0,0 +1,438 @@
+/****************************************************************************
+** VgLogGen implementation
+**  - deterministic synthetic valgrind xml logs, for benchmarking
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "vgloggen.h"
+#include "utils/vk_utils.h"
+
+#include <QDir>
+#include <QSaveFile>
+
+
+/*!
+  Set one param from "key=value", as given on the command line.
+*/
+bool VgLogGenParams::set( const QString& keyEqVal, QString& errMsg )
+{
+   int eq = keyEqVal.indexOf( '=' );
+   QString key = keyEqVal.left( eq );
+   QString val = keyEqVal.mid( eq + 1 );
+
+   if ( eq == -1 ) {
+      errMsg = "Expected key=value, got '" + keyEqVal + "'";
+      return false;
+   }
+   if ( key == "tool" ) {
+      if ( val != "memcheck" && val != "helgrind" ) {
+         errMsg = "tool must be memcheck or helgrind, not '" + val + "'";
+         return false;
+      }
+      tool = val;
+      return true;
+   }
+   if ( key == "srcdir" ) {
+      srcDir = QDir( val ).absolutePath();
+      return true;
+   }
+
+   bool ok = false;
+   uint num = val.toUInt( &ok );
+   if ( !ok ) {
+      errMsg = "Not a number: '" + keyEqVal + "'";
+      return false;
+   }
+
+   if      ( key == "errors"   ) numErrors    = num;
+   else if ( key == "depth"    ) stackDepth   = qMax( 1u, num );
+   else if ( key == "symbols"  ) numSymbols   = qMax( 1u, num );
+   else if ( key == "leaks"    ) numLeaks     = num;
+   else if ( key == "threads"  ) numThreads   = qMax( 1u, num );
+   else if ( key == "srcfiles" ) numSrcFiles  = qMax( 1u, num );
+   else if ( key == "srclines" ) srcFileLines = qMax( 1u, num );
+   else if ( key == "seed"     ) seed         = num;
+   else {
+      errMsg = "Unknown key '" + key + "': choose from tool, errors, depth, "
+               "symbols, leaks, threads, srcfiles, srclines, srcdir, seed";
+      return false;
+   }
+   return true;
+}
+
+
+QJsonObject VgLogGenParams::toJson() const
+{
+   QJsonObject obj;
+   obj["tool"]     = tool;
+   obj["errors"]   = numErrors;
+   obj["depth"]    = stackDepth;
+   obj["symbols"]  = numSymbols;
+   obj["leaks"]    = numLeaks;
+   obj["threads"]  = numThreads;
+   obj["srcfiles"] = numSrcFiles;
+   obj["srclines"] = srcFileLines;
+   obj["seed"]     = ( qint64 )seed;
+   return obj;
+}
+
+
+
+/***************************************************************************/
+VgLogGen::VgLogGen( const VgLogGenParams& params )
+   : m_params( params ), m_state( params.seed )
+{
+}
+
+
+/*!
+  0 .. range-1, from a 64-bit LCG (Knuth's MMIX constants):
+  no library rand(), so the logs are the same everywhere.
+*/
+quint32 VgLogGen::random( quint32 range )
+{
+   m_state = m_state * Q_UINT64_C( 6364136223846793005 )
+                     + Q_UINT64_C( 1442695040888963407 );
+   return range == 0 ? 0 : ( quint32 )( m_state >> 33 ) % range;
+}
+
+
+QString VgLogGen::hex( quint64 val )
+{
+   return "0x" + QString::number( val, 16 ).toUpper();
+}
+
+
+/*!
+  Write the log. Errors come as valgrind gives them: in the order
+  first seen, with errorcounts (and suppcounts) last.
+*/
+bool VgLogGen::write( const QString& logFile, QString& errMsg )
+{
+   QSaveFile file( logFile );
+   if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+      errMsg = "Failed to open log file: '" + logFile + "'";
+      return false;
+   }
+
+   m_state = m_params.seed;
+   m_counts.clear();
+
+   QTextStream strm( &file );
+   bool helgrind = ( m_params.tool == "helgrind" );
+
+   writePreamble( strm );
+   writeStatus( strm, "RUNNING" );
+
+   if ( helgrind ) {
+      // threads 2..N+1: valgrind announces the root thread differently
+      for ( int tid = 2; tid <= m_params.numThreads + 1; ++tid ) {
+         writeAnnounceThread( strm, tid );
+      }
+   }
+   for ( int i = 0; i < m_params.numErrors; ++i ) {
+      if ( helgrind ) {
+         writeRaceError( strm, i );
+      }
+      else {
+         writeMemcheckError( strm, i );
+      }
+   }
+
+   writeStatus( strm, "FINISHED" );
+   if ( !helgrind ) {
+      for ( int i = 0; i < m_params.numLeaks; ++i ) {
+         writeLeakError( strm, i );
+      }
+   }
+   writeErrorCounts( strm );
+
+   strm << "<suppcounts>\n"
+        << "  <pair>\n"
+        << "    <count>" << 1 + random( 100 ) << "</count>\n"
+        << "    <name>bench-supp-ld.so</name>\n"
+        << "  </pair>\n"
+        << "</suppcounts>\n\n"
+        << "</valgrindoutput>\n\n";
+
+   strm.flush();
+   if ( strm.status() != QTextStream::Ok || !file.commit() ) {
+      errMsg = "Failed to write log file: '" + logFile + "'";
+      return false;
+   }
+   return true;
+}
+
+
+void VgLogGen::writePreamble( QTextStream& strm )
+{
+   QString tool = m_params.tool;
+   QString Tool = tool.left( 1 ).toUpper() + tool.mid( 1 );
+   QString desc = ( tool == "helgrind" ) ? "a thread error detector"
+                                         : "a memory error detector";
+
+   strm << "<?xml version=\"1.0\"?>\n\n"
+        << "<valgrindoutput>\n\n"
+        << "<protocolversion>4</protocolversion>\n"
+        << "<protocoltool>" << tool << "</protocoltool>\n\n"
+        << "<preamble>\n"
+        << "  <line>" << Tool << ", " << desc << "</line>\n"
+        << "  <line>Copyright (C) 2002-2010, and GNU GPL'd, by Julian Seward et al.</line>\n"
+        << "  <line>Using Valgrind-3.6.1 and LibVEX; rerun with -h for copyright info</line>\n"
+        << "  <line>Command: ./vk_bench_target --seed " << m_params.seed << "</line>\n"
+        << "</preamble>\n\n"
+        << "<pid>4242</pid>\n"
+        << "<ppid>4241</ppid>\n"
+        << "<tool>" << tool << "</tool>\n\n"
+        << "<args>\n"
+        << "  <vargv>\n"
+        << "    <exe>/usr/bin/valgrind</exe>\n"
+        << "    <arg>--tool=" << tool << "</arg>\n"
+        << "    <arg>--num-callers=" << m_params.stackDepth << "</arg>\n"
+        << "    <arg>--xml=yes</arg>\n"
+        << "  </vargv>\n"
+        << "  <argv>\n"
+        << "    <exe>./vk_bench_target</exe>\n"
+        << "    <arg>--seed</arg>\n"
+        << "    <arg>" << m_params.seed << "</arg>\n"
+        << "  </argv>\n"
+        << "</args>\n\n";
+}
+
+
+void VgLogGen::writeStatus( QTextStream& strm, const QString& state )
+{
+   strm << "<status>\n"
+        << "  <state>" << state << "</state>\n"
+        << "  <time>00:00:00:0" << ( state == "RUNNING" ? "0.042" : "7.314" ) << " </time>\n"
+        << "</status>\n\n";
+}
+
+
+/*!
+  A stack of depth frames, innermost first, ending in main().
+  Half the frames come from the hottest tenth of the symbols.
+*/
+void VgLogGen::writeStack( QTextStream& strm, int depth )
+{
+   int numSyms = m_params.numSymbols;
+   int hotSyms = qMax( 1, numSyms / 10 );
+
+   strm << "  <stack>\n";
+   for ( int i = 0; i < depth - 1; ++i ) {
+      writeFrame( strm, 1 + random( random( 2 ) ? hotSyms : numSyms ) );
+   }
+   writeFrame( strm, 0 );
+   strm << "  </stack>\n";
+}
+
+
+/*!
+  Symbol sym's frame: always the same. Symbol 0 is main().
+  One in ten symbols has no debug info, so no source location.
+*/
+void VgLogGen::writeFrame( QTextStream& strm, int sym )
+{
+   QString fn = ( sym == 0 ) ? QString( "main" ) : QString( "bench_fn_%1" ).arg( sym );
+
+   strm << "    <frame>\n"
+        << "      <ip>" << hex( 0x400000 + sym * 0x40 ) << "</ip>\n"
+        << "      <obj>/usr/lib/libbench" << sym % 8 << ".so</obj>\n"
+        << "      <fn>" << fn << "</fn>\n";
+   if ( sym % 10 != 9 ) {
+      if ( !m_params.srcDir.isEmpty() ) {
+         strm << "      <dir>" << escapeEntities( m_params.srcDir ) << "</dir>\n";
+      }
+      strm << "      <file>bench_" << sym % m_params.numSrcFiles << ".c</file>\n"
+           << "      <line>" << 1 + ( sym * 37 ) % m_params.srcFileLines << "</line>\n";
+   }
+   strm << "    </frame>\n";
+}
+
+
+void VgLogGen::writeMemcheckError( QTextStream& strm, int idx )
+{
+   static const char* kinds[] = {
+      "InvalidRead", "InvalidWrite", "UninitCondition", "UninitValue",
+      "InvalidFree", "MismatchedFree", "SyscallParam", "Overlap"
+   };
+   QString kind = kinds[ random( 8 ) ];
+   int size = 1 << random( 4 );
+   quint64 addr = 0x5A1D000 + random( 0x100000 ) * 8;
+
+   QString what, auxwhat;
+   if ( kind == "InvalidRead" || kind == "InvalidWrite" ) {
+      what = QString( "Invalid %1 of size %2" )
+             .arg( kind == "InvalidRead" ? "read" : "write" ).arg( size );
+      auxwhat = QString( "Address %1 is 0 bytes after a block of size %2 alloc'd" )
+                .arg( hex( addr ) ).arg( 8 * ( 1 + random( 64 ) ) );
+   }
+   else if ( kind == "UninitCondition" ) {
+      what = "Conditional jump or move depends on uninitialised value(s)";
+   }
+   else if ( kind == "UninitValue" ) {
+      what = QString( "Use of uninitialised value of size %1" ).arg( size );
+   }
+   else if ( kind == "InvalidFree" || kind == "MismatchedFree" ) {
+      what = ( kind == "InvalidFree" ) ? "Invalid free() / delete / delete[] / realloc()"
+                                       : "Mismatched free() / delete / delete []";
+      auxwhat = QString( "Address %1 is 0 bytes inside a block of size %2 free'd" )
+                .arg( hex( addr ) ).arg( 8 * ( 1 + random( 64 ) ) );
+   }
+   else if ( kind == "SyscallParam" ) {
+      what = "Syscall param write(buf) points to uninitialised byte(s)";
+      auxwhat = QString( "Address %1 is 0 bytes inside a block of size %2 alloc'd" )
+                .arg( hex( addr ) ).arg( 8 * ( 1 + random( 64 ) ) );
+   }
+   else {
+      what = QString( "Source and destination overlap in memcpy(%1, %2, %3)" )
+             .arg( hex( addr ) ).arg( hex( addr + 4 ) ).arg( 8 * ( 1 + random( 8 ) ) );
+   }
+
+   strm << "<error>\n"
+        << "  <unique>" << hex( idx ) << "</unique>\n"
+        << "  <tid>1</tid>\n"
+        << "  <kind>" << kind << "</kind>\n"
+        << "  <what>" << escapeEntities( what ) << "</what>\n";
+   writeStack( strm, m_params.stackDepth );
+   if ( !auxwhat.isEmpty() ) {
+      strm << "  <auxwhat>" << escapeEntities( auxwhat ) << "</auxwhat>\n";
+      writeStack( strm, m_params.stackDepth );
+   }
+   strm << "</error>\n\n";
+
+   m_counts << 1 + random( 20 );
+}
+
+
+void VgLogGen::writeLeakError( QTextStream& strm, int idx )
+{
+   static const char* kinds[] = {
+      "Leak_DefinitelyLost", "Leak_IndirectlyLost",
+      "Leak_PossiblyLost", "Leak_StillReachable"
+   };
+   static const char* how[] = {
+      "definitely lost", "indirectly lost", "possibly lost", "still reachable"
+   };
+   int k = random( 4 );
+   int blocks = 1 + random( 10 );
+   int bytes = blocks * 8 * ( 1 + random( 128 ) );
+
+   strm << "<error>\n"
+        << "  <unique>" << hex( m_params.numErrors + idx ) << "</unique>\n"
+        << "  <tid>1</tid>\n"
+        << "  <kind>" << kinds[k] << "</kind>\n"
+        << "  <xwhat>\n"
+        << "    <text>" << bytes << " bytes in " << blocks << " blocks are " << how[k]
+        << " in loss record " << idx + 1 << " of " << m_params.numLeaks << "</text>\n"
+        << "    <leakedbytes>" << bytes << "</leakedbytes>\n"
+        << "    <leakedblocks>" << blocks << "</leakedblocks>\n"
+        << "  </xwhat>\n";
+   writeStack( strm, m_params.stackDepth );
+   strm << "</error>\n\n";
+}
+
+
+void VgLogGen::writeAnnounceThread( QTextStream& strm, int tid )
+{
+   strm << "<announcethread>\n"
+        << "  <hthreadid>" << tid << "</hthreadid>\n";
+   writeStack( strm, qMin( 4, m_params.stackDepth ) );
+   strm << "</announcethread>\n\n";
+}
+
+
+/*!
+  A race between two of the announced threads.
+*/
+void VgLogGen::writeRaceError( QTextStream& strm, int idx )
+{
+   int numThreads = m_params.numThreads;
+   int tid = 2 + random( numThreads );
+   int other = ( numThreads < 2 ) ? tid : 2 + ( tid - 2 + 1 + random( numThreads - 1 ) ) % numThreads;
+   int size = 1 << random( 4 );
+   quint64 addr = 0x5A1D000 + random( 0x100000 ) * 8;
+   bool write = random( 2 );
+
+   strm << "<error>\n"
+        << "  <unique>" << hex( idx ) << "</unique>\n"
+        << "  <tid>" << tid << "</tid>\n"
+        << "  <kind>Race</kind>\n"
+        << "  <xwhat>\n"
+        << "    <text>Possible data race during " << ( write ? "write" : "read" )
+        << " of size " << size << " at " << hex( addr ) << " by thread #" << tid << "</text>\n"
+        << "    <hthreadid>" << tid << "</hthreadid>\n"
+        << "  </xwhat>\n";
+   writeStack( strm, m_params.stackDepth );
+   strm << "  <xauxwhat>\n"
+        << "    <text>This conflicts with a previous write of size " << size
+        << " by thread #" << other << "</text>\n"
+        << "    <hthreadid>" << other << "</hthreadid>\n"
+        << "  </xauxwhat>\n";
+   writeStack( strm, m_params.stackDepth );
+   strm << "</error>\n\n";
+
+   m_counts << 1 + random( 20 );
+}
+
+
+/*!
+  Counts of all the non-leak errors, as valgrind gives at exit.
+*/
+void VgLogGen::writeErrorCounts( QTextStream& strm )
+{
+   strm << "<errorcounts>\n";
+   for ( int i = 0; i < m_counts.count(); ++i ) {
+      strm << "  <pair>\n"
+           << "    <count>" << m_counts.at( i ) << "</count>\n"
+           << "    <unique>" << hex( i ) << "</unique>\n"
+           << "  </pair>\n";
+   }
+   strm << "</errorcounts>\n\n";
+}
+
+
+/*!
+  The source files the frames refer to: srcFileLines lines each.
+*/
+bool VgLogGen::writeSources( QString& errMsg )
+{
+   if ( m_params.srcDir.isEmpty() || !QDir().mkpath( m_params.srcDir ) ) {
+      errMsg = "Failed to create source dir: '" + m_params.srcDir + "'";
+      return false;
+   }
+
+   for ( int f = 0; f < m_params.numSrcFiles; ++f ) {
+      QString fname = QString( "%1/bench_%2.c" ).arg( m_params.srcDir ).arg( f );
+      QSaveFile file( fname );
+      if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+         errMsg = "Failed to open source file: '" + fname + "'";
+         return false;
+      }
+      QTextStream strm( &file );
+      for ( int ln = 1; ln <= m_params.srcFileLines; ++ln ) {
+         strm << "   acc = bench_step( acc, " << ln << " );   /* bench_"
+              << f << ".c:" << ln << " */\n";
+      }
+      strm.flush();
+      if ( !file.commit() ) {
+         errMsg = "Failed to write source file: '" + fname + "'";
+         return false;
+      }
+   }
+   return true;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+** VgLogGen definition
+**  - deterministic synthetic valgrind xml logs, for benchmarking
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGGEN_H
+#define __VGLOGGEN_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+
+// ============================================================
+/*!
+  What to generate. Frames draw their function from numSymbols
+  distinct symbols, and a symbol always has the same ip, object,
+  file and line, so the symbol cardinality sets how much a log
+  repeats itself - as real logs do.
+*/
+class VgLogGenParams
+{
+public:
+   VgLogGenParams()
+      : tool( "memcheck" ), numErrors( 1000 ), stackDepth( 12 ),
+        numSymbols( 500 ), numLeaks( 100 ), numThreads( 4 ),
+        numSrcFiles( 20 ), srcFileLines( 2000 ), seed( 1 ) {}
+
+   bool set( const QString& keyEqVal, QString& errMsg );
+   QJsonObject toJson() const;
+
+   QString tool;        // memcheck | helgrind
+   int numErrors;       // distinct errors before the leak check
+   int stackDepth;      // frames per stack
+   int numSymbols;      // distinct functions the frames draw on
+   int numLeaks;        // loss records (memcheck)
+   int numThreads;      // threads announced, and racing (helgrind)
+   int numSrcFiles;     // source files the symbols live in
+   int srcFileLines;    // ... and their length
+   QString srcDir;      // where the source files are (absolute)
+   quint32 seed;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogGen: writes a protocol-4 xml log as valgrind would, from
+  VgLogGenParams alone: the same params always give the same bytes.
+
+  writeSources() writes the source files the frames refer to, so
+  the source snippets under each frame can be loaded too.
+*/
+class VgLogGen
+{
+public:
+   VgLogGen( const VgLogGenParams& params );
+
+   bool write( const QString& logFile, QString& errMsg );
+   bool writeSources( QString& errMsg );
+
+private:
+   quint32 random( quint32 range );
+   QString hex( quint64 val );
+
+   void writePreamble( QTextStream& strm );
+   void writeStatus( QTextStream& strm, const QString& state );
+   void writeStack( QTextStream& strm, int depth );
+   void writeFrame( QTextStream& strm, int sym );
+   void writeMemcheckError( QTextStream& strm, int idx );
+   void writeLeakError( QTextStream& strm, int idx );
+   void writeAnnounceThread( QTextStream& strm, int tid );
+   void writeRaceError( QTextStream& strm, int idx );
+   void writeErrorCounts( QTextStream& strm );
+
+private:
+   VgLogGenParams m_params;
+   quint64 m_state;        // the random number generator's
+   QList<int> m_counts;    // times each error was seen
+};
+
+#endif // #ifndef __VGLOGGEN_H
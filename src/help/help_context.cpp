@@ -25,6 +25,7 @@
 
 #include "help/help_context.h"
 #include "help/help_handbook.h"
+#include "mainwindow.h"
 #include "utils/vk_utils.h"              // VK_DEBUG
 
 
@@ -45,7 +46,7 @@ ContextHelpAction::~ContextHelpAction()
 }
 
 
-ContextHelpAction::ContextHelpAction( QWidget* parent, HandBook* book )
+ContextHelpAction::ContextHelpAction( MainWindow* parent )
    : QAction( parent )
 {
    setObjectName( QString::fromUtf8( "ctxt_help_tb" ) );
@@ -53,7 +54,7 @@ ContextHelpAction::ContextHelpAction( QWidget* parent, HandBook* book )
    ContextHelp::setupSingleton();
    
    ctxt->actions.append( this );
-   ctxt->hbook = book;
+   ctxt->mainWin = parent;
    
    setIcon( QPixmap( QString::fromUtf8( ":/vk_icons/icons/context_help.xpm" ) ) );
    setCheckable( true );
@@ -104,6 +105,7 @@ ContextHelp::ContextHelp()
 {
    setObjectName( QString::fromUtf8( "ctxt_help_tb" ) );
    ctxt = this;
+   mainWin = 0;
    listeningForEvent = false;
 }
 
@@ -265,6 +267,8 @@ void ContextHelp::showHelp( const QString& text )
       return;
    }
    
+   // the handbook is made on first use: this may be it
+   HandBook* hbook = mainWin->getHandBook();
    if ( !hbook->isVisible() ) {
    
       // find out where MainWindow is, and park up beside it
@@ -30,7 +30,7 @@
 
 
 // Forward decls
-class HandBook;
+class MainWindow;
 
 
 // ============================================================
@@ -38,7 +38,7 @@ class ContextHelpAction: public QAction
 {
    Q_OBJECT
 public:
-   ContextHelpAction( QWidget* parent, HandBook* book );
+   ContextHelpAction( MainWindow* parent );
    ~ContextHelpAction();
    
 public slots:
@@ -68,7 +68,7 @@ private:
    void cancelHelpEvent();
    void remove( QWidget* );
    
-   HandBook* hbook;   // ptr to the application-wide handbook
+   MainWindow* mainWin;   // has the application-wide handbook
    
    QHash<QWidget*, QString> wdict;    // mapping widg->url
    QList<ContextHelpAction*> actions; // allows turning off all registered ctxt help actions
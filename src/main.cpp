@@ -20,6 +20,12 @@
 
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <stdio.h>
+#include <string.h>
 
 #include "mainwindow.h"
 #include "objects/valkyrie_object.h"
@@ -27,6 +33,7 @@
 #include "toolview/toolview.h"
 #include "utils/vk_utils.h"
 #include "utils/vk_config.h"
+#include "utils/vk_trace.h"
 
 
 VkCfgGlbl* vkCfgGlbl = NULL;  // Singleton VkCfgGlbl (non-project config)
@@ -34,6 +41,62 @@ VkCfgProj* vkCfgProj = NULL;  // Singleton VkCfgProj (project config)
 
 
 
+/*!
+    Headless mode / startup profile requested?
+    Must be known before the application object is created, so before
+    the proper cmdline parse: that then checks we got it right.
+    As there, our options end at the first argument that isn't one:
+    the program to run, whose own arguments follow.
+*/
+static bool wantEarlyFlag( int argc, char* argv[], const char* flag )
+{
+   for ( int i = 1; i < argc; i++ ) {
+      if ( strcmp( argv[i], "--" ) == 0 || argv[i][0] != '-' ) {
+         break;
+      }
+      if ( strcmp( argv[i], flag ) == 0 ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+
+/*!
+    --startup-profile: the time taken by each phase of startup, from
+    main() on.  Kept until the cmdline parse says the flag was ours,
+    then reported on stderr, just before we hand over to the event loop
+    (or to the batch run).
+*/
+static QElapsedTimer startupClock;
+static qint64        startupLastNs = 0;
+static QStringList   startupPhases;
+
+static void startupPhase( const char* phase )
+{
+   if ( !startupClock.isValid() ) {
+      return;
+   }
+   qint64 nowNs = startupClock.nsecsElapsed();
+   startupPhases << QString( "%1 %2 ms" ).arg( phase, -16 )
+                    .arg( ( nowNs - startupLastNs ) / 1e6, 8, 'f', 2 );
+   startupLastNs = nowNs;
+}
+
+static void startupReport()
+{
+   if ( !startupClock.isValid() ) {
+      return;
+   }
+   foreach ( QString line, startupPhases ) {
+      fprintf( stderr, "startup: %s\n", qPrintable( line ) );
+   }
+   fprintf( stderr, "startup: %-16s %8.2f ms\n", "total",
+            startupClock.nsecsElapsed() / 1e6 );
+   startupClock.invalidate();
+}
+
+
 /*!
     Main program entry point
     arguments parsed, Qt setup, application setup, the ball set rolling.
@@ -41,17 +104,29 @@ VkCfgProj* vkCfgProj = NULL;  // Singleton VkCfgProj (project config)
 int main( int argc, char* argv[] )
 {
    int exit_status = EXIT_SUCCESS;
-   QApplication* app  = 0;
+   QCoreApplication* app = 0;
    MainWindow* vkWin  = 0;
    VGTOOL::ToolProcessId startProcess = VGTOOL::PROC_NONE;
+   bool batch_mode = wantEarlyFlag( argc, argv, "--batch" );
+   if ( wantEarlyFlag( argc, argv, "--startup-profile" ) ) {
+      startupClock.start();
+   }
 
    // ------------------------------------------------------------
    // Create all VkObjects: Vk[ Vg[ Tools[] ] ]
    Valkyrie valkyrie;
+   startupPhase( "objects" );
    
    // ------------------------------------------------------------
    // Start turning the engine over
-   app = new QApplication( argc, argv );
+   //  - batch mode: no widgets, so no need for (or of) a display.
+   if ( batch_mode ) {
+      app = new QCoreApplication( argc, argv );
+   }
+   else {
+      app = new QApplication( argc, argv );
+   }
+   startupPhase( "application" );
    
    // ------------------------------------------------------------
    // Setup application config settings
@@ -69,6 +144,7 @@ int main( int argc, char* argv[] )
                 qPrintable( VkCfg::cfgDir() ) );
       goto cleanup_and_exit;
    }
+   startupPhase( "project config" );
 
    cfg_ok = VkCfgGlbl::createConfig();
    if ( !cfg_ok || vkCfgGlbl == NULL ) {
@@ -78,6 +154,7 @@ int main( int argc, char* argv[] )
                 qPrintable( VkCfg::cfgDir() ) );
       goto cleanup_and_exit;
    }
+   startupPhase( "global config" );
 
    //TODO: check docs found
 
@@ -86,9 +163,13 @@ int main( int argc, char* argv[] )
    //  - if a project file is given, the settings will override the initialised vkCfgProj.
    if ( argc > 1 ) {
       // parse cmdline args, overwrite vkCfgProj with any options found.
+      //  - one config sync for the lot, not one per option
       bool show_help_and_exit;
       
-      if ( ! parseCmdArgs( argc, argv, &valkyrie, show_help_and_exit ) ) {
+      vkCfgProj->beginBatch();
+      bool parsed_ok = parseCmdArgs( argc, argv, &valkyrie, show_help_and_exit );
+      vkCfgProj->endBatch();
+      if ( !parsed_ok ) {
          exit_status = EXIT_FAILURE;
          goto cleanup_and_exit;
       }
@@ -100,12 +181,42 @@ int main( int argc, char* argv[] )
    
    // save the working config we've gotten so far.
    vkCfgProj->sync();
+   startupPhase( "command line" );
+
+   // the '--startup-profile' we found belongs to the program to run
+   if ( !valkyrie.isStartupProfile() ) {
+      startupClock.invalidate();
+   }
+
+   // time this session's log loading, for --trace-out
+   if ( !valkyrie.traceOutFile().isEmpty() ) {
+      QString errMsg;
+      if ( !VkTrace::instance()->startTrace( valkyrie.traceOutFile(), errMsg ) ) {
+         vkPrintErr( "%s", qPrintable( errMsg ) );
+      }
+   }
+   
+   // ------------------------------------------------------------
+   // Headless: report on the log(s), and exit.
+   if ( batch_mode ) {
+      if ( !valkyrie.isBatchMode() ) {
+         // the '--batch' we found belongs to the program to run
+         vkPrintErr( "--batch must come before the program to run." );
+         exit_status = EXIT_FAILURE;
+      }
+      else {
+         startupReport();
+         exit_status = valkyrie.runBatch();
+      }
+      goto cleanup_and_exit;
+   }
    
    
    
    // ------------------------------------------------------------
    // Start up the gui
    vkWin = new MainWindow( &valkyrie );
+   startupPhase( "main window" );
    
    if ( 0 && vkCfgProj->value(
            valkyrie.getOption( VALKYRIE::BINARY )->configKey() ).toString().isEmpty() ) {
@@ -113,6 +224,7 @@ int main( int argc, char* argv[] )
    }
    
    vkWin->showToolView( VGTOOL::ID_MEMCHECK );
+   startupPhase( "tool view" );
    vkWin->show();
 
    // start up a process (run valgrind / view-log / ...) from the command line.
@@ -122,6 +234,8 @@ int main( int argc, char* argv[] )
    }
    
    qApp->processEvents();
+   startupPhase( "first paint" );
+   startupReport();
    
    // ------------------------------------------------------------
    // Hand over to QtApp.
@@ -132,6 +246,12 @@ cleanup_and_exit:
 
    // ------------------------------------------------------------
    // We're done - clean up and return.
+   if ( VkTrace::instance()->isTracing() ) {
+      QString errMsg;
+      if ( !VkTrace::instance()->writeTrace( errMsg ) ) {
+         vkPrintErr( "%s", qPrintable( errMsg ) );
+      }
+   }
    if ( vkWin ) {
       delete vkWin;
    }
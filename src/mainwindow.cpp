@@ -22,22 +22,27 @@
 #include <QColor>
 #include <QColor>
 #include <QEvent>
+#include <QFile>
 #include <QFileDialog>
 #include <QGroupBox>
 #include <QInputDialog>
 #include <QMenu>
 #include <QMenuBar>
+#include <QThread>
 #include <QToolBar>
 
 #include "mainwindow.h"
 #include "toolview/memcheckview.h"
 #include "toolview/helgrindview.h"
+#include "toolview/vgjobqueue_dialog.h"
 
 #include "help/help_about.h"
 #include "help/help_context.h"
 #include "help/help_urls.h"
 #include "options/vk_option.h"
 #include "objects/tool_object.h"
+#include "utils/vgcapabilities.h"
+#include "utils/vgoptprofile.h"
 #include "utils/vk_config.h"
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"
@@ -67,7 +72,7 @@
 */
 MainWindow::MainWindow( Valkyrie* vk )
    : QMainWindow(),
-     valkyrie( vk ), toolViewStack( 0 ), statusLabel( 0 ),
+     valkyrie( vk ), toolViewStack( 0 ), statusLabel( 0 ), loadProgressBar( 0 ),
      handBook( 0 ), optionsDialog( 0 )
 {
    setObjectName( QString::fromUtf8( "MainWindowClass" ) );
@@ -80,9 +85,6 @@ MainWindow::MainWindow( Valkyrie* vk )
    icon_vk.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/valkyrie.xpm" ) ) );
    setWindowIcon( icon_vk );
 
-   // handbook: init before menubar / toolbar
-   handBook = new HandBook();
-
    // interface setup
    setupLayout();
    setupActions();
@@ -103,6 +105,13 @@ MainWindow::MainWindow( Valkyrie* vk )
    connect( opt, SIGNAL( valueChanged() ), this, SLOT( setToolFont() ) );
    opt = valkyrie->getOption( VALKYRIE::PALETTE );
    connect( opt, SIGNAL( valueChanged() ), this, SLOT( setPalette() ) );
+   opt = valkyrie->getOption( VALKYRIE::VG_EXEC );
+   connect( opt, SIGNAL( valueChanged() ), this, SLOT( probeValgrind() ) );
+
+   // what can our valgrind do? found out off the gui thread, once per binary
+   connect( VgCapsCache::instance(), SIGNAL( probed( QString, bool, QString ) ),
+            this, SLOT( valgrindProbed( QString, bool, QString ) ) );
+   probeValgrind();
 
    showLabels();
    showToolTips();
@@ -111,7 +120,6 @@ MainWindow::MainWindow( Valkyrie* vk )
    setPalette();
 
    updateEventFilters( this );
-   updateEventFilters( handBook );
 
 #if 0
    // CAB: Handy shortcut for testing: load last project
@@ -271,6 +279,18 @@ void MainWindow::setupActions()
    actProcess_Stop->setIconVisibleInMenu( true );
    connect( actProcess_Stop, SIGNAL( triggered() ), this, SLOT( stopTool() ) );
 
+   actProcess_RunJobs = new QAction( this );
+   actProcess_RunJobs->setObjectName( QString::fromUtf8( "actProcess_RunJobs" ) );
+   actProcess_RunJobs->setText( tr( "Run &Job List..." ) );
+   actProcess_RunJobs->setToolTip( tr( "Run Valgrind on many programs at once, from a job list" ) );
+   connect( actProcess_RunJobs, SIGNAL( triggered() ), this, SLOT( runJobList() ) );
+
+   actProcess_OptProfile = new QAction( this );
+   actProcess_OptProfile->setObjectName( QString::fromUtf8( "actProcess_OptProfile" ) );
+   actProcess_OptProfile->setText( tr( "Profile Memcheck &Options..." ) );
+   actProcess_OptProfile->setToolTip( tr( "Time Memcheck on the binary under each setting of its costly options" ) );
+   connect( actProcess_OptProfile, SIGNAL( triggered() ), this, SLOT( profileOptions() ) );
+
    actHelp_Handbook = new QAction( this );
    actHelp_Handbook->setObjectName( QString::fromUtf8( "actHelp_Handbook" ) );
    actHelp_Handbook->setText( tr( "Handbook" ) );
@@ -282,6 +302,12 @@ void MainWindow::setupActions()
    actHelp_Handbook->setIconVisibleInMenu( true );
    connect( actHelp_Handbook, SIGNAL( triggered() ), this, SLOT( openHandBook() ) );
 
+   actHelp_Metrics = new QAction( this );
+   actHelp_Metrics->setObjectName( QString::fromUtf8( "actHelp_Metrics" ) );
+   actHelp_Metrics->setText( tr( "Performance &Metrics" ) );
+   actHelp_Metrics->setToolTip( tr( "Where the time goes when loading and viewing logs" ) );
+   connect( actHelp_Metrics, SIGNAL( triggered() ), this, SLOT( openMetrics() ) );
+
    actHelp_About_Valkyrie = new QAction( this );
    actHelp_About_Valkyrie->setObjectName( QString::fromUtf8( "actHelp_About_Valkyrie" ) );
    actHelp_About_Valkyrie->setText( tr( "About Valkyrie" ) );
@@ -371,7 +397,7 @@ void MainWindow::setupMenus()
    menuHelp->setTitle( tr( "Help" ) );
 
    // application-wide context help button
-   ContextHelpAction* ctxtHlpAction = new ContextHelpAction( this, handBook );
+   ContextHelpAction* ctxtHlpAction = new ContextHelpAction( this );
    ctxtHlpAction->setText( tr( "Context Help" ) );
 
 
@@ -401,6 +427,9 @@ void MainWindow::setupMenus()
 
    menuProcess->addAction( actProcess_Run );
    menuProcess->addAction( actProcess_Stop );
+   menuProcess->addSeparator();
+   menuProcess->addAction( actProcess_RunJobs );
+   menuProcess->addAction( actProcess_OptProfile );
 
    foreach( QAction * actTool, toolActionGroup->actions() ) {
       menuTools->addAction( actTool );
@@ -409,6 +438,7 @@ void MainWindow::setupMenus()
    menuHelp->addAction( ctxtHlpAction );
    menuHelp->addSeparator();
    menuHelp->addAction( actHelp_Handbook );
+   menuHelp->addAction( actHelp_Metrics );
    menuHelp->addSeparator();
    menuHelp->addAction( actHelp_About_Valkyrie );
    menuHelp->addAction( actHelp_About_Qt );
@@ -462,6 +492,30 @@ void MainWindow::setupStatusBar()
 
    mainStatusBar->addWidget( statusLabel, 1 );
 //   mainStatusBar->addPermanentWidget( permanentLabel, 0 );
+
+   // how far through the file a (progressively) loading log is
+   loadProgressBar = new QProgressBar( mainStatusBar );
+   loadProgressBar->setObjectName( QString::fromUtf8( "loadProgressBar" ) );
+   loadProgressBar->setRange( 0, 1000 );
+   loadProgressBar->setMaximumWidth( 200 );
+   loadProgressBar->setFormat( "%p%" );
+   loadProgressBar->hide();
+   mainStatusBar->addPermanentWidget( loadProgressBar, 0 );
+}
+
+
+/*!
+  A tool object's log loading: bytes read, of total.  Hidden once
+  done (total 0).  Per mille: an int's too small for the bytes.
+*/
+void MainWindow::updateLoadProgress( qint64 done, qint64 total )
+{
+   if ( total <= 0 ) {
+      loadProgressBar->hide();
+      return;
+   }
+   loadProgressBar->setValue( ( int )( qMin( done, total ) * 1000 / total ) );
+   loadProgressBar->show();
 }
 
 
@@ -528,10 +582,16 @@ void MainWindow::showToolView( VGTOOL::ToolID toolId )
                this,       SLOT( updateVgButtons( bool ) ) );
       connect( nextTool, SIGNAL( message( QString ) ),
                statusLabel,       SLOT( setText( QString ) ) );
+      connect( nextTool, SIGNAL( loadProgress( qint64, qint64 ) ),
+               this,       SLOT( updateLoadProgress( qint64, qint64 ) ) );
 
       // Set a vg logfile. Loading done by tool_object
       connect( nextView, SIGNAL( logFileChosen( QString ) ),
                this,       SLOT( setLogFile( QString ) ) );
+      connect( nextView, SIGNAL( diffLogChosen( QString ) ),
+               this,       SLOT( setDiffLogFile( QString ) ) );
+      connect( nextView, SIGNAL( mergeLogChosen( QString ) ),
+               this,       SLOT( setMergeLogList( QString ) ) );
 
       //TODO: perhaps bring ToolObject::fileSaveDialog() here too...
       // + ToolObject::saveParsedOutput()...
@@ -584,6 +644,8 @@ void MainWindow::setToggles( VGTOOL::ToolID toolId )
       actFile_Close->setEnabled( false );
       actProcess_Run->setEnabled( false );
       actProcess_Stop->setEnabled( false );
+      actProcess_RunJobs->setEnabled( false );
+      actProcess_OptProfile->setEnabled( false );
    }
    else {
       // at least one toolview found: update state
@@ -605,6 +667,8 @@ void MainWindow::setToggles( VGTOOL::ToolID toolId )
       }
 
       actFile_Close->setEnabled( true );
+      actProcess_RunJobs->setEnabled( true );
+      actProcess_OptProfile->setEnabled( true );
       updateVgButtons( false );
    }
 }
@@ -750,6 +814,28 @@ void MainWindow::setLogFile( QString logFilename )
 }
 
 
+/*!
+  Set baseline logfile to compare the current log against.
+  As setLogFile(), but for cmd line --diff-log
+*/
+void MainWindow::setDiffLogFile( QString logFilename )
+{
+   VkOption* opt = valkyrie->getOption( VALKYRIE::DIFF_LOG );
+   opt->updateConfig( logFilename );
+}
+
+
+/*!
+  Set list of logfiles to be merged.
+  As setLogFile(), but for cmd line --merge
+*/
+void MainWindow::setMergeLogList( QString loglistFilename )
+{
+   VkOption* opt = valkyrie->getOption( VALKYRIE::MERGE_LOGS );
+   opt->updateConfig( loglistFilename );
+}
+
+
 /*!
     Create a new project based on the default-project settings.
     Save configuration in a new project file.
@@ -842,6 +928,9 @@ void MainWindow::setCurrentProject(const QString &projPath )
    projName.replace( 0, 1, projName[0].toUpper() );
    setWindowTitle( VkCfg::appTitle() + " - " + projName );
 
+   // the project may use another valgrind
+   probeValgrind();
+
    QStringList files = vkCfgGlbl->value( "recent_projects" )
                        .toString().split( VkCfg::sepChar(), QString::SkipEmptyParts );
    files.removeAll( projPath );
@@ -1009,6 +1098,182 @@ void MainWindow::runValgrind()
 
 
 
+/*!
+  run valgrind --tool=<current_tool> + flags on each program in a
+  job list, many at once: see VgJobQueue.
+  This doesn't touch the tool's own process: the jobs are separate.
+*/
+void MainWindow::runJobList()
+{
+   VGTOOL::ToolID tId = toolViewStack->currentToolId();
+   vk_assert( tId != VGTOOL::ID_NULL );
+
+   QString jobList =
+      QFileDialog::getOpenFileName( this, tr( "Choose Job List" ), "./",
+                                    tr( "All Files (*)" ) );
+   if ( jobList.isEmpty() ) { // user clicked Cancel
+      return;
+   }
+
+   QString errMsg;
+   QList<QStringList> targets;
+   if ( !VgJobQueue::readJobList( jobList, targets, errMsg ) ) {
+      vkError( this, "Run Job List", "<p>%s</p>", qPrintable( errMsg ) );
+      return;
+   }
+
+   int maxJobs = valkyrie->numParallelJobs();
+   if ( maxJobs <= 0 ) {
+      maxJobs = qMax( 1, QThread::idealThreadCount() );
+   }
+   bool ok;
+   maxJobs = QInputDialog::getInt( this, tr( "Run Job List" ),
+                                   tr( "%1 jobs: how many to run at once?" )
+                                   .arg( targets.count() ),
+                                   maxJobs, 1, 1024, 1, &ok );
+   if ( !ok ) {
+      return;
+   }
+
+   VgJobQueue* queue = new VgJobQueue( valkyrie->getJobFlags( tId ), maxJobs );
+   foreach ( QStringList target, targets ) {
+      queue->addJob( target );
+   }
+
+   // the dialog owns the queue: closing it cancels the jobs
+   VgJobQueueDialog* dlg = new VgJobQueueDialog( this, queue );
+   dlg->setAttribute( Qt::WA_DeleteOnClose );
+   connect( dlg,  SIGNAL( viewLog( QString ) ),
+            this, SLOT( viewJobLog( QString ) ) );
+   connect( dlg,  SIGNAL( viewLogList( QString ) ),
+            this, SLOT( viewJobLogList( QString ) ) );
+
+   if ( !queue->start( errMsg ) ) {
+      vkError( this, "Run Job List", "<p>%s</p>", qPrintable( errMsg ) );
+      delete dlg;
+      return;
+   }
+   dlg->show();
+}
+
+
+/*!
+  Run memcheck on the binary under each setting of its costly options,
+  many at once, to see what each costs, against what it finds:
+  see VgOptProfile. The report is shown once all the runs are done.
+*/
+void MainWindow::profileOptions()
+{
+   QStringList target = valkyrie->getTargetFlags();
+   if ( target.isEmpty() ) {
+      vkError( this, "Profile Memcheck Options",
+               "<p>No program to profile: set the Binary (via Options->Valkyrie).</p>" );
+      return;
+   }
+
+   QStringList vgFlags = valkyrie->getJobFlags( VGTOOL::ID_MEMCHECK );
+   int maxJobs = valkyrie->numParallelJobs();
+   if ( maxJobs <= 0 ) {
+      maxJobs = qMax( 1, QThread::idealThreadCount() );
+   }
+   bool ok;
+   maxJobs = QInputDialog::getInt( this, tr( "Profile Memcheck Options" ),
+                                   tr( "Profiling %1:\nhow many runs at once?" )
+                                   .arg( VgOptProfile::axisNames().join( ", " ) ),
+                                   maxJobs, 1, 1024, 1, &ok );
+   if ( !ok ) {
+      return;
+   }
+
+   VgJobQueue* queue = new VgJobQueue( vgFlags, maxJobs );
+   VgOptProfile* profile = new VgOptProfile( vgFlags, queue );
+   profile->addJobs( queue, target );
+   connect( profile, SIGNAL( reportReady( QString ) ),
+            this,    SLOT( showOptProfile( QString ) ) );
+
+   // the dialog owns the queue (and profile): closing it cancels the runs
+   VgJobQueueDialog* dlg = new VgJobQueueDialog( this, queue );
+   dlg->setAttribute( Qt::WA_DeleteOnClose );
+   connect( dlg,  SIGNAL( viewLog( QString ) ),
+            this, SLOT( viewJobLog( QString ) ) );
+   connect( dlg,  SIGNAL( viewLogList( QString ) ),
+            this, SLOT( viewJobLogList( QString ) ) );
+
+   QString errMsg;
+   if ( !queue->start( errMsg ) ) {
+      vkError( this, "Profile Memcheck Options", "<p>%s</p>", qPrintable( errMsg ) );
+      delete dlg;
+      return;
+   }
+   dlg->show();
+}
+
+
+/*!
+  Show the option profile's report, once all its runs are done.
+*/
+void MainWindow::showOptProfile( QString reportFile )
+{
+   QFile file( reportFile );
+   if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
+      vkError( this, "Profile Memcheck Options",
+               "<p>Failed to read the report '%s'</p>", qPrintable( reportFile ) );
+      return;
+   }
+   QString report = QString::fromLocal8Bit( file.readAll() );
+   vkInfo( this, "Profile Memcheck Options", "<p>%s</p><pre>%s</pre>",
+           qPrintable( reportFile ), qPrintable( escapeEntities( report ) ) );
+}
+
+
+/*!
+  View one job's log, from the job queue dialog.
+*/
+void MainWindow::viewJobLog( QString logFilename )
+{
+   setLogFile( logFilename );
+   runTool( VGTOOL::PROC_PARSE_LOG );
+}
+
+/*!
+  View one job's logs (tracing children), from the job queue dialog.
+*/
+void MainWindow::viewJobLogList( QString loglistFilename )
+{
+   setMergeLogList( loglistFilename );
+   runTool( VGTOOL::PROC_MERGE_LOGS );
+}
+
+
+/*!
+  (Re)probe the configured valgrind, unless its capabilities are
+  already cached: see VgCapsCache.
+*/
+void MainWindow::probeValgrind()
+{
+   VgCapsCache::instance()->probeInBackground(
+      vkCfgProj->value( valkyrie->getOption( VALKYRIE::VG_EXEC )->configKey() ).toString() );
+}
+
+
+/*!
+  A valgrind's been probed: only a failure is news to the user.
+*/
+void MainWindow::valgrindProbed( QString vgPath, bool ok, QString errMsg )
+{
+   if ( ok ) {
+      VgCapabilities caps;
+      if ( VgCapsCache::instance()->lookup( vgPath, caps ) ) {
+         statusLabel->setText( "Found " + caps.version + " (" + vgPath + ")" );
+      }
+      return;
+   }
+   vkError( this, "Valgrind Check",
+            "<p>%s</p><p>Please check the Valgrind path (via Options->Valkyrie).</p>",
+            qPrintable( escapeEntities( errMsg ) ) );
+}
+
+
 /*!
     Stop the valgrind tool process.
 */
@@ -1023,7 +1288,37 @@ void MainWindow::stopTool()
 */
 void MainWindow::openHandBook()
 {
-   handBook->showYourself();
+   getHandBook()->showYourself();
+}
+
+
+/*!
+  The handbook: made on first use, as it loads its index page
+  from disk, and that's not something to hold up startup for.
+*/
+HandBook* MainWindow::getHandBook()
+{
+   if ( !handBook ) {
+      handBook = new HandBook();
+      updateEventFilters( handBook );
+   }
+   return handBook;
+}
+
+
+/*!
+    Show the session's performance metrics: one dialog, kept
+    updated while it's open.
+*/
+void MainWindow::openMetrics()
+{
+   if ( metricsDialog == 0 ) {
+      metricsDialog = new VkMetricsDialog( this );
+      metricsDialog->setAttribute( Qt::WA_DeleteOnClose );
+   }
+   metricsDialog->show();
+   metricsDialog->raise();
+   metricsDialog->activateWindow();
 }
 
 
@@ -28,6 +28,8 @@
 #include <QMainWindow>
 #include <QPalette>
 #include <QPlainTextEdit>
+#include <QPointer>
+#include <QProgressBar>
 #include <QStatusBar>
 #include <QToolButton>
 #include <QVBoxLayout>
@@ -36,6 +38,7 @@
 #include "objects/valkyrie_object.h"
 #include "options/vk_options_dialog.h"
 #include "toolview/toolview.h"
+#include "toolview/vkmetrics_dialog.h"
 
 
 // ============================================================
@@ -52,6 +55,7 @@ public:
    Valkyrie* getValkyrie() {
       return valkyrie;
    }
+   HandBook* getHandBook();
    
 public slots:
    void showToolView( VGTOOL::ToolID toolId );
@@ -78,12 +82,16 @@ private slots:
    void saveAsProject();
    void closeToolView();
    void runValgrind();
+   void runJobList();
+   void profileOptions();
    void stopTool();
    void openHandBook();
+   void openMetrics();
    void openAboutVk();
    void openAboutLicense();
    void openAboutSupport();
    void updateVgButtons( bool running );
+   void updateLoadProgress( qint64 done, qint64 total );
    
    // functions for dealing with config updates
    void showLabels();
@@ -94,6 +102,13 @@ private slots:
    
    // functions for dealing with toolview updates
    void setLogFile( QString logFilename );
+   void setDiffLogFile( QString logFilename );
+   void setMergeLogList( QString loglistFilename );
+   void viewJobLog( QString logFilename );
+   void viewJobLogList( QString loglistFilename );
+   void showOptProfile( QString reportFile );
+   void probeValgrind();
+   void valgrindProbed( QString vgPath, bool ok, QString errMsg );
    
    
 private:
@@ -108,7 +123,10 @@ private:
    QAction* actEdit_Search;
    QAction* actProcess_Run;
    QAction* actProcess_Stop;
+   QAction* actProcess_RunJobs;
+   QAction* actProcess_OptProfile;
    QAction* actHelp_Handbook;
+   QAction* actHelp_Metrics;
    QAction* actHelp_About_Valkyrie;
    QAction* actHelp_About_Qt;
    QAction* actHelp_License;
@@ -130,8 +148,10 @@ private:
    Valkyrie*        valkyrie;
    ToolViewStack*   toolViewStack;
    QLabel*          statusLabel;
+   QProgressBar*    loadProgressBar;   // shown while a log loads
    HandBook*        handBook;
    VkOptionsDialog* optionsDialog;
+   QPointer<VkMetricsDialog> metricsDialog;   // deletes itself on close
    
    bool     fShowToolTips;
    QFont    lastAppFont;
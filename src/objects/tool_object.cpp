@@ -35,6 +35,10 @@ processDone() ->(parser alive && vgproc error)-> stopProcess()
 readVgLog()   ->(parser error && vgproc alive)-> stopProcess()
 User Input    ->(Stop command)-> stop()       -> stopProcess()
 
+=== Loading a log (gui) ===
+start() -> parseLogFile() -> VgLogLoader ->(parsed on a pool thread,
+        shown a chunk at a time)-> ... ->(all in)-> logLoaded() -> DONE
+
 stopProcess()
   -> cleanup logpoller
   -> cleanup vgproc
@@ -60,11 +64,20 @@ stopProcess()
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"      // vk_assert, VK_DEBUG, etc.
 #include "utils/vglogreader.h"
+#include "utils/vglogdiff.h"
+#include "utils/vglogexport.h"
+#include "utils/vglogmerge.h"
+#include "toolview/vglogdiff_dialog.h"
+#include "options/suppressions.h"
 #include "options/vk_option.h"   // PERROR* and friends
 //#include "vk_file_utils.h"       // FileCopy()
 
 #include <QApplication>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThreadPool>
 #include <QTimer>
 #endif
 
@@ -93,12 +106,18 @@ stopProcess()
 ToolObject::ToolObject( const QString& toolname, VGTOOL::ToolID id )
    : VkObject( toolname ),
      toolView( 0 ), vgRunSaved( true ), processId( VGTOOL::PROC_NONE ),
-     toolId( id ), vgreader( 0 ), vgproc( 0 )
+     toolId( id ), vgreader( 0 ), logLoader( 0 ),
+     vgproc( 0 ), vglogview( 0 )
 {
    // init logpoller
    logpoller = new VkLogPoller( this );
    connect( logpoller, SIGNAL( logUpdated() ),
             this,        SLOT( readVgLog() ) );
+
+   // init process sampler
+   procsampler = new VkProcSampler( this );
+   connect( procsampler, SIGNAL( sampled() ),
+            this,        SLOT( updateResources() ) );
 }
 
 ToolObject::~ToolObject()
@@ -122,6 +141,12 @@ ToolObject::~ToolObject()
       delete vgreader;
       vgreader = 0;
    }
+   deleteChildReaders();
+
+   if ( logLoader ) {
+      delete logLoader;
+      logLoader = 0;
+   }
 
    // logpoller auto deleted by Qt when 'this' dies
 
@@ -129,6 +154,7 @@ ToolObject::~ToolObject()
    if ( QFile::exists( tmplogFname ) ) {
       QFile::remove( tmplogFname );
    }
+   removeChildLogs();
 }
 
 
@@ -143,6 +169,12 @@ ToolView* ToolObject::createView( QWidget* parent )
    // signals tool_view --> tool_obj
    connect( toolView, SIGNAL( saveLogFile() ),
             this,       SLOT( fileSaveDialog() ) );
+   connect( toolView, SIGNAL( exportLogFile() ),
+            this,       SLOT( fileExportDialog() ) );
+   connect( toolView, SIGNAL( message( QString ) ),
+            this,     SIGNAL( message( QString ) ) );
+   connect( this,     SIGNAL( loadProgress( qint64, qint64 ) ),
+            toolView,   SLOT( loadProgress( qint64, qint64 ) ) );
 
    // signals tool_obj --> tool_view
    connect( this,    SIGNAL( running( bool ) ),
@@ -241,7 +273,13 @@ bool ToolObject::start( VGTOOL::ToolProcessId procId,
       ok = runValgrind( vgflags );
       break;
    case VGTOOL::PROC_PARSE_LOG:
-      ok = parseLogFile();
+      ok = parseLogFile( true/*progressive*/ );
+      break;
+   case VGTOOL::PROC_DIFF_LOG:
+      ok = diffLogFiles();
+      break;
+   case VGTOOL::PROC_MERGE_LOGS:
+      ok = mergeLogFiles();
       break;
    default:
       vk_assert_never_reached();
@@ -256,8 +294,12 @@ bool ToolObject::start( VGTOOL::ToolProcessId procId,
   Called by valkyrie->runTool() if cmdline --view-log=<file> specified.
   ToolView::openLogFile() if gui parse-log selected.
   If 'checked' == true, file perms/format has already been checked
+
+  progressive: return at once, the log being read in the background
+  (VgLogLoader), so a huge log can be looked at while it loads.
+  The process stays PROC_PARSE_LOG until it's all in: logLoaded().
 */
-bool ToolObject::parseLogFile()
+bool ToolObject::parseLogFile( bool progressive )
 {
    vk_assert( toolView != 0 );
    // any vg run should have been cleaned up:
@@ -289,12 +331,25 @@ bool ToolObject::parseLogFile()
    // Could be a very large file, so at least get ui up-to-date now
    qApp->processEvents( QEventLoop::AllEvents, 1000/*max msecs*/ );
 
+   if ( progressive ) {
+      loadLog = log_file;
+      logLoader = new VgLogLoader( toolView->createVgLogView(), this );
+      connect( logLoader, SIGNAL( progress( qint64, qint64 ) ),
+               this,        SIGNAL( loadProgress( qint64, qint64 ) ) );
+      connect( logLoader, SIGNAL( finished( bool, QString ) ),
+               this,        SLOT( logLoaded( bool, QString ) ) );
+      statusMsg( "Loading '" + log_file + "'" );
+      logLoader->start( QThreadPool::globalInstance(), log_file );
+      return true;
+   }
+
    // Parse the log
    VgLogReader vgLogFileReader( toolView->createVgLogView() );
    bool success = vgLogFileReader.parse( log_file );
 
    if ( success ) {
       statusMsg( "Loaded Logfile '" + log_file + "'" );
+      viewLogs = QStringList( log_file );
    }
    else {
       statusMsg( "Error Parsing Logfile '" + log_file + "'" );
@@ -309,6 +364,160 @@ bool ToolObject::parseLogFile()
 }
 
 
+/*!
+  All in, or failed: what's been loaded stays in the view.
+*/
+void ToolObject::logLoaded( bool ok, QString errMsg )
+{
+   logLoader->deleteLater();   // we're in its signal
+   logLoader = 0;
+   emit loadProgress( 0, 0 );
+
+   if ( ok ) {
+      statusMsg( "Loaded Logfile '" + loadLog + "'" );
+      viewLogs = QStringList( loadLog );
+   }
+   else {
+      statusMsg( "Error Parsing Logfile '" + loadLog + "'" );
+      vkError( toolView, "XML Parse Error",
+               "<p>%s</p>", qPrintable( str2html( escapeEntities( errMsg ) ) ) );
+   }
+
+   setProcessId( VGTOOL::PROC_NONE );
+}
+
+
+/*!
+  Compare log file given by [VALKYRIE::VIEW_LOG] against the
+  baseline given by [VALKYRIE::DIFF_LOG].
+  Called by valkyrie->runTool() if cmdline --diff-log=<file> specified.
+  ToolView::openLogDiff() if gui compare-log selected.
+
+  The current log is loaded into the view as usual; the comparison
+  itself works on light-weight digests of both logs, not on the view.
+*/
+bool ToolObject::diffLogFiles()
+{
+   vk_assert( toolView != 0 );
+
+   QString base_file = vkCfgProj->value( "valkyrie/diff-log" ).toString();
+   QString log_file  = vkCfgProj->value( "valkyrie/view-log" ).toString();
+
+   if ( log_file.isEmpty() ) {
+      vkError( toolView, "Log Comparison",
+               "<p>No log to compare with the baseline log.<br>"
+               "Please specify one via --view-log=&lt;file&gt;.</p>" );
+      return false;
+   }
+
+   // load the current log into the view: sets processId for us.
+   if ( !parseLogFile() ) {
+      return false;
+   }
+   log_file = vkCfgProj->value( "valkyrie/view-log" ).toString();
+
+   setProcessId( VGTOOL::PROC_DIFF_LOG );
+   statusMsg( "Comparing '" + log_file + "' with '" + base_file + "'" );
+
+   int errval = PARSED_OK;
+   QString ret_file = fileCheck( &errval, base_file, true );
+
+   if ( errval != PARSED_OK ) {
+      vkError( toolView, "File Error", "%s: \n\"%s\"",
+               parseErrString( errval ),
+               qPrintable( escapeEntities( base_file ) ) );
+      setProcessId( VGTOOL::PROC_NONE );
+      return false;
+   }
+   base_file = ret_file;
+
+   qApp->processEvents( QEventLoop::AllEvents, 1000/*max msecs*/ );
+
+   VgLogDiff logDiff;
+   QString errMsg;
+   bool success = logDiff.diff( base_file, log_file, errMsg );
+
+   if ( success ) {
+      statusMsg( QString( "Compared logs: %1 new, %2 fixed, %3 persisting" )
+                 .arg( logDiff.numEntries( VGLOGDIFF::NEW ) )
+                 .arg( logDiff.numEntries( VGLOGDIFF::FIXED ) )
+                 .arg( logDiff.numEntries( VGLOGDIFF::PERSISTING ) ) );
+      setProcessId( VGTOOL::PROC_NONE );
+
+      VgLogDiffDialog dlg( toolView, &logDiff );
+      dlg.exec();
+   }
+   else {
+      statusMsg( "Error Comparing Logfiles" );
+      setProcessId( VGTOOL::PROC_NONE );
+
+      vkError( toolView, "Log Comparison Error",
+               "<p>%s</p>", qPrintable( str2html( escapeEntities( errMsg ) ) ) );
+   }
+
+   return success;
+}
+
+
+/*!
+  Merge the log files listed in [VALKYRIE::MERGE_LOGS] into one view.
+  Called by valkyrie->runTool() if cmdline --merge=<loglist> specified.
+  ToolView::openLogMerge() if gui merge-logs selected.
+*/
+bool ToolObject::mergeLogFiles()
+{
+   vk_assert( toolView != 0 );
+   // any vg run should have been cleaned up:
+   vk_assert( vgRunSaved );
+   vk_assert( tmplogFname.isEmpty() );
+
+   setProcessId( VGTOOL::PROC_MERGE_LOGS );
+
+   QString loglist = vkCfgProj->value( "valkyrie/merge" ).toString();
+
+   // check this is a valid file, and has at least read perms
+   int errval = PARSED_OK;
+   QString ret_file = fileCheck( &errval, loglist, true );
+
+   if ( errval != PARSED_OK ) {
+      vkError( toolView, "File Error", "%s: \n\"%s\"",
+               parseErrString( errval ),
+               qPrintable( escapeEntities( loglist ) ) );
+      setProcessId( VGTOOL::PROC_NONE );
+      return false;
+   }
+   loglist = ret_file;
+
+   QString errMsg;
+   QStringList log_files;
+   bool success = VgLogMerge::readLogList( loglist, log_files, errMsg );
+
+   if ( success ) {
+      statusMsg( QString( "Merging %1 logs from '%2'" )
+                 .arg( log_files.count() ).arg( loglist ) );
+      qApp->processEvents( QEventLoop::AllEvents, 1000/*max msecs*/ );
+
+      VgLogMerge merger;
+      success = merger.merge( log_files, toolView->createVgLogView(), errMsg );
+
+      if ( success ) {
+         statusMsg( QString( "Merged %1 logs: %2 distinct errors" )
+                    .arg( log_files.count() ).arg( merger.numErrors() ) );
+         viewLogs = log_files;
+      }
+   }
+
+   if ( !success ) {
+      statusMsg( "Error Merging Logfiles" );
+      vkError( toolView, "Log Merge Error",
+               "<p>%s</p>", qPrintable( str2html( escapeEntities( errMsg ) ) ) );
+   }
+
+   setProcessId( VGTOOL::PROC_NONE );
+   return success;
+}
+
+
 /*!
   Run a VKProcess, as given by 'flags'.
    - Reads ouput from file, loading this to the listview.
@@ -335,7 +544,10 @@ bool ToolObject::runValgrind( QStringList flags )
 
    // new vgreader - view may have been recreated, so need up-to-date ptr
    vk_assert( vgreader == 0 );
-   vgreader = new VgLogReader( toolView->createVgLogView() );
+   vk_assert( childReaders.isEmpty() && childLogs.isEmpty() );
+   vglogview = toolView->createVgLogView();
+   vgreader = new VgLogReader( vglogview );
+   viewLogs.clear();   // the view now shows this run
 
    // start a new process, listening on exit signal to call processDone().
    //  - once Vg is done, we can read the remainder of the log in one last go.
@@ -354,6 +566,17 @@ bool ToolObject::runValgrind( QStringList flags )
    vgproc->start( program, args );
    //VK_DEBUG( "Started VgProcess" );
 
+   // tracing children: each process logs to its own file (%p -> pid).
+   // Valgrind's pid is that of the main process: children are found
+   // later, by readChildLogs().
+   childLogPattern = QString();
+   if ( tmplogFname.contains( "%p" ) ) {
+      childLogPattern = tmplogFname;
+      if ( vgproc->waitForStarted( WAIT_VG_START_MAX ) ) {
+         tmplogFname.replace( "%p", QString::number( vgproc->pid() ) );
+      }
+   }
+
    // Make sure Vg started ok before moving further.
    // Don't bother using QProcess::start():
    //  1) Vg may have finished already(!)
@@ -373,6 +596,13 @@ bool ToolObject::runValgrind( QStringList flags )
       // poll log regularly to trigger parsing of the latest data via readVgLog()
       // doesn't matter if processDone() or readVgLog() gets called first.
       logpoller->start( 250 );  // msec
+
+      // sample valgrind's resource usage, if wanted
+      int interval = vkCfgProj->value( "valkyrie/sample-interval" ).toInt();
+      if ( interval > 0 && VkProcSampler::isSupported() &&
+           vgproc->state() != QProcess::NotRunning ) {
+         procsampler->start( vgproc->pid(), interval );
+      }
    }
    else {
       vgRunSaved = true;  // nothing to save
@@ -421,6 +651,7 @@ void ToolObject::stopProcess()
       delete vgreader;
       vgreader = 0;
    }
+   deleteChildReaders();
 
    switch ( getProcessId() ) {
    case VGTOOL::PROC_VALGRIND: {
@@ -469,7 +700,19 @@ void ToolObject::stopProcess()
    }
    break;
 
-   case VGTOOL::PROC_PARSE_LOG: {   // parse log
+   case VGTOOL::PROC_PARSE_LOG:     // parse log
+      if ( logLoader != 0 ) {
+         // what's loaded so far stays in the view
+         delete logLoader;
+         logLoader = 0;
+         statusMsg( "Stopped loading '" + loadLog + "': the view has part of it" );
+         emit loadProgress( 0, 0 );
+      }
+      setProcessId( VGTOOL::PROC_NONE );
+      break;
+
+   case VGTOOL::PROC_DIFF_LOG:      // compare logs
+   case VGTOOL::PROC_MERGE_LOGS: {  // merge logs
       // TODO
       VK_DEBUG( "TODO: ToolObject::stop(parse log)" );
       setProcessId( VGTOOL::PROC_NONE );
@@ -530,6 +773,7 @@ bool ToolObject::queryDone()
          QFile::remove( tmplogFname );
       }
       tmplogFname = QString();
+      removeChildLogs();
       vgRunSaved = true; // nothing more to save
 
       // TODO: clear View
@@ -587,6 +831,7 @@ void ToolObject::killProcess()
       // cleanup already.
       delete vgproc;
       vgproc = 0;
+      stopProcSampler();
       setProcessId( VGTOOL::PROC_NONE );
 
    }
@@ -632,6 +877,7 @@ void ToolObject::processDone( int exitCode, QProcess::ExitStatus exitStatus )
    // cleanup first -------------------------------------------------
    delete vgproc;
    vgproc = 0;
+   stopProcSampler();
 
    // ---------------------------------------------------------------
    // check process exit status - valgrind might have bombed
@@ -664,6 +910,7 @@ void ToolObject::processDone( int exitCode, QProcess::ExitStatus exitStatus )
    if ( vgreader == 0 ) {
       //VK_DEBUG( "All done." );
       statusMsg( "Finished running Valgrind successfully!" );
+      recordSuppUsage();
       setProcessId( VGTOOL::PROC_NONE );
    }
    else {
@@ -691,6 +938,60 @@ void ToolObject::processDone( int exitCode, QProcess::ExitStatus exitStatus )
 
 
 
+/*!
+  Live resource usage of the running valgrind, for the view.
+*/
+void ToolObject::updateResources()
+{
+   if ( vglogview ) {
+      vglogview->updateResources( procsampler->liveText() );
+   }
+}
+
+
+/*!
+  Valgrind's gone: stop sampling it, and hand the view the summary.
+*/
+void ToolObject::stopProcSampler()
+{
+   if ( !procsampler->isActive() ) {
+      return;
+   }
+   procsampler->stop();
+
+   if ( vglogview ) {
+      vglogview->setResourceSummary( procsampler->summary() );
+   }
+}
+
+
+/*!
+  A valgrind run is done: add its suppcounts to the project's
+  suppression usage history (see SuppUsage).
+  Runs that never got as far as their suppcounts aren't recorded:
+  they say nothing about which suppressions are used.
+*/
+void ToolObject::recordSuppUsage()
+{
+   if ( getProcessId() != VGTOOL::PROC_VALGRIND || vglogview == 0 ) {
+      return;
+   }
+
+   QHash<QString, int> counts;
+   if ( !vglogview->suppCounts( counts ) ) {
+      VK_DEBUG( "No suppcounts: run not recorded in suppression usage" );
+      return;
+   }
+   QStringList suppFiles = vkCfgProj->value( "valgrind/suppressions" ).toString()
+                           .split( ",", QString::SkipEmptyParts );
+   if ( !SuppUsage::appendRun( counts, suppFiles ) ) {
+      VK_DEBUG( "Failed to update suppression usage history '%s'",
+                qPrintable( SuppUsage::historyFile() ) );
+   }
+}
+
+
+
 /*!
   Read Valgrind XML
    - Called by logpoller signals only.
@@ -714,7 +1015,10 @@ void ToolObject::readVgLog()
    QString errHeader;
    statusMsg( "Parsing Valgrind XML log..." );
 
-   if ( !vgreader->handler()->started() ) {
+   if ( vgreader->handler()->finished() ) {
+      // main log done: only waiting on child logs now.
+   }
+   else if ( !vgreader->handler()->started() ) {
       // first time around...
       //VK_DEBUG( "Start parsing Valgrind XML log" );
 
@@ -745,6 +1049,15 @@ void ToolObject::readVgLog()
       //VK_DEBUG( "Reached end of XML log" );
    }
 
+   if ( ok ) {
+      readChildLogs();
+
+      // valgrind's gone, its log all read: the child logs are all there is
+      if ( vgproc == 0 && vgreader->handler()->finished() && !childLogsFinished() ) {
+         finishChildLogs();
+      }
+   }
+
 
    // deal with failures --------------------------------------------
    if ( !ok ) {
@@ -761,7 +1074,7 @@ void ToolObject::readVgLog()
 
    // cleanup -------------------------------------------------------
    // if parsing failed, or this was a last call, then cleanup
-   if ( !ok || vgreader->handler()->finished() ) {
+   if ( !ok || ( vgreader->handler()->finished() && childLogsFinished() ) ) {
       //VK_DEBUG( "Cleaning up logpoller & reader" );
       vk_assert( vgreader != 0 );
       vk_assert( logpoller != 0 );
@@ -771,11 +1084,13 @@ void ToolObject::readVgLog()
       logpoller->stop();
       delete vgreader;
       vgreader = 0;
+      deleteChildReaders();
 
       // if vgproc not active anymore, we're done!
       if ( vgproc == 0 ) {
          //VK_DEBUG( "All done." );
          statusMsg( "Finished running Valgrind successfully!" );
+         recordSuppUsage();
          setProcessId( VGTOOL::PROC_NONE );
       }
       else {
@@ -794,6 +1109,175 @@ void ToolObject::readVgLog()
 }
 
 
+/*!
+  --trace-children=yes: each child process writes its own log,
+  as given by childLogPattern.
+  Picks up any new child logs, then reads a little more from each:
+  as for the main log, each child log has its own incremental parser,
+  all feeding the one view.
+
+  A broken child log (e.g. the child was killed) doesn't stop the run:
+  that log is just dropped.
+*/
+void ToolObject::readChildLogs()
+{
+   if ( childLogPattern.isEmpty() || !vglogview->isStarted() ) {
+      return;
+   }
+
+   // look for new logs
+   QFileInfo fi( childLogPattern );
+   QDir dir = fi.absoluteDir();
+   QString name_filter = fi.fileName().replace( "%p", "*" );
+   QString main_log = QFileInfo( tmplogFname ).fileName();
+
+   foreach ( QString log, dir.entryList( QStringList( name_filter ), QDir::Files ) ) {
+      QString path = dir.absoluteFilePath( log );
+      if ( log == main_log || childLogs.contains( path ) ) {
+         continue;
+      }
+      childLogs << path;
+      childReaders << new VgLogReader( vglogview, childLogs.count() /*stream*/ );
+   }
+
+   // read from each live log
+   for ( int i = 0; i < childReaders.count(); ++i ) {
+      VgLogReader* reader = childReaders.at( i );
+      if ( reader == 0 ) {
+         continue;
+      }
+
+      bool ok = true;
+      if ( !reader->handler()->started() ) {
+         // QXmlSimpleReader won't start on an empty log
+         if ( QFileInfo( childLogs.at( i ) ).size() == 0 ) {
+            continue;
+         }
+         ok = reader->parse( childLogs.at( i ), true/*incremental*/ );
+      }
+      else {
+         ok = reader->parseContinue();
+      }
+
+      if ( !reader->handler()->fatalMsg().isEmpty() ) {
+         ok = false;
+      }
+
+      if ( !ok ) {
+         VK_DEBUG( "Error parsing child log '%s'", qPrintable( childLogs.at( i ) ) );
+         vkPrintErr( "Failed to parse Valgrind XML output for child process %s:\n%s",
+                     qPrintable( childLogPid( childLogs.at( i ) ) ),
+                     qPrintable( reader->handler()->fatalMsg() ) );
+         statusMsg( "Error parsing child log '" + childLogs.at( i ) + "'" );
+      }
+
+      if ( !ok || reader->handler()->finished() ) {
+         delete reader;
+         childReaders[i] = 0;
+      }
+   }
+}
+
+
+/*!
+  true if all child logs found so far have been read
+*/
+bool ToolObject::childLogsFinished()
+{
+   foreach ( VgLogReader* reader, childReaders ) {
+      if ( reader != 0 ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+
+/*!
+  Valgrind's gone and its log is all read: a child log not finished
+  by now never will be (e.g. the child was killed before it wrote its
+  closing tag).  What's left of each is read, then any still unfinished
+  is dropped, with a warning: else the run never finishes.
+*/
+void ToolObject::finishChildLogs()
+{
+   QStringList dropped;
+   for ( int i = 0; i < childReaders.count(); ++i ) {
+      VgLogReader* reader = childReaders.at( i );
+      if ( reader == 0 ) {
+         continue;
+      }
+
+      if ( reader->handler()->started() ) {
+         int eofPasses = 0;
+         while ( !reader->handler()->finished() &&
+                 eofPasses <= LOAD_EOF_PASSES ) {
+            if ( !reader->parseContinue() ||
+                 !reader->handler()->fatalMsg().isEmpty() ) {
+               break;
+            }
+            if ( reader->atEnd() ) {
+               ++eofPasses;
+            }
+         }
+      }
+
+      if ( !reader->handler()->finished() ) {
+         QString pid = childLogPid( childLogs.at( i ) );
+         vkPrintErr( "Child process %s: its log ends before its closing tag: '%s'",
+                     qPrintable( pid ), qPrintable( childLogs.at( i ) ) );
+         dropped << QString( "%1: %2" ).arg( pid )
+                    .arg( escapeEntities( childLogs.at( i ) ) );
+      }
+      delete reader;
+      childReaders[i] = 0;
+   }
+
+   if ( !dropped.isEmpty() ) {
+      statusMsg( QString( "Dropped %1 unfinished child logs" ).arg( dropped.count() ) );
+      vkInfo( toolView, "Unfinished child logs",
+              "<p>Valgrind finished, but these child processes' logs<br>"
+              "end before their closing tag (e.g. the child was killed).<br>"
+              "What they held is shown; the rest is lost:</p><p>%s</p>",
+              qPrintable( dropped.join( "<br>" ) ) );
+   }
+}
+
+
+void ToolObject::deleteChildReaders()
+{
+   qDeleteAll( childReaders );
+   childReaders.clear();
+}
+
+
+/*!
+  delete the child logs of the last run
+*/
+void ToolObject::removeChildLogs()
+{
+   foreach ( QString log, childLogs ) {
+      if ( QFile::exists( log ) ) {
+         QFile::remove( log );
+      }
+   }
+   childLogs.clear();
+}
+
+
+/*!
+  the pid a child log was named after: what %p stood for.
+*/
+QString ToolObject::childLogPid( const QString& childLog )
+{
+   QString pattern = QFileInfo( childLogPattern ).fileName();
+   QString log = QFileInfo( childLog ).fileName();
+   int pre  = pattern.indexOf( "%p" );
+   int post = pattern.length() - pre - 2;
+   return log.mid( pre, log.length() - pre - post );
+}
+
+
 /*!
   If for some reason Valgrind has finished and the parser still hasn't,
   inform the user and remind of option to stopping by hand.
@@ -827,7 +1311,7 @@ void ToolObject::checkParserFinished()
 /*!
   1. Brings up a Save File Dialog to choose a filename to save to
   2. Gets log to read from
-  3. Copies log to given filename
+  3. Copies log to given filename, adding a run's resource usage
   returns false on: user pressing Cancel, src==dst, copy fail
   else true.
 */
@@ -862,6 +1346,22 @@ bool ToolObject::fileSaveDialog()
       QFile::remove( fname );
    }
    bool ok = QFile::copy( srcFname, fname );
+   if ( ok && srcFname == tmplogFname ) {
+      ok = saveResourceSummary( fname );
+   }
+
+   // child logs (--trace-children=yes) go alongside: <name>.<pid>.<ext>
+   if ( ok && srcFname == tmplogFname ) {
+      QFileInfo fi( fname );
+      foreach ( QString log, childLogs ) {
+         QString child_fname = fi.path() + "/" + fi.completeBaseName() + "." +
+                               childLogPid( log ) + "." + fi.suffix();
+         if ( QFile::exists( child_fname ) ) {
+            QFile::remove( child_fname );
+         }
+         ok = ok && QFile::copy( log, child_fname );
+      }
+   }
 
    if ( ok ) {
       vgRunSaved = true;
@@ -876,3 +1376,93 @@ bool ToolObject::fileSaveDialog()
 
    return ok;
 }
+
+
+/*!
+  The run's resource usage (see VgLogView::setResourceSummary()) is
+  only in the view: write it into the saved log, before the closing
+  </valgrindoutput>, where the view will find it when loaded.
+  Only the end of the log is read: logs can be big.
+  A log with no closing tag (valgrind was killed) is left as it is.
+*/
+bool ToolObject::saveResourceSummary( const QString& fname )
+{
+   if ( vglogview == 0 || vglogview->resourceSummary().isNull() ) {
+      return true;
+   }
+
+   QFile file( fname );
+   if ( !file.open( QIODevice::ReadWrite ) ) {
+      return false;
+   }
+   const qint64 tailSize = 1024;
+   qint64 tailPos = qMax( file.size() - tailSize, ( qint64 )0 );
+   if ( !file.seek( tailPos ) ) {
+      return false;
+   }
+   QByteArray tail = file.readAll();
+   int closePos = tail.lastIndexOf( "</valgrindoutput>" );
+   if ( closePos == -1 ) {
+      return true;
+   }
+
+   QString res;
+   QTextStream ts( &res );
+   vglogview->resourceSummary().save( ts, 2 );
+   ts.flush();
+
+   QByteArray rest = res.toUtf8() + tail.mid( closePos );
+   return ( file.seek( tailPos + closePos ) &&
+            file.write( rest ) == rest.size() );
+}
+
+
+/*!
+  1. Brings up a Save File Dialog to choose a filename to export to
+  2. Streams the log(s) behind the view to it, as JSON Lines, CSV or
+     SARIF, going by the file extension.
+  returns false on: user pressing Cancel, nothing to export, export fail
+  else true.
+*/
+bool ToolObject::fileExportDialog()
+{
+   vk_assert( toolView != 0 );
+
+   QString fname = vkDlgCfgGetFile( toolView, "valkyrie/export",
+                                    QFileDialog::AcceptSave );
+
+   if ( fname.isEmpty() ) { // Cancelled
+      return false;
+   }
+
+   // a vg run: its log, plus any child logs. Else the loaded log(s).
+   QStringList logs;
+   if ( !tmplogFname.isEmpty() ) {
+      logs << tmplogFname << childLogs;
+   }
+   else {
+      logs = viewLogs;
+   }
+
+   if ( logs.isEmpty() ) {
+      vkInfo( toolView, "Export Log", "<p>No log to export.</p>" );
+      return false;
+   }
+
+   statusMsg( "Exporting to '" + fname + "'" );
+   qApp->processEvents( QEventLoop::AllEvents, 1000/*max msecs*/ );
+
+   QString errMsg;
+   bool ok = VgLogExport::exportLogs( logs, fname, errMsg );
+
+   if ( ok ) {
+      statusMsg( "Exported: " + fname );
+   }
+   else {
+      vkError( toolView, "Export Failed",
+               "<p>%s</p>", qPrintable( str2html( escapeEntities( errMsg ) ) ) );
+      statusMsg( "Failed Export: " + fname );
+   }
+
+   return ok;
+}
@@ -30,8 +30,10 @@
 
 #include "objects/vk_objects.h"
 #include "toolview/toolview.h"
+#include "utils/vglogloader.h"
 #include "utils/vglogreader.h"
 #include "utils/vk_logpoller.h"
+#include "utils/vk_procsampler.h"
 
 #include <QList>
 #include <QProcess>
@@ -77,6 +79,8 @@ public:
 signals:
    void running( bool );
    void message( QString );
+   // loading a log progressively: bytes read, of total
+   void loadProgress( qint64 done, qint64 total );
    
 protected:
    void setProcessId( int procId );
@@ -86,18 +90,33 @@ private:
    virtual ToolView* createToolView( QWidget* parent ) = 0;
    virtual void statusMsg( QString msg ) = 0;
    bool runValgrind( QStringList vgflags );
-   bool parseLogFile();
+   bool parseLogFile( bool progressive = false );
+   bool diffLogFiles();
+   bool mergeLogFiles();
    bool queryFileSave();
 
+   void readChildLogs();
+   bool childLogsFinished();
+   void finishChildLogs();
+   void deleteChildReaders();
+   void removeChildLogs();
+   QString childLogPid( const QString& childLog );
+   void recordSuppUsage();
+   bool saveResourceSummary( const QString& fname );
+   void stopProcSampler();
+
 private slots:
    void stopProcess();
    void killProcess();
    void processDone( int exitCode, QProcess::ExitStatus exitStatus );
    void readVgLog();
+   void logLoaded( bool ok, QString errMsg );
    void checkParserFinished();
+   void updateResources();
 
 public slots:
    bool fileSaveDialog();
+   bool fileExportDialog();
 
 public:
    VGTOOL::ToolID getToolId() {
@@ -110,6 +129,7 @@ protected:
 private:
    QString    tmplogFname;
    bool       vgRunSaved;
+   QStringList viewLogs;   // loaded/merged log(s) shown in the view
 
    // tools need to add own processId's: classic enum extend problem :-(
    int processId;
@@ -117,8 +137,17 @@ private:
    VGTOOL::ToolID toolId;  // which tool are we.
 
    VgLogReader* vgreader;
+   VgLogLoader* logLoader;  // loading a log progressively
+   QString      loadLog;
    QProcess*    vgproc;
    VkLogPoller* logpoller;
+   VkProcSampler* procsampler;
+   VgLogView*   vglogview;  // owned by toolView
+
+   // --trace-children=yes: one log (and reader) per child process
+   QString             childLogPattern;  // log name with %p for the pid
+   QStringList         childLogs;        // logs found so far
+   QList<VgLogReader*> childReaders;     // one per childLog: 0 when done
 };
 
 
@@ -18,10 +18,12 @@
 **
 ****************************************************************************/
 
+#include <QCoreApplication>
 #include <QDir>
 
 #include "help/help_urls.h"
 #include "objects/valgrind_object.h"
+#include "options/suppressions.h"
 #include "options/valgrind_options_page.h"  // createVkOptionsPage()
 
 #include "utils/vk_config.h"
@@ -553,30 +555,19 @@ int Valgrind::checkOptArg( int optid, QString& argval )
       }
 
       argval = files.join( sep );
-   }
-   break;
-   
-   case VALGRIND::TRACE_CH: {
-#if 0
-      // TODO
-      if ( opt->isValidArg( &errval, argval ) ) {
-         if ( argval == "yes" ) {
-            if ( vkCfgProj->rdBool( "db-attach", "valgrind" ) ) {
-               errval = PERROR_DB_CONFLICT;
-            }
-         }
+
+      // bundle them now, in the background, ready for the next run
+      if ( QCoreApplication::instance()->inherits( "QApplication" ) ) {
+         SuppBundleCache::instance()->buildInBackground( files );
       }
-      
-#else
-      /* Disabled for now - can't deal with the multiple xml files this generates */
-      /* Note: Also disabled in ValgrindOptionsPage() */
-      errval = PERROR_BADOPT;
-      //         vkPrintErr("Option disabled '--%s'", opt->m_longFlag.latin1());
-      //         vkPrintErr(" - Valkyrie can't yet handle the multiple xml files this generates.");
-#endif
    }
    break;
    
+   case VALGRIND::TRACE_CH:
+      // each process gets its own xml log: see Valkyrie::runTool()
+      opt->isValidArg( &errval, argval );
+      break;
+   
    case VALGRIND::SILENT_CH: {
       /* Disabled for now - output between fork and exec is confusing for the XML output */
       /* Note: Also disabled in ValgrindOptionsPage() */
@@ -21,14 +21,27 @@
 #include "help/help_urls.h"
 #include "objects/tool_object.h"
 #include "objects/valkyrie_object.h"
+#include "options/suppressions.h"
 #include "options/valkyrie_options_page.h"   // createVkOptionsPage()
+#include "utils/vgcapabilities.h"
+#include "utils/vgjobqueue.h"
+#include "utils/vglogexport.h"
+#include "utils/vglogmerge.h"
+#include "utils/vglogreport.h"
+#include "utils/vgoptprofile.h"
+#include "utils/vgsuppmatch.h"
 #include "utils/vk_config.h"
 #include "utils/vk_utils.h"
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
+#include <QProcess>
 #include <QPoint>
 #include <QStringList>
+#include <QTextStream>
 
 
 // TODO: put this in a define in the build scripts,or something.
@@ -49,6 +62,13 @@ Valkyrie::Valkyrie()
    // init valgrind
    m_valgrind = new Valgrind();
    m_startToolProcess = VGTOOL::PROC_NONE;
+   m_batchMode = false;
+   m_batchExport = false;
+   m_batchSuppCheck = false;
+   m_batchSuppBench = false;
+   m_batchJobs = false;
+   m_batchOptProfile = false;
+   m_startupProfile = false;
 }
 
 
@@ -342,6 +362,247 @@ void Valkyrie::setupOptions()
       VkOPT::ARG_STRING,
       VkOPT::WDG_NONE
    );
+
+   options.addOpt(
+      VALKYRIE::DIFF_LOG,
+      this->objectName(),
+      "diff-log",
+      '\0',
+      "<file>",
+      "",
+      "",
+      "",
+      "compare --view-log with a baseline valgrind logfile",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::MERGE_LOGS,
+      this->objectName(),
+      "merge",
+      '\0',
+      "<loglist>",
+      "",
+      "",
+      "",
+      "merge the valgrind logfiles listed in <loglist>",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::BATCH,
+      this->objectName(),
+      "batch",
+      '\0',
+      "",
+      "",
+      "",
+      "",
+      "no gui: summarise --view-log / --merge logs and exit (status 2 if new errors)",
+      urlNone,
+      VkOPT::ARG_NONE,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::REPORT,
+      this->objectName(),
+      "report",
+      '\0',
+      "<file>",
+      "",
+      "-",
+      "",
+      "where --batch writes its report ('-' for stdout)",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::EXPORT,
+      this->objectName(),
+      "export",
+      '\0',
+      "<file>",
+      "",
+      "",
+      "",
+      "with --batch: also export the log(s) to <file> (.jsonl, .csv or .sarif)",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::SUPP_CHECK,
+      this->objectName(),
+      "supp-check",
+      '\0',
+      "<file>",
+      "",
+      "",
+      "",
+      "with --batch: match the --suppressions files against the log(s), report to <file> ('-' for stdout)",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::SUPP_BUNDLE,
+      this->objectName(),
+      "supp-bundle",
+      '\0',
+      "<yes|no>",
+      "yes|no",
+      "yes",
+      "",
+      "merge the suppression files into one (cached) file for valgrind",
+      urlNone,
+      VkOPT::ARG_BOOL,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::SUPP_BENCH,
+      this->objectName(),
+      "supp-bench",
+      '\0',
+      "<1..100>",
+      "1|100",
+      "3",
+      "",
+      "with --batch: time <num> valgrind runs with the suppression files, and with their bundle",
+      urlNone,
+      VkOPT::ARG_UINT,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::JOB_LIST,
+      this->objectName(),
+      "job-list",
+      '\0',
+      "<file>",
+      "",
+      "",
+      "",
+      "with --batch: run valgrind on each program (plus args) listed in <file>, one per line",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::JOBS,
+      this->objectName(),
+      "jobs",
+      '\0',
+      "<0..1024>",
+      "0|1024",
+      "0",
+      "",
+      "run up to <num> valgrinds at once for a job list (0: one per core)",
+      urlNone,
+      VkOPT::ARG_UINT,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::OPT_PROFILE,
+      this->objectName(),
+      "opt-profile",
+      '\0',
+      "<all|opt,...>",
+      "",
+      "",
+      "",
+      "with --batch: time memcheck on the binary with each setting of these options, "
+      "against what it finds",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::SAMPLE_INTERVAL,
+      this->objectName(),
+      "sample-interval",
+      '\0',
+      "<0..10000>",
+      "0|10000",
+      "1000",
+      "Sample Valgrind's CPU, memory and I/O every (ms, 0: never):",
+      "sample valgrind's cpu, memory and i/o use every <num> ms (0: never)",
+      urlNone,
+      VkOPT::ARG_UINT,
+      VkOPT::WDG_SPINBOX
+   );
+
+   options.addOpt(
+      VALKYRIE::EXPAND_MEM_LIMIT,
+      this->objectName(),
+      "expand-mem-limit",
+      '\0',
+      "<0..65536>",
+      "0|65536",
+      "2048",
+      "Open all: stop at a memory use of (MB, 0: no limit):",
+      "stop opening all errors when using <num> MB (0: no limit)",
+      urlNone,
+      VkOPT::ARG_UINT,
+      VkOPT::WDG_SPINBOX
+   );
+
+   options.addOpt(
+      VALKYRIE::CLOSED_MEM_BUDGET,
+      this->objectName(),
+      "closed-mem-budget",
+      '\0',
+      "<0..4096>",
+      "0|4096",
+      "64",
+      "Closed errors: keep their items up to (MB, 0: keep all):",
+      "keep the items of closed errors up to <num> MB, dropping the least recently closed (0: keep all)",
+      urlNone,
+      VkOPT::ARG_UINT,
+      VkOPT::WDG_SPINBOX
+   );
+
+   options.addOpt(
+      VALKYRIE::TRACE_OUT,
+      this->objectName(),
+      "trace-out",
+      '\0',
+      "<file>",
+      "",
+      "",
+      "",
+      "time log loading this session, and write it to <file> on exit (chrome trace-event json)",
+      urlNone,
+      VkOPT::ARG_STRING,
+      VkOPT::WDG_NONE
+   );
+
+   options.addOpt(
+      VALKYRIE::STARTUP_PROFILE,
+      this->objectName(),
+      "startup-profile",
+      '\0',
+      "",
+      "",
+      "",
+      "",
+      "report the time taken by each phase of startup, on stderr",
+      urlNone,
+      VkOPT::ARG_NONE,
+      VkOPT::WDG_NONE
+   );
    
    options.addOpt(
       VALKYRIE::DFLT_LOGDIR,
@@ -522,51 +783,147 @@ int Valkyrie::checkOptArg( int optid, QString& argval )
             return errval;
          }
 
-         // check the version
-         QString cmd_qstr = argval + " --version 2>&1";
-         const char* cmd = cmd_qstr.toLatin1().constData();
-         FILE* fp = popen( cmd, "r" );
-         if ( !fp ) {
-            pclose( fp );
-            return PERROR_BADFILE;
+         // check the version: valgrind's own say, from the capability
+         // cache, else probe it - in the background, if there's a gui
+         // to keep responsive: that tells the user if it's no good.
+         VgCapabilities caps;
+         if ( !VgCapsCache::instance()->lookup( argval, caps ) ) {
+            if ( QCoreApplication::instance()->inherits( "QApplication" ) ) {
+               VgCapsCache::instance()->probeInBackground( argval );
+               break;
+            }
+            QString errMsg;
+            if ( !VgCapsCache::instance()->probeNow( argval, caps, errMsg ) ) {
+               vkPrintErr( "%s", qPrintable( errMsg ) );
+               return PERROR_BADFILE;
+            }
          }
 
-         char line[50];
-         if ( fgets( line, sizeof( line ), fp ) == NULL ) {
+         // compare with minimum req'd version
+         int versionVgReqd = strVersion2hex( pchVersionVgMin );
+         if ( versionVgReqd == -1 ) {
             return PERROR_BADFILE;
          }
 
-         if ( pclose( fp ) == -1 ) {
-            return PERROR_BADFILE;
+         if ( caps.versionHex <  versionVgReqd ) {
+            return PERROR_BADVERSION;
          }
 
-         // we have a string from the executable: is it what we hope?
-         QString vg_version = QString( line ).simplified();
+         // if we get here, we're fine.
+      } break;
 
-         if ( !vg_version.startsWith( "valgrind" ) ) {
-            return PERROR_BADFILE;
+   case VALKYRIE::VIEW_LOG:
+      if ( !argval.isEmpty() ) {
+         // see if we have a logfile with at least R permissions:
+         argval = fileCheck( &errval, argval, true );
+         // don't override a requested diff: that parses the log too.
+         if ( m_startToolProcess != VGTOOL::PROC_DIFF_LOG ) {
+            m_startToolProcess = VGTOOL::PROC_PARSE_LOG;
          }
+      } break;
 
-         // compare with minimum req'd version
-         int versionVg     = strVersion2hex( vg_version );
-         int versionVgReqd = strVersion2hex( pchVersionVgMin );
+   case VALKYRIE::DIFF_LOG:
+      if ( !argval.isEmpty() ) {
+         // see if we have a logfile with at least R permissions:
+         argval = fileCheck( &errval, argval, true );
+         m_startToolProcess = VGTOOL::PROC_DIFF_LOG;
+      } break;
 
-         if ( versionVg == -1 || versionVgReqd == -1 ) {
-            return PERROR_BADFILE;
+   case VALKYRIE::MERGE_LOGS:
+      if ( !argval.isEmpty() ) {
+         // see if we have a loglist with at least R permissions:
+         argval = fileCheck( &errval, argval, true );
+         m_startToolProcess = VGTOOL::PROC_MERGE_LOGS;
+      } break;
+
+   case VALKYRIE::BATCH:
+      m_batchMode = true;
+      break;
+
+   case VALKYRIE::STARTUP_PROFILE:
+      m_startupProfile = true;
+      break;
+
+   case VALKYRIE::EXPORT:
+      if ( !argval.isEmpty() ) {
+         // the format is given by the file extension
+         if ( VgLogExport::formatForFile( argval ) == VGLOGEXPORT::FMT_NONE ) {
+            errval = PERROR_BADFILENAME;
          }
+         else {
+            QFileInfo fi( argval );
+            ( void ) dirCheck( &errval, fi.absolutePath(), false, true, true );
+            if ( errval == PARSED_OK ) {
+               argval = fi.absoluteFilePath();
+            }
+         }
+         m_batchExport = ( errval == PARSED_OK );
+      } break;
 
-         if ( versionVg <  versionVgReqd ) {
-            return PERROR_BADVERSION;
+   case VALKYRIE::SUPP_CHECK:
+      if ( !argval.isEmpty() && argval != "-" ) {
+         QFileInfo fi( argval );
+         ( void ) dirCheck( &errval, fi.absolutePath(), false, true, true );
+         if ( errval == PARSED_OK ) {
+            argval = fi.absoluteFilePath();
          }
+      }
+      m_batchSuppCheck = !argval.isEmpty() && ( errval == PARSED_OK );
+      break;
 
-         // if we get here, we're fine.
-      } break;
+   case VALKYRIE::SUPP_BUNDLE:
+      opt->isValidArg( &errval, argval );
+      break;
 
-   case VALKYRIE::VIEW_LOG:
+   case VALKYRIE::SUPP_BENCH:
+      opt->isValidArg( &errval, argval );
+      m_batchSuppBench = ( errval == PARSED_OK );
+      break;
+
+   case VALKYRIE::JOB_LIST:
       if ( !argval.isEmpty() ) {
-         // see if we have a logfile with at least R permissions:
+         // see if we have a job list with at least R permissions:
          argval = fileCheck( &errval, argval, true );
-         m_startToolProcess = VGTOOL::PROC_PARSE_LOG;
+         m_batchJobs = ( errval == PARSED_OK );
+      } break;
+
+   case VALKYRIE::OPT_PROFILE:
+      if ( !argval.isEmpty() ) {
+         QString errMsg;
+         VgOptProfile profile( QStringList( "valgrind" ) );
+         if ( !profile.setAxes( argval, errMsg ) ) {
+            vkPrintErr( "%s", qPrintable( errMsg ) );
+            errval = PERROR_BADARG;
+         }
+         m_batchOptProfile = ( errval == PARSED_OK );
+      } break;
+
+   case VALKYRIE::JOBS:
+   case VALKYRIE::SAMPLE_INTERVAL:
+   case VALKYRIE::EXPAND_MEM_LIMIT:
+   case VALKYRIE::CLOSED_MEM_BUDGET:
+      opt->isValidArg( &errval, argval );
+      break;
+
+   case VALKYRIE::TRACE_OUT:
+      // a new file: only the dir can be checked.
+      if ( !argval.isEmpty() ) {
+         QFileInfo fi( argval );
+         ( void ) dirCheck( &errval, fi.absolutePath(), false, true, true );
+         if ( errval == PARSED_OK ) {
+            argval = fi.absoluteFilePath();
+            m_traceOut = argval;
+         }
+      } break;
+
+   case VALKYRIE::REPORT:
+      // a new file, most likely: only the dir can be checked.
+      if ( !argval.isEmpty() && argval != "-" ) {
+         QFileInfo fi( argval );
+         ( void ) dirCheck( &errval, fi.absolutePath(), false, true, true );
+         if ( errval == PARSED_OK ) {
+            argval = fi.absoluteFilePath();
+         }
       } break;
 
    case VALKYRIE::BINARY:
@@ -694,6 +1051,366 @@ bool Valkyrie::queryToolDone( VGTOOL::ToolID tId )
 }
 
 
+/*!
+  Headless run (--batch): no gui, no tool views.
+  Summarises the log(s) given by --view-log or --merge, comparing
+  with --diff-log if given, and writes the report to --report.
+  With --export, the log(s) are also exported.
+  Returns the exit status: see VGLOGREPORT::ExitStatus.
+*/
+int Valkyrie::runBatch()
+{
+   if ( m_batchSuppBench ) {
+      return runSuppBench();
+   }
+   if ( m_batchJobs ) {
+      return runJobs();
+   }
+   if ( m_batchOptProfile ) {
+      return runOptProfile();
+   }
+
+   QString errMsg;
+   QStringList logFiles;
+   bool ok = true;
+
+   switch ( m_startToolProcess ) {
+   case VGTOOL::PROC_PARSE_LOG:
+   case VGTOOL::PROC_DIFF_LOG:
+      logFiles << vkCfgProj->value( getOption( VALKYRIE::VIEW_LOG )->configKey() ).toString();
+      break;
+
+   case VGTOOL::PROC_MERGE_LOGS:
+      ok = VgLogMerge::readLogList(
+              vkCfgProj->value( getOption( VALKYRIE::MERGE_LOGS )->configKey() ).toString(),
+              logFiles, errMsg );
+      break;
+
+   default:
+      errMsg = "--batch needs a log to report on: use --view-log or --merge";
+      ok = false;
+   }
+
+   VgLogReport report;
+   ok = ok && report.addLogs( logFiles, errMsg );
+
+   if ( ok && m_startToolProcess == VGTOOL::PROC_DIFF_LOG ) {
+      ok = report.setBaseline(
+              vkCfgProj->value( getOption( VALKYRIE::DIFF_LOG )->configKey() ).toString(),
+              errMsg );
+   }
+
+   if ( ok && m_batchExport ) {
+      ok = VgLogExport::exportLogs(
+              logFiles,
+              vkCfgProj->value( getOption( VALKYRIE::EXPORT )->configKey() ).toString(),
+              errMsg );
+   }
+
+   ok = ok && report.write(
+           vkCfgProj->value( getOption( VALKYRIE::REPORT )->configKey() ).toString(),
+           errMsg );
+
+   if ( ok && m_batchSuppCheck ) {
+      // the suppression files valgrind would be given
+      QStringList suppFiles = vkCfgProj->value(
+         valgrind()->getOption( VALGRIND::SUPPS_SEL )->configKey() ).toString()
+         .split( ",", QString::SkipEmptyParts );
+
+      VgSuppMatcher matcher;
+      foreach ( QString suppFile, suppFiles ) {
+         ok = ok && matcher.addSuppFile( suppFile, errMsg );
+      }
+      ok = ok && matcher.addLogs( logFiles, errMsg );
+      ok = ok && matcher.write(
+              vkCfgProj->value( getOption( VALKYRIE::SUPP_CHECK )->configKey() ).toString(),
+              errMsg );
+   }
+
+   if ( !ok ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   return report.exitStatus();
+}
+
+
+// timings of one kind of valgrind run, for --supp-bench
+struct SuppBenchStats {
+   SuppBenchStats() : runs( 0 ), totalMs( 0 ), minMs( -1 ),
+                      errors( 0 ), suppressed( 0 ) {}
+   int    runs;
+   qint64 totalMs, minMs;
+   int    errors, suppressed;       // of the last run
+
+   qint64 meanMs() const {
+      return ( runs == 0 ) ? 0 : totalMs / runs;
+   }
+};
+
+/*!
+  Time one valgrind run: vgFlags (valgrind and its options), on target.
+  The xml log is only read for its error and suppression counts.
+*/
+static bool timeValgrind( const QStringList& vgFlags, const QStringList& target,
+                          SuppBenchStats& stats, QString& errMsg )
+{
+   QString logfile = vk_mkstemp( VkCfg::tmpDir() + "suppbench_log", "xml" );
+   vk_assert( !logfile.isEmpty() );
+
+   QStringList args = vgFlags.mid( 1 );
+   args << "--xml=yes" << "--xml-file=" + logfile;
+   args += target;
+
+   QProcess proc;
+   proc.setWorkingDirectory( vkCfgProj->value( "valkyrie/working-dir" ).toString() );
+   proc.setProcessChannelMode( QProcess::MergedChannels );
+   proc.setStandardOutputFile( QProcess::nullDevice() );
+
+   QElapsedTimer timer;
+   timer.start();
+   proc.start( vgFlags.first(), args );
+   bool ok = proc.waitForFinished( -1 ) && proc.exitStatus() == QProcess::NormalExit;
+   qint64 ms = timer.elapsed();
+
+   if ( !ok ) {
+      errMsg = "Failed to run '" + vgFlags.first() + " " + args.join( " " ) + "'";
+      QFile::remove( logfile );
+      return false;
+   }
+
+   VgErrorDigestHash digests;
+   QHash<QString, int> suppCounts;
+   QString tool;
+   ok = VgLogDiff::digestLog( logfile, digests, tool, errMsg, &suppCounts );
+   QFile::remove( logfile );
+   if ( !ok ) {
+      return false;
+   }
+
+   stats.errors = stats.suppressed = 0;
+   foreach ( VgErrorDigest dgst, digests ) {
+      stats.errors += dgst.count;
+   }
+   foreach ( int count, suppCounts ) {
+      stats.suppressed += count;
+   }
+
+   stats.runs++;
+   stats.totalMs += ms;
+   if ( stats.minMs == -1 || ms < stats.minMs ) {
+      stats.minMs = ms;
+   }
+   return true;
+}
+
+static void writeBenchRow( QTextStream& strm, const QString& label,
+                           qint64 files, qint64 bundle )
+{
+   strm << "   " << qSetFieldWidth( 24 ) << left << label
+        << qSetFieldWidth( 12 ) << right << files << bundle
+        << qSetFieldWidth( 0 ) << endl;
+}
+
+
+/*!
+  --batch --supp-bench=<runs>: time memcheck with the suppression files
+  given one by one, and with their bundle:
+   - startup: on /bin/true, so mostly valgrind reading the suppressions
+   - run: on the target binary, if given: this adds the error matching
+  The two alternate, run for run, to even out any drift.
+*/
+int Valkyrie::runSuppBench()
+{
+   QString errMsg;
+   QStringList suppFiles = vkCfgProj->value(
+      valgrind()->getOption( VALGRIND::SUPPS_SEL )->configKey() ).toString()
+      .split( ",", QString::SkipEmptyParts );
+   if ( suppFiles.isEmpty() ) {
+      vkPrintErr( "--supp-bench needs suppression files: use --suppressions" );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   int runs = vkCfgProj->value( getOption( VALKYRIE::SUPP_BENCH )->configKey() ).toInt();
+
+   // the bundle: from scratch, as on any change to the files, then cached
+   QElapsedTimer timer;
+   timer.start();
+   SuppBundle bundle;
+   if ( !bundle.build( suppFiles, errMsg, false ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   qint64 buildMs = timer.restart();
+   SuppBundle cached;
+   ( void ) cached.build( suppFiles, errMsg );
+   qint64 cachedMs = timer.elapsed();
+   QString bundleFile;                           // for getVgFlags() to find
+   ( void ) SuppBundleCache::instance()->buildNow( suppFiles, bundleFile, errMsg );
+
+   // [0]: files, [1]: bundle; the target is run separately
+   QStringList target = getTargetFlags();
+   QStringList flags[2];
+   flags[0] = getVgFlags( VGTOOL::ID_MEMCHECK, false );
+   flags[1] = getVgFlags( VGTOOL::ID_MEMCHECK, true );
+   for ( int v = 0; v < 2; ++v ) {
+      flags[v] = flags[v].mid( 0, flags[v].count() - target.count() );
+   }
+
+   SuppBenchStats startup[2], run[2];
+   bool ok = true;
+   for ( int i = 0; ok && i < runs; ++i ) {
+      for ( int v = 0; ok && v < 2; ++v ) {
+         ok = timeValgrind( flags[v], QStringList( "/bin/true" ), startup[v], errMsg );
+         if ( ok && !target.isEmpty() ) {
+            ok = timeValgrind( flags[v], target, run[v], errMsg );
+         }
+      }
+   }
+
+   // report
+   QString reportFile = vkCfgProj->value( getOption( VALKYRIE::REPORT )->configKey() ).toString();
+   QFile file;
+   if ( ok ) {
+      if ( reportFile.isEmpty() || reportFile == "-" ) {
+         ok = file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+      }
+      else {
+         file.setFileName( reportFile );
+         ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text );
+      }
+      if ( !ok ) {
+         errMsg = "Failed to open report file: '" + reportFile + "'";
+      }
+   }
+   if ( !ok ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   QTextStream strm( &file );
+   strm << "Suppression files: " << suppFiles.count()
+        << "  (" << bundle.numInputSupps() << " suppressions)" << endl;
+   foreach ( QString suppFile, suppFiles ) {
+      strm << "   " << suppFile << endl;
+   }
+   strm << "Bundle: " << bundle.fileName() << endl;
+   strm << "   " << bundle.numSupps() << " suppressions ("
+        << bundle.numInputSupps() - bundle.numSupps() << " duplicates dropped)" << endl;
+   strm << "   built in " << buildMs << " ms, found in the cache in "
+        << cachedMs << " ms" << endl;
+
+   strm << endl << "Runs: " << runs << " each" << endl;
+   strm << "   " << qSetFieldWidth( 24 ) << "" << qSetFieldWidth( 12 ) << right
+        << "files" << "bundle" << qSetFieldWidth( 0 ) << endl;
+   writeBenchRow( strm, "startup: min (ms)", startup[0].minMs, startup[1].minMs );
+   writeBenchRow( strm, "startup: mean (ms)", startup[0].meanMs(), startup[1].meanMs() );
+   if ( !target.isEmpty() ) {
+      writeBenchRow( strm, "run: min (ms)", run[0].minMs, run[1].minMs );
+      writeBenchRow( strm, "run: mean (ms)", run[0].meanMs(), run[1].meanMs() );
+      writeBenchRow( strm, "run: errors", run[0].errors, run[1].errors );
+      writeBenchRow( strm, "run: suppressed", run[0].suppressed, run[1].suppressed );
+   }
+   strm.flush();
+
+   return VGLOGREPORT::EXIT_CLEAN;
+}
+
+
+/*!
+  --batch --job-list=<file>: run valgrind (memcheck, as configured)
+  on each target listed, --jobs at a time, and report on them all.
+  Exit status as for a single log: failed if any job failed,
+  else errors if any job had errors.
+*/
+int Valkyrie::runJobs()
+{
+   QString errMsg;
+   QList<QStringList> targets;
+   if ( !VgJobQueue::readJobList(
+           vkCfgProj->value( getOption( VALKYRIE::JOB_LIST )->configKey() ).toString(),
+           targets, errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   VgJobQueue queue( getJobFlags( VGTOOL::ID_MEMCHECK ), numParallelJobs() );
+   foreach ( QStringList target, targets ) {
+      queue.addJob( target );
+   }
+
+   // the runners report back via queued calls: needs an event loop
+   QEventLoop loop;
+   connect( &queue, SIGNAL( finished() ), &loop, SLOT( quit() ) );
+   if ( !queue.start( errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   loop.exec();
+
+   if ( !queue.write( vkCfgProj->value( getOption( VALKYRIE::REPORT )->configKey() ).toString(),
+                      errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   if ( queue.numInState( VGJOB::DONE ) != queue.numJobs() ) {
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   return ( queue.totalErrors() > 0 ) ? VGLOGREPORT::EXIT_ERRORS
+                                      : VGLOGREPORT::EXIT_CLEAN;
+}
+
+
+/*!
+  --batch --opt-profile=<opts>: run memcheck on the binary under each
+  setting of the options given, --jobs at a time, and report each run's
+  cost against the bugs it found: see VgOptProfile.
+  Exit status: failed if any run failed, else as for the baseline run.
+*/
+int Valkyrie::runOptProfile()
+{
+   QString errMsg;
+   QStringList target = getTargetFlags();
+   if ( target.isEmpty() ) {
+      vkPrintErr( "--opt-profile needs a binary to run: give one, after the options" );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   QStringList vgFlags = getJobFlags( VGTOOL::ID_MEMCHECK );
+   VgOptProfile profile( vgFlags );
+   if ( !profile.setAxes(
+           vkCfgProj->value( getOption( VALKYRIE::OPT_PROFILE )->configKey() ).toString(),
+           errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   VgJobQueue queue( vgFlags, numParallelJobs() );
+   profile.addJobs( &queue, target );
+
+   // the runners report back via queued calls: needs an event loop
+   QEventLoop loop;
+   connect( &queue, SIGNAL( finished() ), &loop, SLOT( quit() ) );
+   if ( !queue.start( errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   loop.exec();
+
+   if ( !profile.write( vkCfgProj->value( getOption( VALKYRIE::REPORT )->configKey() ).toString(),
+                        errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+
+   if ( queue.numInState( VGJOB::DONE ) != queue.numJobs() ) {
+      return VGLOGREPORT::EXIT_FAILED;
+   }
+   return ( queue.job( 0 ).numErrors > 0 ) ? VGLOGREPORT::EXIT_ERRORS
+                                           : VGLOGREPORT::EXIT_CLEAN;
+}
+
+
 /*!
   Run the tool with given process id.
 */
@@ -706,13 +1423,21 @@ bool Valkyrie::runTool( VGTOOL::ToolID tId, VGTOOL::ToolProcessId procId )
    QStringList vg_flags = getVgFlags( tId );
 
    // update the flags with the necessary options: xml etc.
+   //  - tracing children, each process needs its own log: %p -> pid
+   bool trace_children = vg_flags.contains( "--trace-children=yes" );
    QString log_basename = activeTool->objectName() + "_log";
-   QString logfile = vk_mkstemp( VkCfg::tmpDir() + log_basename, "xml" );
+   QString logfile = vk_mkstemp( VkCfg::tmpDir() + log_basename,
+                                 trace_children ? "%p.xml" : "xml" );
    vk_assert( !logfile.isEmpty() );
 
    vg_flags.insert( ++( vg_flags.begin() ), ( "--xml-file=" + logfile ) );
    vg_flags.insert( ++( vg_flags.begin() ), "--xml=yes" );
 
+   if ( trace_children && !vg_flags.contains( "--child-silent-after-fork=yes" ) ) {
+      // fork() without exec() would still write to the parent's log
+      vg_flags.insert( ++( vg_flags.begin() ), "--child-silent-after-fork=yes" );
+   }
+
    return activeTool->start( procId, vg_flags, logfile );
 }
 
@@ -720,7 +1445,7 @@ bool Valkyrie::runTool( VGTOOL::ToolID tId, VGTOOL::ToolProcessId procId )
 /*!
   Returns valgrind flags for given tool
 */
-QStringList Valkyrie::getVgFlags( VGTOOL::ToolID tId )
+QStringList Valkyrie::getVgFlags( VGTOOL::ToolID tId, bool bundleSupps )
 {
    vk_assert( tId != VGTOOL::ID_NULL );
    ToolObject* tool = valgrind()->getToolObj( tId );
@@ -730,16 +1455,112 @@ QStringList Valkyrie::getVgFlags( VGTOOL::ToolID tId )
    VkOption* opt = options.getOption( VALKYRIE::VG_EXEC );
    QString vg_exec = vkCfgProj->value( opt->configKey(), "valgrind" ).toString();
    
+   QStringList tool_flags = valgrind()->getVgFlags( tool );
+   if ( bundleSupps ) {
+      bundleSuppFlags( tool_flags );
+   }
+
+   // this valgrind may not take them all: see VgCapabilities
+   QStringList dropped = VgCapsCache::instance()->filterFlags( vg_exec, tool->objectName(),
+                                                               tool_flags );
+   foreach ( QString flag, dropped ) {
+      vkPrintErr( "Not passing '%s': not supported by this valgrind ('%s')",
+                  qPrintable( flag ), qPrintable( vg_exec ) );
+   }
+
    QStringList vg_flags;
    vg_flags << vg_exec;                          // path/to/valgrind
    vg_flags << "--tool=" + tool->objectName();   // active tool (!= valgrind()->TOOL)
-   vg_flags += valgrind()->getVgFlags( tool );   // valgrind (+ tool) opts
+   vg_flags += tool_flags;                       // valgrind (+ tool) opts
    vg_flags += getTargetFlags();                 // valkyrie opts
    
    return vg_flags;
 }
 
 
+/*!
+  Returns valgrind flags for given tool, as for a run, but without
+  the target: for the job queue, which gives each job its own.
+*/
+QStringList Valkyrie::getJobFlags( VGTOOL::ToolID tId )
+{
+   QStringList vg_flags = getVgFlags( tId );
+   int numTarget = getTargetFlags().count();
+   return vg_flags.mid( 0, vg_flags.count() - numTarget );
+}
+
+
+/*!
+  How many valgrinds the job queue may run at once: 0 for one per core.
+*/
+int Valkyrie::numParallelJobs()
+{
+   return vkCfgProj->value( getOption( VALKYRIE::JOBS )->configKey() ).toInt();
+}
+
+/*!
+  Returns valgrind flags for given tool, bundling the
+  suppression files as configured.
+*/
+QStringList Valkyrie::getVgFlags( VGTOOL::ToolID tId )
+{
+   // on, unless turned off: older configs won't have the key
+   VkOption* opt = options.getOption( VALKYRIE::SUPP_BUNDLE );
+   bool bundle = vkCfgProj->value( opt->configKey() ).toString() != "no";
+   return getVgFlags( tId, bundle );
+}
+
+
+/*!
+  Replace the --suppressions flags with one, for the bundle of their files.
+  If the bundle can't be had, the flags are left as they are:
+  valgrind can still read the files themselves.
+*/
+void Valkyrie::bundleSuppFlags( QStringList& vg_flags )
+{
+   const QString suppFlag = "--suppressions=";
+
+   QStringList suppFiles;
+   int first = -1;
+   for ( int i = 0; i < vg_flags.count(); ++i ) {
+      if ( vg_flags.at( i ).startsWith( suppFlag ) ) {
+         if ( first == -1 ) {
+            first = i;
+         }
+         suppFiles << vg_flags.at( i ).mid( suppFlag.length() );
+      }
+   }
+   if ( suppFiles.isEmpty() ) {
+      return;
+   }
+
+   // only a lookup here: the bundle's built off the gui thread, when
+   // the files are set (see Valgrind::checkOptArg) or on a miss, and
+   // until then valgrind reads the files as they are.
+   QString bundleFile;
+   if ( !SuppBundleCache::instance()->lookup( suppFiles, bundleFile ) ) {
+      if ( QCoreApplication::instance()->inherits( "QApplication" ) ) {
+         SuppBundleCache::instance()->buildInBackground( suppFiles );
+         return;
+      }
+      QString errMsg;
+      if ( !SuppBundleCache::instance()->buildNow( suppFiles, bundleFile, errMsg ) ) {
+         vkPrintErr( "Using the suppression files as they are: %s",
+                     qPrintable( errMsg ) );
+         return;
+      }
+   }
+
+   // the bundle goes where the first file was
+   for ( int i = vg_flags.count() - 1; i > first; --i ) {
+      if ( vg_flags.at( i ).startsWith( suppFlag ) ) {
+         vg_flags.removeAt( i );
+      }
+   }
+   vg_flags[first] = suppFlag + bundleFile;
+}
+
+
 /*!
   Returns valgrind flags for given tool
 */
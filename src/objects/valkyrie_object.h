@@ -59,6 +59,22 @@ enum vkOptId {
    BINARY,        // user-binary to be valgrindised
    BIN_FLAGS,     // flags for user-binary
    VIEW_LOG,      // parse and view a valgrind logfile
+   DIFF_LOG,      // baseline logfile to compare VIEW_LOG against
+   MERGE_LOGS,    // file listing valgrind logfiles to merge
+   BATCH,         // no gui: just report on the log(s)
+   REPORT,        // where --batch writes its report
+   EXPORT,        // --batch: export the log(s) as jsonl/csv/sarif
+   SUPP_CHECK,    // --batch: match the suppressions against the log(s)
+   SUPP_BUNDLE,   // give valgrind one merged, cached suppfile
+   SUPP_BENCH,    // --batch: time valgrind with / without the bundle
+   JOB_LIST,      // --batch: run valgrind on each target listed
+   JOBS,          // how many of those valgrinds to run at once
+   OPT_PROFILE,   // --batch: cost of memcheck's options, on the binary
+   SAMPLE_INTERVAL, // poll valgrind's resource usage every n msecs
+   EXPAND_MEM_LIMIT, // 'Open all' stops when we're using this many MB
+   CLOSED_MEM_BUDGET,// closed errors keep their children up to this many MB
+   TRACE_OUT,     // write a chrome trace of the session's log loading
+   STARTUP_PROFILE, // report the time taken by each phase of startup
    DFLT_LOGDIR,   // where to put our temporary logs
 
    NUM_OPTS
@@ -79,6 +95,7 @@ public:
    ~Valkyrie();
    
    bool runTool( VGTOOL::ToolID tId, VGTOOL::ToolProcessId procId );
+   int  runBatch();
    void stopTool( VGTOOL::ToolID tId );
    bool queryToolDone( VGTOOL::ToolID tId );
    
@@ -102,6 +119,19 @@ public:
    VGTOOL::ToolProcessId getStartToolProcess() {
       return m_startToolProcess;
    }
+
+   bool isBatchMode() {
+      return m_batchMode;
+   }
+
+   // --trace-out given: where to write the trace, else ""
+   QString traceOutFile() {
+      return m_traceOut;
+   }
+
+   bool isStartupProfile() {
+      return m_startupProfile;
+   }
    
    VkOption* findOption( QString& optKey );
 //TODO: needed?
@@ -112,14 +142,31 @@ public:
 //TODO: needed?
    //   VkObject*    vkObject( int objId );
    
+   // for the job queue: see VgJobQueue, VgOptProfile
+   QStringList getJobFlags( VGTOOL::ToolID tId );
+   QStringList getTargetFlags();
+   int  numParallelJobs();
+
 private:
    QStringList getVgFlags( VGTOOL::ToolID tId );
-   QStringList getTargetFlags();
+   QStringList getVgFlags( VGTOOL::ToolID tId, bool bundleSupps );
+   void bundleSuppFlags( QStringList& vg_flags );
+   int  runSuppBench();
+   int  runJobs();
+   int  runOptProfile();
    void setupOptions();
    
 private:
    Valgrind* m_valgrind;
    VGTOOL::ToolProcessId m_startToolProcess;
+   bool m_batchMode;
+   bool m_batchExport;     // --export given: not just left in the config
+   bool m_batchSuppCheck;  // --supp-check given: ditto
+   bool m_batchSuppBench;  // --supp-bench given: ditto
+   bool m_batchJobs;       // --job-list given: ditto
+   bool m_batchOptProfile; // --opt-profile given: ditto
+   QString m_traceOut;     // --trace-out given: ditto
+   bool m_startupProfile;  // --startup-profile given
 };
 
 #endif  // __VALKYRIE_OBJECT_H
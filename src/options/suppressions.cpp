@@ -23,8 +23,16 @@
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"
 
+#include <QCryptographicHash>
 #include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <string.h>
 
 
 
@@ -90,6 +98,15 @@ SuppRanges::SuppRanges()
 
 
 
+// a call-chain frame line: obj:, fun:, or the '...' frame wildcard
+static bool isFrameLine( const QString& line )
+{
+   return ( line.startsWith("obj:") || line.startsWith("fun:") ||
+            line == "..." );
+}
+
+
+
 /*!
   class Suppression
   */
@@ -124,15 +141,18 @@ bool Suppression::setKind( QString str )
       return false;
    }
    
-   QRegExp re( list[0], Qt::CaseInsensitive );
-   int idx = SuppRanges::instance().getKindTools().indexOf( re );
+   // plain compare: this runs for every supp in the file
+   const QStringList& tools = SuppRanges::instance().getKindTools();
+   int idx = tools.count() - 1;
+   while ( idx >= 0 && tools.at( idx ).compare( list[0], Qt::CaseInsensitive ) != 0 )
+      --idx;
    if ( idx == -1 ) {
       vkPrintErr("Bad Tool (%s) for this suppression (%s).",
                  qPrintable(list[0]), qPrintable(m_name));
       return false;
    }
    else {
-      const QStringList kindTypes = SuppRanges::instance().getKindTypes()[idx];
+      const QStringList& kindTypes = SuppRanges::instance().getKindTypes().at(idx);
       if ( !kindTypes.contains( list[1], Qt::CaseInsensitive ) ) {
          vkPrintErr("Bad SupprType (%s) for Tool (%s) for this suppression (%s).",
                     qPrintable(list[1]), qPrintable(list[0]), qPrintable(m_name));
@@ -154,10 +174,16 @@ bool Suppression::setKindAux( QString str )
 
 // e.g. "obj:/usr/X11R6/lib*/libX11.so.6.2"
 // e.g. "fun:*libc_write"
+// e.g. "...": matches zero or more frames
 bool Suppression::addFrame( QString str )
 {
    str = str.simplified();
 
+   if ( str == "..." ) {
+      m_frames.append( str );
+      return true;
+   }
+
    QStringList list = str.split(":");
    if (list.count() != 2) {
       vkPrintErr( "Bad Kind (%s) for suppression '%s'.",
@@ -197,10 +223,11 @@ bool Suppression::fromStringList( const QStringList& lines )
    if ( !setKind( lines[i++] ) ) return false;
 
    // kaux (optional)
-   QRegExp re( "Memcheck:Param", Qt::CaseInsensitive );
-   if ( m_kind.contains( re ) &&
-         !(lines.at(i).startsWith("obj:") ||
-           lines.at(i).startsWith("fun:") ) ) {
+   //  - Memcheck:Param: the syscall param
+   //  - Memcheck:Leak: the leak kinds matched, as printed by valgrind
+   if ( !isFrameLine( lines.at(i) ) &&
+        ( m_kind.contains( "Memcheck:Param", Qt::CaseInsensitive ) ||
+          lines.at(i).startsWith("match-leak-kinds:") ) ) {
       // found an aux line
       if ( !setKindAux( lines[i++] ) ) return false;
    }
@@ -246,50 +273,66 @@ QString Suppression::toString() const
 /*!
   class SuppList
   */
-bool SuppList::readSuppFile( QString& fname )
+
+// bytes copied per read when rebuilding a suppfile
+#define SUPP_COPY_CHUNK 65536
+
+static bool copyBytes( QIODevice& src, QIODevice& dst, qint64 len )
+{
+   QByteArray buf;
+   while ( len > 0 ) {
+      buf = src.read( qMin( len, ( qint64 )SUPP_COPY_CHUNK ) );
+      if ( buf.isEmpty() || dst.write( buf ) != buf.size() ) {
+         return false;
+      }
+      len -= buf.size();
+   }
+   return true;
+}
+
+static inline bool isSpaceByte( char c )
+{
+   return ( c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+            c == '\v' || c == '\f' );
+}
+
+
+/*!
+  Non-interactive: suppressions that failed to parse are just left out,
+  and the file is left as is.
+*/
+bool SuppList::readSuppFile( QString& fname, bool interactive )
 {
    m_fname = fname;
    
    QFile file( fname );
-   if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+   if ( !file.open( QIODevice::ReadOnly ) ) {
       // TODO: error
       return false;
    }
-   
-   bool suppParseError = false;
-   QTextStream in(&file);
-
-   while (!in.atEnd()) {
-      QString line = in.readLine().simplified();
-      if ( line.contains(QRegExp("^\\{$")) ) {     // start of new supp
-         QStringList suppLines;
-         Suppression supp;
-
-         while(!in.atEnd()) {
-            line = in.readLine().simplified();
-            if ( line.startsWith("#") || line.isEmpty() )
-               continue;
-            if ( line.contains(QRegExp("^\\}$")) ) // end of supp
-               break;
-            suppLines += line;
-         }
-         
-         if ( supp.fromStringList( suppLines ) ) {
-            m_supps.append( supp );
-         }
-         else {
-            suppParseError = true;
-            vkPrintErr( "Error reading supps file: %s\n", qPrintable(fname));
-            // carry on with rest of input
-         }
+
+   // map the file if we can, else read it in one go
+   qint64 size = file.size();
+   const char* data = 0;
+   QByteArray buf;
+   if ( size > 0 ) {
+      data = ( const char* )file.map( 0, size );
+      if ( data == 0 ) {
+         buf = file.readAll();
+         data = buf.constData();
+         size = buf.size();
       }
    }
 
+   QList<SuppSpan> badSpans;
+   parseSupps( data, size, badSpans );
+   file.close();                 // also unmaps
+
    if ( m_supps.count() == 0 ) {
       //TODO: tell user (INFO) no supps found in this file.
    }
    
-   if ( suppParseError ) {
+   if ( !badSpans.isEmpty() && interactive ) {
       
       int res = vkQuery( 0, "Confirm Continue", "&Ok;&Cancel",
                          "<p>Problems were found with a suppression file.<br/>"
@@ -298,8 +341,15 @@ bool SuppList::readSuppFile( QString& fname )
                          "<p>Are you sure you want to continue?</p>" );
 
       if (res == MsgBox::vkYes) {
-        // write parsed supps back to file.
-        writeSuppFile();
+         // cut the bad supps out of the file: last first,
+         // so the earlier spans stay put.
+         for ( int i = badSpans.count() - 1; i >= 0; --i ) {
+            if ( !rewriteSpan( badSpans.at(i).begin, badSpans.at(i).end,
+                               QByteArray() ) ) {
+               vkPrintErr( "Failed to update supps file: %s\n", qPrintable(fname) );
+               break;
+            }
+         }
      }
      else {
         return false;
@@ -309,27 +359,162 @@ bool SuppList::readSuppFile( QString& fname )
 }
 
 
-bool SuppList::writeSuppFile()
+/*!
+  Single pass over the file bytes: no regexps, no QString per line
+  outside the suppressions.
+  As ever, a suppression is the lines between a '{' line and a '}' line,
+  ignoring blank lines and '# comments'.
+*/
+void SuppList::parseSupps( const char* data, qint64 size,
+                           QList<SuppSpan>& badSpans )
+{
+   bool inSupp = false;
+   SuppSpan span;
+   span.begin = span.end = 0;
+   QStringList suppLines;
+
+   qint64 pos = 0;
+   while ( pos < size ) {
+      // next line: [lineBegin, lineEnd), pos moves past its '\n'
+      qint64 lineBegin = pos;
+      const char* nl = ( const char* )memchr( data + pos, '\n', size - pos );
+      qint64 lineEnd = ( nl != 0 ) ? ( nl - data ) : size;
+      pos = ( nl != 0 ) ? lineEnd + 1 : size;
+
+      // trim
+      qint64 b = lineBegin, e = lineEnd;
+      while ( b < e && isSpaceByte( data[b] ) ) ++b;
+      while ( e > b && isSpaceByte( data[e-1] ) ) --e;
+      qint64 len = e - b;
+
+      if ( !inSupp ) {
+         if ( len == 1 && data[b] == '{' ) {     // start of new supp
+            inSupp = true;
+            span.begin = lineBegin;
+            suppLines.clear();
+         }
+         continue;
+      }
+
+      if ( len == 0 || data[b] == '#' )
+         continue;
+      if ( len == 1 && data[b] == '}' ) {        // end of supp
+         span.end = pos;
+         addParsedSupp( suppLines, span, badSpans );
+         inSupp = false;
+         continue;
+      }
+      suppLines += QString::fromLocal8Bit( data + b, len );
+   }
+
+   if ( inSupp ) {              // no closing '}': take what we have
+      span.end = size;
+      addParsedSupp( suppLines, span, badSpans );
+   }
+}
+
+
+void SuppList::addParsedSupp( const QStringList& lines, const SuppSpan& span,
+                              QList<SuppSpan>& badSpans )
 {
-   if ( !initSuppsFile( m_fname ) ) {
+   Suppression supp;
+   if ( supp.fromStringList( lines ) ) {
+      m_supps.append( supp );
+      m_spans.append( span );
+   }
+   else {
+      badSpans.append( span );
+      vkPrintErr( "Error reading supps file: %s\n", qPrintable(m_fname) );
+      // carry on with rest of input
+   }
+}
+
+
+/*!
+  Replace bytes [begin, end) of the suppfile with text:
+   - same size: overwritten in place
+   - else: the file is rebuilt (head, text, tail) and atomically
+     renamed over the old one: a failure leaves the old file intact.
+  The spans after end are moved along.
+*/
+bool SuppList::rewriteSpan( qint64 begin, qint64 end, const QByteArray& text )
+{
+   qint64 delta = text.size() - ( end - begin );
+
+   if ( delta == 0 ) {
+      QFile file( m_fname );
+      return ( file.open( QIODevice::ReadWrite ) &&
+               file.seek( begin ) &&
+               file.write( text ) == text.size() );
+   }
+
+   QFile src( m_fname );
+   if ( !src.open( QIODevice::ReadOnly ) ) {
+      return false;
+   }
+   QSaveFile dst( m_fname );
+   if ( !dst.open( QIODevice::WriteOnly ) ) {
+      return false;
+   }
+
+   bool ok = ( copyBytes( src, dst, begin ) &&
+               dst.write( text ) == text.size() &&
+               src.seek( end ) &&
+               copyBytes( src, dst, src.size() - end ) );
+   src.close();
+   if ( !ok ) {
+      dst.cancelWriting();
+   }
+   if ( !dst.commit() ) {
       return false;
    }
 
+   QList<SuppSpan>::iterator it = m_spans.begin();
+   for ( ; it != m_spans.end(); ++it ) {
+      if ( it->begin >= end ) {
+         it->begin += delta;
+         it->end += delta;
+      }
+   }
+   return true;
+}
+
+
+/*!
+  Append supps to the suppfile, and to this list.
+*/
+bool SuppList::appendSupps( const QList<Suppression>& supps )
+{
    QFile file( m_fname );
-   if (!file.open( QIODevice::WriteOnly |
-                   QIODevice::Text |
-                   QIODevice::Append )) {  // append to init header
-      // TODO: error
+   if ( !file.open( QIODevice::ReadWrite ) ) {   // no truncate
       return false;
    }
-   
-   QTextStream out(&file);
-   
-   for (int i=0; i<m_supps.count(); ++i) {
-      out << m_supps.at(i).toString();
+
+   // don't run on from an unterminated last line
+   QByteArray text;
+   qint64 size = file.size();
+   char last;
+   if ( size > 0 && file.seek( size-1 ) && file.getChar( &last ) && last != '\n' ) {
+      text += '\n';
+   }
+
+   QList<SuppSpan> spans;
+   foreach ( Suppression supp, supps ) {
+      // span ends with the '}' line: the blank line after is ours
+      QByteArray entry = supp.toString().toLocal8Bit();
+      SuppSpan span;
+      span.begin = size + text.size();
+      span.end = span.begin + entry.size() - 1;
+      spans.append( span );
+      text += entry;
    }
-  
-   file.close();
+
+   if ( !file.seek( size ) || file.write( text ) != text.size() ) {
+      return false;
+   }
+
+   m_supps += supps;
+   m_spans += spans;
    return true;
 }
 
@@ -348,6 +533,7 @@ const QStringList SuppList::suppNames()
 void SuppList::clear()
 {
    m_supps.clear();
+   m_spans.clear();
    m_fname = QString();
 }
 
@@ -364,7 +550,8 @@ bool SuppList::initSuppsFile( const QString& fname )
              << "# Created by: Valkyrie (" + VkCfg::appVersion() + ")\n"
              << "# Date: " + QDateTime::currentDateTimeUtc().toString() << "\n"
              << "#\n"
-             << "# WARNING: other '# comments' will be discarded by Valkyrie.\n"
+             << "# Note: '# comments' between suppressions are kept by Valkyrie;\n"
+             << "#       those inside a suppression are lost if it is edited.\n"
              << "#\n"
              << "# Format of the objects in this file (in regex style) is:\n"
              << "#\n"
@@ -404,7 +591,8 @@ bool SuppList::newSupp()
    idx == -1: new supp (i.e. not yet managed by us)
    supp:       empty for !new supp
                empty|filled for new supp
-  Returns false if user cancelled edit, else true
+  Returns false if user cancelled edit (or the suppfile couldn't
+  be updated), else true
 */
 bool SuppList::editSupp( int idx, Suppression supp )
 {
@@ -421,27 +609,40 @@ bool SuppList::editSupp( int idx, Suppression supp )
       dlg.setSupp( supp );
    }
 
-   // run dialogbox
-   if ( dlg.exec() == QDialog::Accepted ) {
-      supp = dlg.getUpdatedSupp();
-      
-      // update model and rewrite suppfile
-      if ( isNew )
-         m_supps.append( supp );
-      else {
-         m_supps.replace( idx, supp );
+   // how much has it been used, lately
+   if ( !isNew ) {
+      SuppUsage usage;
+      if ( usage.load() ) {
+         dlg.setUsage( usage.describe( m_fname, supp.getName() ) );
       }
-      
-      if (!writeSuppFile()) {
-         //TODO: error
-         vkPrintErr("Error: failure during log save");
-      }
-      return true;
    }
-   else {
+
+   // run dialogbox
+   if ( dlg.exec() != QDialog::Accepted ) {
       // QDialog::Rejected:
       return false;
    }
+   supp = dlg.getUpdatedSupp();
+
+   // update suppfile: just this supp's span, then the model
+   if ( isNew ) {
+      if ( !appendSupps( QList<Suppression>() << supp ) ) {
+         vkPrintErr("Error: failure during suppfile save");
+         return false;
+      }
+   }
+   else {
+      QByteArray text = supp.toString().toLocal8Bit();
+      text.chop( 1 );                         // keep the old spacing
+      SuppSpan& span = m_spans[idx];
+      if ( !rewriteSpan( span.begin, span.end, text ) ) {
+         vkPrintErr("Error: failure during suppfile save");
+         return false;
+      }
+      span.end = span.begin + text.size();
+      m_supps.replace( idx, supp );
+   }
+   return true;
 }
 
 /*!
@@ -455,12 +656,14 @@ bool SuppList::deleteSupp( int idx )
                       "<p>Are you sure you want to do this ?</p>" );
 
    if ( res == MsgBox::vkYes ) {            // Delete
-      // remove from our list, and write our list over the file.
-      m_supps.removeAt( idx );
-      if (!writeSuppFile()) {
-         //TODO: error
-         vkPrintErr("Error: failure during log save");
+      // cut it out of the file, then out of our list
+      if ( !rewriteSpan( m_spans.at(idx).begin, m_spans.at(idx).end,
+                         QByteArray() ) ) {
+         vkPrintErr("Error: failure during suppfile save");
+         return false;
       }
+      m_supps.removeAt( idx );
+      m_spans.removeAt( idx );
       return true;
    }
    else {                                   // Cancel
@@ -469,3 +672,856 @@ bool SuppList::deleteSupp( int idx )
    }
 }
 
+/*!
+  Delete several suppressions, e.g. when pruning unused ones:
+  the file is rebuilt once, skipping their spans.
+  No confirmation here: the caller has shown the user the list.
+*/
+bool SuppList::deleteSupps( QList<int> idxs )
+{
+   if ( idxs.isEmpty() ) {
+      return true;
+   }
+   std::sort( idxs.begin(), idxs.end() );
+
+   QFile src( m_fname );
+   if ( !src.open( QIODevice::ReadOnly ) ) {
+      return false;
+   }
+   QSaveFile dst( m_fname );
+   if ( !dst.open( QIODevice::WriteOnly ) ) {
+      return false;
+   }
+
+   // the spans are in file order: copy what lies between the cuts
+   bool ok = true;
+   qint64 pos = 0;
+   foreach ( int idx, idxs ) {
+      const SuppSpan& span = m_spans.at( idx );
+      ok = ok && copyBytes( src, dst, span.begin - pos ) && src.seek( span.end );
+      pos = span.end;
+   }
+   ok = ok && copyBytes( src, dst, src.size() - pos );
+   src.close();
+   if ( !ok ) {
+      dst.cancelWriting();
+   }
+   if ( !dst.commit() ) {
+      vkPrintErr("Error: failure during suppfile save");
+      return false;
+   }
+
+   // drop the cut supps, moving the later spans back
+   qint64 delta = 0;
+   int next = 0;
+   QList<Suppression> supps;
+   QList<SuppSpan> spans;
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      SuppSpan span = m_spans.at( i );
+      if ( next < idxs.count() && idxs.at( next ) == i ) {
+         delta += span.end - span.begin;
+         while ( next < idxs.count() && idxs.at( next ) == i ) {
+            next++;                     // skip duplicates
+         }
+         continue;
+      }
+      span.begin -= delta;
+      span.end -= delta;
+      supps.append( m_supps.at( i ) );
+      spans.append( span );
+   }
+   m_supps = supps;
+   m_spans = spans;
+   return true;
+}
+
+
+
+/*!
+  Add supps to this list, appending them to the suppfile.
+*/
+bool SuppList::addSupps( const QList<Suppression>& supps )
+{
+   return appendSupps( supps );
+}
+
+
+
+
+/*!
+  class SuppSynthesiser
+  */
+SuppSynthesiser::SuppSynthesiser( int maxFrames, int maxWildcards )
+   : m_maxFrames( maxFrames ), m_maxWildcards( maxWildcards ),
+     m_numAdded( 0 ), m_numRejected( 0 )
+{
+   vk_assert( m_maxFrames > 0 && m_maxFrames <= MAX_SUPP_FRAMES );
+}
+
+
+/*!
+  Add the suppression printed for one error.
+  Frames beyond the budget are dropped before parsing:
+  valgrind may well print more than we allow.
+*/
+bool SuppSynthesiser::addSupp( const QString& str )
+{
+   QStringList lines;
+   foreach ( QString line, str.split( "\n" ) ) {
+      line = line.simplified();
+      if ( !line.isEmpty() ) {
+         lines << line;
+      }
+   }
+   int nHead = ( lines.count() > 2 && !isFrameLine( lines.at(2) ) ) ? 3 : 2;
+   lines = lines.mid( 0, nHead + m_maxFrames );
+
+   Suppression supp;
+   if ( !supp.fromStringList( lines ) ) {
+      m_numRejected++;
+      return false;
+   }
+
+   SynthSupp s;
+   s.kind      = supp.getKind();
+   s.kaux      = supp.getKAux();
+   s.frames    = supp.getFrames();
+   s.numErrors = 1;
+   s.numWild   = 0;
+   s.alive     = true;
+   m_supps.append( s );
+   m_numAdded++;
+   return true;
+}
+
+
+/*!
+  Minimise the suppressions added so far.
+  Returned with the suppressions covering the most errors first.
+*/
+QList<Suppression> SuppSynthesiser::synthesise( const QString& namePrefix )
+{
+   removeDuplicates();
+   removeSubsumed();
+
+   // merge until nothing more will merge: each merge loses a supp.
+   bool changed;
+   do {
+      changed = false;
+      for ( int pos = 0; pos < m_maxFrames; ++pos ) {
+         if ( mergeAt( pos ) ) {
+            changed = true;
+            removeDuplicates();
+         }
+      }
+   } while ( changed );
+
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      if ( m_supps.at(i).alive ) {
+         tidyFrames( m_supps[i] );
+      }
+   }
+   removeDuplicates();
+   removeSubsumed();
+
+   QList<SynthSupp> alive;
+   foreach ( SynthSupp s, m_supps ) {
+      if ( s.alive ) {
+         alive.append( s );
+      }
+   }
+   std::stable_sort( alive.begin(), alive.end(), moreErrors );
+
+   QList<Suppression> supps;
+   for ( int i = 0; i < alive.count(); ++i ) {
+      const SynthSupp& s = alive.at(i);
+      QString kind = s.kind.mid( s.kind.indexOf( ':' ) + 1 );
+
+      Suppression supp;
+      supp.setName( QString( "%1-%2-%3" ).arg( namePrefix ).arg( kind ).arg( i + 1 ) );
+      supp.setKind( s.kind );
+      supp.setKindAux( s.kaux );
+      foreach ( QString frame, s.frames ) {
+         supp.addFrame( frame );
+      }
+      supps.append( supp );
+   }
+   return supps;
+}
+
+
+// key: kind, kaux and the first nFrames frames
+QString SuppSynthesiser::suppKey( const SynthSupp& s, int nFrames )
+{
+   return s.kind + "\n" + s.kaux + "\n" + QStringList( s.frames.mid( 0, nFrames ) ).join( "\n" );
+}
+
+bool SuppSynthesiser::isWildFrame( const QString& frame )
+{
+   return ( frame == "fun:*" || frame == "obj:*" || frame == "..." );
+}
+
+bool SuppSynthesiser::moreErrors( const SynthSupp& s1, const SynthSupp& s2 )
+{
+   return s1.numErrors > s2.numErrors;
+}
+
+
+void SuppSynthesiser::removeDuplicates()
+{
+   QHash<QString, int> seen;
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      SynthSupp& s = m_supps[i];
+      if ( !s.alive ) {
+         continue;
+      }
+      QString key = suppKey( s, s.frames.count() );
+      QHash<QString, int>::const_iterator it = seen.find( key );
+      if ( it == seen.constEnd() ) {
+         seen.insert( key, i );
+      }
+      else {
+         m_supps[it.value()].numErrors += s.numErrors;
+         s.alive = false;
+      }
+   }
+}
+
+
+/*!
+  Valgrind matches a suppression's frames against the top of the
+  stack, so a suppression is redundant if a shorter one has the same
+  leading frames. Shortest prefix first: that one can't be redundant.
+*/
+void SuppSynthesiser::removeSubsumed()
+{
+   QHash<QString, int> keys;
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      const SynthSupp& s = m_supps.at(i);
+      if ( s.alive ) {
+         keys.insert( suppKey( s, s.frames.count() ), i );
+      }
+   }
+
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      SynthSupp& s = m_supps[i];
+      if ( !s.alive ) {
+         continue;
+      }
+      for ( int n = 1; n < s.frames.count(); ++n ) {
+         QHash<QString, int>::const_iterator it = keys.find( suppKey( s, n ) );
+         if ( it != keys.constEnd() ) {
+            m_supps[it.value()].numErrors += s.numErrors;
+            s.alive = false;
+            break;
+         }
+      }
+   }
+}
+
+
+/*!
+  Merge the supps that differ only in the frame at pos.
+  Supps are bucketed on their frames with pos blanked out:
+  O(n) per position, rather than comparing every pair.
+*/
+bool SuppSynthesiser::mergeAt( int pos )
+{
+   QHash<QString, QList<int> > buckets;
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      const SynthSupp& s = m_supps.at(i);
+      if ( !s.alive || s.frames.count() <= pos ||
+           isWildFrame( s.frames.at( pos ) ) ||
+           s.numWild >= m_maxWildcards ||
+           s.frames.count() - s.numWild < 2 ) {  // keep a concrete frame
+         continue;
+      }
+      SynthSupp blanked = s;
+      blanked.frames[pos] = QString();
+      buckets[suppKey( blanked, blanked.frames.count() )].append( i );
+   }
+
+   bool merged = false;
+   foreach ( QList<int> bucket, buckets ) {
+      if ( bucket.count() < 2 ) {
+         continue;
+      }
+
+      bool allFun = true, allObj = true;
+      foreach ( int idx, bucket ) {
+         const QString& frame = m_supps.at( idx ).frames.at( pos );
+         allFun = allFun && frame.startsWith( "fun:" );
+         allObj = allObj && frame.startsWith( "obj:" );
+      }
+
+      SynthSupp& into = m_supps[bucket.first()];
+      for ( int j = 1; j < bucket.count(); ++j ) {
+         SynthSupp& from = m_supps[bucket.at( j )];
+         into.numErrors += from.numErrors;
+         from.alive = false;
+      }
+      into.frames[pos] = allFun ? "fun:*" : ( allObj ? "obj:*" : "..." );
+      into.numWild++;
+      merged = true;
+   }
+   return merged;
+}
+
+
+/*!
+  Collapse runs of wildcard frames into one '...',
+  and drop trailing wildcards: they match anything anyway.
+*/
+void SuppSynthesiser::tidyFrames( SynthSupp& s )
+{
+   QStringList frames;
+   for ( int i = 0; i < s.frames.count(); ++i ) {
+      const QString& frame = s.frames.at( i );
+      if ( isWildFrame( frame ) && i + 1 < s.frames.count() &&
+           isWildFrame( s.frames.at( i + 1 ) ) ) {
+         // start of a run
+         while ( i + 1 < s.frames.count() && isWildFrame( s.frames.at( i + 1 ) ) ) {
+            ++i;
+         }
+         frames << "...";
+      }
+      else {
+         frames << frame;
+      }
+   }
+   while ( frames.count() > 1 && isWildFrame( frames.last() ) ) {
+      frames.removeLast();
+   }
+   s.frames = frames;
+}
+
+
+
+
+/*!
+  class SuppBundle
+  */
+SuppBundle::SuppBundle()
+   : m_cached( false ), m_numInput( -1 ), m_numSupps( -1 )
+{ }
+
+
+/*!
+  Hash of the suppfiles' paths and content, in order:
+  order matters to valgrind, as the first matching supp is the one counted.
+*/
+QString SuppBundle::contentHash( const QStringList& suppFiles, QString& errMsg )
+{
+   QCryptographicHash hash( QCryptographicHash::Sha1 );
+   hash.addData( QByteArray( "vk-supp-bundle-3" ) );        // bump if the bundle format changes
+
+   foreach ( QString fname, suppFiles ) {
+      QFile file( fname );
+      if ( !file.open( QIODevice::ReadOnly ) ) {
+         errMsg = "Failed to open suppressions file: '" + fname + "'";
+         return QString();
+      }
+      hash.addData( QFileInfo( fname ).absoluteFilePath().toUtf8() );
+      hash.addData( "\0", 1 );
+      hash.addData( file.readAll() );
+      hash.addData( "\0", 1 );
+   }
+   return QString( hash.result().toHex() );
+}
+
+
+/*!
+  Build the bundle for suppFiles, or find it in the cache.
+  Returns false (with errMsg set) if an input couldn't be read,
+  or the bundle couldn't be written.
+*/
+bool SuppBundle::build( const QStringList& suppFiles, QString& errMsg,
+                        bool useCache )
+{
+   QString key = contentHash( suppFiles, errMsg );
+   if ( key.isEmpty() ) {
+      return false;
+   }
+   m_fname = VkCfg::suppsDir() + "bundle_" + key + ".supp";
+   m_cached = false;
+   m_numInput = m_numSupps = -1;
+
+   if ( useCache && QFile::exists( m_fname ) && QFile::exists( namesFile( m_fname ) ) ) {
+      m_cached = true;
+      return true;
+   }
+
+   // in file order, deduped by kind, kaux and frames: first one wins
+   QList<Suppression> supps;
+   QHash<QString, QString> keptNames;           // suppKey -> name kept
+   QByteArray names;
+   m_numInput = 0;
+   foreach ( QString fname, suppFiles ) {
+      SuppList supplist;
+      if ( !supplist.readSuppFile( fname, false ) ) {
+         errMsg = "Failed to read suppressions file: '" + fname + "'";
+         return false;
+      }
+      QString absName = QFileInfo( fname ).absoluteFilePath();
+      foreach ( Suppression supp, supplist.supps() ) {
+         QString key = suppKey( supp );
+         if ( !keptNames.contains( key ) ) {
+            keptNames.insert( key, supp.getName() );
+            supps.append( supp );
+         }
+         names += ( keptNames.value( key ) + '\t' + absName + '\t' +
+                    supp.getName() + '\n' ).toUtf8();
+         m_numInput++;
+      }
+   }
+   m_numSupps = supps.count();
+
+   QSaveFile file( m_fname );
+   if ( !file.open( QIODevice::WriteOnly ) ) {
+      errMsg = "Failed to write suppressions bundle: '" + m_fname + "'";
+      return false;
+   }
+   foreach ( Suppression supp, supps ) {
+      file.write( supp.toString().toLocal8Bit() );
+   }
+   if ( !file.commit() ) {
+      errMsg = "Failed to write suppressions bundle: '" + m_fname + "'";
+      return false;
+   }
+
+   QSaveFile namesOut( namesFile( m_fname ) );
+   if ( !namesOut.open( QIODevice::WriteOnly ) ||
+        namesOut.write( names ) != names.size() || !namesOut.commit() ) {
+      errMsg = "Failed to write suppressions bundle: '" + namesOut.fileName() + "'";
+      return false;
+   }
+
+   pruneCache( m_fname );
+   return true;
+}
+
+
+/*!
+  What makes two supps duplicates, names aside.
+*/
+QString SuppBundle::suppKey( const Suppression& supp )
+{
+   return supp.getKind().toLower() + '\n' + supp.getKAux() + '\n' +
+          supp.getFrames().join( "\n" );
+}
+
+
+/*!
+  Next to each bundle: a line per input supp, "<kept>\t<file>\t<name>",
+  kept being the name of the supp in the bundle that stands for it.
+*/
+QString SuppBundle::namesFile( const QString& bundleFile )
+{
+   QString fname = bundleFile;
+   fname.chop( 5 );                              // ".supp"
+   return fname + ".names";
+}
+
+
+/*!
+  For each name valgrind may count a hit under, with or without the
+  bundle: the input supps (see SuppUsage::key()) it may stand for.
+  Supps can share a name, so this errs on the side of more.
+*/
+bool SuppBundle::readNames( const QString& bundleFile,
+                            QHash<QString, QStringList>& names )
+{
+   QFile file( namesFile( bundleFile ) );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      return false;
+   }
+   while ( !file.atEnd() ) {
+      QStringList fields = QString::fromUtf8( file.readLine() ).remove( '\n' ).split( '\t' );
+      if ( fields.count() != 3 ) {
+         continue;
+      }
+      QString key = SuppUsage::key( fields.at( 1 ), fields.at( 2 ) );
+      names[fields.at( 0 )] << key;            // counted in the bundle's name
+      if ( fields.at( 2 ) != fields.at( 0 ) ) {
+         names[fields.at( 2 )] << key;         // counted in its own name
+      }
+   }
+   return true;
+}
+
+
+/*!
+  Remove cached bundles, other than keep, not read for a while:
+  every change to an input leaves a stale bundle behind.
+*/
+void SuppBundle::pruneCache( const QString& keep )
+{
+   QDateTime cutoff = QDateTime::currentDateTime().addDays( -SUPP_BUNDLE_MAX_AGE );
+   QDir dir( VkCfg::suppsDir() );
+   QFileInfoList bundles = dir.entryInfoList( QStringList( "bundle_*.supp" ),
+                                              QDir::Files );
+   foreach ( QFileInfo fi, bundles ) {
+      if ( fi.absoluteFilePath() != QFileInfo( keep ).absoluteFilePath() &&
+           fi.lastRead() < cutoff ) {
+         QFile::remove( fi.absoluteFilePath() );
+         QFile::remove( namesFile( fi.absoluteFilePath() ) );
+      }
+   }
+}
+
+
+
+
+/*!
+  class SuppBundler
+*/
+SuppBundler::SuppBundler( SuppBundleCache* cache, const QStringList& suppFiles,
+                          const QString& stamp )
+   : m_cache( cache ), m_suppFiles( suppFiles ), m_stamp( stamp )
+{ }
+
+
+void SuppBundler::run()
+{
+   SuppBundle bundle;
+   QString errMsg;
+   bool ok = bundle.build( m_suppFiles, errMsg );
+
+   QMetaObject::invokeMethod( m_cache, "bundlerDone", Qt::QueuedConnection,
+                              Q_ARG( QString, m_stamp ), Q_ARG( bool, ok ),
+                              Q_ARG( QString, bundle.fileName() ),
+                              Q_ARG( QString, errMsg ) );
+}
+
+
+
+
+/*!
+  class SuppBundleCache
+*/
+
+/*!
+  The one cache: first asked for from the gui thread, which it lives in.
+*/
+SuppBundleCache* SuppBundleCache::instance()
+{
+   static SuppBundleCache* cache = 0;
+   if ( cache == 0 ) {
+      cache = new SuppBundleCache();
+   }
+   return cache;
+}
+
+
+SuppBundleCache::SuppBundleCache()
+   : QObject( 0 )
+{
+   this->setObjectName( "suppbundlecache" );
+}
+
+
+/*!
+  The suppfiles as they are now: paths, sizes and modification times.
+  Empty if one's not there.
+*/
+QString SuppBundleCache::stamp( const QStringList& suppFiles )
+{
+   QString str;
+   foreach ( QString fname, suppFiles ) {
+      QFileInfo fi( fname );
+      if ( !fi.exists() ) {
+         return QString();
+      }
+      str += fi.absoluteFilePath() + '\t' + QString::number( fi.size() ) + '\t' +
+             QString::number( fi.lastModified().toMSecsSinceEpoch() ) + '\n';
+   }
+   return str;
+}
+
+
+/*!
+  The bundle for suppFiles, if one's been built since they last changed.
+*/
+bool SuppBundleCache::lookup( const QStringList& suppFiles, QString& bundleFile )
+{
+   QString key = stamp( suppFiles );
+   QHash<QString, QString>::iterator it = m_bundles.find( key );
+   if ( key.isEmpty() || it == m_bundles.end() ) {
+      return false;
+   }
+   if ( !QFile::exists( it.value() ) ) {
+      m_bundles.erase( it );
+      return false;
+   }
+   bundleFile = it.value();
+   return true;
+}
+
+
+/*!
+  Build the bundle for suppFiles on a pool thread, unless we have it,
+  or it's being built. built() is emitted once it's done.
+*/
+void SuppBundleCache::buildInBackground( const QStringList& suppFiles )
+{
+   QString key = stamp( suppFiles );
+   QString bundleFile;
+   if ( key.isEmpty() || m_building.contains( key ) || lookup( suppFiles, bundleFile ) ) {
+      return;
+   }
+
+   m_building.insert( key );
+   QThreadPool::globalInstance()->start( new SuppBundler( this, suppFiles, key ) );
+}
+
+
+/*!
+  As lookup(), else build the bundle here and now.
+*/
+bool SuppBundleCache::buildNow( const QStringList& suppFiles, QString& bundleFile,
+                                QString& errMsg )
+{
+   if ( lookup( suppFiles, bundleFile ) ) {
+      return true;
+   }
+
+   QString key = stamp( suppFiles );
+   SuppBundle bundle;
+   if ( !bundle.build( suppFiles, errMsg ) ) {
+      return false;
+   }
+   bundleFile = bundle.fileName();
+   if ( !key.isEmpty() ) {
+      m_bundles.insert( key, bundleFile );
+   }
+   return true;
+}
+
+
+void SuppBundleCache::bundlerDone( QString stamp, bool ok, QString bundleFile,
+                                   QString errMsg )
+{
+   m_building.remove( stamp );
+   if ( ok ) {
+      m_bundles.insert( stamp, bundleFile );
+   }
+   emit built( ok, errMsg );
+}
+
+
+
+
+/*!
+  class SuppUsage
+  */
+SuppUsage::SuppUsage()
+   : m_numRuns( 0 )
+{ }
+
+
+/*!
+  A supp in the history: its file and name, as names needn't be unique.
+*/
+QString SuppUsage::key( const QString& suppFile, const QString& name )
+{
+   return QFileInfo( suppFile ).absoluteFilePath() + '\t' + name;
+}
+
+
+/*!
+  One history per project: named by a hash of the project file's path.
+  The working config of an unsaved project has a new name every
+  session, so that goes by the program being debugged instead.
+  ("usage2_": the first histories went by name alone.)
+*/
+QString SuppUsage::historyFile()
+{
+   QString cfgFile = vkCfgProj->fileName();
+   QByteArray proj;
+   if ( cfgFile == VkCfg::tmpCfgPath() ) {
+      QString binary = vkCfgProj->value( "valkyrie/binary" ).toString();
+      proj = "binary:" + QFileInfo( binary ).absoluteFilePath().toUtf8();
+   }
+   else {
+      proj = QFileInfo( cfgFile ).absoluteFilePath().toUtf8();
+   }
+   QString key = QCryptographicHash::hash( proj, QCryptographicHash::Sha1 ).toHex().left( 16 );
+   return VkCfg::suppsDir() + "usage2_" + key + ".hist";
+}
+
+
+/*!
+  Read the history. No history yet is not an error: just no runs.
+*/
+bool SuppUsage::load()
+{
+   m_stats.clear();
+   m_numRuns = 0;
+
+   QFile file( historyFile() );
+   if ( !file.exists() ) {
+      return true;
+   }
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      return false;
+   }
+
+   while ( !file.atEnd() ) {
+      QByteArray line = file.readLine().trimmed();
+      if ( line.isEmpty() || line.startsWith( '#' ) ) {
+         continue;
+      }
+
+      // skip the time: "<count>:<file>:<name>" per hit supp,
+      // the file percent-encoded, so free of colons
+      QList<QByteArray> fields = line.split( '\t' );
+      for ( int i = 1; i < fields.count(); ++i ) {
+         int colon1 = fields.at( i ).indexOf( ':' );
+         int colon2 = fields.at( i ).indexOf( ':', colon1 + 1 );
+         if ( colon1 == -1 || colon2 == -1 ) {
+            continue;
+         }
+         QString file = QString::fromUtf8( QByteArray::fromPercentEncoding(
+                           fields.at( i ).mid( colon1 + 1, colon2 - colon1 - 1 ) ) );
+         QString name = QString::fromUtf8( fields.at( i ).mid( colon2 + 1 ) );
+         Stats& st = m_stats[key( file, name )];
+         st.hits += fields.at( i ).left( colon1 ).toInt();
+         st.runs++;
+         st.lastRun = m_numRuns;
+      }
+      m_numRuns++;
+   }
+   return true;
+}
+
+
+/*!
+  Append a run to the history, dropping the oldest runs if need be.
+  counts are valgrind's, by name: each is credited to every supp in
+  suppFiles it may stand for - all those the bundle dropped as
+  duplicates of it, as well as those sharing its name.  Without the
+  bundle's record of those, a name is credited in every file.
+*/
+bool SuppUsage::appendRun( const QHash<QString, int>& counts,
+                           const QStringList& suppFiles )
+{
+   QString bundleFile;
+   QHash<QString, QStringList> names;
+   bool haveNames = ( SuppBundleCache::instance()->lookup( suppFiles, bundleFile ) &&
+                      SuppBundle::readNames( bundleFile, names ) );
+
+   QHash<QString, int> hits;                     // key() -> count
+   QHash<QString, int>::const_iterator it = counts.constBegin();
+   for ( ; it != counts.constEnd(); ++it ) {
+      if ( it.value() <= 0 ) {
+         continue;
+      }
+      QStringList keys;
+      if ( haveNames ) {
+         keys = names.value( it.key() );
+         keys.removeDuplicates();
+      }
+      else {
+         foreach ( QString fname, suppFiles ) {
+            keys << key( fname, it.key() );
+         }
+      }
+      foreach ( QString k, keys ) {
+         hits[k] += it.value();
+      }
+   }
+
+   QByteArray run = QByteArray::number( QDateTime::currentMSecsSinceEpoch() / 1000 );
+   QHash<QString, int>::const_iterator hit = hits.constBegin();
+   for ( ; hit != hits.constEnd(); ++hit ) {
+      int tab = hit.key().indexOf( '\t' );
+      run += '\t' + QByteArray::number( hit.value() ) + ':' +
+             hit.key().left( tab ).toUtf8().toPercentEncoding() + ':' +
+             hit.key().mid( tab + 1 ).toUtf8();
+   }
+   run += '\n';
+
+   QString fname = historyFile();
+   QList<QByteArray> runs;
+   QFile file( fname );
+   if ( file.open( QIODevice::ReadOnly ) ) {
+      while ( !file.atEnd() ) {
+         QByteArray line = file.readLine();
+         if ( !line.startsWith( '#' ) && !line.trimmed().isEmpty() ) {
+            runs.append( line );
+         }
+      }
+      file.close();
+   }
+
+   QByteArray header = "# Valkyrie suppression usage, one run per line:"
+                       " <time>\t<count>:<file>:<name>...\n";
+
+   if ( runs.count() < SUPP_USAGE_MAX_RUNS ) {
+      // the usual case: just append
+      bool isNew = !file.exists();
+      if ( !file.open( QIODevice::WriteOnly | QIODevice::Append ) ) {
+         return false;
+      }
+      return ( ( !isNew || file.write( header ) == header.size() ) &&
+               file.write( run ) == run.size() );
+   }
+
+   // full: rewrite with the oldest runs dropped
+   QSaveFile out( fname );
+   if ( !out.open( QIODevice::WriteOnly ) ) {
+      return false;
+   }
+   out.write( header );
+   for ( int i = runs.count() - SUPP_USAGE_MAX_RUNS + 1; i < runs.count(); ++i ) {
+      out.write( runs.at( i ) );
+   }
+   out.write( run );
+   return out.commit();
+}
+
+
+int SuppUsage::totalHits( const QString& suppFile, const QString& name )
+{
+   return m_stats.value( key( suppFile, name ) ).hits;
+}
+
+int SuppUsage::runsHit( const QString& suppFile, const QString& name )
+{
+   return m_stats.value( key( suppFile, name ) ).runs;
+}
+
+/*!
+  Runs since name last had a hit: numRuns() if it never had.
+*/
+int SuppUsage::runsSinceHit( const QString& suppFile, const QString& name )
+{
+   QHash<QString, Stats>::const_iterator it = m_stats.constFind( key( suppFile, name ) );
+   if ( it == m_stats.constEnd() ) {
+      return m_numRuns;
+   }
+   return m_numRuns - 1 - it.value().lastRun;
+}
+
+
+/*!
+  One line summary of name's usage, for the user.
+*/
+QString SuppUsage::describe( const QString& suppFile, const QString& name )
+{
+   if ( m_numRuns == 0 ) {
+      return "No runs recorded for this project yet";
+   }
+   int runs = runsHit( suppFile, name );
+   if ( runs == 0 ) {
+      return QString( "Not used in the last %1 runs" ).arg( m_numRuns );
+   }
+
+   QString str = QString( "Used in %1 of the last %2 runs, %3 errors suppressed" )
+                 .arg( runs ).arg( m_numRuns ).arg( totalHits( suppFile, name ) );
+   int since = runsSinceHit( suppFile, name );
+   if ( since > 0 ) {
+      str += QString( "; last used %1 runs ago" ).arg( since );
+   }
+   return str;
+}
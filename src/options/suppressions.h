@@ -20,7 +20,11 @@
 #ifndef SUPPRESSIONS_H
 #define SUPPRESSIONS_H
 
+#include <QHash>
 #include <QList>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QTextStream>
@@ -28,6 +32,17 @@
 // TODO: what's reasonable? what does Vg allow?
 #define MAX_SUPP_FRAMES 20
 
+// SuppSynthesiser defaults
+#define SYNTH_SUPP_FRAMES     8   // frame budget per suppression
+#define SYNTH_SUPP_WILDCARDS  2   // max frames generalised per suppression
+
+// SuppBundle: cached bundles not read for this many days are removed
+#define SUPP_BUNDLE_MAX_AGE  14
+
+// SuppUsage: runs kept in the usage history; default runs for pruning
+#define SUPP_USAGE_MAX_RUNS  100
+#define SUPP_PRUNE_RUNS      10
+
 
 // ============================================================
 // SuppRanges: read-only configuration data for Suppressions
@@ -88,23 +103,240 @@ private:
 
 
 // ============================================================
+/*!
+  SuppList: the suppressions of one suppfile.
+   - the file is read in a single pass over its bytes (mapped, if
+     possible), recording the byte range of each suppression
+   - edits only touch the affected range: rewritten in place if the
+     size is unchanged, else the file is rebuilt around it and renamed
+     over the old one; new suppressions are appended.
+  So anything outside the suppressions, e.g. '# comments', is kept.
+*/
 class SuppList
 {
 public:
    SuppList() {};
    
-   bool readSuppFile( QString& filename );
-   bool writeSuppFile();
+   bool readSuppFile( QString& filename, bool interactive = true );
    const QStringList suppNames();
    void clear();
    bool initSuppsFile( const QString& fname );
    bool newSupp();
    bool editSupp( int idx, Suppression supp = Suppression() );
    bool deleteSupp( int idx );
+   bool deleteSupps( QList<int> idxs );
+   bool addSupps( const QList<Suppression>& supps );
+   const QList<Suppression>& supps() const { return m_supps; }
+
+private:
+   // byte range of a suppression in the file: '{' line to '}' line, inclusive
+   struct SuppSpan {
+      qint64 begin, end;
+   };
+
+   void parseSupps( const char* data, qint64 size, QList<SuppSpan>& badSpans );
+   void addParsedSupp( const QStringList& lines, const SuppSpan& span,
+                       QList<SuppSpan>& badSpans );
+   bool rewriteSpan( qint64 begin, qint64 end, const QByteArray& text );
+   bool appendSupps( const QList<Suppression>& supps );
 
 private:   
    QList<Suppression> m_supps;
+   QList<SuppSpan> m_spans;       // one per supp
+   QString m_fname;
+};
+
+
+// ============================================================
+/*!
+  SuppSynthesiser: turns the suppressions printed for many errors
+  into a minimal set of suppressions covering them all.
+   - frames beyond the frame budget are dropped
+   - duplicates are dropped
+   - suppressions made redundant by a shorter one (valgrind matches
+     the frames as a prefix of the stack) are dropped
+   - suppressions differing in only one frame are merged, that frame
+     becoming 'fun:*' / 'obj:*' (or '...' if the frame types differ),
+     up to a number of wildcards per suppression
+   - runs of wildcards are collapsed into '...', trailing ones dropped
+*/
+class SuppSynthesiser
+{
+public:
+   SuppSynthesiser( int maxFrames = SYNTH_SUPP_FRAMES,
+                    int maxWildcards = SYNTH_SUPP_WILDCARDS );
+
+   bool addSupp( const QString& str );
+   QList<Suppression> synthesise( const QString& namePrefix );
+
+   int numAdded()    { return m_numAdded; }
+   int numRejected() { return m_numRejected; }
+
+private:
+   struct SynthSupp {
+      QString kind, kaux;
+      QStringList frames;
+      int  numErrors;      // errors covered
+      int  numWild;        // frames generalised so far
+      bool alive;
+   };
+
+   static QString suppKey( const SynthSupp& s, int nFrames );
+   static bool isWildFrame( const QString& frame );
+   static bool moreErrors( const SynthSupp& s1, const SynthSupp& s2 );
+   void removeDuplicates();
+   void removeSubsumed();
+   bool mergeAt( int pos );
+   void tidyFrames( SynthSupp& s );
+
+private:
+   int m_maxFrames, m_maxWildcards;
+   int m_numAdded, m_numRejected;
+   QList<SynthSupp> m_supps;
+};
+
+
+// ============================================================
+/*!
+  SuppBundle: the suppressions of several suppfiles, merged into one
+  file for valgrind to read: deduplicated and free of comments.
+   - suppressions keep their order, files' and within files: where
+     several match an error, valgrind counts the first.
+   - bundles are cached in the suppressions config dir, named by
+     a hash of their inputs' paths and content: so a bundle is only
+     rebuilt when an input changes.
+   - the first of duplicate suppressions is kept, name and all.
+     Which input supps each kept one stands for goes in a file next to
+     the bundle (see readNames()), so their hits can be credited.
+*/
+class SuppBundle
+{
+public:
+   SuppBundle();
+
+   bool build( const QStringList& suppFiles, QString& errMsg,
+               bool useCache = true );
+
+   QString fileName()  { return m_fname; }
+   bool wasCached()    { return m_cached; }
+   // only known if built, not cached:
+   int numInputSupps() { return m_numInput; }
+   int numSupps()      { return m_numSupps; }
+
+   static QString contentHash( const QStringList& suppFiles, QString& errMsg );
+   static QString suppKey( const Suppression& supp );
+   static bool readNames( const QString& bundleFile,
+                          QHash<QString, QStringList>& names );
+
+private:
+   static QString namesFile( const QString& bundleFile );
+   static void pruneCache( const QString& keep );
+
+private:
    QString m_fname;
+   bool m_cached;
+   int m_numInput, m_numSupps;
+};
+
+
+class SuppBundleCache;
+
+/*!
+  SuppBundler: builds a bundle on a pool thread, and tells the cache.
+*/
+class SuppBundler : public QRunnable
+{
+public:
+   SuppBundler( SuppBundleCache* cache, const QStringList& suppFiles,
+                const QString& stamp );
+
+   void run();
+
+private:
+   SuppBundleCache* m_cache;    // we don't own this
+   QStringList m_suppFiles;
+   QString m_stamp;
+};
+
+
+
+// ============================================================
+/*!
+  SuppBundleCache: the bundles built this session, for the gui thread
+  to look up without hashing or reading a suppfile.
+
+  A bundle is known by its inputs' paths, sizes and modification times:
+  a stat each.  lookup() only gives a bundle for the files as they are
+  now; buildInBackground() builds one if there's none, signalling
+  built() when done; buildNow() does the same in the calling thread,
+  for when there's no gui to keep responsive.
+*/
+class SuppBundleCache : public QObject
+{
+   Q_OBJECT
+public:
+   static SuppBundleCache* instance();
+
+   bool lookup( const QStringList& suppFiles, QString& bundleFile );
+   void buildInBackground( const QStringList& suppFiles );
+   bool buildNow( const QStringList& suppFiles, QString& bundleFile,
+                  QString& errMsg );
+
+signals:
+   void built( bool ok, QString errMsg );
+
+private slots:
+   void bundlerDone( QString stamp, bool ok, QString bundleFile,
+                     QString errMsg );
+
+private:
+   SuppBundleCache();
+   static QString stamp( const QStringList& suppFiles );
+
+private:
+   QHash<QString, QString> m_bundles;   // stamp -> bundle file
+   QSet<QString> m_building;            // stamps being built
+};
+
+
+// ============================================================
+/*!
+  SuppUsage: per-project history of suppression hits.
+   - each finished run appends its suppcounts: one line per run,
+     "<time_t>\t<count>:<file>:<name>...", hits only, by file and
+     name: valgrind's counts go by name, credited to every supp they
+     may stand for (see appendRun())
+   - only the last SUPP_USAGE_MAX_RUNS runs are kept
+  A suppression not hit in the last N runs is a candidate for pruning:
+  valgrind tries every suppression against every error.
+*/
+class SuppUsage
+{
+public:
+   SuppUsage();
+
+   bool load();
+   static bool appendRun( const QHash<QString, int>& counts,
+                          const QStringList& suppFiles );
+   static QString historyFile();
+   static QString key( const QString& suppFile, const QString& name );
+
+   int numRuns()  { return m_numRuns; }
+   int totalHits( const QString& suppFile, const QString& name );
+   int runsHit( const QString& suppFile, const QString& name );
+   int runsSinceHit( const QString& suppFile, const QString& name );
+   QString describe( const QString& suppFile, const QString& name );
+
+private:
+   struct Stats {
+      Stats() : hits( 0 ), runs( 0 ), lastRun( -1 ) {}
+      int hits;       // summed over all runs
+      int runs;       // runs with hits
+      int lastRun;    // index of the last run with hits
+   };
+
+   QHash<QString, Stats> m_stats;
+   int m_numRuns;
 };
 
 
@@ -18,13 +18,22 @@
 **
 ****************************************************************************/
 
+#include <QApplication>
+#include <QDateTime>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QDir>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QLabel>
 #include <QListWidget>
+#include <QPlainTextEdit>
 #include <QTabWidget>
+#include <QTextStream>
 
 #include "help/help_context.h"
 #include "help/help_urls.h"
+#include "utils/vgsuppmatch.h"
 #include "utils/vk_config.h"
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"
@@ -229,17 +238,21 @@ void ValgrindOptionsPage::setupOptions()
    btn_suppfile_new = new QPushButton("New", butts1_groupbox );
    btn_suppfile_add = new QPushButton("Add", butts1_groupbox );
    btn_suppfile_rmv = new QPushButton("Remove", butts1_groupbox );
+   btn_suppfile_chk = new QPushButton("Check...", butts1_groupbox );
+   btn_suppfile_chk->setToolTip( "Match the suppressions against an existing log" );
    setSuppFileBtns();
    connect( btn_suppfile_up,  SIGNAL(clicked()), this, SLOT( suppfileUp() ) );
    connect( btn_suppfile_dwn, SIGNAL(clicked()), this, SLOT( suppfileDown() ) );
    connect( btn_suppfile_new, SIGNAL(clicked()), this, SLOT( suppfileNew() ) );
    connect( btn_suppfile_add, SIGNAL(clicked()), this, SLOT( suppfileAdd() ) );
    connect( btn_suppfile_rmv, SIGNAL(clicked()), this, SLOT( suppfileRemove() ) );
+   connect( btn_suppfile_chk, SIGNAL(clicked()), this, SLOT( suppfileCheck() ) );
    butts1_vbox->addWidget( btn_suppfile_up  );
    butts1_vbox->addWidget( btn_suppfile_dwn );
    butts1_vbox->addWidget( btn_suppfile_new );
    butts1_vbox->addWidget( btn_suppfile_add );
    butts1_vbox->addWidget( btn_suppfile_rmv );
+   butts1_vbox->addWidget( btn_suppfile_chk );
    butts1_vbox->addStretch( 1 );
    butts1_groupbox->setLayout( butts1_vbox );
    // setup horizontal layout
@@ -269,13 +282,17 @@ void ValgrindOptionsPage::setupOptions()
    btn_supp_new = new QPushButton("New", butts_groupbox );
    btn_supp_edt = new QPushButton("Edit", butts_groupbox );
    btn_supp_del = new QPushButton("Delete", butts_groupbox );
+   btn_supp_prn = new QPushButton("Prune...", butts_groupbox );
+   btn_supp_prn->setToolTip( "Delete suppressions not used in recent runs" );
    suppLoad();
    connect( btn_supp_new, SIGNAL(clicked()), this, SLOT( suppNew() ) );
    connect( btn_supp_edt, SIGNAL(clicked()), this, SLOT( suppEdit() ) );
    connect( btn_supp_del, SIGNAL(clicked()), this, SLOT( suppDelete() ) );
+   connect( btn_supp_prn, SIGNAL(clicked()), this, SLOT( suppPrune() ) );
    butts_vbox->addWidget( btn_supp_new );
    butts_vbox->addWidget( btn_supp_edt );
    butts_vbox->addWidget( btn_supp_del );
+   butts_vbox->addWidget( btn_supp_prn );
    butts_vbox->addStretch( 1 );
    butts_groupbox->setLayout( butts_vbox );
    // setup horizontal layout   
@@ -307,10 +324,6 @@ void ValgrindOptionsPage::setupOptions()
    /* Disabled for now: Only supporting memcheck so far. */
    m_itemList[VALGRIND::TOOL       ]->setEnabled( false );
    
-   /* Disabled for now - can't deal with the multiple xml files this generates */
-   /* Note: Also disabled in Valgrind::checkOptArg() */
-   m_itemList[VALGRIND::TRACE_CH   ]->setEnabled( false );
-   
    /* Disabled - must be left on to generate clean XML */
    /* Note: Also disabled in Valgrind::checkOptArg() */
    m_itemList[VALGRIND::SILENT_CH  ]->setEnabled( false );
@@ -357,6 +370,8 @@ void ValgrindOptionsPage::setSuppFileBtns()
 {
    QListWidget* lwSuppFiles = (QListWidget*)m_itemList[VALGRIND::SUPPS_SEL]->widget();
    
+   btn_suppfile_chk->setEnabled( lwSuppFiles->count() > 0 );
+
    if ( lwSuppFiles->currentItem() != 0 ) {
       btn_suppfile_rmv->setEnabled( true );
       btn_suppfile_up->setEnabled( lwSuppFiles->currentRow() > 0 );
@@ -447,6 +462,61 @@ void ValgrindOptionsPage::suppfileRemove()
 
 
 
+// match all listed suppfiles against an existing log, without
+// re-running valgrind, and show which errors / supps match.
+void ValgrindOptionsPage::suppfileCheck()
+{
+   LbWidget* lbSel = ( LbWidget* )m_itemList[VALGRIND::SUPPS_SEL];
+   QListWidget* lwSuppFiles = (QListWidget*)lbSel->widget();
+
+   QString log_file =
+      QFileDialog::getOpenFileName( this,
+                                    tr( "Choose Log File" ),
+                                    "./", tr("XML Files (*.xml);;All Files (*)") );
+   if ( log_file.isEmpty() ) { // user clicked Cancel
+      return;
+   }
+
+   QApplication::setOverrideCursor( Qt::WaitCursor );
+
+   VgSuppMatcher matcher;
+   QString errMsg;
+   bool ok = true;
+   for ( int i = 0; ok && i < lwSuppFiles->count(); ++i ) {
+      ok = matcher.addSuppFile( lwSuppFiles->item( i )->text(), errMsg );
+   }
+   ok = ok && matcher.addLogs( QStringList( log_file ), errMsg );
+
+   QString report;
+   if ( ok ) {
+      QTextStream strm( &report );
+      matcher.writeReport( strm );
+   }
+
+   QApplication::restoreOverrideCursor();
+
+   if ( !ok ) {
+      vkError( this, "Check Suppressions", "<p>%s</p>", qPrintable( errMsg ) );
+      return;
+   }
+
+   QDialog dlg( this );
+   dlg.setWindowTitle( "Check Suppressions" );
+   QVBoxLayout* vbox = new QVBoxLayout( &dlg );
+   QPlainTextEdit* text = new QPlainTextEdit( report, &dlg );
+   text->setReadOnly( true );
+   text->setLineWrapMode( QPlainTextEdit::NoWrap );
+   text->setFont( QFont( "Courier" ) );
+   QDialogButtonBox* buttons = new QDialogButtonBox( QDialogButtonBox::Close, Qt::Horizontal, &dlg );
+   connect( buttons, SIGNAL(rejected()), &dlg, SLOT(reject()) );
+   vbox->addWidget( text );
+   vbox->addWidget( buttons );
+   dlg.resize( 640, 480 );
+   dlg.exec();
+}
+
+
+
 void ValgrindOptionsPage::setSuppBtns()
 {
    QListWidget* lwFiles = (QListWidget*)m_itemList[VALGRIND::SUPPS_SEL]->widget();
@@ -456,6 +526,7 @@ void ValgrindOptionsPage::setSuppBtns()
    btn_supp_new->setEnabled( suppfileSelected );
    btn_supp_edt->setEnabled( suppfileSelected && suppItemSelected );
    btn_supp_del->setEnabled( suppfileSelected && suppItemSelected );
+   btn_supp_prn->setEnabled( suppfileSelected && lwSupps->count() > 0 );
 }
 
 void ValgrindOptionsPage::suppLoad()
@@ -476,11 +547,33 @@ void ValgrindOptionsPage::suppLoad()
       }
       lwSupps->addItems( supplist.suppNames() );
       lwSupps->setCurrentRow( 0 );
+      setSuppUsageTips();
    }
    
    setSuppBtns();
 }
 
+// tooltip per supp: how much it's been used in this project's runs
+void ValgrindOptionsPage::setSuppUsageTips()
+{
+   QListWidget* lwFiles = (QListWidget*)m_itemList[VALGRIND::SUPPS_SEL]->widget();
+   if ( lwFiles->currentItem() == 0 ) {
+      return;
+   }
+   QString fname = lwFiles->currentItem()->text();
+
+   SuppUsage usage;
+   if ( !usage.load() ) {
+      vkPrintErr("Failed to read suppression usage history '%s'",
+                 qPrintable( SuppUsage::historyFile() ));
+      return;
+   }
+   for ( int i = 0; i < lwSupps->count(); ++i ) {
+      QListWidgetItem* item = lwSupps->item( i );
+      item->setToolTip( usage.describe( fname, item->text() ) );
+   }
+}
+
 //
 void ValgrindOptionsPage::setCurrentTab( int idx )
 {
@@ -518,6 +611,69 @@ void ValgrindOptionsPage::suppNewFromStr( const QString& str )
 }
    
 
+// synthesise a minimal set of supps from many errors' supps,
+// and add them to the current suppfile
+void ValgrindOptionsPage::suppsNewFromStrs( const QStringList& strs )
+{
+   // first check we have a file to write to
+   LbWidget* lbSel = ( LbWidget* )m_itemList[VALGRIND::SUPPS_SEL];
+   QListWidget* lwSuppFiles = (QListWidget*)lbSel->widget();
+   if ( lwSuppFiles->count() == 0 ) {
+      suppfileNew();
+   }
+   // still no supp file? user may have Cancelled...
+   if ( lwSuppFiles->count() == 0 || lwSuppFiles->currentItem() == 0 ) {
+      return;
+   }
+
+   bool ok;
+   int maxFrames = QInputDialog::getInt( this, tr( "Generate Suppressions" ),
+                                         tr( "Maximum frames per suppression:" ),
+                                         SYNTH_SUPP_FRAMES, 1, MAX_SUPP_FRAMES,
+                                         1, &ok );
+   if ( !ok ) {
+      return;
+   }
+
+   SuppSynthesiser synth( maxFrames );
+   foreach ( QString str, strs ) {
+      synth.addSupp( str );
+   }
+
+   // unique names, should this be done more than once per file
+   QString prefix = "vk_synth_" +
+                    QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" );
+   QList<Suppression> supps = synth.synthesise( prefix );
+
+   if ( supps.isEmpty() ) {
+      vkInfo( this, "Generate Suppressions",
+              "<p>None of the %d suppressions could be parsed.</p>",
+              strs.count() );
+      return;
+   }
+
+   // update model and suppfile first...
+   if ( !supplist.addSupps( supps ) ) {
+      vkError( this, "Generate Suppressions",
+               "<p>Failed to write suppressions file '%s'</p>",
+               qPrintable( lwSuppFiles->currentItem()->text() ) );
+      return;
+   }
+   // ... then update the view
+   foreach ( Suppression supp, supps ) {
+      lwSupps->addItem( supp.getName() );
+   }
+   lwSupps->setCurrentRow( lwSupps->count()-1 );
+
+   vkInfo( this, "Generate Suppressions",
+           "<p>%d errors: %d suppressions added.</p>%s",
+           synth.numAdded(), supps.count(),
+           synth.numRejected() == 0 ? "" :
+           qPrintable( QString( "<p>%1 suppressions could not be parsed.</p>" )
+                       .arg( synth.numRejected() ) ) );
+}
+
+
 // create default supp, pass to editor, save if ok
 void ValgrindOptionsPage::suppNew()
 {
@@ -563,6 +719,119 @@ void ValgrindOptionsPage::suppDelete()
    }
 }
 
+// delete the supps that haven't been used in the last N runs,
+// as recorded in the project's suppression usage history
+void ValgrindOptionsPage::suppPrune()
+{
+   QListWidget* lwFiles = (QListWidget*)m_itemList[VALGRIND::SUPPS_SEL]->widget();
+   vk_assert( lwFiles->currentItem() != 0 );
+
+   SuppUsage usage;
+   if ( !usage.load() || usage.numRuns() == 0 ) {
+      vkInfo( this, "Prune Suppressions",
+              "<p>No Valgrind runs have been recorded for this project yet.</p>"
+              "<p>Each run's suppression counts are recorded when it finishes.</p>" );
+      return;
+   }
+
+   bool ok;
+   int nRuns = QInputDialog::getInt( this, tr( "Prune Suppressions" ),
+                                     tr( "Delete suppressions not used in the last N runs:" ),
+                                     qMin( SUPP_PRUNE_RUNS, usage.numRuns() ),
+                                     1, usage.numRuns(), 1, &ok );
+   if ( !ok ) {
+      return;
+   }
+
+   // not candidates: supps the bundle drops, as duplicates of one
+   // before them, here or in an earlier file.  Their hits are credited
+   // to them, but they're not what valgrind reads.
+   QString fname = lwFiles->currentItem()->text();
+   QSet<QString> keysBefore;
+   for ( int i = 0; i < lwFiles->row( lwFiles->currentItem() ); ++i ) {
+      QString before = lwFiles->item( i )->text();
+      SuppList earlier;
+      if ( earlier.readSuppFile( before, false ) ) {
+         foreach ( Suppression supp, earlier.supps() ) {
+            keysBefore.insert( SuppBundle::suppKey( supp ) );
+         }
+      }
+   }
+
+   // candidates: all checked, but the user has the last word
+   QDialog dlg( this );
+   dlg.setWindowTitle( "Prune Suppressions" );
+   QVBoxLayout* vbox = new QVBoxLayout( &dlg );
+   QListWidget* lwPrune = new QListWidget( &dlg );
+   QList<int> candidates;
+   QStringList names = supplist.suppNames();
+   for ( int i = 0; i < names.count(); ++i ) {
+      QString suppKey = SuppBundle::suppKey( supplist.supps().at( i ) );
+      if ( keysBefore.contains( suppKey ) ) {
+         continue;
+      }
+      keysBefore.insert( suppKey );
+
+      if ( usage.runsSinceHit( fname, names.at( i ) ) >= nRuns ) {
+         QListWidgetItem* item = new QListWidgetItem( names.at( i ), lwPrune );
+         item->setCheckState( Qt::Checked );
+         item->setToolTip( usage.describe( fname, names.at( i ) ) );
+         candidates << i;
+      }
+   }
+   if ( candidates.isEmpty() ) {
+      vkInfo( this, "Prune Suppressions",
+              "<p>All suppressions were used in the last %d runs.</p>", nRuns );
+      return;
+   }
+
+   QLabel* lbl = new QLabel( QString( "<p>%1 of %2 suppressions were not used in the last "
+                                      "%3 runs, and will be deleted.</p>"
+                                      "<p>Note: suppressions added since those runs "
+                                      "have not had the chance to be used.</p>" )
+                             .arg( candidates.count() ).arg( names.count() ).arg( nRuns ), &dlg );
+   lbl->setWordWrap( true );
+   QDialogButtonBox* buttons = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
+                                                     Qt::Horizontal, &dlg );
+   buttons->button( QDialogButtonBox::Ok )->setText( "&Delete" );
+   connect( buttons, SIGNAL(accepted()), &dlg, SLOT(accept()) );
+   connect( buttons, SIGNAL(rejected()), &dlg, SLOT(reject()) );
+   vbox->addWidget( lbl );
+   vbox->addWidget( lwPrune );
+   vbox->addWidget( buttons );
+   dlg.resize( 480, 360 );
+   if ( dlg.exec() != QDialog::Accepted ) {
+      return;
+   }
+
+   QList<int> idxs;
+   for ( int i = 0; i < lwPrune->count(); ++i ) {
+      if ( lwPrune->item( i )->checkState() == Qt::Checked ) {
+         idxs << candidates.at( i );
+      }
+   }
+   if ( idxs.isEmpty() ) {
+      return;
+   }
+
+   // update model and suppfile first...
+   if ( !supplist.deleteSupps( idxs ) ) {
+      vkError( this, "Prune Suppressions",
+               "<p>Failed to write suppressions file '%s'</p>",
+               qPrintable( lwFiles->currentItem()->text() ) );
+      return;
+   }
+   // ... then update the view
+   lwSupps->clear();
+   lwSupps->addItems( supplist.suppNames() );
+   lwSupps->setCurrentRow( 0 );
+   setSuppUsageTips();
+   setSuppBtns();
+
+   vkInfo( this, "Prune Suppressions",
+           "<p>%d suppressions deleted.</p>", idxs.count() );
+}
+
 
 #if 0 //TODO
 {
@@ -39,6 +39,7 @@ public:
    
    void setCurrentTab( int idx );
    void suppNewFromStr( const QString& str );
+   void suppsNewFromStrs( const QStringList& strs );
    
 public slots:
    void suppNew();
@@ -52,13 +53,16 @@ private slots:
    void suppfileRemove();
    void suppfileUp();
    void suppfileDown();
+   void suppfileCheck();
    void setSuppBtns();
    void suppLoad();
    void suppEdit( QListWidgetItem* );
    void suppDelete();
+   void suppPrune();
    
 private:
    void setupOptions();
+   void setSuppUsageTips();
    
 private:
    QTabWidget* tabWidget;
@@ -69,9 +73,11 @@ private:
    QPushButton* btn_suppfile_new;
    QPushButton* btn_suppfile_add;
    QPushButton* btn_suppfile_rmv;
+   QPushButton* btn_suppfile_chk;
    QPushButton* btn_supp_new;
    QPushButton* btn_supp_edt;
    QPushButton* btn_supp_del;
+   QPushButton* btn_supp_prn;
 
    SuppList supplist;
 };
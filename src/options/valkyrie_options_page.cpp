@@ -100,6 +100,12 @@ void ValkyrieOptionsPage::setupOptions()
    editLedit->addButton( group1, this, SLOT( getEditor() ) );
 
    insertOptionWidget( VALKYRIE::SRC_LINES, group1, true );    // intspin
+
+   insertOptionWidget( VALKYRIE::SAMPLE_INTERVAL, group1, true );  // intspin
+
+   insertOptionWidget( VALKYRIE::EXPAND_MEM_LIMIT, group1, true );  // intspin
+
+   insertOptionWidget( VALKYRIE::CLOSED_MEM_BUDGET, group1, true );  // intspin
    
    insertOptionWidget( VALKYRIE::BROWSER, group1, false );  // line edit
    LeWidget* brwsrLedit = (( LeWidget* )m_itemList[VALKYRIE::BROWSER] );
@@ -117,6 +123,9 @@ void ValkyrieOptionsPage::setupOptions()
    grid->addWidget( editLedit->button(), i, 0 );
    grid->addWidget( editLedit->widget(), i++, 1, 1, 3 );
    grid->addLayout( m_itemList[VALKYRIE::SRC_LINES]->hlayout(),  i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::SAMPLE_INTERVAL]->hlayout(), i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::EXPAND_MEM_LIMIT]->hlayout(), i++, 0, 1, 4 );
+   grid->addLayout( m_itemList[VALKYRIE::CLOSED_MEM_BUDGET]->hlayout(), i++, 0, 1, 4 );
    
    grid->addWidget( brwsrLedit->button(), i, 0 );
    grid->addWidget( brwsrLedit->widget(), i++, 1, 1, 3 );
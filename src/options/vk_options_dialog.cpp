@@ -52,20 +52,12 @@ VkOptionsDialog::VkOptionsDialog( QWidget* parent )
    // Add categories, and the pages
    // Note: both the pages and categories list use the same 'index',
    // which is how we keep them in sync.
-   // TODO: if any complaints re speed, load the pages on demand.
-   VkObjectList objList = (( MainWindow* )parent )->getValkyrie()->vkObjList();
+   // The pages are made on demand: until then, an empty placeholder
+   // holds each one's place in the stack.
+   objList = (( MainWindow* )parent )->getValkyrie()->vkObjList();
    
    for ( int i = 0; i < objList.size(); ++i ) {
-   
-      // Allow the VkObject to create the appropriate options page
-      // Pass 'this' so constructor widgets auto-size correctly.
       VkObject* obj = objList.at( i );
-      VkOptionsPage* page = obj->createVkOptionsPage();
-      vk_assert( page != 0 );
-      page->init();
-      connect( page, SIGNAL( modified() ), this, SLOT( pageModified() ) );
-      // handle e.g. user pressing return in an ledit
-      connect( page, SIGNAL( apply() ), this, SLOT( apply() ) );
       
       // Set list item entry
       QListWidgetItem* item = new QListWidgetItem( contentsListWidget );
@@ -79,12 +71,15 @@ VkOptionsDialog::VkOptionsDialog( QWidget* parent )
       item->setFont( font );
 
       // insert into stack (takes ownership)
-      optionPages->addWidget( page );
+      optionPages->addWidget( new QWidget( optionPages ) );
+      pages.append( 0 );
    }
    
    contentsListWidget->setCurrentRow( 0 );
    contentsListWidget->setFocus();
    optionPages->setCurrentIndex( 0 );
+   // placeholders are all the same size: size ourselves on a real page
+   ensurePage( 0 );
    
    // Give a max to our contentsList, based on hints from the list-items.
    // TODO: surely this can be done automatically?
@@ -103,8 +98,42 @@ VkOptionsDialog::~VkOptionsDialog()
 }
 
 
+/*!
+  Make page 'idx', if not yet made, in place of its placeholder.
+*/
+VkOptionsPage* VkOptionsDialog::ensurePage( int idx )
+{
+   vk_assert( idx >= 0 && idx < pages.count() );
+   if ( pages[idx] != 0 ) {
+      return pages[idx];
+   }
+
+   // Allow the VkObject to create the appropriate options page
+   VkOptionsPage* page = objList.at( idx )->createVkOptionsPage();
+   vk_assert( page != 0 );
+   page->init();
+   connect( page, SIGNAL( modified() ), this, SLOT( pageModified() ) );
+   // handle e.g. user pressing return in an ledit
+   connect( page, SIGNAL( apply() ), this, SLOT( apply() ) );
+
+   // swap out the placeholder: keep the current index as was
+   bool isCurrent = ( optionPages->currentIndex() == idx );
+   QWidget* placeholder = optionPages->widget( idx );
+   optionPages->insertWidget( idx, page );
+   optionPages->removeWidget( placeholder );
+   delete placeholder;
+   if ( isCurrent ) {
+      optionPages->setCurrentIndex( idx );
+   }
+
+   pages[idx] = page;
+   return page;
+}
+
+
 QWidget* VkOptionsDialog::setCurrentPage( int idx )
 {
+   ensurePage( idx );
    optionPages->setCurrentIndex( idx );
    contentsListWidget->setCurrentRow( idx );
    
@@ -274,6 +303,7 @@ void VkOptionsDialog::showPage()
 
    if ( continueToNext ) {
       // All done with last page: open next page
+      ensurePage( nextIdx );
       optionPages->setCurrentIndex( nextIdx );
    }
    else {
@@ -26,8 +26,13 @@
 #include <QDialogButtonBox>
 #include <QListWidget>
 #include <QStackedWidget>
+#include <QVector>
 #include <QWidget>
 
+#include "objects/vk_objects.h"
+
+class VkOptionsPage;
+
 
 // ============================================================
 class VkOptionsDialog : public QDialog
@@ -42,6 +47,7 @@ public:
    
 private:
    void setupLayout();
+   VkOptionsPage* ensurePage( int idx );
    void keyPressEvent( QKeyEvent* event ); // overloaded
 
 private slots:
@@ -60,6 +66,9 @@ private:
    QStackedWidget*   optionPages;
    QDialogButtonBox* optionsButtonBox;
    QPushButton*      updateDefaultsButton;
+
+   VkObjectList            objList;   // one page per object
+   QVector<VkOptionsPage*> pages;     // 0 until first shown
 };
 
 
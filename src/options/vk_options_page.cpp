@@ -27,6 +27,7 @@
 #include "options/widgets/opt_lb_widget.h"
 #include "options/widgets/opt_le_widget.h"
 #include "options/widgets/opt_sp_widget.h"
+#include "utils/vgcapabilities.h"
 #include "utils/vk_config.h"
 #include "utils/vk_messages.h"
 #include "utils/vk_utils.h"
@@ -165,13 +166,15 @@ bool VkOptionsPage::applyEdits()
       }
    }
    
-   // all edited entries ok: commit them all
+   // all edited entries ok: commit them all, in one config sync
    QList<OptionWidget*> tmpList;
+   vkCfgProj->beginBatch();
    foreach( OptionWidget* optw, m_editList ) {
       // optw->option emits valueChanged() on save:
       optw->saveEdit();
       tmpList.append( optw );
    }
+   vkCfgProj->endBatch();
    
    // now remove all the saved items from m_editList
    foreach( OptionWidget* optw, tmpList ) {
@@ -273,6 +276,19 @@ OptionWidget* VkOptionsPage::insertOptionWidget( int optid,
       break;
    }
 
+   // valgrind (and tool) options the installed valgrind doesn't take:
+   // greyed out, as getVgFlags() won't pass them on anyway.
+   if ( optWidget && opt->configGrp != "valkyrie" &&
+        !VgCapsCache::instance()->supportsFlag(
+           vkCfgProj->value( "valkyrie/vg-exec" ).toString(),
+           opt->configGrp, opt->longFlag ) ) {
+      optWidget->setEnabled( false );
+      if ( optWidget->widget() ) {
+         optWidget->widget()->setToolTip( "--" + opt->longFlag +
+                                          ": not supported by this valgrind" );
+      }
+   }
+
    // check validity of option values immediately upon finishing edit
    connect( optWidget, SIGNAL( editDone( OptionWidget* ) ),
             this,        SLOT( checkOption( OptionWidget* ) ) );
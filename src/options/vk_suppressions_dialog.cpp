@@ -52,8 +52,11 @@ SuppFrame::SuppFrame( bool isFirstFrame, QWidget* parent )
    frame_cmb = new QComboBox();
    frame_cmb->setMinimumWidth( width_col1 );
    frame_cmb->addItems( SuppRanges::instance().getFrameTypes() );
+   frame_cmb->addItem( "..." );      // frame wildcard: no contents
    
    frame_le  = new QLineEdit();
+   connect( frame_cmb, SIGNAL(currentIndexChanged(const QString&)),
+            this,      SLOT(typeChanged(const QString&)) );
    
    frame_but = new QPushButton("-");
    if ( isFirstFrame ) frame_but->hide();
@@ -70,6 +73,15 @@ void SuppFrame::buttClicked()
    emit removeFrame( this );
 }
 
+void SuppFrame::typeChanged( const QString& type )
+{
+   bool isWild = ( type == "..." );
+   if ( isWild ) {
+      frame_le->clear();
+   }
+   frame_le->setEnabled( !isWild );
+}
+
 
 
 
@@ -121,6 +133,11 @@ void VkSuppressionsDialog::setupLayout()
    QLabel* name_lbl = new QLabel("Name:");
    name_le = new QLineEdit();
 
+   // Usage: from the project's suppression usage history
+   QLabel* usage_lbl = new QLabel("Usage:");
+   usage_val_lbl = new QLabel("(new suppression)");
+   usage_val_lbl->setWordWrap( true );
+
    // Kind-Tool
    QLabel* tool_lbl = new QLabel("Kind-Tool:");
    tool_cmb = new QComboBox();
@@ -156,6 +173,8 @@ void VkSuppressionsDialog::setupLayout()
    // gridLayout->setRowMinimumHeight( i++, lineHeight / 2 ); // blank row
    gridLayout->addWidget( name_lbl, i,   0, Qt::AlignRight );
    gridLayout->addWidget( name_le,  i++, 1 );
+   gridLayout->addWidget( usage_lbl, i,   0, Qt::AlignRight );
+   gridLayout->addWidget( usage_val_lbl, i++, 1 );
 
    gridLayout->addWidget( VkOptionsPage::sep( layoutWidget ), i++, 0, 1, 2 );
    
@@ -260,6 +279,15 @@ void VkSuppressionsDialog::TypeChanged( int )
 }
 
 
+/*!
+  Hit statistics of the supp being edited: see SuppUsage::describe()
+*/
+void VkSuppressionsDialog::setUsage( const QString& usage )
+{
+   usage_val_lbl->setText( usage );
+}
+
+
 void VkSuppressionsDialog::setSupp( const Suppression& supp )
 {
    // Name
@@ -282,10 +310,15 @@ void VkSuppressionsDialog::setSupp( const Suppression& supp )
       // new widgets for new frames, apart from first
       if ( i>0) addNewSuppFrame();
       
+      QComboBox* cmb = suppFrames[i]->frame_cmb;
+      if ( frames.at(i) == "..." ) {
+         cmb->setCurrentIndex( cmb->findText( "...", Qt::MatchExactly ) );
+         continue;
+      }
+
       QStringList frame = frames.at(i).split(":");
       vk_assert( frame.count() == 2 );
       
-      QComboBox* cmb = suppFrames[i]->frame_cmb;
       cmb->setCurrentIndex( cmb->findText( frame[0], Qt::MatchExactly ) );
       QLineEdit* le = suppFrames[i]->frame_le;
       le->setText( frame[1] );
@@ -311,6 +344,10 @@ const Suppression VkSuppressionsDialog::getUpdatedSupp()
    for (int i=0; i<suppFrames.count(); i++) {
       QString type = suppFrames[i]->frame_cmb->currentText();
       QString data = suppFrames[i]->frame_le->text();
+      if ( type == "..." ) {
+         supp.addFrame( type );
+         continue;
+      }
       if ( i==0 && data.isEmpty() )
          data = "<unknown>";
       if ( !data.isEmpty() )
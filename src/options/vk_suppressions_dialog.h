@@ -43,6 +43,7 @@ private:
    
 private slots:
    void buttClicked();
+   void typeChanged( const QString& type );
    
 public:
    QComboBox* frame_cmb;
@@ -60,6 +61,7 @@ public:
    VkSuppressionsDialog(QWidget *parent = 0);
 
    void setSupp( const Suppression& supp );
+   void setUsage( const QString& usage );
    const Suppression getUpdatedSupp();
    
 private:
@@ -75,6 +77,7 @@ private:
    QVBoxLayout* callChainLayout;
 
    QLineEdit* name_le;
+   QLabel* usage_val_lbl;
    QComboBox* tool_cmb;
    QComboBox* type_cmb;
    QLabel* kaux_lbl;
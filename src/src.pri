@@ -0,0 +1,141 @@
+######################################################################
+# Valkyrie qmake include file: the application's sources, bar main()
+#
+# Shared by src.pro and anything else built from them (benchmarks/),
+# so paths are relative to this file, not the includer.
+######################################################################
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/mainwindow.cpp \
+    $$PWD/help/help_about.cpp \
+    $$PWD/help/help_context.cpp \
+    $$PWD/help/help_handbook.cpp \
+    $$PWD/help/help_urls.cpp \
+    $$PWD/objects/helgrind_object.cpp \
+    $$PWD/objects/memcheck_object.cpp \
+    $$PWD/objects/tool_object.cpp \
+    $$PWD/objects/valkyrie_object.cpp \
+    $$PWD/objects/valgrind_object.cpp \
+    $$PWD/objects/vk_objects.cpp \
+    $$PWD/options/helgrind_options_page.cpp \
+    $$PWD/options/memcheck_options_page.cpp \
+    $$PWD/options/suppressions.cpp \
+    $$PWD/options/vk_option.cpp \
+    $$PWD/options/vk_options_dialog.cpp \
+    $$PWD/options/vk_options_page.cpp \
+    $$PWD/options/vk_parse_cmdline.cpp \
+    $$PWD/options/vk_popt.cpp \
+    $$PWD/options/vk_suppressions_dialog.cpp \
+    $$PWD/options/valgrind_options_page.cpp \
+    $$PWD/options/valkyrie_options_page.cpp \
+    $$PWD/options/widgets/opt_base_widget.cpp \
+    $$PWD/options/widgets/opt_cb_widget.cpp \
+    $$PWD/options/widgets/opt_ck_widget.cpp \
+    $$PWD/options/widgets/opt_le_widget.cpp \
+    $$PWD/options/widgets/opt_sp_widget.cpp \
+    $$PWD/options/widgets/opt_lb_widget.cpp \
+    $$PWD/toolview/helgrindview.cpp \
+    $$PWD/toolview/helgrind_logview.cpp \
+    $$PWD/toolview/logviewfilter_mc.cpp \
+    $$PWD/toolview/memcheckview.cpp \
+    $$PWD/toolview/memcheck_logview.cpp \
+    $$PWD/toolview/toolview.cpp \
+    $$PWD/toolview/vgcollapsedlru.cpp \
+    $$PWD/toolview/vgerrorsort.cpp \
+    $$PWD/toolview/vgexpandall.cpp \
+    $$PWD/toolview/vgheapindex.cpp \
+    $$PWD/toolview/vghgindex.cpp \
+    $$PWD/toolview/vgjobqueue_dialog.cpp \
+    $$PWD/toolview/vglockgraph.cpp \
+    $$PWD/toolview/vglogdiff_dialog.cpp \
+    $$PWD/toolview/vglogview.cpp \
+    $$PWD/toolview/vkmetrics_dialog.cpp \
+    $$PWD/utils/vgcapabilities.cpp \
+    $$PWD/utils/vgjobqueue.cpp \
+    $$PWD/utils/vglogdiff.cpp \
+    $$PWD/utils/vglogexport.cpp \
+    $$PWD/utils/vglogloader.cpp \
+    $$PWD/utils/vglogmerge.cpp \
+    $$PWD/utils/vglogreport.cpp \
+    $$PWD/utils/vglogreader.cpp \
+    $$PWD/utils/vgoptprofile.cpp \
+    $$PWD/utils/vgsuppmatch.cpp \
+    $$PWD/utils/vk_config.cpp \
+    $$PWD/utils/vk_logpoller.cpp \
+    $$PWD/utils/vk_messages.cpp \
+    $$PWD/utils/vk_procsampler.cpp \
+    $$PWD/utils/vk_srccache.cpp \
+    $$PWD/utils/vk_stringpool.cpp \
+    $$PWD/utils/vk_trace.cpp \
+    $$PWD/utils/vk_utils.cpp \
+    $$PWD/utils/vknewprojectdialog.cpp
+
+HEADERS += \
+    $$PWD/mainwindow.h \
+    $$PWD/help/help_about.h \
+    $$PWD/help/help_context.h \
+    $$PWD/help/help_handbook.h \
+    $$PWD/help/help_urls.h \
+    $$PWD/objects/helgrind_object.h \
+    $$PWD/objects/memcheck_object.h \
+    $$PWD/objects/tool_object.h \
+    $$PWD/objects/valkyrie_object.h \
+    $$PWD/objects/valgrind_object.h \
+    $$PWD/objects/vk_objects.h \
+    $$PWD/options/helgrind_options_page.h \
+    $$PWD/options/memcheck_options_page.h \
+    $$PWD/options/suppressions.h \
+    $$PWD/options/vk_option.h \
+    $$PWD/options/vk_options_dialog.h \
+    $$PWD/options/vk_options_page.h \
+    $$PWD/options/vk_parse_cmdline.h \
+    $$PWD/options/vk_popt.h \
+    $$PWD/options/valgrind_options_page.h \
+    $$PWD/options/valkyrie_options_page.h \
+    $$PWD/options/vk_suppressions_dialog.h \
+    $$PWD/options/widgets/opt_base_widget.h \
+    $$PWD/options/widgets/opt_cb_widget.h \
+    $$PWD/options/widgets/opt_ck_widget.h \
+    $$PWD/options/widgets/opt_le_widget.h \
+    $$PWD/options/widgets/opt_sp_widget.h \
+    $$PWD/options/widgets/opt_lb_widget.h \
+    $$PWD/toolview/helgrindview.h \
+    $$PWD/toolview/helgrind_logview.h \
+    $$PWD/toolview/logviewfilter_mc.h \
+    $$PWD/toolview/memcheckview.h \
+    $$PWD/toolview/memcheck_logview.h \
+    $$PWD/toolview/toolview.h \
+    $$PWD/toolview/vgcollapsedlru.h \
+    $$PWD/toolview/vgerrorsort.h \
+    $$PWD/toolview/vgexpandall.h \
+    $$PWD/toolview/vgheapindex.h \
+    $$PWD/toolview/vghgindex.h \
+    $$PWD/toolview/vgjobqueue_dialog.h \
+    $$PWD/toolview/vglockgraph.h \
+    $$PWD/toolview/vglogdiff_dialog.h \
+    $$PWD/toolview/vglogview.h \
+    $$PWD/toolview/vkmetrics_dialog.h \
+    $$PWD/utils/vgcapabilities.h \
+    $$PWD/utils/vgjobqueue.h \
+    $$PWD/utils/vglogdiff.h \
+    $$PWD/utils/vglogexport.h \
+    $$PWD/utils/vglogloader.h \
+    $$PWD/utils/vglogmerge.h \
+    $$PWD/utils/vglogreport.h \
+    $$PWD/utils/vglogreader.h \
+    $$PWD/utils/vgoptprofile.h \
+    $$PWD/utils/vgsuppmatch.h \
+    $$PWD/utils/vk_config.h \
+    $$PWD/utils/vk_defines.h \
+    $$PWD/utils/vk_logpoller.h \
+    $$PWD/utils/vk_messages.h \
+    $$PWD/utils/vk_procsampler.h \
+    $$PWD/utils/vk_srccache.h \
+    $$PWD/utils/vk_stringpool.h \
+    $$PWD/utils/vk_trace.h \
+    $$PWD/utils/vk_utils.h \
+    $$PWD/utils/vknewprojectdialog.h
+
+RESOURCES += $$PWD/../icons.qrc
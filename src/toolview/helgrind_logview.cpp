@@ -183,7 +183,12 @@ bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
       updateThreadId( err.firstChildElement( "what" ) );
       updateThreadId( err.firstChildElement( "auxwhat" ) );
 
-      lastItem = new ErrorItemHG( topStatus, lastItem, err );
+      // no parent yet: put in (sort) order by addErrorItem()
+      ErrorItem* errItem = new ErrorItemHG( 0, 0, err );
+      addErrorItem( errItem );
+      hgIdx.addError( errItem, err );
+      lockOrder.addError( errItem, err );
+      lastItem = errItem;
 
       // update topStatus
       topStatus->updateToolStatus( err );
@@ -192,7 +197,10 @@ bool HelgrindLogView::appendNodeTool( QDomElement elem, QString& errMsg )
 
    case VG_ELEM::ANNOUNCETHREAD: {
       QDomElement announcethread = elem;
-      lastItem = new AnnounceThreadItem( topStatus, lastItem, announcethread );
+      lastItem = new AnnounceThreadItem( topStatus, lastTopChild(), announcethread );
+      topItemAdded( lastItem );
+      hgIdx.addAnnounce( announcethread.firstChildElement( "hthreadid" ).text().toInt(),
+                         lastItem );
       break;
    }
 
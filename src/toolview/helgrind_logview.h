@@ -21,6 +21,8 @@
 #ifndef __VK_HELGRINDLOGVIEW_H
 #define __VK_HELGRINDLOGVIEW_H
 
+#include "toolview/vghgindex.h"
+#include "toolview/vglockgraph.h"
 #include "toolview/vglogview.h"
 
 
@@ -31,6 +33,15 @@ public:
    HelgrindLogView( QTreeWidget* );
    ~HelgrindLogView();
 
+   // thread announcements and races by group, as read so far
+   const VgHgIndex& hgIndex() const {
+      return hgIdx;
+   }
+   // lock order cycles, as read so far
+   const VgLockGraph& lockGraph() const {
+      return lockOrder;
+   }
+
 private:
    void updateThreadId( QDomElement elem );
 
@@ -39,6 +50,10 @@ private:
                                    QDomElement status, QString _protocol );
    QString toolName();
    bool appendNodeTool( QDomElement elem, QString& errMsg );
+
+private:
+   VgHgIndex hgIdx;
+   VgLockGraph lockOrder;
 };
 
 
@@ -22,6 +22,7 @@
 #include "toolview/helgrind_logview.h"
 #include "utils/vk_config.h"
 #include "utils/vk_messages.h"
+#include "utils/vk_trace.h"
 #include "utils/vk_utils.h"
 
 #include <QAction>
@@ -61,60 +62,69 @@
     Constructs a HelgrindView with the given \a parent.
 */
 HelgrindView::HelgrindView( QWidget* parent )
-   : ToolView( parent, VGTOOL::ID_HELGRIND ), logview(0)
+   : ToolView( parent, VGTOOL::ID_HELGRIND ), groupShown( false )
 {
    setObjectName( QString::fromUtf8( "HelgrindView" ) );
 
    setupLayout();
    setupActions();
    setupToolBar();
-
-   // enable | disable show*Item buttons
-   connect( treeView, SIGNAL( itemSelectionChanged() ),
-            this,       SLOT( updateItemActions() ) );
-
-   // on collapsing a branch, reset currentItem to branch head.
-   connect( treeView, SIGNAL( itemCollapsed( QTreeWidgetItem* ) ),
-            this,       SLOT( itemCollapsed( QTreeWidgetItem* ) ) );
-
-   // load items on-demand
-   connect( treeView, SIGNAL( itemExpanded( QTreeWidgetItem* ) ),
-            this,       SLOT( itemExpanded( QTreeWidgetItem* ) ) );
-
-   // launch editor with src file loaded
-   connect( treeView, SIGNAL( itemDoubleClicked( QTreeWidgetItem*, int ) ),
-            this,       SLOT( launchEditor( QTreeWidgetItem* ) ) );
 }
 
 
 /*!
     Destroys this widget, and frees any allocated resources.
+    The tabs' logs go with the base class.
 */
 HelgrindView::~HelgrindView()
 {
-   if ( logview != 0 ) {
-      delete logview;
-      logview = 0;
-   }
 }
 
 
 /*!
-   Provide the tool-object access to our model, to fill it,
-   but keep ownership ourselves: we know when we're done with it.
+    A tab's tree.
+*/
+QTreeWidget* HelgrindView::createLogTree()
+{
+   QTreeWidget* tree = new QTreeWidget( this );
+   tree->setObjectName( QString::fromUtf8( "treeview_Helgrind" ) );
+   tree->setHeaderHidden( true );
+   tree->setRootIsDecorated( false );
+   return tree;
+}
+
 
-   Creates a clean log on each call.
-   This should be called by the tool-object just before it intends
-   to fill the log.
+/*!
+    Connect a tab's tree to our slots: these work on the current tab's.
 */
-VgLogView* HelgrindView::createVgLogView()
+void HelgrindView::connectLogTree( QTreeWidget* tree )
 {
-   if ( logview != 0 ) {
-      delete logview;
-   }
+   // enable | disable show*Item buttons
+   connect( tree, SIGNAL( itemSelectionChanged() ),
+            this,   SLOT( updateItemActions() ) );
 
-   logview = new HelgrindLogView( treeView );
-   return logview;
+   // on collapsing a branch, reset currentItem to branch head.
+   connect( tree, SIGNAL( itemCollapsed( QTreeWidgetItem* ) ),
+            this,   SLOT( itemCollapsed( QTreeWidgetItem* ) ) );
+
+   // load items on-demand
+   connect( tree, SIGNAL( itemExpanded( QTreeWidgetItem* ) ),
+            this,   SLOT( itemExpanded( QTreeWidgetItem* ) ) );
+
+   // launch editor with src file loaded
+   connect( tree, SIGNAL( itemDoubleClicked( QTreeWidgetItem*, int ) ),
+            this,   SLOT( launchEditor( QTreeWidgetItem* ) ) );
+}
+
+
+/*!
+    A clean log on the given tree, for the run's tab or another.
+*/
+VgLogView* HelgrindView::newLogView( QTreeWidget* tree )
+{
+   VgLogView* lv = new HelgrindLogView( tree );
+   lv->sortErrors( errorSortSpec );
+   return lv;
 }
 
 
@@ -127,11 +137,8 @@ void HelgrindView::setupLayout()
    QVBoxLayout* vLayout = new QVBoxLayout( this );
    vLayout->setMargin(0);
    
-   treeView = new QTreeWidget( this );
-   treeView->setObjectName( QString::fromUtf8( "treeview_Helgrind" ) );
-   treeView->setHeaderHidden( true );
-   treeView->setRootIsDecorated( false );
-   vLayout->addWidget( treeView );
+   // the run's tab, and logs opened alongside
+   vLayout->addWidget( createLogTabs() );
 }
 
 
@@ -176,6 +183,28 @@ void HelgrindView::setupActions()
    act_OpenLog->setIconVisibleInMenu( true );
    connect( act_OpenLog, SIGNAL( triggered() ), this, SLOT( openLogFile() ) );
 
+   act_OpenLogTab = new QAction( this );
+   act_OpenLogTab->setObjectName( QString::fromUtf8( "act_OpenLogTab" ) );
+   act_OpenLogTab->setIcon( icon_openlog );
+   act_OpenLogTab->setIconVisibleInMenu( true );
+   connect( act_OpenLogTab, SIGNAL( triggered() ), this, SLOT( openLogTabs() ) );
+
+   act_DiffLog = new QAction( this );
+   act_DiffLog->setObjectName( QString::fromUtf8( "act_DiffLog" ) );
+   QIcon icon_difflog;
+   icon_difflog.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/folder_blue.png" ) ) );
+   act_DiffLog->setIcon( icon_difflog );
+   act_DiffLog->setIconVisibleInMenu( true );
+   connect( act_DiffLog, SIGNAL( triggered() ), this, SLOT( openLogDiff() ) );
+
+   act_MergeLogs = new QAction( this );
+   act_MergeLogs->setObjectName( QString::fromUtf8( "act_MergeLogs" ) );
+   QIcon icon_mergelogs;
+   icon_mergelogs.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/folder_green.png" ) ) );
+   act_MergeLogs->setIcon( icon_mergelogs );
+   act_MergeLogs->setIconVisibleInMenu( true );
+   connect( act_MergeLogs, SIGNAL( triggered() ), this, SLOT( openLogMerge() ) );
+
    act_SaveLog = new QAction( this );
    act_SaveLog->setObjectName( QString::fromUtf8( "act_SaveLog" ) );
    QIcon icon_savelog;
@@ -184,6 +213,63 @@ void HelgrindView::setupActions()
    act_SaveLog->setIconVisibleInMenu( true );
    connect( act_SaveLog, SIGNAL( triggered() ), this, SIGNAL( saveLogFile() ) );
 
+   act_ExportLog = new QAction( this );
+   act_ExportLog->setObjectName( QString::fromUtf8( "act_ExportLog" ) );
+   QIcon icon_exportlog;
+   icon_exportlog.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/filesave.png" ) ) );
+   act_ExportLog->setIcon( icon_exportlog );
+   act_ExportLog->setIconVisibleInMenu( true );
+   connect( act_ExportLog, SIGNAL( triggered() ), this, SIGNAL( exportLogFile() ) );
+
+   createSortAction( false );
+   connect( act_SortErrors->menu(), SIGNAL( triggered( QAction* ) ),
+            this,                     SLOT( sortErrors( QAction* ) ) );
+
+   // the current error's threads: filled as the menu opens
+   act_GotoThread = new QAction( this );
+   act_GotoThread->setObjectName( QString::fromUtf8( "act_GotoThread" ) );
+   QIcon icon_gotothread;
+   icon_gotothread.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/arrow_up.png" ) ) );
+   act_GotoThread->setIcon( icon_gotothread );
+   act_GotoThread->setIconVisibleInMenu( true );
+   act_GotoThread->setMenu( new QMenu( this ) );
+   connect( act_GotoThread->menu(), SIGNAL( aboutToShow() ),
+            this,                     SLOT( fillThreadMenu() ) );
+   connect( act_GotoThread->menu(), SIGNAL( triggered( QAction* ) ),
+            this,                     SLOT( gotoAnnounce( QAction* ) ) );
+
+   QMenu* groupMenu = new QMenu( this );
+   for ( int g = 0; g < VG_HG::NUM_GROUPS; ++g ) {
+      QAction* groupAction =
+         groupMenu->addAction( VgHgIndex::groupTitle( ( VG_HG::Group )g ) );
+      groupAction->setData( g );
+   }
+   groupMenu->addSeparator();
+   groupMenu->addAction( tr( "Show all errors" ) )->setData( -1 );
+
+   act_RaceGroup = new QAction( this );
+   act_RaceGroup->setObjectName( QString::fromUtf8( "act_RaceGroup" ) );
+   QIcon icon_racegroup;
+   icon_racegroup.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/filter.png" ) ) );
+   act_RaceGroup->setIcon( icon_racegroup );
+   act_RaceGroup->setIconVisibleInMenu( true );
+   act_RaceGroup->setMenu( groupMenu );
+   connect( groupMenu, SIGNAL( triggered( QAction* ) ),
+            this,        SLOT( showRaceGroup( QAction* ) ) );
+
+   // the log's lock order cycles: filled as the menu opens
+   act_LockCycles = new QAction( this );
+   act_LockCycles->setObjectName( QString::fromUtf8( "act_LockCycles" ) );
+   QIcon icon_lockcycles;
+   icon_lockcycles.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/refresh.png" ) ) );
+   act_LockCycles->setIcon( icon_lockcycles );
+   act_LockCycles->setIconVisibleInMenu( true );
+   act_LockCycles->setMenu( new QMenu( this ) );
+   connect( act_LockCycles->menu(), SIGNAL( aboutToShow() ),
+            this,                     SLOT( fillCycleMenu() ) );
+   connect( act_LockCycles->menu(), SIGNAL( triggered( QAction* ) ),
+            this,                     SLOT( showLockCycle( QAction* ) ) );
+
    // ------------------------------------------------------------
    // initialise actions (enable / disable)
    setState( false );
@@ -193,14 +279,31 @@ void HelgrindView::setupActions()
    act_OpenClose_item->setText(    tr( "Open/Close item" ) );
    act_OpenClose_item->setToolTip( tr( "Open/Close currently selected item" ) );
    act_OpenClose_all->setText(     tr( "Open/Close all" ) );
-   act_OpenClose_all->setToolTip(  tr( "Open/Close all Valgrind::ERROR items" ) );
+   act_OpenClose_all->setToolTip(  tr( "Open/Close all Valgrind::ERROR items (while opening: stop)" ) );
    act_ShowSrcPaths->setText(      tr( "Display simple" ) );
    act_ShowSrcPaths->setToolTip(   tr( "Display complex / simplified view" ) );
 
    act_OpenLog->setText(    tr( "Open Log" ) );
    act_OpenLog->setToolTip( tr( "Open XML log" ) );
+   act_OpenLogTab->setText(    tr( "Open Log in New Tab" ) );
+   act_OpenLogTab->setToolTip( tr( "Open XML logs, each in a tab of its own, "
+                                   "alongside this one" ) );
    act_SaveLog->setText(    tr( "Save Log" ) );
    act_SaveLog->setToolTip( tr( "Save Valgrind output to an XML log" ) );
+   act_ExportLog->setText(    tr( "Export Log" ) );
+   act_ExportLog->setToolTip( tr( "Export the log as JSON Lines, CSV or SARIF" ) );
+   act_DiffLog->setText(    tr( "Compare Log" ) );
+   act_DiffLog->setToolTip( tr( "Compare the current log with a baseline XML log" ) );
+   act_MergeLogs->setText(    tr( "Merge Logs" ) );
+   act_MergeLogs->setToolTip( tr( "Merge several Helgrind XML logs, e.g. one per process" ) );
+   act_GotoThread->setText(    tr( "Go to thread" ) );
+   act_GotoThread->setToolTip( tr( "Go to the announcement of a thread of the current error" ) );
+   act_RaceGroup->setText(    tr( "Races like this" ) );
+   act_RaceGroup->setToolTip( tr( "Show only the races with the current one's address, "
+                                  "locks held or threads" ) );
+   act_LockCycles->setText(    tr( "Lock order cycles" ) );
+   act_LockCycles->setToolTip( tr( "Show only the lock order errors of one cycle: "
+                                   "each a potential deadlock" ) );
 }
 
 
@@ -218,7 +321,25 @@ void HelgrindView::setupToolBar()
    toolToolBar->addAction( act_OpenClose_all );
    toolToolBar->addAction( act_ShowSrcPaths );
    toolToolBar->addAction( act_OpenLog );
+   toolToolBar->addAction( act_OpenLogTab );
    toolToolBar->addAction( act_SaveLog );
+   toolToolBar->addAction( act_ExportLog );
+   toolToolBar->addAction( act_DiffLog );
+   toolToolBar->addAction( act_MergeLogs );
+   toolToolBar->addAction( act_SortErrors );
+   toolToolBar->addAction( act_GotoThread );
+   toolToolBar->addAction( act_RaceGroup );
+   toolToolBar->addAction( act_LockCycles );
+   // the menus at once: the actions themselves do nothing
+   QAction* menuActions[] = { act_SortErrors, act_GotoThread,
+                              act_RaceGroup, act_LockCycles };
+   for ( int i = 0; i < 4; ++i ) {
+      QToolButton* menuButton =
+         qobject_cast<QToolButton*>( toolToolBar->widgetForAction( menuActions[i] ) );
+      if ( menuButton ) {
+         menuButton->setPopupMode( QToolButton::InstantPopup );
+      }
+   }
 
    // ------------------------------------------------------------
    // Menu (created in base class)
@@ -229,7 +350,15 @@ void HelgrindView::setupToolBar()
    toolMenu->addAction( act_OpenClose_all );
    toolMenu->addAction( act_ShowSrcPaths );
    toolMenu->addAction( act_OpenLog );
+   toolMenu->addAction( act_OpenLogTab );
    toolMenu->addAction( act_SaveLog );
+   toolMenu->addAction( act_ExportLog );
+   toolMenu->addAction( act_DiffLog );
+   toolMenu->addAction( act_MergeLogs );
+   toolMenu->addAction( act_SortErrors );
+   toolMenu->addAction( act_GotoThread );
+   toolMenu->addAction( act_RaceGroup );
+   toolMenu->addAction( act_LockCycles );
 }
 
 
@@ -240,27 +369,71 @@ void HelgrindView::setupToolBar()
 void HelgrindView::setState( bool run )
 {
    act_OpenLog->setEnabled( !run );  // just turn off while running
+   act_DiffLog->setEnabled( !run );
+   act_MergeLogs->setEnabled( !run );
 
    if ( run ) {
-      // turn off while running...
-      act_OpenClose_item->setEnabled( false );
-      act_OpenClose_all->setEnabled( false );
-      act_ShowSrcPaths->setEnabled( false );
-      act_SaveLog->setEnabled( false );
-
+      // the run's tab is filled afresh
+      showRunTab();
       this->setCursor( QCursor( Qt::WaitCursor ) );
+      expandAll->cancel();   // before its items go
+      collapsedLru->clear();
       treeView->clear();
+      groupShown = false;
    }
    else {
       unsetCursor();
+   }
+   runActive = run;
+   updateLogActions();
+}
+
 
-      // ... turn on again only if they can be used
-      bool tree_empty = ( treeView->topLevelItemCount() == 0 );
-      act_OpenClose_item->setEnabled( false );       // can't enable before item clicked
-      act_OpenClose_all->setEnabled( !tree_empty );  // enable only if sthng in tree
-      act_ShowSrcPaths->setEnabled( !tree_empty );   // enable only if sthng in tree
-      act_SaveLog->setEnabled( !tree_empty );
+/*!
+  Turn on only what can be used, on the current tab: nothing on the
+  run's tab while running.  Other tabs' logs are files already: not
+  saved or exported.
+*/
+void HelgrindView::updateLogActions()
+{
+   bool onRun = ( currentTab() == runTab() );
+   bool busy = runActive && onRun;
+   bool tree_empty = ( treeView->topLevelItemCount() == 0 );
+   act_OpenClose_all->setEnabled( !busy && !tree_empty );  // enable only if sthng in tree
+   act_ShowSrcPaths->setEnabled( !busy && !tree_empty );   // enable only if sthng in tree
+   act_SaveLog->setEnabled( !busy && !tree_empty && onRun );
+   act_ExportLog->setEnabled( !busy && !tree_empty && onRun );
+   act_LockCycles->setEnabled( !busy && !tree_empty );
+   updateItemActions();
+}
+
+
+/*!
+  Errors hidden for a group or cycle are for the tab we're leaving.
+*/
+void HelgrindView::leaveLogTab()
+{
+   if ( groupShown ) {
+      showAllErrors();
+   }
+}
+
+
+/*!
+  A log is loading, its first screen up: errors may be looked at,
+  opened and sorted meanwhile.  Saving and exporting wait until
+  it's all in: setState( false ).
+*/
+void HelgrindView::loadProgress( qint64, qint64 total )
+{
+   if ( total <= 0 || currentTab() != runTab() ) {
+      return;
    }
+   unsetCursor();
+   bool tree_empty = ( treeView->topLevelItemCount() == 0 );
+   act_OpenClose_all->setEnabled( !tree_empty );
+   act_ShowSrcPaths->setEnabled( !tree_empty );
+   act_LockCycles->setEnabled( !tree_empty );
 }
 
 
@@ -405,14 +578,29 @@ void HelgrindView::showSrcPath()
 }
 
 
+/*!
+  A key picked from the sort menu: errors in the new order, now (in
+  every tab) and in logs to come.
+*/
+void HelgrindView::sortErrors( QAction* keyAction )
+{
+   updateErrorSort( keyAction );
+   sortLogViews();
+}
+
+
 /*!
     Opens all error items, including their children.
     Ignores non-error items (status, preample, etc).
 */
 void HelgrindView::opencloseAllItems()
 {
+   VK_TRACE_SCOPE( VKTRACE::EXPAND_ALL );
    //vkDebug( "HelgrindView::opencloseAllItems()" );
 
+   // still opening all: stop, and as some are open, close them all
+   expandAll->cancel();
+
    if ( treeView->topLevelItemCount() == 0 ) {
       // empty tree.
       return;
@@ -457,13 +645,24 @@ void HelgrindView::opencloseAllItems()
 
    // iterate over the same items, opening or collapsing all.
    // note: only opening/collapsing first-child level, not all levels.
+   //  - opening makes each item's children: leave it to expandAll
+   QList<QTreeWidgetItem*> items;
    for ( int i=idxItemERR; i<vgItemTop->childCount(); ++i ) {
       VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
-      // skip suppressions
-      if ( child->elemType() == VG_ELEM::SUPPCOUNTS ) {
+      // skip suppressions, and errors out of the race group shown
+      if ( child->elemType() == VG_ELEM::SUPPCOUNTS || child->isHidden() ) {
          continue;
       }
-      child->setExpanded( !anItemIsOpen );
+      if ( anItemIsOpen ) {
+         child->setExpanded( false );
+      }
+      else {
+         items.append( child );
+      }
+   }
+
+   if ( !anItemIsOpen ) {
+      expandAll->start( items, expandMemLimit() );
    }
 
 
@@ -509,6 +708,8 @@ void HelgrindView::opencloseOneItem()
 void HelgrindView::itemExpanded( QTreeWidgetItem* item )
 {
    //vkDebug( "HelgrindView::itemExpanded():" );
+   // children dropped while closed are made afresh here
+   collapsedLru->expanded( item );
    ((VgOutputItem*)item)->openChildren();
 }
 
@@ -524,6 +725,10 @@ void HelgrindView::itemCollapsed( QTreeWidgetItem* item )
       // this should be a slot. grr!
       treeView->setCurrentItem( item );
    }
+
+   // its children may go, if closed errors are over budget
+   collapsedLru->setBudget( collapsedMemBudget() );
+   collapsedLru->collapsed( item );
 }
 
 
@@ -543,4 +748,211 @@ void HelgrindView::updateItemActions()
       VgOutputItem* vgItem = (VgOutputItem*)item;
       act_OpenClose_item->setEnabled( vgItem->getIsExpandable() );
    }
+
+   // the current error's threads, and races like it
+   ErrorItem* error = currentError();
+   const VgHgIndex* index = ( logview != 0 ) ?
+      &( ( HelgrindLogView* )logview )->hgIndex() : 0;
+   bool isRace = ( error != 0 && index != 0 && index->isRace( error ) );
+   act_GotoThread->setEnabled( error != 0 && index != 0 &&
+                               !index->threads( error ).isEmpty() );
+   act_RaceGroup->setEnabled( isRace || groupShown );
+   foreach ( QAction* groupAction, act_RaceGroup->menu()->actions() ) {
+      if ( groupAction->data().isValid() && groupAction->data().toInt() != -1 ) {
+         groupAction->setEnabled( isRace );
+      }
+   }
+}
+
+
+/*!
+  The error the current item is in, if any.
+*/
+ErrorItem* HelgrindView::currentError()
+{
+   if ( treeView->topLevelItemCount() == 0 ) {
+      return 0;
+   }
+   QTreeWidgetItem* vgItemTop = treeView->topLevelItem( 0 );
+
+   QTreeWidgetItem* item = treeView->currentItem();
+   while ( item != 0 && item->parent() != vgItemTop ) {
+      item = item->parent();
+   }
+   if ( item == 0 || ( ( VgOutputItem* )item )->elemType() != VG_ELEM::ERROR ) {
+      return 0;
+   }
+   return ( ErrorItem* )item;
+}
+
+
+/*!
+  One entry per thread of the current error: those not announced
+  (yet) can't be gone to.
+*/
+void HelgrindView::fillThreadMenu()
+{
+   QMenu* threadMenu = act_GotoThread->menu();
+   threadMenu->clear();
+
+   ErrorItem* error = currentError();
+   if ( error == 0 || logview == 0 ) {
+      return;
+   }
+   const VgHgIndex& index = ( ( HelgrindLogView* )logview )->hgIndex();
+   foreach ( int tid, index.threads( error ) ) {
+      QAction* threadAction =
+         threadMenu->addAction( QString( "Thread #HG_%1" ).arg( tid ) );
+      threadAction->setData( tid );
+      threadAction->setEnabled( index.announce( tid ) != 0 );
+   }
+}
+
+
+/*!
+  Jump to where Helgrind announced the thread: a lookup, not a search.
+*/
+void HelgrindView::gotoAnnounce( QAction* threadAction )
+{
+   if ( logview == 0 ) {
+      return;
+   }
+   int tid = threadAction->data().toInt();
+   QTreeWidgetItem* announce = ( ( HelgrindLogView* )logview )->hgIndex().announce( tid );
+   if ( announce == 0 ) {
+      return;
+   }
+   treeView->setCurrentItem( announce );
+   treeView->scrollToItem( announce, QAbstractItemView::PositionAtTop );
+}
+
+
+/*!
+  Show only the races in the current one's group.
+*/
+void HelgrindView::showRaceGroup( QAction* groupAction )
+{
+   if ( groupAction->data().toInt() == -1 ) {
+      showAllErrors();
+      emit message( "Showing all errors" );
+      return;
+   }
+
+   ErrorItem* error = currentError();
+   if ( error == 0 || logview == 0 ) {
+      return;
+   }
+   const VgHgIndex& index = ( ( HelgrindLogView* )logview )->hgIndex();
+   VG_HG::Group g = ( VG_HG::Group )groupAction->data().toInt();
+   QSet<QTreeWidgetItem*> inGroup = index.group( g, error ).toSet();
+   if ( inGroup.isEmpty() ) {
+      return;
+   }
+
+   showOnlyErrors( inGroup );
+   treeView->scrollToItem( error );
+   emit message( QString( "Showing %1 races with %2 (of %3 such groups)" )
+                 .arg( inGroup.count() ).arg( index.groupName( g, error ) )
+                 .arg( index.groupCount( g ) ) );
+}
+
+
+/*!
+  The cycles with most errors first: a big log's thousands of
+  LockOrder errors come down to a few entries here.
+*/
+void HelgrindView::fillCycleMenu()
+{
+   static const int maxCycles = 30;
+
+   QMenu* cycleMenu = act_LockCycles->menu();
+   cycleMenu->clear();
+   lockCycles.clear();
+   if ( logview != 0 ) {
+      lockCycles = ( ( HelgrindLogView* )logview )->lockGraph().cycles();
+   }
+
+   if ( lockCycles.isEmpty() ) {
+      cycleMenu->addAction( tr( "No lock order cycles" ) )->setEnabled( false );
+   }
+   for ( int i = 0; i < lockCycles.count() && i < maxCycles; ++i ) {
+      const VgLockGraph::Cycle& cycle = lockCycles.at( i );
+      QStringList locks;
+      foreach ( quint64 lock, cycle.locks ) {
+         locks << "0x" + QString::number( lock, 16 );
+      }
+      QAction* cycleAction = cycleMenu->addAction(
+         QString( "Locks %1: %2 errors" ).arg( locks.join( ", " ) )
+                                         .arg( cycle.errors.count() ) );
+      cycleAction->setData( i );
+   }
+   if ( lockCycles.count() > maxCycles ) {
+      cycleMenu->addAction( QString( "... %1 more" )
+                            .arg( lockCycles.count() - maxCycles ) )->setEnabled( false );
+   }
+   if ( groupShown ) {
+      cycleMenu->addSeparator();
+      cycleMenu->addAction( tr( "Show all errors" ) )->setData( -1 );
+   }
+}
+
+
+void HelgrindView::showLockCycle( QAction* cycleAction )
+{
+   int i = cycleAction->data().toInt();
+   if ( i == -1 ) {
+      showAllErrors();
+      emit message( "Showing all errors" );
+      return;
+   }
+   if ( i < 0 || i >= lockCycles.count() ) {
+      return;
+   }
+
+   const VgLockGraph::Cycle& cycle = lockCycles.at( i );
+   showOnlyErrors( cycle.errors.toSet() );
+   treeView->setCurrentItem( cycle.errors.first() );
+   treeView->scrollToItem( cycle.errors.first(), QAbstractItemView::PositionAtTop );
+   emit message( QString( "Showing the %1 errors of a cycle of %2 locks "
+                          "(of %3 cycles)" ).arg( cycle.errors.count() )
+                 .arg( cycle.locks.count() ).arg( lockCycles.count() ) );
+}
+
+
+/*!
+  Hide the errors not given: hidden, not taken, so showAllErrors()
+  puts them straight back.
+*/
+void HelgrindView::showOnlyErrors( const QSet<QTreeWidgetItem*>& shown )
+{
+   if ( treeView->topLevelItemCount() == 0 ) {
+      return;
+   }
+   QTreeWidgetItem* vgItemTop = treeView->topLevelItem( 0 );
+   for ( int i = 0; i < vgItemTop->childCount(); ++i ) {
+      VgOutputItem* child = ( VgOutputItem* )vgItemTop->child( i );
+      if ( child->elemType() == VG_ELEM::ERROR ) {
+         child->setHidden( !shown.contains( child ) );
+      }
+   }
+   groupShown = true;
+   updateItemActions();
+}
+
+
+void HelgrindView::showAllErrors()
+{
+   if ( treeView->topLevelItemCount() != 0 ) {
+      QTreeWidgetItem* vgItemTop = treeView->topLevelItem( 0 );
+      for ( int i = 0; i < vgItemTop->childCount(); ++i ) {
+         vgItemTop->child( i )->setHidden( false );
+      }
+   }
+   groupShown = false;
+   updateItemActions();
+
+   QTreeWidgetItem* item = treeView->currentItem();
+   if ( item != 0 ) {
+      treeView->scrollToItem( item );
+   }
 }
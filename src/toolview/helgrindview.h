@@ -22,9 +22,11 @@
 #define __HELGRINDVIEW_H
 
 #include "toolview/toolview.h"
+#include "toolview/vglockgraph.h"
 #include "toolview/vglogview.h"
 
 #include <QMenu>
+#include <QSet>
 #include <QTreeWidget>
 #include <QToolButton>
 
@@ -36,16 +38,20 @@ class HelgrindView : public ToolView
 public:
    HelgrindView( QWidget* parent );
    ~HelgrindView();
-   
-   VgLogView* createVgLogView();
 
 public slots:
    virtual void setState( bool run );
+   virtual void loadProgress( qint64 done, qint64 total );
 
 private:
    void setupLayout();
    void setupActions();
    void setupToolBar();
+   QTreeWidget* createLogTree();
+   void connectLogTree( QTreeWidget* tree );
+   VgLogView* newLogView( QTreeWidget* tree );
+   void updateLogActions();
+   void leaveLogTab();
 
 private slots:
    void opencloseAllItems();
@@ -54,17 +60,35 @@ private slots:
    void launchEditor( QTreeWidgetItem* item );
    void itemExpanded( QTreeWidgetItem* item );
    void itemCollapsed( QTreeWidgetItem* item );
+   void sortErrors( QAction* keyAction );
+   void fillThreadMenu();
+   void gotoAnnounce( QAction* threadAction );
+   void showRaceGroup( QAction* groupAction );
+   void fillCycleMenu();
+   void showLockCycle( QAction* cycleAction );
    void updateItemActions();
 
+private:
+   ErrorItem* currentError();
+   void showOnlyErrors( const QSet<QTreeWidgetItem*>& shown );
+   void showAllErrors();
+
 private:
    QAction* act_OpenClose_all;
    QAction* act_OpenClose_item;
    QAction* act_ShowSrcPaths;
    QAction* act_OpenLog;
+   QAction* act_OpenLogTab;
    QAction* act_SaveLog;
+   QAction* act_ExportLog;
+   QAction* act_DiffLog;
+   QAction* act_MergeLogs;
+   QAction* act_GotoThread;
+   QAction* act_RaceGroup;
+   QAction* act_LockCycles;
 
-   QTreeWidget* treeView;
-   VgLogView*   logview;
+   bool         groupShown;   // some errors hidden by showOnlyErrors()
+   QList<VgLockGraph::Cycle> lockCycles;   // as last listed
 };
 
 #endif // __HELGRINDVIEW_H
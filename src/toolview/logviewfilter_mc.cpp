@@ -18,6 +18,7 @@
 ****************************************************************************/
 
 #include "toolview/logviewfilter_mc.h"
+#include "utils/vk_trace.h"
 #include "utils/vk_utils.h"
 
 #include <QAction>
@@ -191,6 +192,7 @@ void LogViewFilterMC::refresh()
 
 void LogViewFilterMC::updateView()
 {
+   VK_TRACE_SCOPE( VKTRACE::FILTER_REFRESH );
 //   vkDebug( "LogViewFilterMC::updateView()" );
 
    if ( m_view == NULL ) {
@@ -311,6 +313,14 @@ void LogViewFilterMC::showHideItem( VgOutputItem* item )
 }
 
 
+/* another tree (e.g. another log's tab): filter that one now */
+void LogViewFilterMC::setView( QTreeWidget* view )
+{
+   m_view = view;
+   updateView();
+}
+
+
 void LogViewFilterMC::enableFilter( bool enable )
 {
    if ( enable )
@@ -35,6 +35,8 @@ class LogViewFilterMC : public QWidget
 public:
     LogViewFilterMC(QWidget *parent, QTreeWidget* view );
 
+    void setView( QTreeWidget* view );
+
 public slots:
     void showHideItem( VgOutputItem* item );
     void enableFilter( bool enable );
@@ -107,7 +107,11 @@ void TopStatusItemMC::updateToolStatus( QDomElement err )
             - if this is 'record 1' then reset counters
          */
          QDomElement text = xwhat.firstChildElement( "text" );
-         if ( ! text.isNull() ) {
+         if ( !err.firstChildElement( "pidcounts" ).isNull() ) {
+            // merged logs: leaks already totalled over the last leak
+            // check of each process, so never reset.
+         }
+         else if ( ! text.isNull() ) {
             QString text_str = text.text();
             QString lossrec_str = text_str.mid( text_str.indexOf( "in loss record " ) );
 
@@ -182,7 +186,11 @@ bool MemcheckLogView::appendNodeTool( QDomElement elem, QString& errMsg )
 
    case VG_ELEM::ERROR: {
       QDomElement err = elem;
-      lastItem = new ErrorItemMC( topStatus, lastItem, err );
+      // no parent yet: put in (sort) order by addErrorItem()
+      ErrorItem* errItem = new ErrorItemMC( 0, 0, err );
+      addErrorItem( errItem );
+      heapIdx.addError( errItem, err );
+      lastItem = errItem;
 
 // TODO: 
 //      flicker a problem?
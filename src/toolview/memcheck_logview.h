@@ -21,6 +21,7 @@
 #ifndef __VK_MEMCHECKLOGVIEW_H
 #define __VK_MEMCHECKLOGVIEW_H
 
+#include "toolview/vgheapindex.h"
 #include "toolview/vglogview.h"
 
 
@@ -31,6 +32,11 @@ class MemcheckLogView : public VgLogView
 public:
    MemcheckLogView( QTreeWidget* );
    ~MemcheckLogView();
+
+   // errors by heap block and allocation site, as read so far
+   const VgHeapIndex& heapIndex() const {
+      return heapIdx;
+   }
    
 signals:
    void errorItemAdded( VgOutputItem* item );
@@ -41,6 +47,9 @@ private:
                                    QDomElement status, QString _protocol );
    QString toolName();
    bool appendNodeTool( QDomElement elem, QString& errMsg );
+
+private:
+   VgHeapIndex heapIdx;
 };
 
 
@@ -28,12 +28,14 @@
 #include "toolview/memcheck_logview.h"
 #include "utils/vk_config.h"
 #include "utils/vk_messages.h"
+#include "utils/vk_trace.h"
 #include "utils/vk_utils.h"
 
 #include <QAction>
 #include <QApplication>
 #include <QClipboard>
 #include <QHeaderView>
+#include <QInputDialog>
 #include <QLabel>
 #include <QMenuBar>
 #include <QProcess>
@@ -64,69 +66,84 @@
     Constructs a MemcheckView with the given \a parent.
 */
 MemcheckView::MemcheckView( QWidget* parent )
-   : ToolView( parent, VGTOOL::ID_MEMCHECK ), logview(0)
+   : ToolView( parent, VGTOOL::ID_MEMCHECK ), heapShown( false )
 {
    setObjectName( QString::fromUtf8( "MemcheckView" ) );
 
    setupLayout();
    setupActions();
    setupToolBar();
+}
 
-   // enable | disable show*Item buttons
-   connect( treeView, SIGNAL( itemSelectionChanged() ),
-            this,       SLOT( updateItemActions() ) );
 
-   // on collapsing a branch, reset currentItem to branch head.
-   connect( treeView, SIGNAL( itemCollapsed( QTreeWidgetItem* ) ),
-            this,       SLOT( itemCollapsed( QTreeWidgetItem* ) ) );
+/*!
+    Destroys this widget, and frees any allocated resources.
+    The tabs' logs go with the base class.
+*/
+MemcheckView::~MemcheckView()
+{
+}
 
-   // load items on-demand
-   connect( treeView, SIGNAL( itemExpanded( QTreeWidgetItem* ) ),
-            this,       SLOT( itemExpanded( QTreeWidgetItem* ) ) );
 
-   // launch editor with src file loaded
-   connect( treeView, SIGNAL( itemDoubleClicked( QTreeWidgetItem*, int ) ),
-            this,       SLOT( launchEditor( QTreeWidgetItem* ) ) );
+/*!
+    A tab's tree.
+*/
+QTreeWidget* MemcheckView::createLogTree()
+{
+   QTreeWidget* tree = new QTreeWidget( this );
+   tree->setObjectName( QString::fromUtf8( "treeview_Memcheck" ) );
+   tree->setHeaderHidden( true );
+   tree->setRootIsDecorated( false );
+   // several errors may be selected, to generate suppressions for
+   tree->setSelectionMode( QAbstractItemView::ExtendedSelection );
 
-   treeView->setContextMenuPolicy( Qt::CustomContextMenu );
-   connect( treeView, SIGNAL( customContextMenuRequested( const QPoint& ) ),
-            this,       SLOT( popupMenu( const QPoint& ) ) );
+   // give us a horizontal scrollbar rather than an ellipsis
+   tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+   tree->header()->setStretchLastSection(false);
+   return tree;
 }
 
 
 /*!
-    Destroys this widget, and frees any allocated resources.
+    Connect a tab's tree to our slots: these work on the current tab's.
 */
-MemcheckView::~MemcheckView()
+void MemcheckView::connectLogTree( QTreeWidget* tree )
 {
-   if ( logview != 0 ) {
-      delete logview;
-      logview = 0;
-   }
+   // enable | disable show*Item buttons
+   connect( tree, SIGNAL( itemSelectionChanged() ),
+            this,   SLOT( updateItemActions() ) );
+
+   // on collapsing a branch, reset currentItem to branch head.
+   connect( tree, SIGNAL( itemCollapsed( QTreeWidgetItem* ) ),
+            this,   SLOT( itemCollapsed( QTreeWidgetItem* ) ) );
+
+   // load items on-demand
+   connect( tree, SIGNAL( itemExpanded( QTreeWidgetItem* ) ),
+            this,   SLOT( itemExpanded( QTreeWidgetItem* ) ) );
+
+   // launch editor with src file loaded
+   connect( tree, SIGNAL( itemDoubleClicked( QTreeWidgetItem*, int ) ),
+            this,   SLOT( launchEditor( QTreeWidgetItem* ) ) );
+
+   tree->setContextMenuPolicy( Qt::CustomContextMenu );
+   connect( tree, SIGNAL( customContextMenuRequested( const QPoint& ) ),
+            this,   SLOT( popupMenu( const QPoint& ) ) );
 }
 
 
 /*!
-   Provide the tool-object access to our model, to fill it,
-   but keep ownership ourselves: we know when we're done with it.
-
-   Creates a clean log on each call.
-   This should be called by the tool-object just before it intends
-   to fill the log.
+    A clean log on the given tree, for the run's tab or another.
 */
-VgLogView* MemcheckView::createVgLogView()
+VgLogView* MemcheckView::newLogView( QTreeWidget* tree )
 {
-   if ( logview != 0 ) {
-      delete logview;
-   }
-
-   logview = new MemcheckLogView( treeView );
+   VgLogView* lv = new MemcheckLogView( tree );
+   lv->sortErrors( errorSortSpec );
 
    // let filter show/hide an item
-   connect( logview, SIGNAL(errorItemAdded(VgOutputItem*)),
+   connect( lv, SIGNAL(errorItemAdded(VgOutputItem*)),
             logviewFilter, SLOT(showHideItem(VgOutputItem*)) );
 
-   return logview;
+   return lv;
 }
 
 
@@ -139,21 +156,15 @@ void MemcheckView::setupLayout()
    QVBoxLayout* vLayout = new QVBoxLayout( this );
    vLayout->setMargin(0);
 
-   treeView = new QTreeWidget( this );
-   treeView->setObjectName( QString::fromUtf8( "treeview_Memcheck" ) );
-   treeView->setHeaderHidden( true );
-   treeView->setRootIsDecorated( false );
-
-   // give us a horizontal scrollbar rather than an ellipsis
-   treeView->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
-   treeView->header()->setStretchLastSection(false);
+   // the run's tab, and logs opened alongside
+   QWidget* logTabs = createLogTabs();
 
-   // filter
+   // filter: of the current tab
    logviewFilter = new LogViewFilterMC( this, treeView );
 
    // layout
    vLayout->addWidget( logviewFilter );
-   vLayout->addWidget( treeView );
+   vLayout->addWidget( logTabs );
 }
 
 
@@ -198,6 +209,28 @@ void MemcheckView::setupActions()
    act_OpenLog->setIconVisibleInMenu( true );
    connect( act_OpenLog, SIGNAL( triggered() ), this, SLOT( openLogFile() ) );
 
+   act_OpenLogTab = new QAction( this );
+   act_OpenLogTab->setObjectName( QString::fromUtf8( "act_OpenLogTab" ) );
+   act_OpenLogTab->setIcon( icon_openlog );
+   act_OpenLogTab->setIconVisibleInMenu( true );
+   connect( act_OpenLogTab, SIGNAL( triggered() ), this, SLOT( openLogTabs() ) );
+
+   act_DiffLog = new QAction( this );
+   act_DiffLog->setObjectName( QString::fromUtf8( "act_DiffLog" ) );
+   QIcon icon_difflog;
+   icon_difflog.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/folder_blue.png" ) ) );
+   act_DiffLog->setIcon( icon_difflog );
+   act_DiffLog->setIconVisibleInMenu( true );
+   connect( act_DiffLog, SIGNAL( triggered() ), this, SLOT( openLogDiff() ) );
+
+   act_MergeLogs = new QAction( this );
+   act_MergeLogs->setObjectName( QString::fromUtf8( "act_MergeLogs" ) );
+   QIcon icon_mergelogs;
+   icon_mergelogs.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/folder_green.png" ) ) );
+   act_MergeLogs->setIcon( icon_mergelogs );
+   act_MergeLogs->setIconVisibleInMenu( true );
+   connect( act_MergeLogs, SIGNAL( triggered() ), this, SLOT( openLogMerge() ) );
+
    act_SaveLog = new QAction( this );
    act_SaveLog->setObjectName( QString::fromUtf8( "act_SaveLog" ) );
    QIcon icon_savelog;
@@ -206,6 +239,14 @@ void MemcheckView::setupActions()
    act_SaveLog->setIconVisibleInMenu( true );
    connect( act_SaveLog, SIGNAL( triggered() ), this, SIGNAL( saveLogFile() ) );
 
+   act_ExportLog = new QAction( this );
+   act_ExportLog->setObjectName( QString::fromUtf8( "act_ExportLog" ) );
+   QIcon icon_exportlog;
+   icon_exportlog.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/filesave.png" ) ) );
+   act_ExportLog->setIcon( icon_exportlog );
+   act_ExportLog->setIconVisibleInMenu( true );
+   connect( act_ExportLog, SIGNAL( triggered() ), this, SIGNAL( exportLogFile() ) );
+
    act_enableFilter = new QAction( this );
    act_enableFilter->setObjectName( QString::fromUtf8( "act_enableFilter" ) );
    QIcon icon_filter;
@@ -220,6 +261,23 @@ void MemcheckView::setupActions()
    connect( act_enableFilter, SIGNAL(toggled(bool)),
             logviewFilter, SLOT(enableFilter(bool)) );
 
+   createSortAction( true );
+   connect( act_SortErrors->menu(), SIGNAL( triggered( QAction* ) ),
+            this,                     SLOT( sortErrors( QAction* ) ) );
+
+   // errors by heap block: filled as the menu opens
+   act_HeapBlocks = new QAction( this );
+   act_HeapBlocks->setObjectName( QString::fromUtf8( "act_HeapBlocks" ) );
+   QIcon icon_heapblocks;
+   icon_heapblocks.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/gear.png" ) ) );
+   act_HeapBlocks->setIcon( icon_heapblocks );
+   act_HeapBlocks->setIconVisibleInMenu( true );
+   act_HeapBlocks->setMenu( new QMenu( this ) );
+   connect( act_HeapBlocks->menu(), SIGNAL( aboutToShow() ),
+            this,                     SLOT( fillHeapMenu() ) );
+   connect( act_HeapBlocks->menu(), SIGNAL( triggered( QAction* ) ),
+            this,                     SLOT( showHeapErrors( QAction* ) ) );
+
    // ------------------------------------------------------------
    // initialise actions (enable / disable)
    setState( false );
@@ -229,17 +287,29 @@ void MemcheckView::setupActions()
    act_OpenClose_item->setText(    tr( "Open/Close item" ) );
    act_OpenClose_item->setToolTip( tr( "Open/Close currently selected item" ) );
    act_OpenClose_all->setText(     tr( "Open/Close all" ) );
-   act_OpenClose_all->setToolTip(  tr( "Open/Close all Valgrind::ERROR items" ) );
+   act_OpenClose_all->setToolTip(  tr( "Open/Close all Valgrind::ERROR items (while opening: stop)" ) );
    act_ShowSrcPaths->setText(      tr( "Display simple" ) );
    act_ShowSrcPaths->setToolTip(   tr( "Display short / full source paths" ) );
 
    act_OpenLog->setText(    tr( "Open Log" ) );
    act_OpenLog->setToolTip( tr( "Open Memcheck XML log" ) );
+   act_OpenLogTab->setText(    tr( "Open Log in New Tab" ) );
+   act_OpenLogTab->setToolTip( tr( "Open Memcheck XML logs, each in a tab of its own, "
+                                   "alongside this one" ) );
    act_SaveLog->setText(    tr( "Save Log" ) );
    act_SaveLog->setToolTip( tr( "Save Valgrind output to an XML log" ) );
+   act_ExportLog->setText(    tr( "Export Log" ) );
+   act_ExportLog->setToolTip( tr( "Export the log as JSON Lines, CSV or SARIF" ) );
+   act_DiffLog->setText(    tr( "Compare Log" ) );
+   act_DiffLog->setToolTip( tr( "Compare the current log with a baseline XML log" ) );
+   act_MergeLogs->setText(    tr( "Merge Logs" ) );
+   act_MergeLogs->setToolTip( tr( "Merge several Memcheck XML logs, e.g. one per process" ) );
 
    act_enableFilter->setText( tr( "Filters on/off" ) );
    act_enableFilter->setToolTip( tr( "Enable or disable the temporary log filters." ) );
+   act_HeapBlocks->setText(    tr( "Heap blocks" ) );
+   act_HeapBlocks->setToolTip( tr( "Show only the errors on one heap block, "
+                                   "or from one allocation site" ) );
 
 }
 
@@ -258,8 +328,23 @@ void MemcheckView::setupToolBar()
    toolToolBar->addAction( act_OpenClose_all );
    toolToolBar->addAction( act_ShowSrcPaths );
    toolToolBar->addAction( act_OpenLog );
+   toolToolBar->addAction( act_OpenLogTab );
    toolToolBar->addAction( act_SaveLog );
+   toolToolBar->addAction( act_ExportLog );
+   toolToolBar->addAction( act_DiffLog );
+   toolToolBar->addAction( act_MergeLogs );
    toolToolBar->addAction( act_enableFilter );
+   toolToolBar->addAction( act_SortErrors );
+   toolToolBar->addAction( act_HeapBlocks );
+   // the menus at once: the actions themselves do nothing
+   QAction* menuActions[] = { act_SortErrors, act_HeapBlocks };
+   for ( int i = 0; i < 2; ++i ) {
+      QToolButton* menuButton =
+         qobject_cast<QToolButton*>( toolToolBar->widgetForAction( menuActions[i] ) );
+      if ( menuButton ) {
+         menuButton->setPopupMode( QToolButton::InstantPopup );
+      }
+   }
 
    // ------------------------------------------------------------
    // Memcheck menu (created in base class)
@@ -270,8 +355,14 @@ void MemcheckView::setupToolBar()
    toolMenu->addAction( act_OpenClose_all );
    toolMenu->addAction( act_ShowSrcPaths );
    toolMenu->addAction( act_OpenLog );
+   toolMenu->addAction( act_OpenLogTab );
    toolMenu->addAction( act_SaveLog );
+   toolMenu->addAction( act_ExportLog );
+   toolMenu->addAction( act_DiffLog );
+   toolMenu->addAction( act_MergeLogs );
    toolMenu->addAction( act_enableFilter );
+   toolMenu->addAction( act_SortErrors );
+   toolMenu->addAction( act_HeapBlocks );
 }
 
 
@@ -284,27 +375,80 @@ void MemcheckView::setState( bool run )
    //vkDebug( "MemcheckView::setState( %d )", run );
 
    act_OpenLog->setEnabled( !run );  // just turn off while running
+   act_DiffLog->setEnabled( !run );
+   act_MergeLogs->setEnabled( !run );
 
    if ( run ) {
-      // turn off while running...
-      act_OpenClose_item->setEnabled( false );
-      act_OpenClose_all->setEnabled( false );
-      act_ShowSrcPaths->setEnabled( false );
-      act_SaveLog->setEnabled( false );
-
+      // the run's tab is filled afresh
+      showRunTab();
       this->setCursor( QCursor( Qt::WaitCursor ) );
+      expandAll->cancel();   // before its items go
+      collapsedLru->clear();
       treeView->clear();
+      heapShown = false;
    }
    else {
       unsetCursor();
+   }
+   runActive = run;
+   updateLogActions();
+}
+
 
-      // ... turn on again only if they can be used
-      bool tree_empty = ( treeView->topLevelItemCount() == 0 );
-      act_OpenClose_item->setEnabled( false );       // can't enable before item clicked
-      act_OpenClose_all->setEnabled( !tree_empty );  // enable only if sthng in tree
-      act_ShowSrcPaths->setEnabled( !tree_empty );   // enable only if sthng in tree
-      act_SaveLog->setEnabled( !tree_empty );
+/*!
+  Turn on only what can be used, on the current tab: nothing on the
+  run's tab while running.  Other tabs' logs are files already: not
+  saved or exported.
+*/
+void MemcheckView::updateLogActions()
+{
+   bool onRun = ( currentTab() == runTab() );
+   bool busy = runActive && onRun;
+   bool tree_empty = ( treeView->topLevelItemCount() == 0 );
+   act_OpenClose_all->setEnabled( !busy && !tree_empty );  // enable only if sthng in tree
+   act_ShowSrcPaths->setEnabled( !busy && !tree_empty );   // enable only if sthng in tree
+   act_SaveLog->setEnabled( !busy && !tree_empty && onRun );
+   act_ExportLog->setEnabled( !busy && !tree_empty && onRun );
+   act_HeapBlocks->setEnabled( !busy && !tree_empty );
+   updateItemActions();
+}
+
+
+/*!
+  Errors hidden for a heap block are for the tab we're leaving.
+*/
+void MemcheckView::leaveLogTab()
+{
+   heapShown = false;
+}
+
+
+/*!
+  The filters apply to the tab on show: re-applied to it, which also
+  brings back errors hidden for a heap block.
+*/
+void MemcheckView::logTabShown()
+{
+   logviewFilter->setView( treeView );
+   ToolView::logTabShown();
+}
+
+
+/*!
+  A log is loading, its first screen up: errors may be looked at,
+  opened and sorted meanwhile.  Saving and exporting wait until
+  it's all in: setState( false ).
+*/
+void MemcheckView::loadProgress( qint64, qint64 total )
+{
+   if ( total <= 0 || currentTab() != runTab() ) {
+      return;
    }
+   unsetCursor();
+   bool tree_empty = ( treeView->topLevelItemCount() == 0 );
+   act_OpenClose_all->setEnabled( !tree_empty );
+   act_ShowSrcPaths->setEnabled( !tree_empty );
+   act_HeapBlocks->setEnabled( !tree_empty );
 }
 
 
@@ -421,12 +565,27 @@ void MemcheckView::popupMenu( const QPoint& pos )
    if ( ( item->elemType() != VG_ELEM::ERROR ) )
       actSuppr.setEnabled( false );
 
+   // many errors -> a minimal set of suppressions
+   QList<ErrorItem*> selErrors;
+   foreach ( QTreeWidgetItem* sel, treeView->selectedItems() ) {
+      if ( ((VgOutputItem*)sel)->elemType() == VG_ELEM::ERROR )
+         selErrors.append( (ErrorItem*)sel );
+   }
+   QAction actSupprSel( "Generate suppressions: selected errors", this );
+   actSupprSel.setEnabled( selErrors.count() > 1 );
+   QAction actSupprKind( "Generate suppressions: all errors of this kind", this );
+   actSupprKind.setEnabled( actSuppr.isEnabled() );
+   QAction actSupprAll( "Generate suppressions: all errors", this );
+
    // the menu
    QMenu menu( treeView );
    menu.addAction( &actTitle );   // title: no action
    menu.addAction( &actCopyTxt ); // plain text of node tree -> clipboard
    menu.addAction( &actCopyXML ); // xml of node tree -> clipboard
    menu.addAction( &actSuppr );
+   menu.addAction( &actSupprSel );
+   menu.addAction( &actSupprKind );
+   menu.addAction( &actSupprAll );
 
    // popup
    QAction* act = menu.exec( treeView->mapToGlobal( pos ) );
@@ -443,32 +602,83 @@ void MemcheckView::popupMenu( const QPoint& pos )
       clipboard->setText( xml );
    }
    else if ( act == &actSuppr ) {
-      // get suppression from ErrorItem
-      QString str_supp = ((ErrorItem*)item)->getSuppressionStr();
-
-      if ( str_supp.isEmpty() ) {
-         vkPrintErr("No suppression found for this Error");
-         vkInfo( this, "No suppression could be found for this Error.",
-                 "Please check (via Options->Valgrind->Error Reporting)<br>"
-                 "that the option \"Print suppressions for errors\"<br/>"
-                 "is set to \"all\".");
-      }
-      else {
-         // Send gathered supp to Options->Supp Editor
-         // NOTE: Assuming first supp_file in list is our default
-         // TODO:  - document that!
-
-         // TODO: this is just nasty. What's an elegant solution?
-         VkOptionsDialog optionsDlg( (MainWindow*)this->parent()->parent()->parent() );
-         ValgrindOptionsPage* pg = (ValgrindOptionsPage*)optionsDlg.setCurrentPage( 1 );
-         pg->setCurrentTab( 2 );
-         pg->suppNewFromStr( str_supp );
-         optionsDlg.exec();
-      }
+      suppsToEditor( QList<ErrorItem*>() << (ErrorItem*)item );
+   }
+   else if ( act == &actSupprSel ) {
+      suppsToEditor( selErrors );
+   }
+   else if ( act == &actSupprKind ) {
+      QString kind = item->getElement().firstChildElement( "kind" ).text();
+      suppsToEditor( errorItems( kind ) );
+   }
+   else if ( act == &actSupprAll ) {
+      suppsToEditor( errorItems() );
    }
 }
 
 
+/*!
+  All (unfiltered) error items, of the given kind if not empty.
+*/
+QList<ErrorItem*> MemcheckView::errorItems( const QString& kind )
+{
+   QList<ErrorItem*> errors;
+   if ( treeView->topLevelItemCount() == 0 ) {
+      return errors;
+   }
+
+   VgOutputItem* vgItemTop = (VgOutputItem*)treeView->topLevelItem( 0 );
+   for ( int i=0; i<vgItemTop->childCount(); ++i ) {
+      VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
+      if ( child->elemType() != VG_ELEM::ERROR || child->isHidden() )
+         continue;
+      if ( !kind.isEmpty() &&
+           child->getElement().firstChildElement( "kind" ).text() != kind )
+         continue;
+      errors.append( (ErrorItem*)child );
+   }
+   return errors;
+}
+
+
+/*!
+  Send the suppressions of the given errors to Options->Supp Editor:
+   - one error: its suppression, to edit
+   - many: synthesised into a minimal set of suppressions
+*/
+void MemcheckView::suppsToEditor( const QList<ErrorItem*>& errors )
+{
+   QStringList supps;
+   foreach ( ErrorItem* error, errors ) {
+      QString str_supp = error->getSuppressionStr();
+      if ( !str_supp.isEmpty() )
+         supps << str_supp;
+   }
+
+   if ( supps.isEmpty() ) {
+      vkPrintErr("No suppression found for this Error");
+      vkInfo( this, "No suppression could be found for this Error.",
+              "Please check (via Options->Valgrind->Error Reporting)<br>"
+              "that the option \"Print suppressions for errors\"<br/>"
+              "is set to \"all\".");
+      return;
+   }
+
+   // NOTE: Assuming first supp_file in list is our default
+   // TODO:  - document that!
+
+   // TODO: this is just nasty. What's an elegant solution?
+   VkOptionsDialog optionsDlg( (MainWindow*)this->parent()->parent()->parent() );
+   ValgrindOptionsPage* pg = (ValgrindOptionsPage*)optionsDlg.setCurrentPage( 1 );
+   pg->setCurrentTab( 2 );
+   if ( errors.count() == 1 )
+      pg->suppNewFromStr( supps.first() );
+   else
+      pg->suppsNewFromStrs( supps );
+   optionsDlg.exec();
+}
+
+
 /*!
     Shows/Hides the file paths for all frames under current item.
 */
@@ -519,14 +729,29 @@ void MemcheckView::showSrcPath()
 }
 
 
+/*!
+  A key picked from the sort menu: errors in the new order, now (in
+  every tab) and in logs to come.
+*/
+void MemcheckView::sortErrors( QAction* keyAction )
+{
+   updateErrorSort( keyAction );
+   sortLogViews();
+}
+
+
 /*!
     Opens all error items, including their children.
     Ignores non-error items (status, preample, etc).
 */
 void MemcheckView::opencloseAllItems()
 {
+   VK_TRACE_SCOPE( VKTRACE::EXPAND_ALL );
    //vkDebug( "MemcheckView::opencloseAllItems()" );
 
+   // still opening all: stop, and as some are open, close them all
+   expandAll->cancel();
+
    if ( treeView->topLevelItemCount() == 0 ) {
       // empty tree.
       return;
@@ -571,13 +796,24 @@ void MemcheckView::opencloseAllItems()
 
    // iterate over the same items, opening or collapsing all.
    // note: only opening/collapsing first-child level, not all levels.
+   //  - opening makes each item's children: leave it to expandAll
+   QList<QTreeWidgetItem*> items;
    for ( int i=idxItemERR; i<vgItemTop->childCount(); ++i ) {
       VgOutputItem* child = (VgOutputItem*)vgItemTop->child( i );
       // skip suppressions
       if ( child->elemType() == VG_ELEM::SUPPCOUNTS ) {
          continue;
       }
-      child->setExpanded( !anItemIsOpen );
+      if ( anItemIsOpen ) {
+         child->setExpanded( false );
+      }
+      else {
+         items.append( child );
+      }
+   }
+
+   if ( !anItemIsOpen ) {
+      expandAll->start( items, expandMemLimit() );
    }
 
 
@@ -622,6 +858,8 @@ void MemcheckView::opencloseOneItem()
 void MemcheckView::itemExpanded( QTreeWidgetItem* item )
 {
    //vkDebug( "MemcheckView::itemExpanded():" );
+   // children dropped while closed are made afresh here
+   collapsedLru->expanded( item );
    ((VgOutputItem*)item)->openChildren();
 }
 
@@ -637,6 +875,10 @@ void MemcheckView::itemCollapsed( QTreeWidgetItem* item )
       // this should be a slot. grr!
       treeView->setCurrentItem( item );
    }
+
+   // its children may go, if closed errors are over budget
+   collapsedLru->setBudget( collapsedMemBudget() );
+   collapsedLru->collapsed( item );
 }
 
 
@@ -657,3 +899,166 @@ void MemcheckView::updateItemActions()
       act_OpenClose_item->setEnabled( vgItem->getIsExpandable() );
    }
 }
+
+
+/*!
+  The error the current item is in, if any.
+*/
+ErrorItem* MemcheckView::currentError()
+{
+   if ( treeView->topLevelItemCount() == 0 ) {
+      return 0;
+   }
+   QTreeWidgetItem* vgItemTop = treeView->topLevelItem( 0 );
+
+   QTreeWidgetItem* item = treeView->currentItem();
+   while ( item != 0 && item->parent() != vgItemTop ) {
+      item = item->parent();
+   }
+   if ( item == 0 || ( ( VgOutputItem* )item )->elemType() != VG_ELEM::ERROR ) {
+      return 0;
+   }
+   return ( ErrorItem* )item;
+}
+
+
+// heap menu entries, besides the blocks themselves (>= 0)
+static const int heapShowAll   = -1;
+static const int heapSameBlock = -2;
+static const int heapSameSite  = -3;
+static const int heapAtAddress = -4;
+
+// busiest blocks listed
+static const int heapMenuBlocks = 15;
+
+
+/*!
+  The current error's block and site, a lookup by address, and the
+  blocks with most errors: the one buffer behind thousands of errors
+  is at the top.
+*/
+void MemcheckView::fillHeapMenu()
+{
+   QMenu* heapMenu = act_HeapBlocks->menu();
+   heapMenu->clear();
+   if ( logview == 0 ) {
+      return;
+   }
+   const VgHeapIndex& index = ( ( MemcheckLogView* )logview )->heapIndex();
+
+   ErrorItem* error = currentError();
+   bool inBlock = ( error != 0 && index.blockOf( error ) != -1 );
+   heapMenu->addAction( tr( "Same heap block" ) )->setData( heapSameBlock );
+   heapMenu->addAction( tr( "Same allocation site" ) )->setData( heapSameSite );
+   foreach ( QAction* act, heapMenu->actions() ) {
+      act->setEnabled( inBlock );
+   }
+   heapMenu->addAction( tr( "Blocks at address..." ) )->setData( heapAtAddress );
+
+   heapMenu->addSeparator();
+   QList<int> busiest = index.busiestBlocks( heapMenuBlocks );
+   if ( busiest.isEmpty() ) {
+      heapMenu->addAction( tr( "No heap blocks in this log" ) )->setEnabled( false );
+   }
+   foreach ( int b, busiest ) {
+      heapMenu->addAction( QString( "%1: %2 errors" ).arg( index.blockName( b ) )
+                           .arg( index.block( b ).errors.count() ) )->setData( b );
+   }
+   if ( index.blockCount() > busiest.count() ) {
+      heapMenu->addAction( QString( "... %1 more blocks" )
+                           .arg( index.blockCount() - busiest.count() ) )->setEnabled( false );
+   }
+
+   if ( heapShown ) {
+      heapMenu->addSeparator();
+      heapMenu->addAction( tr( "Show all errors" ) )->setData( heapShowAll );
+   }
+}
+
+
+void MemcheckView::showHeapErrors( QAction* heapAction )
+{
+   if ( logview == 0 || !heapAction->data().isValid() ) {
+      return;
+   }
+   const VgHeapIndex& index = ( ( MemcheckLogView* )logview )->heapIndex();
+   int what = heapAction->data().toInt();
+
+   QList<QTreeWidgetItem*> errors;
+   QString desc;
+   if ( what == heapShowAll ) {
+      // back to what the filters show
+      logviewFilter->enableFilter( act_enableFilter->isChecked() );
+      heapShown = false;
+      emit message( "Showing all errors" );
+      return;
+   }
+   else if ( what == heapSameBlock || what == heapSameSite ) {
+      int b = index.blockOf( currentError() );
+      if ( b == -1 ) {
+         return;
+      }
+      if ( what == heapSameBlock ) {
+         errors = index.block( b ).errors;
+         desc = "block " + index.blockName( b );
+      }
+      else {
+         errors = index.siteErrors( index.block( b ).site );
+         desc = "blocks " + index.siteName( index.block( b ).site );
+      }
+   }
+   else if ( what == heapAtAddress ) {
+      bool ok;
+      QString str = QInputDialog::getText( this, tr( "Heap Blocks" ),
+                                           tr( "Address (hex):" ), QLineEdit::Normal,
+                                           "0x", &ok ).trimmed();
+      if ( !ok || str.isEmpty() ) {
+         return;
+      }
+      quint64 addr = str.toULongLong( &ok, 16 );
+      if ( !ok ) {
+         vkError( this, "Heap Blocks", "<p>Not a hex address: %s</p>",
+                  qPrintable( str ) );
+         return;
+      }
+      QList<int> blocks = index.blocksAt( addr );
+      foreach ( int b, blocks ) {
+         errors += index.block( b ).errors;
+      }
+      desc = QString( "the %1 blocks holding 0x%2" ).arg( blocks.count() )
+             .arg( addr, 0, 16 );
+   }
+   else {
+      errors = index.block( what ).errors;
+      desc = "block " + index.blockName( what );
+   }
+
+   if ( errors.isEmpty() ) {
+      emit message( "No errors on " + desc );
+      return;
+   }
+   showOnlyErrors( errors.toSet() );
+   treeView->setCurrentItem( errors.first() );
+   treeView->scrollToItem( errors.first(), QAbstractItemView::PositionAtTop );
+   emit message( QString( "Showing %1 errors on %2" ).arg( errors.count() ).arg( desc ) );
+}
+
+
+/*!
+  Hide the errors not given: hidden, not taken, so 'Show all errors'
+  puts them straight back, through the filters.
+*/
+void MemcheckView::showOnlyErrors( const QSet<QTreeWidgetItem*>& shown )
+{
+   if ( treeView->topLevelItemCount() == 0 ) {
+      return;
+   }
+   QTreeWidgetItem* vgItemTop = treeView->topLevelItem( 0 );
+   for ( int i = 0; i < vgItemTop->childCount(); ++i ) {
+      VgOutputItem* child = ( VgOutputItem* )vgItemTop->child( i );
+      if ( child->elemType() == VG_ELEM::ERROR ) {
+         child->setHidden( !shown.contains( child ) );
+      }
+   }
+   heapShown = true;
+}
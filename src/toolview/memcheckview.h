@@ -26,6 +26,7 @@
 #include "toolview/logviewfilter_mc.h"
 
 #include <QMenu>
+#include <QSet>
 #include <QTreeWidget>
 #include <QToolButton>
 
@@ -38,15 +39,24 @@ public:
    MemcheckView( QWidget* parent );
    ~MemcheckView();
    
-   VgLogView* createVgLogView();
-   
 public slots:
    virtual void setState( bool run );
+   virtual void loadProgress( qint64 done, qint64 total );
    
 private:
    void setupLayout();
    void setupActions();
    void setupToolBar();
+   QTreeWidget* createLogTree();
+   void connectLogTree( QTreeWidget* tree );
+   VgLogView* newLogView( QTreeWidget* tree );
+   void updateLogActions();
+   void leaveLogTab();
+   void logTabShown();
+   QList<ErrorItem*> errorItems( const QString& kind = QString() );
+   void suppsToEditor( const QList<ErrorItem*>& errors );
+   ErrorItem* currentError();
+   void showOnlyErrors( const QSet<QTreeWidgetItem*>& shown );
    
 private slots:
    void opencloseAllItems();
@@ -55,7 +65,10 @@ private slots:
    void launchEditor( QTreeWidgetItem* item );
    void itemExpanded( QTreeWidgetItem* item );
    void itemCollapsed( QTreeWidgetItem* item );
+   void sortErrors( QAction* keyAction );
    void popupMenu( const QPoint& pos );
+   void fillHeapMenu();
+   void showHeapErrors( QAction* heapAction );
    void updateItemActions();
 
 private:
@@ -63,13 +76,16 @@ private:
    QAction* act_OpenClose_item;
    QAction* act_ShowSrcPaths;
    QAction* act_OpenLog;
+   QAction* act_OpenLogTab;
    QAction* act_SaveLog;
+   QAction* act_ExportLog;
+   QAction* act_DiffLog;
+   QAction* act_MergeLogs;
    QAction* act_enableFilter;
-   
-   QTreeWidget* treeView;
-   VgLogView*   logview;
+   QAction* act_HeapBlocks;
    
    LogViewFilterMC* logviewFilter;
+   bool heapShown;   // some errors hidden by showOnlyErrors()
 };
 
 #endif // __MEMCHECKVIEW_H
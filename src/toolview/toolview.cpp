@@ -18,13 +18,20 @@
 **
 ****************************************************************************/
 
+#include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QMenu>
 #include <QMenuBar>
+#include <QTabBar>
+#include <QTextStream>
 #include <QToolBar>
 
 #include "toolview/toolview.h"
 #include "mainwindow.h"
+#include "options/vk_option.h"
 #include "utils/vk_config.h"
+#include "utils/vk_messages.h"
 #include "utils/vk_utils.h"
 
 
@@ -50,7 +57,9 @@
     The toolId is used to track which tool corresponds to which interface.
 */
 ToolView::ToolView( QWidget* parent, VGTOOL::ToolID id )
-   : QWidget( parent ), toolId( id )
+   : QWidget( parent ), toolId( id ), act_SortErrors( 0 ),
+     treeView( 0 ), logview( 0 ), expandAll( 0 ), collapsedLru( 0 ),
+     runActive( false ), logTabWidget( 0 )
 {
    // Create and add toolToolBar to MainWindow
    //  - Note: this reparents it to MainWindow, which is fine.
@@ -91,6 +100,19 @@ ToolView::~ToolView()
          toolToolBar->setParent( this );
       }
    }
+
+   // stop the loads first: their threads may still be parsing
+   foreach ( VgLogTab* tab, logTabs ) {
+      delete tab->loader;
+      tab->loader = 0;
+   }
+   // the trees go with our children
+   foreach ( VgLogTab* tab, logTabs ) {
+      delete tab->logview;
+      delete tab->collapsedLru;
+      delete tab;
+   }
+   logTabs.clear();
 }
 
 
@@ -160,6 +182,469 @@ void ToolView::openLogFile()
 }
 
 
+/*!
+    Open logs alongside the run's, each in a tab of its own:
+    they load at once, in the background.
+*/
+void ToolView::openLogTabs()
+{
+   QString start_dir = "./";
+   QFileInfo fi( vkCfgProj->value( "valkyrie/view-log" ).toString() );
+   if ( fi.exists() ) {
+      start_dir = fi.absolutePath();
+   }
+
+   QString filter = vkCfgGlbl->value( "filefilters/valkyrie_view-log" ).toString();
+   QStringList log_files = QFileDialog::getOpenFileNames( this, tr( "Open Logs in New Tabs" ),
+                                                          start_dir, filter );
+
+   int idx = -1;
+   foreach( QString log_file, log_files ) {
+      int errval = PARSED_OK;
+      QString ret_file = fileCheck( &errval, log_file, true );
+      if ( errval != PARSED_OK ) {
+         vkError( this, "File Error", "%s: \n\"%s\"",
+                  parseErrString( errval ),
+                  qPrintable( escapeEntities( log_file ) ) );
+         continue;
+      }
+      addLogTab( ret_file );
+      idx = logTabs.count() - 1;
+   }
+
+   // user might have clicked Cancel
+   if ( idx != -1 ) {
+      logTabWidget->setCurrentIndex( idx );
+   }
+}
+
+
+/*!
+    Compare the current log (as given by [VALKYRIE::VIEW_LOG]) with a
+    baseline log, e.g. from the last nightly run.
+    If no log has been opened yet, ask for that first.
+*/
+void ToolView::openLogDiff()
+{
+   QString log_file = vkCfgProj->value( "valkyrie/view-log" ).toString();
+
+   if ( log_file.isEmpty() || !QFile::exists( log_file ) ) {
+      log_file = vkDlgCfgGetFile( this, "valkyrie/view-log" );
+
+      // user might have clicked Cancel
+      if ( log_file.isEmpty() ) {
+         return;
+      }
+      emit logFileChosen( log_file );
+   }
+
+   QString base_file = vkDlgCfgGetFile( this, "valkyrie/diff-log" );
+
+   // user might have clicked Cancel
+   if ( base_file.isEmpty() ) {
+      return;
+   }
+
+   // updates config (as does cmd line --diff-log...)
+   emit diffLogChosen( base_file );
+
+   // informs tool_object to diff the logs given in config
+   emit run( VGTOOL::PROC_DIFF_LOG );
+}
+
+
+/*!
+    Merge several valgrind xml logfiles (e.g. from --trace-children=yes
+    with --xml-file=log.%p.xml) into a single view.
+    The chosen files are written to a loglist, as taken by cmd line --merge.
+*/
+void ToolView::openLogMerge()
+{
+   QString start_dir = "./";
+   QFileInfo fi( vkCfgProj->value( "valkyrie/view-log" ).toString() );
+   if ( fi.exists() ) {
+      start_dir = fi.absolutePath();
+   }
+
+   QString filter = vkCfgGlbl->value( "filefilters/valkyrie_view-log" ).toString();
+   QStringList log_files = QFileDialog::getOpenFileNames( this, tr( "Choose Logs to Merge" ),
+                                                          start_dir, filter );
+
+   // user might have clicked Cancel
+   if ( log_files.isEmpty() ) {
+      return;
+   }
+
+   QString loglist = vk_mkstemp( VkCfg::tmpDir() + "merge", "loglst" );
+   QFile file( loglist );
+   if ( loglist.isEmpty() || !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+      vkError( this, "Merge Logs", "<p>Failed to create the log list:<br>'%s'</p>",
+               qPrintable( escapeEntities( loglist ) ) );
+      return;
+   }
+   QTextStream strm( &file );
+   foreach( QString log_file, log_files ) {
+      strm << log_file << "\n";
+   }
+   file.close();
+
+   // updates config (as does cmd line --merge...)
+   emit mergeLogChosen( loglist );
+
+   // informs tool_object to merge the logs given in config
+   emit run( VGTOOL::PROC_MERGE_LOGS );
+}
+
+
+/*!
+    The 'Open all' job for the given tree: reports to the status bar.
+*/
+VgExpandAll* ToolView::createExpandAll( QTreeWidget* tree )
+{
+   VgExpandAll* opener = new VgExpandAll( tree );
+   connect( opener, SIGNAL( progress( int, int ) ),
+            this,     SLOT( expandAllProgress( int, int ) ) );
+   connect( opener, SIGNAL( finished( int, int, QString ) ),
+            this,     SLOT( expandAllFinished( int, int, QString ) ) );
+   return opener;
+}
+
+
+static const char* sortHelp =
+   "\n(a key again: reverse it; another: sort by it, then the others)";
+
+/*!
+    The 'Sort errors' action, with a menu of the sort keys: each key's
+    action has the key as its data.  Leak keys only for tools with leaks.
+    The view connects the menu's triggered() to its own slot, which
+    calls updateErrorSort() then re-sorts its logview.
+*/
+QAction* ToolView::createSortAction( bool withLeaks )
+{
+   QMenu* sortMenu = new QMenu( this );
+   for ( int key = 0; key < VG_SORT::NUM_KEYS; ++key ) {
+      if ( !withLeaks && ( key == VG_SORT::LEAKED_BYTES ||
+                           key == VG_SORT::LEAKED_BLOCKS ) ) {
+         continue;
+      }
+      QAction* keyAction = sortMenu->addAction(
+                              VgErrorSort::keyName( ( VG_SORT::Key )key ) );
+      keyAction->setData( key );
+      if ( key == VG_SORT::FILE_ORDER ) {
+         sortMenu->addSeparator();
+      }
+   }
+
+   act_SortErrors = new QAction( this );
+   act_SortErrors->setObjectName( QString::fromUtf8( "act_SortErrors" ) );
+   QIcon icon_sort;
+   icon_sort.addPixmap( QPixmap( QString::fromUtf8( ":/vk_icons/icons/arrow_down.png" ) ) );
+   act_SortErrors->setIcon( icon_sort );
+   act_SortErrors->setIconVisibleInMenu( true );
+   act_SortErrors->setMenu( sortMenu );
+   act_SortErrors->setText( tr( "Sort errors" ) );
+   act_SortErrors->setToolTip( tr( "Sort errors by: file order" ) + sortHelp );
+   return act_SortErrors;
+}
+
+
+/*!
+    A sort key was picked: the new order, on the tooltip and status bar.
+*/
+void ToolView::updateErrorSort( QAction* keyAction )
+{
+   VgErrorSort::sortBy( errorSortSpec, ( VG_SORT::Key )keyAction->data().toInt() );
+
+   QString spec = VgErrorSort::specString( errorSortSpec );
+   act_SortErrors->setToolTip( tr( "Sort errors by: " ) + spec + sortHelp );
+   emit message( "Errors sorted by: " + spec );
+}
+
+
+/*!
+    Re-sort every tab's log, as the spec changed.
+*/
+void ToolView::sortLogViews()
+{
+   foreach ( VgLogTab* tab, logTabs ) {
+      if ( tab->logview != 0 ) {
+         tab->logview->sortErrors( errorSortSpec );
+      }
+   }
+}
+
+
+/*!
+    The tabs, holding the run's tab: for the view's layout.
+    Called from the view's setupLayout().
+*/
+QWidget* ToolView::createLogTabs()
+{
+   logTabWidget = new QTabWidget( this );
+   logTabWidget->setObjectName( QString::fromUtf8( "logTabWidget" ) );
+   logTabWidget->setDocumentMode( true );
+   logTabWidget->setTabsClosable( true );
+   // just the run's tab: no tab bar
+   logTabWidget->setTabBarAutoHide( true );
+
+   addLogTab( QString() );
+   // the run's tab stays
+   logTabWidget->tabBar()->setTabButton( 0, QTabBar::RightSide, 0 );
+   logTabWidget->tabBar()->setTabButton( 0, QTabBar::LeftSide, 0 );
+   showLogTab( runTab() );
+
+   connect( logTabWidget, SIGNAL( currentChanged( int ) ),
+            this,           SLOT( logTabChanged( int ) ) );
+   connect( logTabWidget, SIGNAL( tabCloseRequested( int ) ),
+            this,           SLOT( closeLogTab( int ) ) );
+   return logTabWidget;
+}
+
+
+/*!
+    A new tab: with no log file, the run's tab, its log made later by
+    createVgLogView().  Else, the log starts loading, in the background.
+*/
+VgLogTab* ToolView::addLogTab( const QString& logFile )
+{
+   VgLogTab* tab = new VgLogTab;
+   tab->tree = createLogTree();
+   tab->expandAll = createExpandAll( tab->tree );
+   tab->collapsedLru = new VgCollapsedLru( tab->tree );
+   tab->logview = 0;
+   tab->loader = 0;
+   tab->logFile = logFile;
+   connectLogTree( tab->tree );
+   logTabs.append( tab );
+
+   if ( logFile.isEmpty() ) {
+      logTabWidget->addTab( tab->tree, tr( "Run" ) );
+      return tab;
+   }
+
+   int idx = logTabWidget->addTab( tab->tree, QFileInfo( logFile ).fileName() );
+   logTabWidget->setTabToolTip( idx, logFile );
+
+   tab->logview = newLogView( tab->tree );
+   tab->loader = new VgLogLoader( tab->logview, this );
+   connect( tab->loader, SIGNAL( progress( qint64, qint64 ) ),
+            this,          SLOT( logTabProgress( qint64, qint64 ) ) );
+   connect( tab->loader, SIGNAL( finished( bool, QString ) ),
+            this,          SLOT( logTabFinished( bool, QString ) ) );
+   tab->loader->start( &loadPool, logFile );
+   emit message( "Loading '" + logFile + "'" );
+   return tab;
+}
+
+
+VgLogTab* ToolView::currentTab()
+{
+   return logTabs.value( logTabWidget->currentIndex(), runTab() );
+}
+
+
+/*!
+    Valgrind's run, or a log to view: into the run's tab.
+*/
+void ToolView::showRunTab()
+{
+   logTabWidget->setCurrentIndex( 0 );
+}
+
+
+/*!
+   Provide the tool-object access to our model, to fill it,
+   but keep ownership ourselves: we know when we're done with it.
+
+   Creates a clean log, in the run's tab, on each call.
+   This should be called by the tool-object just before it intends
+   to fill the log.
+*/
+VgLogView* ToolView::createVgLogView()
+{
+   VgLogTab* tab = runTab();
+   if ( tab->logview != 0 ) {
+      delete tab->logview;
+   }
+   tab->logview = newLogView( tab->tree );
+
+   if ( currentTab() == tab ) {
+      logview = tab->logview;
+   }
+   return tab->logview;
+}
+
+
+/*!
+    The view's actions now work on this tab.
+*/
+void ToolView::showLogTab( VgLogTab* tab )
+{
+   treeView     = tab->tree;
+   logview      = tab->logview;
+   expandAll    = tab->expandAll;
+   collapsedLru = tab->collapsedLru;
+}
+
+
+void ToolView::logTabChanged( int index )
+{
+   VgLogTab* tab = logTabs.value( index, 0 );
+   if ( tab == 0 || tab->tree == treeView ) {
+      return;
+   }
+   leaveLogTab();
+   showLogTab( tab );
+   logTabShown();
+}
+
+
+/*!
+    About to show another tab: undo what's only for this one.
+*/
+void ToolView::leaveLogTab()
+{
+}
+
+
+/*!
+    Another tab's on show.
+*/
+void ToolView::logTabShown()
+{
+   updateLogActions();
+}
+
+
+/*!
+    Closing a tab frees all of its log: items, model and all.
+    Its load, if still going, is stopped.
+*/
+void ToolView::closeLogTab( int index )
+{
+   if ( index <= 0 || index >= logTabs.count() ) {
+      return;   // the run's tab stays
+   }
+   VgLogTab* tab = logTabs.at( index );
+
+   delete tab->loader;   // waits for its thread
+   tab->loader = 0;
+   tab->expandAll->cancel();
+
+   logTabs.removeAt( index );
+   logTabWidget->removeTab( index );   // may show another tab
+
+   delete tab->logview;
+   delete tab->collapsedLru;
+   delete tab->tree;
+   delete tab;
+}
+
+
+VgLogTab* ToolView::loaderTab( QObject* loader )
+{
+   foreach ( VgLogTab* tab, logTabs ) {
+      if ( tab->loader == loader ) {
+         return tab;
+      }
+   }
+   return 0;
+}
+
+
+void ToolView::logTabProgress( qint64 done, qint64 total )
+{
+   VgLogTab* tab = loaderTab( sender() );
+   if ( tab == 0 ) {
+      return;
+   }
+   QString name = QFileInfo( tab->logFile ).fileName();
+   if ( total > 0 ) {
+      name += QString( " (%1%)" ).arg( done * 100 / total );
+   }
+   logTabWidget->setTabText( logTabs.indexOf( tab ), name );
+
+   if ( tab == currentTab() ) {
+      updateLogActions();
+   }
+}
+
+
+/*!
+    A tab's log is all in, or failed: what's loaded stays.
+*/
+void ToolView::logTabFinished( bool ok, QString errMsg )
+{
+   VgLogTab* tab = loaderTab( sender() );
+   if ( tab == 0 ) {
+      return;
+   }
+   tab->loader->deleteLater();   // we're in its signal
+   tab->loader = 0;
+   logTabWidget->setTabText( logTabs.indexOf( tab ),
+                             QFileInfo( tab->logFile ).fileName() );
+   if ( tab == currentTab() ) {
+      updateLogActions();
+   }
+
+   if ( ok ) {
+      emit message( "Loaded Logfile '" + tab->logFile + "'" );
+   }
+   else {
+      emit message( "Error Parsing Logfile '" + tab->logFile + "'" );
+      vkError( this, "XML Parse Error", "<p>%s</p><p>%s</p>",
+               qPrintable( escapeEntities( tab->logFile ) ),
+               qPrintable( str2html( escapeEntities( errMsg ) ) ) );
+   }
+}
+
+
+/*!
+    A log is loading, a chunk at a time, behind what's shown.
+    Views may let the user at what's loaded meanwhile.
+*/
+void ToolView::loadProgress( qint64, qint64 )
+{
+}
+
+
+/*!
+    Memory ceiling for 'Open all', in MB: 0 for none.
+*/
+int ToolView::expandMemLimit()
+{
+   return vkCfgProj->value( "valkyrie/expand-mem-limit" ).toInt();
+}
+
+
+/*!
+    Memory budget for the children of closed errors, in bytes: 0 for none.
+*/
+qint64 ToolView::collapsedMemBudget()
+{
+   return vkCfgProj->value( "valkyrie/closed-mem-budget" ).toLongLong() * 1024 * 1024;
+}
+
+
+void ToolView::expandAllProgress( int done, int total )
+{
+   emit message( QString( "Opening all errors: %1 of %2 (Open/Close all to stop)" )
+                 .arg( done ).arg( total ) );
+}
+
+
+void ToolView::expandAllFinished( int done, int total, QString why )
+{
+   if ( why.isEmpty() ) {
+      emit message( QString( "Opened all %1 errors" ).arg( total ) );
+   }
+   else {
+      emit message( QString( "Stopped opening errors (%1): %2 of %3 open" )
+                    .arg( why ).arg( done ).arg( total ) );
+   }
+}
+
+
 
 /***************************************************************************/
 /*!
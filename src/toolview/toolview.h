@@ -21,11 +21,17 @@
 #ifndef __VK_TOOLVIEW_H
 #define __VK_TOOLVIEW_H
 
+#include "toolview/vgcollapsedlru.h"
+#include "toolview/vgerrorsort.h"
+#include "toolview/vgexpandall.h"
 #include "toolview/vglogview.h"
+#include "utils/vglogloader.h"
 
 #include <QMainWindow>
 #include <QStackedWidget>
 #include <QList>
+#include <QTabWidget>
+#include <QThreadPool>
 
 
 // ============================================================
@@ -51,16 +57,34 @@ enum ToolProcessId {
    PROC_NONE = -1,    // no process running
    PROC_VALGRIND = 0, // run valgrind for given tool
    PROC_PARSE_LOG = 1,
+   PROC_DIFF_LOG = 2, // compare a baseline log with the current log
+   PROC_MERGE_LOGS = 3, // merge per-process logs into one view
 
    // If Tools need their own processes, extend this enum as follows:
    // Add PROC_TOOL_FIRST here: tool defined proc-id's start here, and run to < PROC_MAX
    // Within tool: enum toolProcess { PROC_TOOL1 = VGTOOL::PROC_TOOL_FIRST, ... }
 
-   PROC_MAX = 2       // to a reasonable max number of processes per tool
+   PROC_MAX = 4       // to a reasonable max number of processes per tool
 };
 }
 
 
+// ============================================================
+/*!
+  VgLogTab: a log on show, in a tab of its own.
+  The first tab is the run's: runs, and logs opened, compared or merged.
+  The others hold logs opened alongside, each loaded in the background.
+*/
+struct VgLogTab {
+   QTreeWidget*    tree;
+   VgLogView*      logview;
+   VgExpandAll*    expandAll;
+   VgCollapsedLru* collapsedLru;
+   VgLogLoader*    loader;     // while the log loads
+   QString         logFile;    // empty for the run's tab
+};
+
+
 // ============================================================
 class ToolView : public QWidget
 {
@@ -71,17 +95,29 @@ public:
    ToolView( QWidget* parent, VGTOOL::ToolID toolId );
    ~ToolView();
    
-   virtual VgLogView* createVgLogView() = 0;
+   VgLogView* createVgLogView();
 
    void setToolFont( QFont font );
 
 signals:
    void saveLogFile();
+   void exportLogFile();
+   void message( QString );
 
 protected:
    virtual void setupLayout() = 0;
    virtual void setupActions() = 0;
    virtual void setupToolBar() = 0;
+
+   // a tab's tree: made, and connected to the view's slots
+   virtual QTreeWidget* createLogTree() = 0;
+   virtual void connectLogTree( QTreeWidget* tree ) = 0;
+   // a clean log, on a tab's tree
+   virtual VgLogView* newLogView( QTreeWidget* tree ) = 0;
+   // the actions, for the current tab
+   virtual void updateLogActions() = 0;
+   virtual void leaveLogTab();
+   virtual void logTabShown();
    
 protected:
    void showToolMenus();
@@ -89,23 +125,69 @@ protected:
    VGTOOL::ToolID getToolId() {
       return toolId;
    }
+   VgExpandAll* createExpandAll( QTreeWidget* tree );
+   int expandMemLimit();
+   qint64 collapsedMemBudget();
+   QAction* createSortAction( bool withLeaks );
+   void updateErrorSort( QAction* keyAction );
+   void sortLogViews();
+   QWidget* createLogTabs();
+   VgLogTab* addLogTab( const QString& logFile );
+   VgLogTab* runTab() {
+      return logTabs.first();
+   }
+   VgLogTab* currentTab();
+   void showRunTab();
    
 protected slots:
    void openLogFile();
+   void openLogTabs();
+   void closeLogTab( int index );
+   void logTabChanged( int index );
+   void logTabProgress( qint64 done, qint64 total );
+   void logTabFinished( bool ok, QString errMsg );
+   void openLogDiff();
+   void openLogMerge();
+   void expandAllProgress( int done, int total );
+   void expandAllFinished( int done, int total, QString why );
    
 public slots:
    // called by the view's object
    virtual void setState( bool run ) = 0;
+   // a log loading progressively: total 0 when done
+   virtual void loadProgress( qint64 done, qint64 total );
    
 signals:
    // start appropriate process for given runState
    void run( VGTOOL::ToolProcessId procId );
    void logFileChosen( QString logFilename );
+   void diffLogChosen( QString logFilename );
+   void mergeLogChosen( QString loglistFilename );
    
 protected:
    VGTOOL::ToolID toolId;
    QToolBar*      toolToolBar;
    QMenu*         toolMenu;
+
+   // errors' order, kept over logs: see createSortAction()
+   VgErrorSortSpec errorSortSpec;
+   QAction*       act_SortErrors;
+
+   // the current tab's: what the view's actions work on
+   QTreeWidget*    treeView;
+   VgLogView*      logview;
+   VgExpandAll*    expandAll;
+   VgCollapsedLru* collapsedLru;
+   bool            runActive;    // valgrind running, or a log loading, in the run's tab
+
+private:
+   void showLogTab( VgLogTab* tab );
+   VgLogTab* loaderTab( QObject* loader );
+
+private:
+   QTabWidget*      logTabWidget;
+   QList<VgLogTab*> logTabs;
+   QThreadPool      loadPool;     // for the tabs' background loads
 };
 
 
@@ -0,0 +1,159 @@
+/****************************************************************************
+** VgCollapsedLru implementation
+**  - drops the children of the least recently closed errors
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgcollapsedlru.h"
+#include "toolview/vglogview.h"
+#include "utils/vk_utils.h"
+
+
+// an item's own cost, before its text: QTreeWidgetItem, its d-ptr and
+// column data, our VgOutputItem members, the view's model bookkeeping.
+static const qint64 itemOverheadBytes = 256;
+
+
+VgCollapsedLru::VgCollapsedLru( QTreeWidget* tree )
+   : m_tree( tree ), m_budget( 0 ), m_bytes( 0 ), m_seq( 0 )
+{
+}
+
+
+/*!
+  Takes effect from the next close.
+*/
+void VgCollapsedLru::setBudget( qint64 budgetBytes )
+{
+   m_budget = budgetBytes;
+}
+
+
+/*!
+  An item was closed: its children can go, in their turn.
+*/
+void VgCollapsedLru::collapsed( QTreeWidgetItem* item )
+{
+   remove( item );
+   if ( item->childCount() == 0 ) {
+      return;
+   }
+
+   // errors only: other items' children aren't all made by setupChildren()
+   VgOutputItem* vgItem = ( VgOutputItem* )item;
+   if ( vgItem->parent() == 0 || vgItem->parent()->parent() != 0 ||
+        vgItem->elemType() != VG_ELEM::ERROR ) {
+      return;
+   }
+
+   qint64 cost = childrenBytes( item );
+   m_order.insert( ++m_seq, item );
+   m_seqs.insert( item, m_seq );
+   m_costs.insert( item, cost );
+   m_bytes += cost;
+
+   evict();
+}
+
+
+/*!
+  An item was opened: its children are in use.
+*/
+void VgCollapsedLru::expanded( QTreeWidgetItem* item )
+{
+   remove( item );
+}
+
+
+/*!
+  Forget all: the view's items are going.
+*/
+void VgCollapsedLru::clear()
+{
+   m_order.clear();
+   m_seqs.clear();
+   m_costs.clear();
+   m_bytes = 0;
+}
+
+
+void VgCollapsedLru::remove( QTreeWidgetItem* item )
+{
+   QHash<QTreeWidgetItem*, quint64>::iterator it = m_seqs.find( item );
+   if ( it == m_seqs.end() ) {
+      return;
+   }
+   m_order.remove( it.value() );
+   m_seqs.erase( it );
+   m_bytes -= m_costs.take( item );
+}
+
+
+/*!
+  Drop the children of the least recently closed, until within budget.
+  An item holding the current item keeps its children: the view would
+  otherwise lose its place.
+*/
+void VgCollapsedLru::evict()
+{
+   if ( m_budget <= 0 ) {
+      return;
+   }
+
+   QMap<quint64, QTreeWidgetItem*>::iterator it = m_order.begin();
+   while ( m_bytes > m_budget && it != m_order.end() ) {
+      QTreeWidgetItem* item = it.value();
+      if ( holdsCurrent( item ) ) {
+         ++it;
+         continue;
+      }
+
+      it = m_order.erase( it );
+      m_seqs.remove( item );
+      m_bytes -= m_costs.take( item );
+
+      qDeleteAll( item->takeChildren() );
+   }
+}
+
+
+bool VgCollapsedLru::holdsCurrent( QTreeWidgetItem* item )
+{
+   QTreeWidgetItem* current = m_tree->currentItem();
+   for ( ; current != 0; current = current->parent() ) {
+      if ( current->parent() == item ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+
+/*!
+  What an item's children cost, roughly: per item, the overhead and
+  the text.  Source items' text is their snippet of the file.
+*/
+qint64 VgCollapsedLru::childrenBytes( QTreeWidgetItem* item )
+{
+   qint64 bytes = 0;
+   for ( int i = 0; i < item->childCount(); ++i ) {
+      QTreeWidgetItem* child = item->child( i );
+      bytes += itemOverheadBytes + child->text( 0 ).size() * sizeof( QChar );
+      bytes += childrenBytes( child );
+   }
+   return bytes;
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+** VgCollapsedLru definition
+**  - drops the children of the least recently closed errors
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGCOLLAPSEDLRU_H
+#define __VGCOLLAPSEDLRU_H
+
+#include <QHash>
+#include <QMap>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+
+// ============================================================
+/*!
+  VgCollapsedLru: keeps the children of closed error items within a
+  memory budget.
+
+  An error's stack, frame and source items are made when it's first
+  opened, and were then kept for good: after a long session, most of
+  a big log's errors had been opened once and closed.  Here, closed
+  errors with children are kept least recently closed first, with an
+  estimate of what their children cost; over the budget, the oldest
+  lose their children.  Opening one again makes them afresh, via
+  VgOutputItem::setupChildren(), as on first opening.
+
+  The view tells us of each open / close of an error item, and must
+  clear() us before deleting its items.
+*/
+class VgCollapsedLru
+{
+public:
+   VgCollapsedLru( QTreeWidget* tree );
+
+   // 0: no budget, keep all
+   void setBudget( qint64 budgetBytes );
+
+   void collapsed( QTreeWidgetItem* item );
+   void expanded( QTreeWidgetItem* item );
+   void clear();
+
+   qint64 bytesKept() const {
+      return m_bytes;
+   }
+
+private:
+   void remove( QTreeWidgetItem* item );
+   void evict();
+   bool holdsCurrent( QTreeWidgetItem* item );
+   static qint64 childrenBytes( QTreeWidgetItem* item );
+
+private:
+   QTreeWidget* m_tree;
+   qint64  m_budget;
+   qint64  m_bytes;     // estimate for all kept
+   quint64 m_seq;       // close order
+
+   // oldest first: close seq -> item; and back again, with its cost
+   QMap<quint64, QTreeWidgetItem*>  m_order;
+   QHash<QTreeWidgetItem*, quint64> m_seqs;
+   QHash<QTreeWidgetItem*, qint64>  m_costs;
+};
+
+#endif // __VGCOLLAPSEDLRU_H
@@ -0,0 +1,356 @@
+/****************************************************************************
+** VgErrorSort implementation
+**  - sort keys of a log's errors, and their order
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgerrorsort.h"
+#include "utils/vk_utils.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+
+// below this many errors per slice, threads cost more than they save
+#define ERROR_SORT_MIN_SLICE 4096
+
+// most columns a sort keeps
+#define ERROR_SORT_MAX_FIELDS 3
+
+
+
+// ============================================================
+/* VgErrorLess */
+VgErrorLess::VgErrorLess( const VgErrorKeys* keys, const quint32* strRanks,
+                          const VgErrorSortSpec& spec )
+   : m_keys( keys ), m_strRanks( strRanks ), m_numFields( 0 )
+{
+   foreach ( VgErrorSortField field, spec ) {
+      if ( m_numFields == VG_SORT::NUM_KEYS ) {
+         break;
+      }
+      m_fields[m_numFields] = field.key;
+      m_descending[m_numFields] = field.descending;
+      m_numFields++;
+   }
+}
+
+
+bool VgErrorLess::operator()( int a, int b ) const
+{
+   for ( int i = 0; i < m_numFields; ++i ) {
+      quint64 va = value( a, m_fields[i] );
+      quint64 vb = value( b, m_fields[i] );
+      if ( va != vb ) {
+         return m_descending[i] ? va > vb : va < vb;
+      }
+   }
+   return a < b;
+}
+
+
+quint64 VgErrorLess::value( int seq, VG_SORT::Key key ) const
+{
+   const VgErrorKeys& k = m_keys[seq];
+   switch ( key ) {
+   case VG_SORT::COUNT:         return k.count;
+   case VG_SORT::LEAKED_BYTES:  return k.leakedBytes;
+   case VG_SORT::LEAKED_BLOCKS: return k.leakedBlocks;
+   case VG_SORT::KIND:          return m_strRanks[k.kind];
+   case VG_SORT::FUNCTION:      return m_strRanks[k.fn];
+   case VG_SORT::OBJECT:        return m_strRanks[k.obj];
+   case VG_SORT::THREAD:        return k.tid;
+   default:                     return seq;
+   }
+}
+
+
+
+// ============================================================
+/* VgErrorSortJob */
+VgErrorSortJob::VgErrorSortJob( const VgErrorLess& less, int* order,
+                                int begin, int mid, int end )
+   : m_less( less ), m_order( order ), m_begin( begin ), m_mid( mid ), m_end( end )
+{
+}
+
+
+void VgErrorSortJob::run()
+{
+   if ( m_mid == -1 ) {
+      std::sort( m_order + m_begin, m_order + m_end, m_less );
+   }
+   else {
+      std::inplace_merge( m_order + m_begin, m_order + m_mid,
+                          m_order + m_end, m_less );
+   }
+}
+
+
+
+// ============================================================
+/* VgErrorSort */
+VgErrorSort::VgErrorSort()
+{
+   clear();
+}
+
+
+void VgErrorSort::clear()
+{
+   m_keys.clear();
+   m_order.clear();
+   m_strIds.clear();
+   m_strs.clear();
+   m_strRanks.clear();
+
+   // id 0: no such string
+   intern( QString() );
+   m_ranksStale = true;
+}
+
+
+void VgErrorSort::setSpec( const VgErrorSortSpec& spec )
+{
+   m_spec = spec;
+}
+
+
+bool VgErrorSort::isFileOrder() const
+{
+   return m_spec.isEmpty() ||
+          ( m_spec.first().key == VG_SORT::FILE_ORDER && !m_spec.first().descending );
+}
+
+
+bool VgErrorSort::sortsBy( VG_SORT::Key key ) const
+{
+   foreach ( VgErrorSortField field, m_spec ) {
+      if ( field.key == key ) {
+         return true;
+      }
+      if ( field.key == VG_SORT::FILE_ORDER ) {
+         break;   // never a tie after this one
+      }
+   }
+   return false;
+}
+
+
+/*!
+  Read err's keys.  Its count starts at 1, as the ErrorItem's.
+*/
+int VgErrorSort::add( QDomElement err )
+{
+   VgErrorKeys k;
+   k.count = 1;
+   k.kind = intern( err.firstChildElement( "kind" ).text() );
+   k.tid  = err.firstChildElement( "tid" ).text().toUInt();
+
+   QDomElement xwhat = err.firstChildElement( "xwhat" );
+   k.leakedBytes  = xwhat.firstChildElement( "leakedbytes" ).text().toULongLong();
+   k.leakedBlocks = xwhat.firstChildElement( "leakedblocks" ).text().toULongLong();
+
+   // top frame of the (first) stack
+   QDomElement frame = err.firstChildElement( "stack" ).firstChildElement( "frame" );
+   k.fn  = intern( frame.firstChildElement( "fn" ).text() );
+   k.obj = intern( frame.firstChildElement( "obj" ).text() );
+
+   m_keys.append( k );
+   return m_keys.count() - 1;
+}
+
+
+void VgErrorSort::setCount( int seq, quint64 count )
+{
+   m_keys[seq].count = count;
+}
+
+
+int VgErrorSort::place( int seq )
+{
+   if ( isFileOrder() ) {
+      m_order.append( seq );
+      return m_order.count() - 1;
+   }
+
+   ensureRanks();
+   VgErrorLess less( m_keys.constData(), m_strRanks.constData(), m_spec );
+
+   QVector<int>::iterator it = std::upper_bound( m_order.begin(), m_order.end(),
+                                                 seq, less );
+   int pos = it - m_order.begin();
+   m_order.insert( pos, seq );
+   return pos;
+}
+
+
+void VgErrorSort::placeAll( QVector<int> seqs )
+{
+   ensureRanks();
+   VgErrorLess less( m_keys.constData(), m_strRanks.constData(), m_spec );
+
+   std::sort( seqs.begin(), seqs.end(), less );
+   QVector<int> merged( m_order.count() + seqs.count() );
+   std::merge( m_order.constBegin(), m_order.constEnd(),
+               seqs.constBegin(), seqs.constEnd(), merged.begin(), less );
+   m_order.swap( merged );
+}
+
+
+/*!
+  Sort all errors: a slice per thread, then the slices merged,
+  pairwise, a round at a time.
+*/
+void VgErrorSort::sort()
+{
+   int num = m_keys.count();
+   m_order.resize( num );
+   for ( int i = 0; i < num; ++i ) {
+      m_order[i] = i;
+   }
+   if ( isFileOrder() ) {
+      return;
+   }
+
+   ensureRanks();
+   VgErrorLess less( m_keys.constData(), m_strRanks.constData(), m_spec );
+
+   int nThreads = qMax( 1, QThread::idealThreadCount() );
+   int slice = qMax( ERROR_SORT_MIN_SLICE, ( num + nThreads - 1 ) / nThreads );
+   int* order = m_order.data();
+
+   // our own pool: the global one may be busy with long jobs
+   QThreadPool pool;
+   pool.setMaxThreadCount( nThreads );
+   for ( int begin = 0; begin < num; begin += slice ) {
+      pool.start( new VgErrorSortJob( less, order, begin, -1,
+                                      qMin( begin + slice, num ) ) );
+   }
+   pool.waitForDone();
+
+   for ( ; slice < num; slice *= 2 ) {
+      for ( int begin = 0; begin + slice < num; begin += 2 * slice ) {
+         pool.start( new VgErrorSortJob( less, order, begin, begin + slice,
+                                         qMin( begin + 2 * slice, num ) ) );
+      }
+      pool.waitForDone();
+   }
+}
+
+
+/*!
+  Picking a key makes it the first column, the others following;
+  picking the first column again turns it around.  Counts and sizes
+  start biggest first.  File order is no sort at all.
+*/
+void VgErrorSort::sortBy( VgErrorSortSpec& spec, VG_SORT::Key key )
+{
+   if ( key == VG_SORT::FILE_ORDER ) {
+      spec.clear();
+      return;
+   }
+   if ( !spec.isEmpty() && spec.first().key == key ) {
+      spec.first().descending = !spec.first().descending;
+      return;
+   }
+
+   for ( int i = 0; i < spec.count(); ++i ) {
+      if ( spec.at( i ).key == key ) {
+         spec.removeAt( i );
+         break;
+      }
+   }
+   VgErrorSortField field;
+   field.key = key;
+   field.descending = ( key == VG_SORT::COUNT || key == VG_SORT::LEAKED_BYTES ||
+                        key == VG_SORT::LEAKED_BLOCKS );
+   spec.prepend( field );
+   while ( spec.count() > ERROR_SORT_MAX_FIELDS ) {
+      spec.removeLast();
+   }
+}
+
+
+QString VgErrorSort::keyName( VG_SORT::Key key )
+{
+   switch ( key ) {
+   case VG_SORT::FILE_ORDER:    return "File order";
+   case VG_SORT::COUNT:         return "Count";
+   case VG_SORT::LEAKED_BYTES:  return "Leaked bytes";
+   case VG_SORT::LEAKED_BLOCKS: return "Leaked blocks";
+   case VG_SORT::KIND:          return "Kind";
+   case VG_SORT::FUNCTION:      return "Function";
+   case VG_SORT::OBJECT:        return "Object";
+   case VG_SORT::THREAD:        return "Thread";
+   default:
+      vk_assert_never_reached();
+      return QString();
+   }
+}
+
+
+/*!
+  e.g. "count (desc), kind"
+*/
+QString VgErrorSort::specString( const VgErrorSortSpec& spec )
+{
+   if ( spec.isEmpty() ) {
+      return "file order";
+   }
+   QStringList fields;
+   foreach ( VgErrorSortField field, spec ) {
+      fields << keyName( field.key ).toLower() + ( field.descending ? " (desc)" : "" );
+   }
+   return fields.join( ", " );
+}
+
+
+quint32 VgErrorSort::intern( const QString& str )
+{
+   QHash<QString, quint32>::const_iterator it = m_strIds.constFind( str );
+   if ( it != m_strIds.constEnd() ) {
+      return it.value();
+   }
+   quint32 id = m_strs.count();
+   m_strs.append( str );
+   m_strIds.insert( str, id );
+   m_ranksStale = true;
+   return id;
+}
+
+
+/*!
+  Rank the strings: a new one may go anywhere among them.
+  The order of those already ranked doesn't change.
+*/
+void VgErrorSort::ensureRanks()
+{
+   if ( !m_ranksStale ) {
+      return;
+   }
+   QStringList sorted = m_strs;   // interned: no duplicates
+   sorted.sort();
+
+   m_strRanks.resize( sorted.count() );
+   for ( int i = 0; i < sorted.count(); ++i ) {
+      m_strRanks[m_strIds.value( sorted.at( i ) )] = i;
+   }
+   m_ranksStale = false;
+}
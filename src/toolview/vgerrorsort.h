@@ -0,0 +1,178 @@
+/****************************************************************************
+** VgErrorSort definition
+**  - sort keys of a log's errors, and their order
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGERRORSORT_H
+#define __VGERRORSORT_H
+
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// ============================================================
+namespace VG_SORT {
+   // what errors can be sorted by
+   enum Key {
+      FILE_ORDER, COUNT, LEAKED_BYTES, LEAKED_BLOCKS,
+      KIND, FUNCTION, OBJECT, THREAD,
+      NUM_KEYS
+   };
+}
+
+// one column of a sort
+struct VgErrorSortField
+{
+   VG_SORT::Key key;
+   bool descending;
+};
+
+// most significant first; empty: file order
+typedef QList<VgErrorSortField> VgErrorSortSpec;
+
+
+/*!
+  An error's sort keys, read from its element once, as it arrives.
+  Strings are interned: sorting compares their ranks.
+*/
+struct VgErrorKeys
+{
+   quint64 count;
+   quint64 leakedBytes;
+   quint64 leakedBlocks;
+   quint32 kind, fn, obj;   // string ids
+   quint32 tid;
+};
+
+
+// ============================================================
+/*!
+  VgErrorLess: orders error seqs by a spec; ties by file order.
+  Reads only the key arrays, so it's safe to use from several threads.
+*/
+class VgErrorLess
+{
+public:
+   VgErrorLess( const VgErrorKeys* keys, const quint32* strRanks,
+                const VgErrorSortSpec& spec );
+
+   bool operator()( int a, int b ) const;
+
+private:
+   quint64 value( int seq, VG_SORT::Key key ) const;
+
+private:
+   const VgErrorKeys* m_keys;
+   const quint32*     m_strRanks;
+   int          m_numFields;
+   VG_SORT::Key m_fields[VG_SORT::NUM_KEYS];
+   bool         m_descending[VG_SORT::NUM_KEYS];
+};
+
+
+// ============================================================
+/*!
+  VgErrorSortJob: sorts a slice of the order, or merges two sorted
+  neighbouring slices of it.
+*/
+class VgErrorSortJob : public QRunnable
+{
+public:
+   // mid == -1: sort [begin, end); else merge [begin, mid) and [mid, end)
+   VgErrorSortJob( const VgErrorLess& less, int* order,
+                   int begin, int mid, int end );
+
+   void run();
+
+private:
+   VgErrorLess m_less;
+   int* m_order;
+   int  m_begin, m_mid, m_end;
+};
+
+
+// ============================================================
+/*!
+  VgErrorSort: the sort keys of a log's errors, and their order.
+
+  Errors are numbered (seq) in file order as they arrive, and their
+  keys kept in one array: a re-sort never touches the dom or the
+  view's items, and runs a slice per thread, then merges the slices.
+
+  Between re-sorts, new errors are put in order one at a time by
+  place() (a binary search), or, many at once, by placeAll()
+  (sorted by themselves, then merged in).
+*/
+class VgErrorSort
+{
+public:
+   VgErrorSort();
+
+   void clear();
+
+   void setSpec( const VgErrorSortSpec& spec );
+   const VgErrorSortSpec& spec() const {
+      return m_spec;
+   }
+   bool isFileOrder() const;
+   bool sortsBy( VG_SORT::Key key ) const;
+
+   // a new error: returns its seq. Not in order() until placed.
+   int add( QDomElement err );
+   int count() const {
+      return m_keys.count();
+   }
+   void setCount( int seq, quint64 count );
+
+   // seq, added last, into order(): returns its position
+   int place( int seq );
+   void placeAll( QVector<int> seqs );
+   // all errors, afresh
+   void sort();
+
+   // seqs, in the spec's order
+   const QVector<int>& order() const {
+      return m_order;
+   }
+
+   // the spec after picking key from the sort menu
+   static void sortBy( VgErrorSortSpec& spec, VG_SORT::Key key );
+   static QString keyName( VG_SORT::Key key );
+   static QString specString( const VgErrorSortSpec& spec );
+
+private:
+   quint32 intern( const QString& str );
+   void ensureRanks();
+
+private:
+   VgErrorSortSpec      m_spec;
+   QVector<VgErrorKeys> m_keys;      // by seq
+   QVector<int>         m_order;
+
+   QHash<QString, quint32> m_strIds;
+   QStringList          m_strs;      // by id
+   QVector<quint32>     m_strRanks;  // by id: place in sorted m_strs
+   bool                 m_ranksStale;
+};
+
+#endif // __VGERRORSORT_H
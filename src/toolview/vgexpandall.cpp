@@ -0,0 +1,161 @@
+/****************************************************************************
+** VgExpandAll implementation
+**  - opens a view's error items a few at a time, off a timer
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgexpandall.h"
+#include "utils/vk_procsampler.h"
+#include "utils/vk_trace.h"
+#include "utils/vk_utils.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+
+// each chunk's time slice, before the event loop gets a look in
+static const int chunkMSecs = 20;
+
+// items opened between checks of our memory use, within a chunk
+static const int memCheckItems = 64;
+
+
+VgExpandAll::VgExpandAll( QTreeWidget* tree )
+   : QObject( tree ), m_tree( tree ), m_wrapAt( 0 ),
+     m_done( 0 ), m_total( 0 ), m_memLimitKB( 0 )
+{
+   setObjectName( QString::fromUtf8( "VgExpandAll" ) );
+
+   m_timer.setSingleShot( true );
+   m_timer.setInterval( 0 );
+   connect( &m_timer, SIGNAL( timeout() ), this, SLOT( expandChunk() ) );
+}
+
+
+VgExpandAll::~VgExpandAll()
+{
+   m_timer.stop();
+}
+
+
+/*!
+  Open the given items, starting with the first in view.
+  The first chunk is done here and now, so what's in view opens at once.
+*/
+void VgExpandAll::start( const QList<QTreeWidgetItem*>& items, int memLimitMB )
+{
+   if ( isRunning() ) {
+      stop( "restarted" );
+   }
+   if ( items.isEmpty() ) {
+      return;
+   }
+
+   // the item at the top of the viewport may be inside one of ours
+   int first = -1;
+   QTreeWidgetItem* inView = m_tree->itemAt( 0, 0 );
+   while ( inView && first == -1 ) {
+      first = items.indexOf( inView );
+      inView = inView->parent();
+   }
+   if ( first == -1 ) {
+      first = 0;
+   }
+
+   // from the viewport down, then from the top back to it
+   m_pending = items.mid( first ) + items.mid( 0, first );
+   m_wrapAt  = items.count() - first;
+   m_done    = 0;
+   m_total   = items.count();
+   m_memLimitKB = ( qint64 )memLimitMB * 1024;
+
+   expandChunk();
+}
+
+
+/*!
+  Stop now, keeping what's open.
+*/
+void VgExpandAll::cancel()
+{
+   if ( isRunning() ) {
+      stop( "cancelled" );
+   }
+}
+
+
+/*!
+  Open items until our time slice is up, then come back later.
+*/
+void VgExpandAll::expandChunk()
+{
+   VK_TRACE_SCOPE( VKTRACE::EXPAND_ALL );
+
+   QTreeWidgetItem* anchor = 0;
+   QElapsedTimer clock;
+   clock.start();
+   int n = 0;
+   while ( !m_pending.isEmpty() && clock.elapsed() < chunkMSecs ) {
+      if ( n++ % memCheckItems == 0 && overMemLimit() ) {
+         stop( QString( "memory use reached %1 MB" ).arg( m_memLimitKB / 1024 ) );
+         return;
+      }
+
+      // opening items above the viewport pushes it down: keep it put
+      if ( m_done >= m_wrapAt && anchor == 0 ) {
+         anchor = m_tree->itemAt( 0, 0 );
+      }
+
+      // view's itemExpanded() slot makes the children
+      m_pending.takeFirst()->setExpanded( true );
+      m_done++;
+   }
+
+   if ( anchor ) {
+      m_tree->scrollToItem( anchor, QAbstractItemView::PositionAtTop );
+   }
+
+   if ( m_pending.isEmpty() ) {
+      stop( QString() );
+   }
+   else {
+      emit progress( m_done, m_total );
+      m_timer.start();
+   }
+}
+
+
+void VgExpandAll::stop( const QString& why )
+{
+   m_timer.stop();
+   m_pending.clear();
+   emit finished( m_done, m_total, why );
+}
+
+
+/*!
+  At (or over) the memory ceiling?  No ceiling, or no way to tell
+  (no /proc): never.
+*/
+bool VgExpandAll::overMemLimit() const
+{
+   if ( m_memLimitKB <= 0 ) {
+      return false;
+   }
+   qint64 rssKB = VkProcSampler::currentRssKB( QCoreApplication::applicationPid() );
+   return rssKB >= m_memLimitKB;
+}
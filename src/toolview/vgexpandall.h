@@ -0,0 +1,83 @@
+/****************************************************************************
+** VgExpandAll definition
+**  - opens a view's error items a few at a time, off a timer
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGEXPANDALL_H
+#define __VGEXPANDALL_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QTreeWidget>
+
+
+// ============================================================
+/*!
+  VgExpandAll: 'Open all' for a view, as a job.
+
+  Opening an error makes its stack, frame and source items, so
+  opening them all in one go could hang the gui for minutes on a
+  big log.  Instead, the items in view are opened first, then the
+  rest in scroll order (down, then back from the top), a time slice
+  at a time, letting the event loop in between.
+
+  Stops when cancelled, or when our memory use (RSS) reaches the
+  given ceiling: the items opened so far stay open.
+
+  The view must cancel() before deleting any of the items given.
+*/
+class VgExpandAll : public QObject
+{
+   Q_OBJECT
+public:
+   VgExpandAll( QTreeWidget* tree );
+   ~VgExpandAll();
+
+   // items: in tree order.  memLimitMB: 0 for none.
+   void start( const QList<QTreeWidgetItem*>& items, int memLimitMB );
+   bool isRunning() const {
+      return !m_pending.isEmpty();
+   }
+
+public slots:
+   void cancel();
+
+signals:
+   void progress( int done, int total );
+   // why we stopped: empty if all were opened
+   void finished( int done, int total, QString why );
+
+private slots:
+   void expandChunk();
+
+private:
+   void stop( const QString& why );
+   bool overMemLimit() const;
+
+private:
+   QTreeWidget*            m_tree;
+   QList<QTreeWidgetItem*> m_pending;   // still to open, in order
+   int    m_wrapAt;          // m_done from which we're above the viewport
+   int    m_done, m_total;
+   qint64 m_memLimitKB;
+   QTimer m_timer;
+};
+
+#endif // __VGEXPANDALL_H
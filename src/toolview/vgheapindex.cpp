@@ -0,0 +1,307 @@
+/****************************************************************************
+** VgHeapIndex implementation
+**  - Memcheck's errors by the heap block, and allocation site, they hit
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgheapindex.h"
+#include "utils/vk_utils.h"
+
+#include <QPair>
+#include <QRegExp>
+
+#include <algorithm>
+
+
+// frames making an allocation site: enough to tell callers of a
+// wrapper apart, few enough that a deep recursion is still one site
+#define HEAP_SITE_FRAMES 4
+
+
+VgHeapIndex::VgHeapIndex()
+{
+   clear();
+}
+
+
+void VgHeapIndex::clear()
+{
+   m_blocks.clear();
+   m_blockIds.clear();
+   m_errBlocks.clear();
+   m_siteIds.clear();
+   m_siteNames.clear();
+   m_siteErrors.clear();
+   m_byStart.clear();
+   m_maxEnd.clear();
+   m_treeStale = false;
+}
+
+
+/*!
+  "Address A is N bytes inside|after|before a block of size M alloc'd"
+  (or free'd), then its stack.  Since 3.11, a freed block's own
+  "Block was alloc'd at" follows, with the stack that allocated it:
+  that one's the site, when there.
+*/
+bool VgHeapIndex::addError( QTreeWidgetItem* item, QDomElement err )
+{
+   static QRegExp rxBlock( "Address (0x[0-9A-Fa-f]+) is ([0-9,]+) bytes "
+                           "(inside|after|before) a block of size ([0-9,]+) ?(\\S*)" );
+
+   QDomElement blockStack, allocStack;
+   QString how;
+   quint64 addr = 0, offset = 0, size = 0;
+   QString where;
+
+   for ( QDomElement e = err.firstChildElement(); !e.isNull();
+         e = e.nextSiblingElement() ) {
+      QString text;
+      if ( e.tagName() == "auxwhat" ) {
+         text = e.text();
+      }
+      else if ( e.tagName() == "xauxwhat" ) {
+         text = e.firstChildElement( "text" ).text();
+      }
+      else {
+         continue;
+      }
+
+      if ( how.isEmpty() && rxBlock.indexIn( text ) != -1 ) {
+         bool ok1, ok2, ok3;
+         addr   = rxBlock.cap( 1 ).toULongLong( &ok1, 16 );
+         offset = rxBlock.cap( 2 ).remove( ',' ).toULongLong( &ok2 );
+         where  = rxBlock.cap( 3 );
+         size   = rxBlock.cap( 4 ).remove( ',' ).toULongLong( &ok3 );
+         if ( !ok1 || !ok2 || !ok3 ) {
+            return false;
+         }
+         how = ( rxBlock.cap( 5 ) == "free'd" ) ? "free'd" : "alloc'd";
+         blockStack = e.nextSiblingElement();
+      }
+      else if ( !how.isEmpty() && text.startsWith( "Block was alloc'd at" ) ) {
+         allocStack = e.nextSiblingElement();
+      }
+   }
+   if ( how.isEmpty() ) {
+      return false;
+   }
+
+   quint64 start;
+   if ( where == "inside" ) {
+      start = addr - offset;
+   }
+   else if ( where == "after" ) {
+      start = addr - offset - size;
+   }
+   else {
+      start = addr + offset;
+   }
+
+   int s;
+   if ( !allocStack.isNull() && allocStack.tagName() == "stack" ) {
+      s = site( allocStack, "alloc'd" );
+   }
+   else {
+      s = site( blockStack.tagName() == "stack" ? blockStack : QDomElement(), how );
+   }
+
+   // the same range from the same site: the same block, or as good as
+   QString key = QString( "%1 %2 %3" ).arg( start ).arg( size ).arg( s );
+   QHash<QString, int>::const_iterator it = m_blockIds.constFind( key );
+   int b;
+   if ( it != m_blockIds.constEnd() ) {
+      b = it.value();
+   }
+   else {
+      VgHeapBlock block;
+      block.start = start;
+      block.size  = size;
+      block.site  = s;
+      b = m_blocks.count();
+      m_blocks.append( block );
+      m_blockIds.insert( key, b );
+      m_treeStale = true;
+   }
+
+   m_blocks[b].errors.append( item );
+   m_siteErrors[s].append( item );
+   m_errBlocks.insert( item, b );
+   return true;
+}
+
+
+int VgHeapIndex::blockOf( QTreeWidgetItem* error ) const
+{
+   return m_errBlocks.value( error, -1 );
+}
+
+
+QList<QTreeWidgetItem*> VgHeapIndex::siteErrors( int site ) const
+{
+   if ( site < 0 || site >= m_siteErrors.count() ) {
+      return QList<QTreeWidgetItem*>();
+   }
+   return m_siteErrors.at( site );
+}
+
+
+QString VgHeapIndex::siteName( int site ) const
+{
+   return m_siteNames.value( site );
+}
+
+
+QList<int> VgHeapIndex::blocksAt( quint64 addr ) const
+{
+   ensureTree();
+   QList<int> found;
+   query( 0, m_byStart.count(), addr, found );
+   return found;
+}
+
+
+QList<int> VgHeapIndex::busiestBlocks( int max ) const
+{
+   // ( -errors, block ): most errors first, then first seen
+   QVector<QPair<int, int> > ranked( m_blocks.count() );
+   for ( int b = 0; b < m_blocks.count(); ++b ) {
+      ranked[b] = qMakePair( -m_blocks.at( b ).errors.count(), b );
+   }
+   int n = qMin( max, ranked.count() );
+   std::partial_sort( ranked.begin(), ranked.begin() + n, ranked.end() );
+
+   QList<int> busiest;
+   for ( int i = 0; i < n; ++i ) {
+      busiest << ranked.at( i ).second;
+   }
+   return busiest;
+}
+
+
+QString VgHeapIndex::blockName( int b ) const
+{
+   const VgHeapBlock& block = m_blocks.at( b );
+   return QString( "0x%1, %2 bytes, %3" )
+          .arg( block.start, 0, 16 ).arg( block.size ).arg( siteName( block.site ) );
+}
+
+
+/*!
+  A site is its stack's top frames.  It's named for its first frame
+  outside valgrind's own malloc replacements: the caller, not malloc.
+*/
+int VgHeapIndex::site( QDomElement stack, const QString& how )
+{
+   QStringList frames;
+   QString name;
+   int n = 0;
+   for ( QDomElement frame = stack.firstChildElement( "frame" );
+         !frame.isNull() && n < HEAP_SITE_FRAMES;
+         frame = frame.nextSiblingElement( "frame" ), ++n ) {
+      QString fn   = frame.firstChildElement( "fn" ).text();
+      QString file = frame.firstChildElement( "file" ).text();
+      QString obj  = frame.firstChildElement( "obj" ).text();
+      QString at = file.isEmpty() ? obj
+                 : file + ":" + frame.firstChildElement( "line" ).text();
+      if ( fn.isEmpty() ) {
+         fn = frame.firstChildElement( "ip" ).text();
+      }
+      frames << fn + " " + at;
+
+      if ( name.isEmpty() && !obj.contains( "vgpreload" ) ) {
+         name = fn + ( at.isEmpty() ? QString() : " (" + at + ")" );
+      }
+   }
+   if ( name.isEmpty() ) {
+      name = frames.isEmpty() ? QString( "unknown site" ) : frames.first();
+   }
+
+   QString key = how + "|" + frames.join( "|" );
+   QHash<QString, int>::const_iterator it = m_siteIds.constFind( key );
+   if ( it != m_siteIds.constEnd() ) {
+      return it.value();
+   }
+   int id = m_siteNames.count();
+   m_siteIds.insert( key, id );
+   m_siteNames << how + " in " + name;
+   m_siteErrors.append( QList<QTreeWidgetItem*>() );
+   return id;
+}
+
+
+void VgHeapIndex::ensureTree() const
+{
+   if ( !m_treeStale ) {
+      return;
+   }
+   QVector<QPair<quint64, int> > starts( m_blocks.count() );
+   for ( int b = 0; b < m_blocks.count(); ++b ) {
+      starts[b] = qMakePair( m_blocks.at( b ).start, b );
+   }
+   std::sort( starts.begin(), starts.end() );
+
+   m_byStart.resize( starts.count() );
+   for ( int i = 0; i < starts.count(); ++i ) {
+      m_byStart[i] = starts.at( i ).second;
+   }
+   m_maxEnd.resize( starts.count() );
+   buildTree( 0, m_byStart.count() );
+   m_treeStale = false;
+}
+
+
+/*!
+  Subtree [lo, hi) rooted at its midpoint: returns its highest end.
+  An empty block (malloc( 0 )) still holds its own address.
+*/
+quint64 VgHeapIndex::buildTree( int lo, int hi ) const
+{
+   if ( lo >= hi ) {
+      return 0;
+   }
+   int mid = lo + ( hi - lo ) / 2;
+   const VgHeapBlock& block = m_blocks.at( m_byStart.at( mid ) );
+   quint64 end = block.start + qMax( block.size, ( quint64 )1 );
+   end = qMax( end, buildTree( lo, mid ) );
+   end = qMax( end, buildTree( mid + 1, hi ) );
+   m_maxEnd[mid] = end;
+   return end;
+}
+
+
+void VgHeapIndex::query( int lo, int hi, quint64 addr, QList<int>& found ) const
+{
+   if ( lo >= hi ) {
+      return;
+   }
+   int mid = lo + ( hi - lo ) / 2;
+   if ( m_maxEnd.at( mid ) <= addr ) {
+      return;   // all below end before addr
+   }
+   query( lo, mid, addr, found );
+
+   int b = m_byStart.at( mid );
+   const VgHeapBlock& block = m_blocks.at( b );
+   if ( block.start > addr ) {
+      return;   // this, and all to its right, start after addr
+   }
+   if ( addr < block.start + qMax( block.size, ( quint64 )1 ) ) {
+      found << b;
+   }
+   query( mid + 1, hi, addr, found );
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+** VgHeapIndex definition
+**  - Memcheck's errors by the heap block, and allocation site, they hit
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGHEAPINDEX_H
+#define __VGHEAPINDEX_H
+
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTreeWidgetItem>
+#include <QVector>
+
+
+// ============================================================
+// a heap block, as errors describe it: [start, start + size)
+struct VgHeapBlock
+{
+   quint64 start;
+   quint64 size;
+   int site;                         // its allocation site
+   QList<QTreeWidgetItem*> errors;   // in file order
+};
+
+
+// ============================================================
+/*!
+  VgHeapIndex: built as a Memcheck log is read.
+
+  An invalid read, write or free says where it hit:
+  "Address 0x51f1068 is 0 bytes after a block of size 40 alloc'd",
+  then the stack that allocated (or freed) the block.  From that,
+  each error goes with its block, and the block with its allocation
+  site: thousands of errors on one buffer are one block here.
+
+  Blocks are also kept by address, in an interval tree: the blocks
+  holding an address are found in O(log n + found).  The tree is a
+  sorted array, each midpoint holding the highest end below it; new
+  blocks mark it stale, and it's rebuilt on the next lookup.
+
+  Items are only pointed to: the view owns them.
+*/
+class VgHeapIndex
+{
+public:
+   VgHeapIndex();
+
+   void clear();
+
+   // false: err says nothing of a heap block
+   bool addError( QTreeWidgetItem* item, QDomElement err );
+
+   int blockCount() const {
+      return m_blocks.count();
+   }
+   const VgHeapBlock& block( int b ) const {
+      return m_blocks.at( b );
+   }
+   // -1: none
+   int blockOf( QTreeWidgetItem* error ) const;
+
+   QList<QTreeWidgetItem*> siteErrors( int site ) const;
+   QString siteName( int site ) const;
+
+   // blocks holding addr
+   QList<int> blocksAt( quint64 addr ) const;
+   // those with most errors first
+   QList<int> busiestBlocks( int max ) const;
+
+   // e.g. "0x51f1040, 40 bytes, alloc'd in main (a.c:12)"
+   QString blockName( int b ) const;
+
+private:
+   int site( QDomElement stack, const QString& how );
+   void ensureTree() const;
+   quint64 buildTree( int lo, int hi ) const;
+   void query( int lo, int hi, quint64 addr, QList<int>& found ) const;
+
+private:
+   QVector<VgHeapBlock>         m_blocks;
+   QHash<QString, int>          m_blockIds;   // "start size site"
+   QHash<QTreeWidgetItem*, int> m_errBlocks;
+
+   QHash<QString, int>          m_siteIds;    // top frames
+   QStringList                  m_siteNames;  // by site
+   QVector<QList<QTreeWidgetItem*> > m_siteErrors;
+
+   // the interval tree: blocks by start; highest end per subtree
+   mutable QVector<int>     m_byStart;
+   mutable QVector<quint64> m_maxEnd;
+   mutable bool             m_treeStale;
+};
+
+#endif // __VGHEAPINDEX_H
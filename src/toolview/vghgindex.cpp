@@ -0,0 +1,261 @@
+/****************************************************************************
+** VgHgIndex implementation
+**  - Helgrind's thread announcements, and its races by group
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vghgindex.h"
+#include "utils/vk_utils.h"
+
+#include <QRegExp>
+#include <QStringList>
+
+
+VgHgIndex::VgHgIndex()
+{
+}
+
+
+void VgHgIndex::clear()
+{
+   m_announces.clear();
+   m_threads.clear();
+   m_races.clear();
+   m_byAddr.clear();
+   m_byLocks.clear();
+   m_byThreads.clear();
+}
+
+
+void VgHgIndex::addAnnounce( int tid, QTreeWidgetItem* item )
+{
+   if ( !m_announces.contains( tid ) ) {
+      m_announces.insert( tid, item );
+   }
+}
+
+
+/*!
+  Read once, as the error arrives: its threads, and for a race, its
+  address, lock set and thread pair.
+*/
+void VgHgIndex::addError( QTreeWidgetItem* item, QDomElement err )
+{
+   QList<int> tids = hthreadIds( err );
+   if ( !tids.isEmpty() ) {
+      m_threads.insert( item, tids );
+   }
+
+   if ( err.firstChildElement( "kind" ).text() != "Race" ) {
+      return;
+   }
+
+   RaceKeys keys;
+   keys.addr = raceAddress( err, &keys.hasAddr );
+   bool haveLocks;
+   keys.locks = lockSet( err, &haveLocks );
+   keys.pair = 0;
+
+   // the reporting thread, then the one it conflicts with, if shown
+   if ( tids.count() >= 2 && tids.at( 0 ) != tids.at( 1 ) ) {
+      quint64 lo = qMin( tids.at( 0 ), tids.at( 1 ) );
+      quint64 hi = qMax( tids.at( 0 ), tids.at( 1 ) );
+      keys.pair = ( lo << 32 ) | hi;
+   }
+   m_races.insert( item, keys );
+
+   if ( keys.hasAddr ) {
+      m_byAddr[keys.addr].append( item );
+   }
+   if ( haveLocks ) {
+      m_byLocks[keys.locks].append( item );
+   }
+   if ( keys.pair != 0 ) {
+      m_byThreads[keys.pair].append( item );
+   }
+}
+
+
+QTreeWidgetItem* VgHgIndex::announce( int tid ) const
+{
+   return m_announces.value( tid, 0 );
+}
+
+
+QList<int> VgHgIndex::threads( QTreeWidgetItem* error ) const
+{
+   return m_threads.value( error );
+}
+
+
+bool VgHgIndex::isRace( QTreeWidgetItem* error ) const
+{
+   return m_races.contains( error );
+}
+
+
+QList<QTreeWidgetItem*> VgHgIndex::group( VG_HG::Group g,
+                                          QTreeWidgetItem* error ) const
+{
+   QHash<QTreeWidgetItem*, RaceKeys>::const_iterator it = m_races.constFind( error );
+   if ( it == m_races.constEnd() ) {
+      return QList<QTreeWidgetItem*>();
+   }
+   const RaceKeys& keys = it.value();
+
+   switch ( g ) {
+   case VG_HG::ADDRESS:
+      return m_byAddr.value( keys.addr );
+   case VG_HG::LOCKS:
+      return m_byLocks.value( keys.locks );
+   case VG_HG::THREADS:
+      return m_byThreads.value( keys.pair );
+   default:
+      vk_assert_never_reached();
+      return QList<QTreeWidgetItem*>();
+   }
+}
+
+
+QString VgHgIndex::groupName( VG_HG::Group g, QTreeWidgetItem* error ) const
+{
+   QHash<QTreeWidgetItem*, RaceKeys>::const_iterator it = m_races.constFind( error );
+   if ( it == m_races.constEnd() ) {
+      return QString();
+   }
+   const RaceKeys& keys = it.value();
+
+   switch ( g ) {
+   case VG_HG::ADDRESS:
+      return "address 0x" + QString::number( keys.addr, 16 );
+   case VG_HG::LOCKS:
+      return keys.locks.isEmpty() ? QString( "no locks held" )
+                                  : "locks held at " + keys.locks;
+   case VG_HG::THREADS:
+      return QString( "threads #HG_%1 and #HG_%2" )
+             .arg( keys.pair >> 32 ).arg( keys.pair & 0xffffffff );
+   default:
+      vk_assert_never_reached();
+      return QString();
+   }
+}
+
+
+int VgHgIndex::groupCount( VG_HG::Group g ) const
+{
+   switch ( g ) {
+   case VG_HG::ADDRESS: return m_byAddr.count();
+   case VG_HG::LOCKS:   return m_byLocks.count();
+   case VG_HG::THREADS: return m_byThreads.count();
+   default:
+      vk_assert_never_reached();
+      return 0;
+   }
+}
+
+
+QString VgHgIndex::groupTitle( VG_HG::Group g )
+{
+   switch ( g ) {
+   case VG_HG::ADDRESS: return "Same address";
+   case VG_HG::LOCKS:   return "Same locks held";
+   case VG_HG::THREADS: return "Same threads";
+   default:
+      vk_assert_never_reached();
+      return QString();
+   }
+}
+
+
+/*!
+  "Possible data race during read of size 4 at 0x601040 by thread #1"
+*/
+quint64 VgHgIndex::raceAddress( QDomElement err, bool* ok )
+{
+   static QRegExp rxAddr( " at (0x[0-9A-Fa-f]+)" );
+
+   *ok = false;
+   QString what = err.firstChildElement( "xwhat" ).firstChildElement( "text" ).text();
+   if ( what.isEmpty() ) {
+      what = err.firstChildElement( "what" ).text();
+   }
+   if ( rxAddr.indexIn( what ) == -1 ) {
+      return 0;
+   }
+   return rxAddr.cap( 1 ).toULongLong( ok, 16 );
+}
+
+
+/*!
+  The first "Locks held:" of the error is that of the reporting access:
+  "Locks held: none", or "Locks held: 2, at addresses 0x... 0x...".
+  Lock addresses are sorted: the set, not the order they were taken in.
+  Valgrinds before 3.8 don't say: ok is false.
+*/
+QString VgHgIndex::lockSet( QDomElement err, bool* ok )
+{
+   static QRegExp rxLock( "0x[0-9A-Fa-f]+" );
+
+   *ok = false;
+   for ( QDomElement e = err.firstChildElement(); !e.isNull();
+         e = e.nextSiblingElement() ) {
+      QString text;
+      if ( e.tagName() == "what" || e.tagName() == "auxwhat" ) {
+         text = e.text();
+      }
+      else if ( e.tagName() == "xwhat" || e.tagName() == "xauxwhat" ) {
+         text = e.firstChildElement( "text" ).text();
+      }
+      if ( !text.startsWith( "Locks held:" ) ) {
+         continue;
+      }
+
+      QStringList locks;
+      for ( int pos = 0; ( pos = rxLock.indexIn( text, pos ) ) != -1;
+            pos += rxLock.matchedLength() ) {
+         locks << rxLock.cap( 0 ).toLower();
+      }
+      locks.sort();
+      *ok = true;
+      return locks.join( " " );
+   }
+   return QString();
+}
+
+
+/*!
+  The <hthreadid>s of xwhat and xauxwhats, in file order, no repeats.
+*/
+QList<int> VgHgIndex::hthreadIds( QDomElement err )
+{
+   QList<int> tids;
+   for ( QDomElement e = err.firstChildElement(); !e.isNull();
+         e = e.nextSiblingElement() ) {
+      if ( e.tagName() != "xwhat" && e.tagName() != "xauxwhat" ) {
+         continue;
+      }
+      QDomElement hthreadid = e.firstChildElement( "hthreadid" );
+      if ( hthreadid.isNull() ) {
+         continue;
+      }
+      int tid = hthreadid.text().toInt();
+      if ( !tids.contains( tid ) ) {
+         tids << tid;
+      }
+   }
+   return tids;
+}
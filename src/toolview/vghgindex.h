@@ -0,0 +1,102 @@
+/****************************************************************************
+** VgHgIndex definition
+**  - Helgrind's thread announcements, and its races by group
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGHGINDEX_H
+#define __VGHGINDEX_H
+
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QTreeWidgetItem>
+
+
+// ============================================================
+namespace VG_HG {
+   // what races can be grouped by
+   enum Group {
+      ADDRESS,   // the conflicting address
+      LOCKS,     // the locks held by the reporting access
+      THREADS,   // the two threads, either way round
+      NUM_GROUPS
+   };
+}
+
+
+// ============================================================
+/*!
+  VgHgIndex: built as a Helgrind log is read.
+
+  Maps each thread id to the item announcing it, so a "#HG_N" in an
+  error is a lookup away, not a scroll.  Races are kept by conflicting
+  address, by lock set and by thread pair: the races like a given one
+  are those in its group, got without a pass over all the errors.
+
+  Items are only pointed to: the view owns them, and must clear() us
+  before deleting them.
+*/
+class VgHgIndex
+{
+public:
+   VgHgIndex();
+
+   void clear();
+
+   // first announcement of a thread id wins (merged logs may repeat ids)
+   void addAnnounce( int tid, QTreeWidgetItem* item );
+   // any error: its threads; a race: into its groups
+   void addError( QTreeWidgetItem* item, QDomElement err );
+
+   // 0: not (yet) announced
+   QTreeWidgetItem* announce( int tid ) const;
+   QList<int> threads( QTreeWidgetItem* error ) const;
+
+   bool isRace( QTreeWidgetItem* error ) const;
+   // the races in error's group, in file order; error not a race: none
+   QList<QTreeWidgetItem*> group( VG_HG::Group g, QTreeWidgetItem* error ) const;
+   // e.g. "address 0x601040", for messages
+   QString groupName( VG_HG::Group g, QTreeWidgetItem* error ) const;
+   int groupCount( VG_HG::Group g ) const;
+
+   static QString groupTitle( VG_HG::Group g );
+
+private:
+   static quint64 raceAddress( QDomElement err, bool* ok );
+   static QString lockSet( QDomElement err, bool* ok );
+   static QList<int> hthreadIds( QDomElement err );
+
+private:
+   struct RaceKeys {
+      quint64 addr;
+      QString locks;    // sorted lock addresses; null: not in the log
+      quint64 pair;     // lower tid << 32 | higher; 0: no pair
+      bool hasAddr;
+   };
+
+   QHash<int, QTreeWidgetItem*> m_announces;
+   QHash<QTreeWidgetItem*, QList<int> > m_threads;
+   QHash<QTreeWidgetItem*, RaceKeys>  m_races;
+
+   QHash<quint64, QList<QTreeWidgetItem*> > m_byAddr;
+   QHash<QString, QList<QTreeWidgetItem*> > m_byLocks;
+   QHash<quint64, QList<QTreeWidgetItem*> > m_byThreads;
+};
+
+#endif // __VGHGINDEX_H
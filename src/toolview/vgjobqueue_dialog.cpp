@@ -0,0 +1,232 @@
+/****************************************************************************
+** VgJobQueueDialog implementation
+**  - progress and results of a VgJobQueue
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vgjobqueue_dialog.h"
+#include "utils/vk_messages.h"
+#include "utils/vk_procsampler.h"
+#include "utils/vk_utils.h"
+
+#include <QDialogButtonBox>
+#include <QFile>
+#include <QHeaderView>
+#include <QRegExp>
+#include <QTextStream>
+#include <QVBoxLayout>
+
+
+/*!
+  Dialog showing a job queue's progress: the queue should be
+  set up, but not yet started.
+*/
+VgJobQueueDialog::VgJobQueueDialog( QWidget* parent, VgJobQueue* q )
+   : QDialog( parent ), queue( q )
+{
+   vk_assert( queue != 0 );
+   queue->setParent( this );
+
+   setObjectName( QString::fromUtf8( "VgJobQueueDialog" ) );
+   setWindowTitle( "Job Queue" );
+   resize( 900, 500 );
+
+   QVBoxLayout* topVLayout = new QVBoxLayout( this );
+
+   // progress
+   progress = new QProgressBar( this );
+   progress->setRange( 0, queue->numJobs() );
+   progress->setValue( 0 );
+   progress->setFormat( "%v / %m jobs" );
+   topVLayout->addWidget( progress );
+
+   totalsLabel = new QLabel( this );
+   topVLayout->addWidget( totalsLabel );
+
+   // one row per job
+   treeView = new QTreeWidget( this );
+   treeView->setObjectName( QString::fromUtf8( "treeview_JobQueue" ) );
+   treeView->setRootIsDecorated( false );
+   treeView->setColumnCount( NUM_COLS );
+   treeView->setHeaderLabels( QStringList() << "Job" << "State" << "Time (s)"
+                              << "Peak RSS" << "Errors" << "Suppressed" << "Target" );
+   treeView->header()->setStretchLastSection( true );
+   for ( int i = 0; i < queue->numJobs(); ++i ) {
+      QTreeWidgetItem* item = new QTreeWidgetItem( treeView );
+      item->setText( COL_JOB, QString::number( i + 1 ) );
+      item->setText( COL_TARGET, queue->job( i ).description() );
+      for ( int col = COL_JOB; col < COL_TARGET; ++col ) {
+         item->setTextAlignment( col, Qt::AlignRight );
+      }
+      updateItem( i );
+   }
+   connect( treeView, SIGNAL( itemActivated( QTreeWidgetItem*, int ) ),
+            this,     SLOT( itemActivated( QTreeWidgetItem*, int ) ) );
+   topVLayout->addWidget( treeView );
+
+   // buttons
+   QDialogButtonBox* buttonBox = new QDialogButtonBox( this );
+   buttonBox->setObjectName( QString::fromUtf8( "buttonBox" ) );
+   buttonBox->setStandardButtons( QDialogButtonBox::Close );
+   cancelButton = buttonBox->addButton( "Cancel Jobs", QDialogButtonBox::ActionRole );
+   connect( cancelButton, SIGNAL( clicked() ), this, SLOT( cancelJobs() ) );
+   connect( buttonBox, SIGNAL( rejected() ), this, SLOT( reject() ) );
+   topVLayout->addWidget( buttonBox );
+
+   connect( queue, SIGNAL( jobStarted( int ) ),  this, SLOT( jobStarted( int ) ) );
+   connect( queue, SIGNAL( jobFinished( int ) ), this, SLOT( jobFinished( int ) ) );
+   connect( queue, SIGNAL( finished() ),         this, SLOT( queueFinished() ) );
+
+   connect( &clock, SIGNAL( timeout() ), this, SLOT( updateTotals() ) );
+   clock.start( 1000 );
+   updateTotals();
+}
+
+
+/*!
+  The queue goes with us: its destructor cancels (and waits on)
+  any jobs still running.
+*/
+VgJobQueueDialog::~VgJobQueueDialog()
+{
+   clock.stop();
+}
+
+
+void VgJobQueueDialog::updateItem( int idx )
+{
+   const VgJob& job = queue->job( idx );
+   QTreeWidgetItem* item = treeView->topLevelItem( idx );
+   vk_assert( item != 0 );
+
+   item->setText( COL_STATE, VgJob::stateName( job.state ) );
+   if ( job.state == VGJOB::QUEUED || job.state == VGJOB::RUNNING ) {
+      return;
+   }
+
+   item->setText( COL_TIME, QString::number( job.elapsedMs / 1000.0, 'f', 1 ) );
+   if ( job.peakRssKB > 0 ) {
+      item->setText( COL_RSS, VkProcSampler::bytesString( job.peakRssKB * 1024 ) );
+   }
+   if ( job.state == VGJOB::DONE ) {
+      item->setText( COL_ERRORS, QString::number( job.numErrors ) );
+      item->setText( COL_SUPPRESSED, QString::number( job.numSuppressed ) );
+   }
+
+   QString tip = job.outFile;
+   if ( !job.logFiles.isEmpty() ) {
+      tip = job.logFiles.join( "\n" ) + "\n" + tip;
+   }
+   if ( !job.errMsg.isEmpty() ) {
+      tip = job.errMsg + "\n" + tip;
+   }
+   for ( int col = 0; col < NUM_COLS; ++col ) {
+      item->setToolTip( col, tip );
+   }
+
+   if ( job.state == VGJOB::FAILED || ( job.state == VGJOB::DONE && job.numErrors > 0 ) ) {
+      QFont fnt = item->font( COL_STATE );
+      fnt.setBold( true );
+      item->setFont( COL_STATE, fnt );
+      item->setFont( COL_ERRORS, fnt );
+   }
+}
+
+
+void VgJobQueueDialog::jobStarted( int idx )
+{
+   updateItem( idx );
+}
+
+
+void VgJobQueueDialog::jobFinished( int idx )
+{
+   updateItem( idx );
+   progress->setValue( queue->numFinished() );
+   updateTotals();
+}
+
+
+void VgJobQueueDialog::queueFinished()
+{
+   clock.stop();
+   cancelButton->setEnabled( false );
+   updateTotals();
+}
+
+
+void VgJobQueueDialog::updateTotals()
+{
+   totalsLabel->setText(
+      QString( "Running: %1 (up to %2 at once)    Done: %3    Failed: %4    "
+               "Cancelled: %5    Time: %6s\n"
+               "Errors: %7 (%8 distinct)    Suppressed: %9\n"
+               "Logs: %10" )
+      .arg( queue->numInState( VGJOB::RUNNING ) )
+      .arg( queue->maxJobs() )
+      .arg( queue->numInState( VGJOB::DONE ) )
+      .arg( queue->numInState( VGJOB::FAILED ) )
+      .arg( queue->numInState( VGJOB::CANCELLED ) )
+      .arg( queue->elapsedMs() / 1000 )
+      .arg( queue->totalErrors() )
+      .arg( queue->numErrorKinds() )
+      .arg( queue->totalSuppressed() )
+      .arg( queue->logDir() ) );
+}
+
+
+void VgJobQueueDialog::cancelJobs()
+{
+   queue->cancel();
+   cancelButton->setEnabled( false );
+}
+
+
+/*!
+  View a finished job's log: several logs (tracing children)
+  are merged, via a log list next to them.
+*/
+void VgJobQueueDialog::itemActivated( QTreeWidgetItem* item, int )
+{
+   int idx = treeView->indexOfTopLevelItem( item );
+   vk_assert( idx != -1 );
+   const VgJob& job = queue->job( idx );
+
+   // a job's results are only ours once it's finished
+   if ( job.state != VGJOB::DONE || job.logFiles.isEmpty() ) {
+      return;
+   }
+   if ( job.logFiles.count() == 1 ) {
+      emit viewLog( job.logFiles.first() );
+      return;
+   }
+
+   QString loglist = job.outFile;
+   loglist.replace( QRegExp( "\\.out$" ), ".loglist" );
+   QFile file( loglist );
+   if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) ) {
+      vkError( this, "Job Queue", "<p>Failed to write log list '%s'</p>",
+               qPrintable( loglist ) );
+      return;
+   }
+   QTextStream strm( &file );
+   foreach ( QString log, job.logFiles ) {
+      strm << log << endl;
+   }
+   file.close();
+   emit viewLogList( loglist );
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+** VgJobQueueDialog definition
+**  - progress and results of a VgJobQueue
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGJOBQUEUE_DIALOG_H
+#define __VGJOBQUEUE_DIALOG_H
+
+#include "utils/vgjobqueue.h"
+
+#include <QDialog>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+
+
+// ============================================================
+/*!
+  VgJobQueueDialog: one row per job, with its state, time, peak RSS,
+  and error / suppressed counts, plus the queue's progress and totals.
+  Activating a finished job's row asks for its log(s) to be viewed.
+  The dialog owns the queue: closing it cancels any jobs still to run.
+*/
+class VgJobQueueDialog : public QDialog
+{
+   Q_OBJECT
+public:
+   VgJobQueueDialog( QWidget* parent, VgJobQueue* queue );
+   ~VgJobQueueDialog();
+
+signals:
+   void viewLog( QString logFilename );
+   void viewLogList( QString loglistFilename );
+
+private slots:
+   void jobStarted( int idx );
+   void jobFinished( int idx );
+   void queueFinished();
+   void updateTotals();
+   void cancelJobs();
+   void itemActivated( QTreeWidgetItem* item, int col );
+
+private:
+   enum Column { COL_JOB = 0, COL_STATE, COL_TIME, COL_RSS, COL_ERRORS,
+                 COL_SUPPRESSED, COL_TARGET, NUM_COLS };
+   void updateItem( int idx );
+
+private:
+   VgJobQueue*   queue;       // we own this: parented to us
+   QTreeWidget*  treeView;
+   QProgressBar* progress;
+   QLabel*       totalsLabel;
+   QPushButton*  cancelButton;
+   QTimer        clock;       // for the elapsed time
+};
+
+#endif // __VGJOBQUEUE_DIALOG_H
@@ -0,0 +1,285 @@
+/****************************************************************************
+** VgLockGraph implementation
+**  - lock acquisition order, from Helgrind's LockOrder errors
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vglockgraph.h"
+#include "utils/vk_utils.h"
+
+#include <QPair>
+#include <QRegExp>
+
+#include <algorithm>
+
+
+VgLockGraph::VgLockGraph()
+{
+   clear();
+}
+
+
+void VgLockGraph::clear()
+{
+   m_nodes.clear();
+   m_locks.clear();
+   m_parent.clear();
+   m_ord.clear();
+   m_out.clear();
+   m_in.clear();
+   m_members.clear();
+   m_errors.clear();
+   m_nextOrd = 0;
+   m_numCycles = 0;
+}
+
+
+/*!
+  'Thread #HG_1: lock order "0x601040 before 0x601080" violated'
+*/
+bool VgLockGraph::addError( QTreeWidgetItem* item, QDomElement err )
+{
+   static QRegExp rxOrder( "\"(0x[0-9A-Fa-f]+) before (0x[0-9A-Fa-f]+)\"" );
+
+   if ( err.firstChildElement( "kind" ).text() != "LockOrder" ) {
+      return false;
+   }
+   QString what = err.firstChildElement( "xwhat" ).firstChildElement( "text" ).text();
+   if ( what.isEmpty() ) {
+      what = err.firstChildElement( "what" ).text();
+   }
+   if ( rxOrder.indexIn( what ) == -1 ) {
+      VK_DEBUG( "LockOrder error without a lock order: %s", qPrintable( what ) );
+      return false;
+   }
+
+   bool ok1, ok2;
+   quint64 first  = rxOrder.cap( 1 ).toULongLong( &ok1, 16 );
+   quint64 second = rxOrder.cap( 2 ).toULongLong( &ok2, 16 );
+   if ( !ok1 || !ok2 || first == second ) {
+      return false;
+   }
+
+   int a = node( first );
+   int b = node( second );
+   addEdge( a, b );   // the order established
+   addEdge( b, a );   // the acquisition that broke it
+
+   // both ways round: they're one node now
+   int r = find( a );
+   vk_assert( r == find( b ) );
+   m_errors[r].append( item );
+   return true;
+}
+
+
+QList<VgLockGraph::Cycle> VgLockGraph::cycles() const
+{
+   QList<Cycle> all;
+   for ( int n = 0; n < m_parent.count(); ++n ) {
+      if ( find( n ) != n || m_members.at( n ).count() < 2 ) {
+         continue;
+      }
+      Cycle cycle;
+      foreach ( int member, m_members.at( n ) ) {
+         cycle.locks << m_locks.at( member );
+      }
+      std::sort( cycle.locks.begin(), cycle.locks.end() );
+      cycle.errors = m_errors.at( n );
+      all << cycle;
+   }
+   std::stable_sort( all.begin(), all.end(), moreErrors );
+   return all;
+}
+
+
+int VgLockGraph::node( quint64 lock )
+{
+   QHash<quint64, int>::const_iterator it = m_nodes.constFind( lock );
+   if ( it != m_nodes.constEnd() ) {
+      return it.value();
+   }
+
+   // a new lock: nothing after it yet, so last will do
+   int n = m_locks.count();
+   m_nodes.insert( lock, n );
+   m_locks.append( lock );
+   m_parent.append( n );
+   m_ord.append( m_nextOrd++ );
+   m_out.append( QSet<int>() );
+   m_in.append( QSet<int>() );
+   m_members.append( QList<int>() << n );
+   m_errors.append( QList<QTreeWidgetItem*>() );
+   return n;
+}
+
+
+int VgLockGraph::find( int n ) const
+{
+   while ( m_parent.at( n ) != n ) {
+      m_parent[n] = m_parent.at( m_parent.at( n ) );   // path halving
+      n = m_parent.at( n );
+   }
+   return n;
+}
+
+
+/*!
+  An edge with the order costs nothing.  Against it: search forward
+  from 'to' and back from 'from', within the region between them in
+  the order.  Forward reaching 'from' is a cycle: the nodes both
+  searches met are on it, and are merged.  Then the region's places
+  are dealt out again: those reaching 'from' first, then the merged
+  node, if any, then those reached from 'to'.
+*/
+void VgLockGraph::addEdge( int from, int to )
+{
+   int u = find( from );
+   int v = find( to );
+   if ( u == v ) {
+      return;
+   }
+   m_out[u].insert( v );
+   m_in[v].insert( u );
+   if ( m_ord.at( u ) < m_ord.at( v ) ) {
+      return;
+   }
+
+   QSet<int> fwd, bwd;
+   search( v, m_ord.at( u ), true, fwd );
+   search( u, m_ord.at( v ), false, bwd );
+
+   QSet<int> onCycle;
+   if ( fwd.contains( u ) ) {
+      onCycle = fwd;
+      onCycle.intersect( bwd );
+   }
+
+   QList<int> places;
+   QList<QPair<int, int> > before, after;   // (ord, node)
+   foreach ( int n, bwd ) {
+      places << m_ord.at( n );
+      if ( !onCycle.contains( n ) ) {
+         before << qMakePair( m_ord.at( n ), n );
+      }
+   }
+   foreach ( int n, fwd ) {
+      if ( !bwd.contains( n ) ) {
+         places << m_ord.at( n );
+      }
+      if ( !onCycle.contains( n ) ) {
+         after << qMakePair( m_ord.at( n ), n );
+      }
+   }
+   std::sort( places.begin(), places.end() );
+   std::sort( before.begin(), before.end() );
+   std::sort( after.begin(), after.end() );
+
+   // a merge leaves places over: those before take the lowest, those
+   // after the highest, so neither crosses a node outside the region
+   for ( int i = 0; i < before.count(); ++i ) {
+      m_ord[before.at( i ).second] = places.at( i );
+   }
+   if ( !onCycle.isEmpty() ) {
+      m_ord[merge( onCycle )] = places.at( before.count() );
+   }
+   int firstAfter = places.count() - after.count();
+   for ( int i = 0; i < after.count(); ++i ) {
+      m_ord[after.at( i ).second] = places.at( firstAfter + i );
+   }
+}
+
+
+/*!
+  Forward: nodes reachable from start, up to bound in the order.
+  Back: nodes reaching start, down to bound.  Start included.
+*/
+void VgLockGraph::search( int start, int bound, bool forward,
+                          QSet<int>& seen ) const
+{
+   QList<int> stack;
+   stack << start;
+   seen.insert( start );
+   while ( !stack.isEmpty() ) {
+      int n = stack.takeLast();
+      foreach ( int next, forward ? m_out.at( n ) : m_in.at( n ) ) {
+         int r = find( next );
+         if ( r == n || seen.contains( r ) ) {
+            continue;
+         }
+         if ( forward ? m_ord.at( r ) > bound : m_ord.at( r ) < bound ) {
+            continue;
+         }
+         seen.insert( r );
+         stack << r;
+      }
+   }
+}
+
+
+/*!
+  Nodes on a cycle become one: returns its rep.
+*/
+int VgLockGraph::merge( const QSet<int>& nodes )
+{
+   int r = *nodes.constBegin();
+   int cyclesBefore = 0;
+   foreach ( int n, nodes ) {
+      if ( m_members.at( n ).count() >= 2 ) {
+         cyclesBefore++;
+      }
+      if ( n == r ) {
+         continue;
+      }
+      m_parent[n] = r;
+      m_out[r].unite( m_out.at( n ) );
+      m_in[r].unite( m_in.at( n ) );
+      m_members[r] += m_members.at( n );
+      m_errors[r]  += m_errors.at( n );
+      m_out[n].clear();
+      m_in[n].clear();
+      m_members[n].clear();
+      m_errors[n].clear();
+   }
+   m_out[r] = reps( m_out.at( r ), r );
+   m_in[r]  = reps( m_in.at( r ), r );
+
+   m_numCycles += 1 - cyclesBefore;
+   return r;
+}
+
+
+/*!
+  Edges' far ends, as reps, without those now inside self.
+*/
+QSet<int> VgLockGraph::reps( const QSet<int>& nodes, int self ) const
+{
+   QSet<int> result;
+   foreach ( int n, nodes ) {
+      int r = find( n );
+      if ( r != self ) {
+         result.insert( r );
+      }
+   }
+   return result;
+}
+
+
+bool VgLockGraph::moreErrors( const Cycle& a, const Cycle& b )
+{
+   return a.errors.count() > b.errors.count();
+}
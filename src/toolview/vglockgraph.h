@@ -0,0 +1,100 @@
+/****************************************************************************
+** VgLockGraph definition
+**  - lock acquisition order, from Helgrind's LockOrder errors
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOCKGRAPH_H
+#define __VGLOCKGRAPH_H
+
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTreeWidgetItem>
+#include <QVector>
+
+
+// ============================================================
+/*!
+  VgLockGraph: which lock was taken before which, as Helgrind's
+  LockOrder errors tell it, built as the log is read.
+
+  An error 'lock order "A before B" violated' is two edges: A -> B,
+  the order established, and B -> A, the acquisition that broke it.
+  Locks in a cycle are merged into one node, a strongly connected
+  component: each deadlock hazard is shown once, however many errors
+  hit it, with all those errors attached.
+
+  Cycles are found as edges come in, without a pass over the graph:
+  the merged nodes are kept in a topological order, and an edge that
+  agrees with it costs nothing.  One that doesn't is searched from
+  only as far as the order's affected region (Pearce & Kelly); then
+  either the region is reordered, or the nodes on the cycle merged.
+
+  Items are only pointed to: the view owns them.
+*/
+class VgLockGraph
+{
+public:
+   // a deadlock hazard: its locks, and the errors about them
+   struct Cycle {
+      QList<quint64> locks;
+      QList<QTreeWidgetItem*> errors;
+   };
+
+   VgLockGraph();
+
+   void clear();
+
+   // a LockOrder error: its edges, and any cycle they close.
+   // false: not a LockOrder error, or its locks not found
+   bool addError( QTreeWidgetItem* item, QDomElement err );
+
+   // each once, those with most errors first
+   QList<Cycle> cycles() const;
+   int cycleCount() const {
+      return m_numCycles;
+   }
+
+private:
+   int  node( quint64 lock );
+   int  find( int n ) const;
+   void addEdge( int from, int to );
+   void search( int start, int bound, bool forward, QSet<int>& seen ) const;
+   int  merge( const QSet<int>& nodes );
+   QSet<int> reps( const QSet<int>& nodes, int self ) const;
+
+   static bool moreErrors( const Cycle& a, const Cycle& b );
+
+private:
+   QHash<quint64, int> m_nodes;   // lock address -> node
+   QVector<quint64>    m_locks;   // by node
+
+   // union-find over nodes: a merged cycle's nodes point to its rep.
+   // The rest are by rep only.
+   mutable QVector<int> m_parent;
+   QVector<int>         m_ord;    // topological order
+   QVector<QSet<int> >  m_out, m_in;
+   QVector<QList<int> > m_members;
+   QVector<QList<QTreeWidgetItem*> > m_errors;
+
+   int m_nextOrd;
+   int m_numCycles;
+};
+
+#endif // __VGLOCKGRAPH_H
@@ -0,0 +1,113 @@
+/****************************************************************************
+** VgLogDiffDialog implementation
+**  - shows the result of a run-to-run log comparison
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vglogdiff_dialog.h"
+#include "utils/vk_utils.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QVBoxLayout>
+
+
+/*!
+  Dialog showing new / fixed / persisting errors between two logs.
+*/
+VgLogDiffDialog::VgLogDiffDialog( QWidget* parent, VgLogDiff* diff )
+   : QDialog( parent )
+{
+   vk_assert( diff != 0 );
+
+   setObjectName( QString::fromUtf8( "VgLogDiffDialog" ) );
+   setWindowTitle( "Log Comparison" );
+   resize( 800, 500 );
+
+   QVBoxLayout* topVLayout = new QVBoxLayout( this );
+
+   // summary text
+   QLabel* topText = new QLabel( this );
+   topText->setText( QString( "Baseline: %1\nCurrent:  %2\n\n"
+                              "New: %3    Fixed: %4    Persisting: %5" )
+                     .arg( diff->baseLog() )
+                     .arg( diff->newLog() )
+                     .arg( diff->numEntries( VGLOGDIFF::NEW ) )
+                     .arg( diff->numEntries( VGLOGDIFF::FIXED ) )
+                     .arg( diff->numEntries( VGLOGDIFF::PERSISTING ) ) );
+   topVLayout->addWidget( topText );
+
+   // results
+   treeView = new QTreeWidget( this );
+   treeView->setObjectName( QString::fromUtf8( "treeview_LogDiff" ) );
+   treeView->setColumnCount( 4 );
+   treeView->setHeaderLabels( QStringList() << "Error"
+                              << "Baseline" << "Current" << "Delta" );
+   treeView->header()->setSectionResizeMode( 0, QHeaderView::Stretch );
+   treeView->header()->setStretchLastSection( false );
+   topVLayout->addWidget( treeView );
+
+   // buttons
+   QDialogButtonBox* buttonBox = new QDialogButtonBox( this );
+   buttonBox->setObjectName( QString::fromUtf8( "buttonBox" ) );
+   buttonBox->setStandardButtons( QDialogButtonBox::Close );
+   connect( buttonBox, SIGNAL( rejected() ), this, SLOT( reject() ) );
+   topVLayout->addWidget( buttonBox );
+
+   populate( diff );
+}
+
+
+/*!
+  One branch per diff state; entries are already sorted by state,
+  biggest count changes first.
+*/
+void VgLogDiffDialog::populate( VgLogDiff* diff )
+{
+   const char* titles[VGLOGDIFF::NUM_STATES] = {
+      "New errors", "Fixed errors", "Persisting errors"
+   };
+
+   QTreeWidgetItem* branches[VGLOGDIFF::NUM_STATES];
+   for ( int i = 0; i < VGLOGDIFF::NUM_STATES; ++i ) {
+      branches[i] = new QTreeWidgetItem( treeView );
+      branches[i]->setText( 0, QString( "%1 (%2)" ).arg( titles[i] )
+                            .arg( diff->numEntries( ( VGLOGDIFF::DiffState )i ) ) );
+      QFont fnt = branches[i]->font( 0 );
+      fnt.setBold( true );
+      branches[i]->setFont( 0, fnt );
+   }
+
+   foreach( const VgLogDiffEntry & entry, diff->entries() ) {
+      QTreeWidgetItem* item = new QTreeWidgetItem( branches[entry.state] );
+      QString txt = entry.kind + ": " + entry.what;
+      if ( !entry.topFrame.isEmpty() ) {
+         txt += "\n   at " + entry.topFrame;
+      }
+      item->setText( 0, txt );
+      item->setText( 1, QString::number( entry.countOld ) );
+      item->setText( 2, QString::number( entry.countNew ) );
+      item->setText( 3, ( entry.delta() > 0 ? "+" : "" ) + QString::number( entry.delta() ) );
+      for ( int col = 1; col < 4; ++col ) {
+         item->setTextAlignment( col, Qt::AlignRight | Qt::AlignTop );
+      }
+   }
+
+   // new errors are what we're most interested in.
+   branches[VGLOGDIFF::NEW]->setExpanded( true );
+}
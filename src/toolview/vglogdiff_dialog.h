@@ -0,0 +1,44 @@
+/****************************************************************************
+** VgLogDiffDialog definition
+**  - shows the result of a run-to-run log comparison
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGDIFF_DIALOG_H
+#define __VGLOGDIFF_DIALOG_H
+
+#include "utils/vglogdiff.h"
+
+#include <QDialog>
+#include <QTreeWidget>
+
+
+// ============================================================
+class VgLogDiffDialog : public QDialog
+{
+   Q_OBJECT
+public:
+   VgLogDiffDialog( QWidget* parent, VgLogDiff* diff );
+
+private:
+   void populate( VgLogDiff* diff );
+
+private:
+   QTreeWidget* treeView;
+};
+
+#endif // __VGLOGDIFF_DIALOG_H
@@ -21,10 +21,13 @@
 #include "toolview/vglogview.h"
 #include "utils/vk_utils.h"
 #include "utils/vk_config.h"
+#include "utils/vk_srccache.h"
+#include "utils/vk_trace.h"
 
 #include <QFileInfo>
 #include <QStringList>
 #include <QTextStream>
+#include <QTimer>
 
 
 
@@ -86,6 +89,10 @@ static ElemTypeMap setupElemTypeMap()
    etmap["skaux"]            = VG_ELEM::SKAUX;
    etmap["sframe"]           = VG_ELEM::SFRAME;
    etmap["rawtext"]          = VG_ELEM::RAWTEXT;
+   etmap["mergedlogs"]       = VG_ELEM::MERGEDLOGS;
+   etmap["mergedlog"]        = VG_ELEM::MERGEDLOG;
+   etmap["pidcounts"]        = VG_ELEM::PIDCOUNTS;
+   etmap["resourceusage"]    = VG_ELEM::RESOURCEUSAGE;
    return etmap;
 }
 
@@ -138,10 +145,25 @@ VgOutputItem::VgOutputItem( QTreeWidgetItem* parent, QTreeWidgetItem* after,
    initialise();
 }
 
+VgOutputItem::~VgOutputItem()
+{
+   VkTrace::instance()->addCount( VKTRACE::ITEMS_ALIVE, -1 );
+}
+
 void VgOutputItem::initialise()
 {
    isReadable = isWriteable = false;
    isExpandable = false;
+   sortRank = 0;
+   VkTrace::instance()->addCount( VKTRACE::ITEMS_ALIVE, 1 );
+}
+
+/*!
+  Siblings are only ever sorted by the ranks given them.
+*/
+bool VgOutputItem::operator<( const QTreeWidgetItem& other ) const
+{
+   return sortRank < static_cast<const VgOutputItem&>( other ).sortRank;
 }
 
 void VgOutputItem::setText( QString str )
@@ -177,7 +199,10 @@ void VgOutputItem::openChildren()
    }
 
    // load children (overloaded by each item)
-   setupChildren();
+   {
+      VK_TRACE_SCOPE( VKTRACE::OPEN_ITEM );
+      setupChildren();
+   }
 
    // now we've loaded any child items from the model,
    // we can open the item without jitter.
@@ -235,6 +260,9 @@ void TopStatusItem::updateText()
                 .arg( time_str )                                  // time
                 .arg( num_errs )
                 .arg( toolstatus_str );
+   if ( !resources_str.isEmpty() ) {
+      status_str += "\n" + resources_str;
+   }
 
    setText( status_str );
 }
@@ -304,18 +332,32 @@ void TopStatusItem::updateStatus( QDomElement status )
    }
 }
 
-void TopStatusItem::updateFromErrorCounts( QDomElement errcnts )
+void TopStatusItem::updateFromErrorCounts( QDomElement errcnts, int stream/*=0*/ )
 {
    // sum all counts in all pairs of errorcounts
-   num_errs = 0;
+   int errs = 0;
    QDomNodeList pairs = errcnts.childNodes();
    QDomElement e = pairs.item( 0 ).toElement();
 
    for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
       QString count = e.firstChildElement().text();
-      num_errs += count.toInt();
+      errs += count.toInt();
    }
 
+   // each process has its own errorcounts: total them all
+   stream_errs[stream] = errs;
+   num_errs = 0;
+   foreach ( int n, stream_errs ) {
+      num_errs += n;
+   }
+
+   updateText();
+}
+
+// live resource usage, while valgrind runs: empty to clear
+void TopStatusItem::updateResources( QString resources )
+{
+   resources_str = resources;
    updateText();
 }
 
@@ -333,6 +375,7 @@ void TopStatusItem::updateFromErrorCounts( QDomElement errcnts )
    - comment: as text line
    - args
    - details: as text lines
+   - resourceusage: as text lines (valkyrie's own)
 */
 InfoItem::InfoItem( VgOutputItem* parent, QDomElement root /*element:ROOT*/ )
    : VgOutputItem( parent, root )
@@ -377,9 +420,29 @@ void InfoItem::setupChildren()
       QDomElement args = elem.firstChildElement( "args" );
       last_item = new ArgsItem( this, last_item, args );
       last_item->openChildren();
+
+      // added by us, once the run's over
+      QDomElement res = elem.firstChildElement( "resourceusage" );
+      if ( ! res.isNull() ) {
+         addResourceUsage( res );
+      }
    }
 }
 
+void InfoItem::addResourceUsage( QDomElement res )
+{
+   VgOutputItem* res_item = new VgOutputItem( this, child( childCount() - 1 ), res );
+   res_item->setText( "resource usage" );
+
+   VgOutputItem* last_item = 0;
+   QDomElement e = res.firstChildElement( "value" );
+   for ( ; !e.isNull(); e = e.nextSiblingElement( "value" ) ) {
+      last_item = new VgOutputItem( res_item, last_item, e );
+      last_item->setText( e.text() );
+   }
+   res_item->setExpanded( true );
+}
+
 
 
 // ============================================================
@@ -641,12 +704,31 @@ void ErrorItem::setupChildren()
             break;
          }
 
+         case VG_ELEM::PIDCOUNTS: {
+            // merged logs: count per process
+            QStringList counts;
+            QDomElement pair = e.firstChildElement( "pair" );
+            for ( ; !pair.isNull(); pair = pair.nextSiblingElement( "pair" ) ) {
+               counts << QString( "==%1== x%2" )
+                         .arg( pair.firstChildElement( "pid" ).text() )
+                         .arg( pair.firstChildElement( "count" ).text() );
+            }
+            last_item = new VgOutputItem( this, last_item, e );
+            last_item->setText( "Per process: " + counts.join( ", " ) );
+            break;
+         }
+
          default:
             vkPrintErr( "ErrorItem::setupChildren(): unexpected tagName: %s",
                         qPrintable( e.tagName() ) );
             break;
          }
       }
+
+      // made afresh, after being dropped while closed: as they were
+      if ( fullSrcPathShown ) {
+         showFullSrcPath( true );
+      }
    }
 }
 
@@ -880,6 +962,8 @@ SrcItem::SrcItem( VgOutputItem* parent, QDomElement line, QString path )
    }
 
    // num lines to show above / below the target line
+   VK_TRACE_SCOPE( VKTRACE::SRC_IO );
+
    bool ok = false;
    int n_lines = vkCfgProj->value( "valkyrie/src-lines" ).toInt( &ok );
    if ( !ok ) {
@@ -892,29 +976,17 @@ SrcItem::SrcItem( VgOutputItem* parent, QDomElement line, QString path )
       top_line = target_line - n_lines;
    }
    int bot_line = target_line + n_lines;
-   int current_line = 1;
 
-   QFile file( path );
-   if ( !file.open( QIODevice::ReadOnly ) ) {
+   // read once, for all logs: see VkSrcCache
+   QStringList lines;
+   if ( !VkSrcCache::instance()->lines( path, top_line, bot_line, lines ) ) {
       return;
    }
 
-   // TODO: faster to set file pos using QFile::at(offset)
    QString src_lines;
-   QTextStream stream( &file );
-
-   while ( !stream.atEnd() && ( current_line <= bot_line ) ) {
-      if ( current_line < top_line ) {
-         stream.readLine();   // skip lines to top_line
-      }
-      else {
-         src_lines += "  " + stream.readLine() + "\n";
-      }
-
-      current_line++;
+   foreach ( QString src_line, lines ) {
+      src_lines += "  " + src_line + "\n";
    }
-
-   file.close();
    src_lines.truncate( src_lines.length() - 1 ); // remove last newline
 
    // --- setup item ---
@@ -1004,12 +1076,56 @@ void SuppCountsItem::setupChildren()
 
 
 
+// ============================================================
+/*!
+  MergedLogsItem
+   - mergedlogs
+   - mergedlog: as text line: pid, error count, log file
+*/
+MergedLogsItem::MergedLogsItem( VgOutputItem* parent,
+                                QTreeWidgetItem* after,
+                                QDomElement ml )
+   : VgOutputItem( parent, after, ml )
+{
+   int num_logs = 0;
+   QDomElement e = elem.firstChildElement( "mergedlog" );
+   for ( ; !e.isNull(); e = e.nextSiblingElement( "mergedlog" ) ) {
+      num_logs++;
+   }
+
+   setText( QString( "Merged logs: %1 processes" ).arg( num_logs ) );
+
+   isExpandable = true;
+}
+
+void MergedLogsItem::setupChildren()
+{
+   if ( childCount() == 0 ) {
+      VgOutputItem* child_item = 0;
+      QDomElement e = elem.firstChildElement( "mergedlog" );
+      for ( ; !e.isNull(); e = e.nextSiblingElement( "mergedlog" ) ) {
+         QString str = QString( "==%1==  errors: %2  (%3)" )
+                       .arg( e.firstChildElement( "pid" ).text() )
+                       .arg( e.firstChildElement( "count" ).text() )
+                       .arg( e.firstChildElement( "file" ).text() );
+
+         child_item = new VgOutputItem( this, child_item, e );
+         child_item->setText( str );
+      }
+   }
+}
+
+
+
+
+
 // ============================================================
 /*!
   VgLogView
 */
 VgLogView::VgLogView( QTreeWidget* v )
-   : lastItem( 0 ), view( v )
+   : lastItem( 0 ), topStatus( 0 ), infoItem( 0 ), view( v ),
+     errorsAt( 0 ), placedSinceMerge( 0 ), mergePending( false )
 {}
 
 VgLogView::~VgLogView()
@@ -1054,6 +1170,8 @@ bool VgLogView::init( QDomProcessingInstruction xml_insn, QString doc_tag )
 */
 bool VgLogView::appendNode( QDomNode node, QString& errMsg )
 {
+   VK_TRACE_SCOPE( VKTRACE::APPEND_NODE );
+   VkTrace::instance()->addCount( VKTRACE::RECORDS, 1 );
    errMsg = "";
 
    // Test node validity, and attempt to populate QDomDocument model first
@@ -1129,7 +1247,7 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
          topStatus = createTopStatus( view, exe, status, protocol.text() );
          topStatus->setExpanded( true );
 
-         lastItem = new InfoItem( topStatus, logRoot() );
+         lastItem = infoItem = new InfoItem( topStatus, logRoot() );
          lastItem->setChildIndicatorPolicy( QTreeWidgetItem::ShowIndicator );
 
          QDomElement preamble = logRoot().firstChildElement( "preamble" );
@@ -1156,7 +1274,23 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
    }
 
    case VG_ELEM::SUPPCOUNTS: {
-      lastItem = new SuppCountsItem( topStatus, lastItem, elem );
+      lastItem = new SuppCountsItem( topStatus, lastTopChild(), elem );
+      topItemAdded( lastItem );
+      suppCountsElems[-1] = elem;
+      break;
+   }
+
+   case VG_ELEM::MERGEDLOGS: {
+      lastItem = new MergedLogsItem( topStatus, lastTopChild(), elem );
+      topItemAdded( lastItem );
+      break;
+   }
+
+   case VG_ELEM::RESOURCEUSAGE: {
+      // a saved run's: children already set up won't look again
+      if ( infoItem && infoItem->childCount() != 0 ) {
+         infoItem->addResourceUsage( elem );
+      }
       break;
    }
 
@@ -1168,7 +1302,7 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
 
    // --------------------
    // Allow tools to do stuff with elem, a-la "Template Method".
-   if ( ! appendNodeTool( elem, errMsg ) ) {
+   if ( ! timedAppendNodeTool( elem, errMsg ) ) {
       return false;
    }
 
@@ -1183,6 +1317,204 @@ bool VgLogView::appendNode( QDomNode node, QString& errMsg )
 }
 
 
+/*!
+  As appendNode(), for the log of a child process (--trace-children=yes),
+  read by its own parser, identified by stream (> 0).
+   - the child's preamble and status are dropped: the main log's are shown.
+   - error uniques are only unique per process, so are renamed "pid:unique",
+     and each error gets a <pidcounts> child, to show where it came from.
+*/
+bool VgLogView::appendChildNode( int stream, QDomNode node, QString& errMsg )
+{
+   VK_TRACE_SCOPE( VKTRACE::APPEND_NODE );
+   VkTrace::instance()->addCount( VKTRACE::RECORDS, 1 );
+   errMsg = "";
+   vk_assert( stream > 0 );
+
+   if ( !isStarted() ) {
+      errMsg = "Program error: child log started before main log";
+      vkPrintErr( "%s", qPrintable( "VgLogView::appendChildNode(): " + errMsg ) );
+      return false;
+   }
+
+   QDomElement elem = node.toElement();
+   if ( elem.isNull() ) {
+      errMsg = "XML Node not an element (" + node.firstChild().nodeValue() + ")";
+      vkPrintErr( "%s", qPrintable( "VgLogView::appendChildNode(): " + errMsg ) );
+      return false;
+   }
+
+   QString pid = streamPids.value( stream );
+
+   switch ( VgOutputItem::elemType( elem.tagName() ) ) {
+   case VG_ELEM::PROTOCOL_VERSION: {
+      if ( elem.text() != "4" ) {
+         errMsg = "Unsupported XML protocol version: (" + elem.text() + ")";
+         vkPrintErr( "%s", qPrintable( "VgLogView::appendChildNode(): " + errMsg ) );
+         return false;
+      }
+      return true;
+   }
+
+   case VG_ELEM::PROTOCOL_TOOL: {
+      QString tool = this->toolName();
+      if ( elem.text() != tool ) {
+         errMsg = "Wrong tool (" + tool + ") for XML stream (" + elem.text() + ")";
+         vkPrintErr( "%s", qPrintable( "VgLogView::appendChildNode(): " + errMsg ) );
+         return false;
+      }
+      return true;
+   }
+
+   case VG_ELEM::PID: {
+      streamPids.insert( stream, elem.text() );
+      return true;
+   }
+
+   case VG_ELEM::ERROR: {
+      QDomElement unique = elem.firstChildElement( "unique" );
+      QString child_unique = pid + ":" + unique.text();
+      unique.firstChild().setNodeValue( child_unique );
+
+      QDomElement pidcounts = vglog.createElement( "pidcounts" );
+      QDomElement pair  = vglog.createElement( "pair" );
+      QDomElement count = vglog.createElement( "count" );
+      QDomElement epid  = vglog.createElement( "pid" );
+      count.appendChild( vglog.createTextNode( "1" ) );
+      epid.appendChild( vglog.createTextNode( pid ) );
+      pair.appendChild( count );
+      pair.appendChild( epid );
+      pidcounts.appendChild( pair );
+      elem.appendChild( pidcounts );
+
+      childCounts.insert( child_unique, count );
+      break;
+   }
+
+   case VG_ELEM::ERRORCOUNTS: {
+      if ( elem.childNodes().count() == 0 ) { // ignore empty errorcounts
+         return true;
+      }
+
+      QDomElement pair = elem.firstChildElement( "pair" );
+      for ( ; !pair.isNull(); pair = pair.nextSiblingElement( "pair" ) ) {
+         QDomElement unique = pair.firstChildElement( "unique" );
+         QString child_unique = pid + ":" + unique.text();
+         unique.firstChild().setNodeValue( child_unique );
+
+         QDomElement count = childCounts.value( child_unique );
+         if ( !count.isNull() ) {
+            count.firstChild().setNodeValue( pair.firstChildElement( "count" ).text() );
+         }
+      }
+
+      logRoot().appendChild( node );
+      topStatus->updateFromErrorCounts( elem, stream );
+      updateErrorItems( elem );
+      return true;
+   }
+
+   case VG_ELEM::ANNOUNCETHREAD:
+   case VG_ELEM::SUPPCOUNTS:
+      break;
+
+   default:
+      // preamble, status etc: we show the main log's.
+      return true;
+   }
+
+   // reparent node
+   QDomNode n = logRoot().appendChild( node );
+   if ( n.isNull() ) {
+      errMsg = "Program error: Failed to reparent node: (" + elem.tagName() + ")";
+      vkPrintErr( "%s", qPrintable( "VgLogView::appendChildNode(): " + errMsg ) );
+      return false;
+   }
+
+   if ( elem.tagName() == "suppcounts" ) {
+      lastItem = new SuppCountsItem( topStatus, lastTopChild(), elem );
+      topItemAdded( lastItem );
+      suppCountsElems[stream] = elem;
+   }
+   else if ( ! timedAppendNodeTool( elem, errMsg ) ) {
+      return false;
+   }
+
+   if ( lastItem ) {
+      lastItem->setChildIndicatorPolicy( QTreeWidgetItem::ShowIndicator );
+   }
+
+   return true;
+}
+
+
+/*!
+   Per-suppression hit counts of this run: name -> count,
+   summed over the main log and any child-process streams.
+   Valgrind only lists the suppressions that were used.
+   Returns false if no suppcounts were seen (e.g. the run was killed).
+*/
+bool VgLogView::suppCounts( QHash<QString, int>& counts )
+{
+   counts.clear();
+   foreach ( QDomElement elem, suppCountsElems ) {
+      QDomElement pair = elem.firstChildElement( "pair" );
+      for ( ; !pair.isNull(); pair = pair.nextSiblingElement( "pair" ) ) {
+         QString name = pair.firstChildElement( "name" ).text().simplified();
+         counts[name] += pair.firstChildElement( "count" ).text().toInt();
+      }
+   }
+   return !suppCountsElems.isEmpty();
+}
+
+
+/*!
+   Live resource usage of the run, shown under the top status.
+*/
+void VgLogView::updateResources( QString liveText )
+{
+   if ( topStatus ) {
+      topStatus->updateResources( liveText );
+   }
+}
+
+
+/*!
+   The run's resource usage summary, one line per <value>, kept as
+   <resourceusage> under the log's root: shown by the info item.
+   Replaces the live text.
+*/
+void VgLogView::setResourceSummary( QStringList summary )
+{
+   if ( !topStatus || summary.isEmpty() ) {
+      return;
+   }
+   topStatus->updateResources( QString() );
+
+   QDomElement res = vglog.createElement( "resourceusage" );
+   foreach ( QString line, summary ) {
+      QDomElement value = vglog.createElement( "value" );
+      value.appendChild( vglog.createTextNode( line ) );
+      res.appendChild( value );
+   }
+   logRoot().appendChild( res );
+
+   // children already set up: won't look again
+   if ( infoItem->childCount() != 0 ) {
+      infoItem->addResourceUsage( res );
+   }
+}
+
+
+/*!
+   The <resourceusage> set by setResourceSummary(): null if none.
+*/
+QDomElement VgLogView::resourceSummary()
+{
+   return logRoot().firstChildElement( "resourceusage" );
+}
+
+
 /*!
    document element: <valgrindoutput/>
 */
@@ -1192,23 +1524,30 @@ QDomElement VgLogView::logRoot()
 }
 
 
+/*!
+  appendNodeTool(), timed on its own: the tool logview's share of
+  appendNode().
+*/
+bool VgLogView::timedAppendNodeTool( QDomElement elem, QString& errMsg )
+{
+   VK_TRACE_SCOPE( VKTRACE::APPEND_NODE_TOOL );
+   return appendNodeTool( elem, errMsg );
+}
+
+
 /*!
   iterate over all errors in the listview, looking for a match on
   error->unique with ecounts->pairList->unique.  if we find a match,
-  update the error's num_times value
+  update the error's num_times value.
+  Errors not in ecounts are left be: they may be from another process.
 */
 void VgLogView::updateErrorItems( QDomElement ec )
 {
-   for ( int i=0; i<topStatus->childCount(); ++i ) {
-      VgOutputItem* vgItem = (VgOutputItem*)topStatus->child( i );
-
-      if ( vgItem->elemType() != VG_ELEM::ERROR ) {
-         continue;
-      }
+   VK_TRACE_SCOPE( VKTRACE::UPDATE_ERRORS );
+   for ( int seq = 0; seq < errItems.count(); ++seq ) {
+      ErrorItem* vgItemError = errItems.at( seq );
 
-      ErrorItem* vgItemError = ( ErrorItem* )vgItem;
-
-      QString count = "1"; // can't have less than 1 for a reported error
+      QString count;
       QString err_unique = vgItemError->getElement().firstChildElement().text();
 
       // search errorcount pairs for err_unique
@@ -1224,7 +1563,137 @@ void VgLogView::updateErrorItems( QDomElement ec )
          }
       }
 
-      vgItemError->updateCount( count );
+      if ( !count.isEmpty() ) {
+         vgItemError->updateCount( count );
+         errorSort.setCount( seq, count.toULongLong() );
+      }
+   }
+
+   if ( errorSort.sortsBy( VG_SORT::COUNT ) ) {
+      sortErrors( errorSort.spec() );
+   }
+}
+
+
+/*!
+  Put a tool's new error in place, among topStatus's children.
+
+  In file order, it goes last, after whatever came before it in the
+  log.  Otherwise, errors arriving a few at a time (while running) go
+  straight into place; many at once (reading a log), after the others,
+  then all merged in once the event loop gets a look in.
+*/
+void VgLogView::addErrorItem( ErrorItem* item )
+{
+   int seq = errorSort.add( item->getElement() );
+   errItems.append( item );
+   errArrivals.append( topStatus->childCount() );
+   if ( seq == 0 ) {
+      errorsAt = topStatus->childCount();
+   }
+
+   if ( errorSort.isFileOrder() ) {
+      errorSort.place( seq );
+      topStatus->addChild( item );
+   }
+   else if ( unplacedErrors.isEmpty() && placedSinceMerge < 64 ) {
+      int pos = errorSort.place( seq );
+      topStatus->insertChild( errorsAt + pos, item );
+      placedSinceMerge++;
+   }
+   else {
+      topStatus->insertChild( errorsAt + seq, item );
+      unplacedErrors.append( seq );
+   }
+
+   if ( !mergePending && !errorSort.isFileOrder() ) {
+      mergePending = true;
+      QTimer::singleShot( 0, this, SLOT( mergeUnplacedErrors() ) );
+   }
+}
+
+
+void VgLogView::mergeUnplacedErrors()
+{
+   mergePending = false;
+   placedSinceMerge = 0;
+   if ( unplacedErrors.isEmpty() ) {
+      return;
+   }
+
+   errorSort.placeAll( unplacedErrors );
+   unplacedErrors.clear();
+   applyErrorOrder();
+}
+
+
+/*!
+  Sort all errors afresh, by spec.  Before the log is read, just
+  sets the order for the errors to come.
+*/
+void VgLogView::sortErrors( const VgErrorSortSpec& spec )
+{
+   errorSort.setSpec( spec );
+   unplacedErrors.clear();
+   {
+      VK_TRACE_SCOPE( VKTRACE::SORT_ERRORS );
+      errorSort.sort();
+   }
+   applyErrorOrder();
+}
+
+
+/*!
+  Reorder topStatus's children to errorSort's order: the items before
+  the first error stay put.  In file order, the rest go back to where
+  they came in the log; sorted, the errors follow in order, then the
+  items that came among or after them, in file order.
+  Done by the view's model (via ranks), so open, hidden, current and
+  selected items stay so.
+*/
+void VgLogView::applyErrorOrder()
+{
+   if ( topStatus == 0 || errItems.isEmpty() ) {
+      return;
+   }
+   VK_TRACE_SCOPE( VKTRACE::ORDER_ERRORS );
+
+   bool fileOrder = errorSort.isFileOrder();
+   const QVector<int>& order = errorSort.order();
+   for ( int pos = 0; pos < order.count(); ++pos ) {
+      int seq = order.at( pos );
+      errItems.at( seq )->setSortRank( fileOrder ? errArrivals.at( seq ) : errorsAt + pos );
+   }
+   for ( int i = 0; i < laterItems.count(); ++i ) {
+      laterItems.at( i ).second->setSortRank( fileOrder ? laterItems.at( i ).first :
+                                              errorsAt + errItems.count() + i );
+   }
+   for ( int i = 0; i < errorsAt; ++i ) {
+      ( ( VgOutputItem* )topStatus->child( i ) )->setSortRank( i );
+   }
+
+   topStatus->sortChildren( 0, Qt::AscendingOrder );
+}
+
+
+/*!
+  Non-error items go last: after everything, in file order, and after
+  the errors when sorted.
+*/
+QTreeWidgetItem* VgLogView::lastTopChild()
+{
+   return topStatus->child( topStatus->childCount() - 1 );
+}
+
+
+/*!
+  A non-error item, just made after lastTopChild(): noted for
+  applyErrorOrder() if it came after the first error.
+*/
+void VgLogView::topItemAdded( VgOutputItem* item )
+{
+   if ( !errItems.isEmpty() ) {
+      laterItems.append( qMakePair( topStatus->childCount() - 1, item ) );
    }
 }
 
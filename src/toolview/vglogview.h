@@ -21,6 +21,8 @@
 #ifndef __VK_VGLOGVIEW_H
 #define __VK_VGLOGVIEW_H
 
+#include "toolview/vgerrorsort.h"
+
 #include <QColor>
 #include <QDateTime>
 #include <QObject>
@@ -33,6 +35,7 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QList>
+#include <QPair>
 #include <QHash>
 #include <QString>
 
@@ -41,6 +44,8 @@
 // Forward decls
 class VgOutputItem;
 class TopStatusItem;
+class InfoItem;
+class ErrorItem;
 
 
 // ============================================================
@@ -67,6 +72,10 @@ class TopStatusItem;
       Children of top-level items are created only when the user opens
       the branch. the QDomElement refs held by item are then queried
       to fill the item data.
+
+    - Errors are kept in a sort order (file order by default), with
+      the other items before or after them: each error's sort keys are
+      read as it arrives (VgErrorSort), so a re-sort is of those alone.
 */
 class VgLogView : public QObject
 {
@@ -77,26 +86,81 @@ public:
 
    bool init( QDomProcessingInstruction xml_insn, QString doc_tag );
    bool appendNode( QDomNode node, QString& errMsg );
+   bool appendChildNode( int stream, QDomNode node, QString& errMsg );
+
+   // true once the main log has given us a TopStatusItem
+   bool isStarted() {
+      return topStatus != 0;
+   }
+
+   bool suppCounts( QHash<QString, int>& counts );
+
+   // resource usage of the valgrind process tree, while / once run
+   void updateResources( QString liveText );
+   void setResourceSummary( QStringList summary );
+   QDomElement resourceSummary();
+
+   // errors: in this order from now on
+   void sortErrors( const VgErrorSortSpec& spec );
+   int errorCount() {
+      return errItems.count();
+   }
 
 //TODO: needed?
 //   QString toString( int indent = 2 ); // xml output
 
+protected:
+   // tools' new errors: made unparented, put in place here
+   void addErrorItem( ErrorItem* item );
+   // tools' other new top-level items: made after lastTopChild(),
+   // then passed to topItemAdded()
+   QTreeWidgetItem* lastTopChild();
+   void topItemAdded( VgOutputItem* item );
+
 protected:
    // keep track of our progress
    VgOutputItem*  lastItem;
    TopStatusItem* topStatus;
+   InfoItem*      infoItem;
+
+private slots:
+   void mergeUnplacedErrors();
 
 private:
    virtual QString toolName() = 0;
    virtual bool appendNodeTool( QDomElement elem, QString& errMsg ) = 0;
    virtual TopStatusItem* createTopStatus( QTreeWidget* view, QDomElement exe,
                                            QDomElement status, QString _protocol ) = 0;
+   bool timedAppendNodeTool( QDomElement elem, QString& errMsg );
    void updateErrorItems( QDomElement ec );
+   void applyErrorOrder();
    QDomElement logRoot();
 
 private:
    QDomDocument vglog;
    QTreeWidget* view;    // we don't own this: don't cleanup
+
+   // child-process streams: stream -> pid
+   QHash<int, QString> streamPids;
+   // child-process error unique -> its pidcounts::pair::count
+   QHash<QString, QDomElement> childCounts;
+   // the last suppcounts per stream: main log = -1
+   QHash<int, QDomElement> suppCountsElems;
+
+   // errors by seq (file order), and when sorted: topStatus's
+   // children [errorsAt, errorsAt + errItems.count()).  In file order,
+   // they're among the other items, where they came in the log.
+   QVector<ErrorItem*> errItems;
+   QVector<int> errArrivals;            // by seq: topStatus child no.
+   VgErrorSort errorSort;
+   int errorsAt;
+   // non-error items that came after the first error, with their
+   // child no.: after the errors when sorted
+   QVector< QPair<int, VgOutputItem*> > laterItems;
+   // errors after the sorted ones, to be merged in
+   QVector<int> unplacedErrors;
+   int placedSinceMerge;
+   bool mergePending;
 };
 
 
@@ -114,6 +178,8 @@ namespace VG_ELEM {
       ERRORCOUNTS, ANNOUNCETHREAD, HTHREADID, PAIR, COUNT,
       SUPPCOUNTS, NAME, LEAKEDBYTES, LEAKEDBLOCKS,
       SUPPRESSION, SNAME, SKIND, SKAUX, SFRAME, RAWTEXT,
+      MERGEDLOGS, MERGEDLOG, PIDCOUNTS,   // valkyrie's own: merged logs
+      RESOURCEUSAGE,                      //   and process resource usage
       NUM_ELEMS
    };
 }
@@ -142,6 +208,7 @@ public:
    VgOutputItem( QTreeWidget* parent, QDomElement );
    VgOutputItem( QTreeWidgetItem* parent, QDomElement );
    VgOutputItem( QTreeWidgetItem* parent, QTreeWidgetItem* after, QDomElement );
+   virtual ~VgOutputItem();
 
    void setText( QString str );
 
@@ -157,6 +224,12 @@ public:
    static VG_ELEM::ElemType elemType( QString tagName );
    VG_ELEM::ElemType elemType();
 
+   // parent's sortChildren() order: see VgLogView::applyErrorOrder()
+   void setSortRank( int rank ) {
+      sortRank = rank;
+   }
+   bool operator<( const QTreeWidgetItem& other ) const;
+
    // getters
    bool getIsExpandable();
    bool getIsReadable();
@@ -167,6 +240,7 @@ protected:
    bool isReadable, isWriteable;
    QDomElement elem;               // associated element
    bool isExpandable;
+   int sortRank;
 
 private:
    void initialise();
@@ -183,7 +257,8 @@ public:
                               QDomElement status, QString toolstatus,
                               QString _protocol );
    void updateStatus( QDomElement status );
-   void updateFromErrorCounts( QDomElement ec );
+   void updateFromErrorCounts( QDomElement ec, int stream = 0 );
+   void updateResources( QString resources );
 
    // all tool TopStatusItems must implement this:
    virtual void updateToolStatus( QDomElement ) = 0;
@@ -196,9 +271,12 @@ protected:
    int num_errs;
 
 private:
+   QHash<int, int> stream_errs;   // per (child-process) stream
+
    QString state_str, start_time, time_str;
    QString protocol;
    QString status_tmplt, status_str;
+   QString resources_str;         // live process resource usage
 };
 
 
@@ -210,6 +288,7 @@ public:
    InfoItem( VgOutputItem* parent, QDomElement root );
 
    void setupChildren();
+   void addResourceUsage( QDomElement res );
 };
 
 
@@ -319,6 +398,17 @@ public:
 };
 
 
+// ============================================================
+class MergedLogsItem : public VgOutputItem
+{
+public:
+   MergedLogsItem( VgOutputItem* parent, QTreeWidgetItem* after,
+                   QDomElement ml );
+
+   void setupChildren();
+};
+
+
 
 
 // ============================================================
@@ -0,0 +1,157 @@
+/****************************************************************************
+** VkMetricsDialog implementation
+**  - the session's load/parse/view timings and counters
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "toolview/vkmetrics_dialog.h"
+#include "utils/vk_procsampler.h"
+#include "utils/vk_trace.h"
+#include "utils/vk_utils.h"
+
+#include <QCoreApplication>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+
+static QString msecs( qint64 ns )
+{
+   return QString::number( ns / 1000000.0, 'f', 1 );
+}
+
+
+VkMetricsDialog::VkMetricsDialog( QWidget* parent )
+   : QDialog( parent ), m_lastBytes( 0 ), m_lastRecords( 0 ), m_lastNs( 0 )
+{
+   setObjectName( QString::fromUtf8( "VkMetricsDialog" ) );
+   setWindowTitle( "Performance Metrics" );
+   resize( 700, 400 );
+
+   QVBoxLayout* topVLayout = new QVBoxLayout( this );
+
+   ratesLabel = new QLabel( this );
+   ratesLabel->setTextInteractionFlags( Qt::TextSelectableByMouse );
+   topVLayout->addWidget( ratesLabel );
+
+   // one row per section
+   treeView = new QTreeWidget( this );
+   treeView->setObjectName( QString::fromUtf8( "treeview_Metrics" ) );
+   treeView->setRootIsDecorated( false );
+   treeView->setColumnCount( NUM_COLS );
+   treeView->setHeaderLabels( QStringList() << "Section" << "Calls" << "Total (ms)"
+                              << "Mean (ms)" << "Max (ms)" << "Of session" );
+   for ( int s = 0; s < VKTRACE::NUM_SECTIONS; ++s ) {
+      QTreeWidgetItem* item = new QTreeWidgetItem( treeView );
+      item->setText( COL_SECTION, VkTrace::sectionName( ( VKTRACE::Section )s ) );
+      for ( int col = COL_CALLS; col < NUM_COLS; ++col ) {
+         item->setTextAlignment( col, Qt::AlignRight );
+      }
+   }
+   treeView->setToolTip( "Nested sections are part of the sections they're in:\n"
+                         "appendNodeTool and updateErrorItems of appendNode,\n"
+                         "appendNode of parse and parseContinue." );
+   topVLayout->addWidget( treeView );
+
+   traceLabel = new QLabel( this );
+   topVLayout->addWidget( traceLabel );
+   VkTrace* trace = VkTrace::instance();
+   if ( trace->isTracing() ) {
+      traceLabel->setText( "Tracing to: " + trace->traceFile() + " (written on exit)" );
+   }
+   else {
+      traceLabel->setText( "Not tracing: start valkyrie with --trace-out=<file.json>" );
+   }
+
+   // buttons
+   QDialogButtonBox* buttonBox = new QDialogButtonBox( this );
+   buttonBox->setObjectName( QString::fromUtf8( "buttonBox" ) );
+   buttonBox->setStandardButtons( QDialogButtonBox::Close );
+   QPushButton* resetButton = buttonBox->addButton( "Reset", QDialogButtonBox::ResetRole );
+   connect( resetButton, SIGNAL( clicked() ), this, SLOT( resetMetrics() ) );
+   connect( buttonBox, SIGNAL( rejected() ), this, SLOT( reject() ) );
+   topVLayout->addWidget( buttonBox );
+
+   m_lastNs = trace->now();
+   m_lastBytes = trace->count( VKTRACE::BYTES_READ );
+   m_lastRecords = trace->count( VKTRACE::RECORDS );
+
+   connect( &clock, SIGNAL( timeout() ), this, SLOT( updateMetrics() ) );
+   clock.start( 1000 );
+   updateMetrics();
+}
+
+
+VkMetricsDialog::~VkMetricsDialog()
+{
+   clock.stop();
+}
+
+
+void VkMetricsDialog::updateMetrics()
+{
+   VkTrace* trace = VkTrace::instance();
+   qint64 nowNs = trace->now();
+   qint64 sessionNs = trace->sinceResetNs();
+
+   for ( int s = 0; s < VKTRACE::NUM_SECTIONS; ++s ) {
+      const VkTraceStats& stats = trace->stats( ( VKTRACE::Section )s );
+      QTreeWidgetItem* item = treeView->topLevelItem( s );
+      item->setText( COL_CALLS, QString::number( stats.calls ) );
+      item->setText( COL_TOTAL, msecs( stats.totalNs ) );
+      item->setText( COL_MEAN, stats.calls ? msecs( stats.totalNs / stats.calls ) : QString( "-" ) );
+      item->setText( COL_MAX, msecs( stats.maxNs ) );
+      item->setText( COL_SHARE, sessionNs > 0 ?
+                     QString::number( stats.totalNs * 100.0 / sessionNs, 'f', 1 ) + "%" :
+                     QString( "-" ) );
+   }
+
+   // rates: since the last update
+   qint64 bytes = trace->count( VKTRACE::BYTES_READ );
+   qint64 records = trace->count( VKTRACE::RECORDS );
+   double secs = ( nowNs - m_lastNs ) / 1e9;
+   QString bytesRate = "-", recordsRate = "-";
+   if ( secs > 0 ) {
+      bytesRate = VkProcSampler::bytesString( ( qint64 )( ( bytes - m_lastBytes ) / secs ) ) + "/s";
+      recordsRate = QString::number( ( qint64 )( ( records - m_lastRecords ) / secs ) ) + "/s";
+   }
+   m_lastNs = nowNs;
+   m_lastBytes = bytes;
+   m_lastRecords = records;
+
+   qint64 pid = QCoreApplication::applicationPid();
+   QStringList lines;
+   lines << QString( "Log read: %1 (%2 in all)   Records: %3 (%4 in all)" )
+            .arg( bytesRate ).arg( VkProcSampler::bytesString( bytes ) )
+            .arg( recordsRate ).arg( records );
+   lines << QString( "Unparsed backlog: %1   Items alive: %2" )
+            .arg( VkProcSampler::bytesString( trace->count( VKTRACE::BACKLOG ) ) )
+            .arg( trace->count( VKTRACE::ITEMS_ALIVE ) );
+   lines << QString( "Memory: %1 resident, %2 peak" )
+            .arg( VkProcSampler::bytesString( VkProcSampler::currentRssKB( pid ) * 1024 ) )
+            .arg( VkProcSampler::bytesString( VkProcSampler::peakRssKB( pid ) * 1024 ) );
+   ratesLabel->setText( lines.join( "\n" ) );
+}
+
+
+void VkMetricsDialog::resetMetrics()
+{
+   VkTrace::instance()->reset();
+   m_lastBytes = m_lastRecords = 0;
+   updateMetrics();
+}
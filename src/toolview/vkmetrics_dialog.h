@@ -0,0 +1,62 @@
+/****************************************************************************
+** VkMetricsDialog definition
+**  - the session's load/parse/view timings and counters
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VKMETRICS_DIALOG_H
+#define __VKMETRICS_DIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTimer>
+#include <QTreeWidget>
+
+
+// ============================================================
+/*!
+  VkMetricsDialog: what VkTrace has measured this session, updated
+  every second: one row per timed section (calls, total, mean, max),
+  and the rates and levels: log bytes/s and records/s over the last
+  second, the unparsed backlog, items alive, and our memory use.
+*/
+class VkMetricsDialog : public QDialog
+{
+   Q_OBJECT
+public:
+   VkMetricsDialog( QWidget* parent );
+   ~VkMetricsDialog();
+
+private slots:
+   void updateMetrics();
+   void resetMetrics();
+
+private:
+   enum Column { COL_SECTION = 0, COL_CALLS, COL_TOTAL, COL_MEAN,
+                 COL_MAX, COL_SHARE, NUM_COLS };
+
+private:
+   QTreeWidget* treeView;
+   QLabel*      ratesLabel;
+   QLabel*      traceLabel;
+   QTimer       clock;
+
+   // the last update's counts and time, for the rates
+   qint64 m_lastBytes, m_lastRecords, m_lastNs;
+};
+
+#endif // __VKMETRICS_DIALOG_H
@@ -0,0 +1,472 @@
+/****************************************************************************
+** VgCapabilities implementation
+**  - what an installed valgrind can do: version, tools, their flags
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgcapabilities.h"
+#include "utils/vk_config.h"
+#include "utils/vk_utils.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QProcess>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThreadPool>
+
+// how long one valgrind --version / --help may take
+#define CAPS_PROBE_TIMEOUT 10000  // msecs
+
+// bump if the cache file format changes
+#define CAPS_CACHE_VERSION 1
+
+
+/*!
+  The tools we look for: valgrind can't list its own.
+*/
+static QStringList knownTools()
+{
+   return QStringList() << "memcheck" << "helgrind" << "drd" << "cachegrind"
+                        << "callgrind" << "massif" << "dhat" << "lackey"
+                        << "none" << "exp-sgcheck" << "exp-dhat" << "exp-bbv";
+}
+
+
+/*!
+  Run valgrind with args, and give its output (stdout + stderr).
+*/
+static bool runVg( const QString& vgPath, const QStringList& args,
+                   QByteArray& output )
+{
+   QProcess proc;
+   proc.setProcessChannelMode( QProcess::MergedChannels );
+   proc.start( vgPath, args );
+   if ( !proc.waitForFinished( CAPS_PROBE_TIMEOUT ) ) {
+      proc.kill();
+      proc.waitForFinished( -1 );
+      return false;
+   }
+   output = proc.readAll();
+   return proc.exitStatus() == QProcess::NormalExit && proc.exitCode() == 0;
+}
+
+
+
+
+/**********************************************************************/
+/* VgCapabilities */
+
+/*!
+  Does tool take flag? "valgrind": do any of the tools take it -
+  i.e. it's a core flag.
+  Not having been probed, we don't know: so yes.
+*/
+bool VgCapabilities::supportsFlag( const QString& tool, const QString& flag ) const
+{
+   if ( !isValid() ) {
+      return true;
+   }
+   if ( tool == "valgrind" ) {
+      foreach ( const QSet<QString>& flags, toolFlags ) {
+         if ( flags.contains( flag ) ) {
+            return true;
+         }
+      }
+      return false;
+   }
+   return toolFlags.value( tool ).contains( flag );
+}
+
+
+/*!
+  vgExec as an absolute path: looked for in $PATH if need be.
+  Empty if there's no such executable.
+*/
+QString VgCapabilities::resolvePath( const QString& vgExec )
+{
+   QString path = vgExec.isEmpty() ? QString( "valgrind" ) : vgExec;
+   if ( !path.contains( '/' ) ) {
+      path = QStandardPaths::findExecutable( path );
+   }
+   if ( path.isEmpty() ) {
+      return path;
+   }
+   return QFileInfo( path ).absoluteFilePath();
+}
+
+
+/*!
+  mtime of the binary itself, not of any link to it: a new valgrind
+  installed behind the same /usr/bin/valgrind is new to us.
+  0 if it's gone.
+*/
+qint64 VgCapabilities::binaryMtime( const QString& vgPath )
+{
+   QFileInfo fi( vgPath );
+   QString canonical = fi.canonicalFilePath();
+   if ( canonical.isEmpty() ) {
+      return 0;
+   }
+   return QFileInfo( canonical ).lastModified().toMSecsSinceEpoch() / 1000;
+}
+
+
+bool VgCapabilities::isFresh() const
+{
+   return isValid() && mtime != 0 && binaryMtime( vgPath ) == mtime;
+}
+
+
+/*!
+  Find out what the valgrind at vgPath can do: runs it, so this is
+  for a non-gui thread, or when there's no gui.
+*/
+bool VgCapabilities::probe( const QString& vgPath, VgCapabilities& caps,
+                            QString& errMsg )
+{
+   caps = VgCapabilities();
+   caps.vgPath = vgPath;
+   caps.mtime = binaryMtime( vgPath );
+
+   QByteArray output;
+   if ( !runVg( vgPath, QStringList( "--version" ), output ) ) {
+      errMsg = "Failed to run '" + vgPath + " --version'";
+      return false;
+   }
+   QString version = QString( output ).simplified();
+   if ( !version.startsWith( "valgrind" ) ) {
+      errMsg = "'" + vgPath + "' is not valgrind: its --version gave '" + version + "'";
+      return false;
+   }
+   int versionHex = strVersion2hex( version );
+   if ( versionHex == -1 ) {
+      errMsg = "Can't make out valgrind's version from '" + version + "'";
+      return false;
+   }
+
+   // the flags: indented, at the start of a line of the help.
+   // --help-debug: as --help, plus the rarer flags valgrind still takes
+   QRegExp rxFlag( "^\\s+--([A-Za-z0-9][A-Za-z0-9-]*)" );
+   foreach ( QString tool, knownTools() ) {
+      if ( !runVg( vgPath, QStringList() << "--tool=" + tool << "--help-debug", output ) ) {
+         continue;   // no such tool
+      }
+      QSet<QString> flags;
+      foreach ( QByteArray line, output.split( '\n' ) ) {
+         if ( rxFlag.indexIn( QString( line ) ) != -1 ) {
+            flags.insert( rxFlag.cap( 1 ) );
+         }
+      }
+      caps.toolFlags.insert( tool, flags );
+   }
+   if ( caps.toolFlags.isEmpty() ) {
+      errMsg = "'" + vgPath + "' has none of the tools we know of";
+      return false;
+   }
+
+   caps.version = version;
+   caps.versionHex = versionHex;
+   return true;
+}
+
+
+QString VgCapabilities::cacheFile( const QString& vgPath )
+{
+   QString key = QCryptographicHash::hash( vgPath.toUtf8(), QCryptographicHash::Sha1 )
+                 .toHex().left( 16 );
+   return VkCfg::cfgDir() + "vgcaps_" + key + ".cache";
+}
+
+
+/*!
+  Cache file format, one item per line, tab separated:
+   - version  <CAPS_CACHE_VERSION>
+   - path     <vgPath>
+   - mtime    <secs>
+   - valgrind <version string>
+   - tool     <name>  <flag> <flag> ...
+  Fails if there's no cache for vgPath, or it's stale.
+*/
+bool VgCapabilities::load( const QString& path )
+{
+   *this = VgCapabilities();
+
+   QFile file( cacheFile( path ) );
+   if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
+      return false;
+   }
+
+   QTextStream strm( &file );
+   while ( !strm.atEnd() ) {
+      QStringList fields = strm.readLine().split( '\t' );
+      if ( fields.count() < 2 ) {
+         continue;
+      }
+      const QString& key = fields.at( 0 );
+      if ( key == "version" ) {
+         if ( fields.at( 1 ).toInt() != CAPS_CACHE_VERSION ) {
+            *this = VgCapabilities();
+            return false;
+         }
+      }
+      else if ( key == "path" ) {
+         vgPath = fields.at( 1 );
+      }
+      else if ( key == "mtime" ) {
+         mtime = fields.at( 1 ).toLongLong();
+      }
+      else if ( key == "valgrind" ) {
+         version = fields.at( 1 );
+         versionHex = strVersion2hex( version );
+      }
+      else if ( key == "tool" ) {
+         QSet<QString> flags;
+         if ( fields.count() > 2 ) {
+            flags = fields.at( 2 ).split( ' ', QString::SkipEmptyParts ).toSet();
+         }
+         toolFlags.insert( fields.at( 1 ), flags );
+      }
+   }
+
+   // a hash clash, or an old valgrind
+   if ( vgPath != path || !isFresh() ) {
+      *this = VgCapabilities();
+      return false;
+   }
+   return true;
+}
+
+
+bool VgCapabilities::save( QString& errMsg ) const
+{
+   vk_assert( isValid() );
+
+   QSaveFile file( cacheFile( vgPath ) );
+   if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+      errMsg = "Failed to write valgrind capability cache: '" + file.fileName() + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   strm << "version\t" << CAPS_CACHE_VERSION << "\n";
+   strm << "path\t" << vgPath << "\n";
+   strm << "mtime\t" << mtime << "\n";
+   strm << "valgrind\t" << version << "\n";
+   QStringList tools = toolFlags.keys();
+   tools.sort();
+   foreach ( QString tool, tools ) {
+      QStringList flags = toolFlags.value( tool ).toList();
+      flags.sort();
+      strm << "tool\t" << tool << "\t" << flags.join( " " ) << "\n";
+   }
+   strm.flush();
+
+   if ( !file.commit() ) {
+      errMsg = "Failed to write valgrind capability cache: '" + file.fileName() + "'";
+      return false;
+   }
+   return true;
+}
+
+
+
+
+/**********************************************************************/
+/* VgCapsProber */
+VgCapsProber::VgCapsProber( VgCapsCache* cache, const QString& vgPath )
+   : m_cache( cache ), m_vgPath( vgPath )
+{ }
+
+
+void VgCapsProber::run()
+{
+   VgCapabilities caps;
+   QString errMsg;
+   bool ok = VgCapabilities::probe( m_vgPath, caps, errMsg );
+   if ( ok ) {
+      // failing to cache it only costs us a probe next time
+      QString saveErr;
+      if ( !caps.save( saveErr ) ) {
+         vkPrintErr( "%s", qPrintable( saveErr ) );
+      }
+   }
+
+   QMetaObject::invokeMethod( m_cache, "proberDone", Qt::QueuedConnection,
+                              Q_ARG( QString, m_vgPath ), Q_ARG( bool, ok ),
+                              Q_ARG( QString, errMsg ) );
+}
+
+
+
+
+/**********************************************************************/
+/* VgCapsCache */
+
+/*!
+  The one cache: first asked for from the gui thread, which it lives in.
+*/
+VgCapsCache* VgCapsCache::instance()
+{
+   static VgCapsCache* cache = 0;
+   if ( cache == 0 ) {
+      cache = new VgCapsCache();
+   }
+   return cache;
+}
+
+
+VgCapsCache::VgCapsCache()
+   : QObject( 0 )
+{
+   this->setObjectName( "vgcapscache" );
+}
+
+
+/*!
+  Fresh capabilities of vgExec, if we have them: never runs valgrind.
+*/
+bool VgCapsCache::lookup( const QString& vgExec, VgCapabilities& caps )
+{
+   QString vgPath = VgCapabilities::resolvePath( vgExec );
+   if ( vgPath.isEmpty() ) {
+      return false;
+   }
+
+   QHash<QString, VgCapabilities>::iterator it = m_caps.find( vgPath );
+   if ( it != m_caps.end() ) {
+      if ( it.value().isFresh() ) {
+         caps = it.value();
+         return true;
+      }
+      m_caps.erase( it );
+   }
+
+   if ( !caps.load( vgPath ) ) {
+      return false;
+   }
+   m_caps.insert( vgPath, caps );
+   return true;
+}
+
+
+/*!
+  Probe vgExec on a pool thread, unless we know it already, or
+  a probe of it is under way. probed() is emitted once it's done.
+*/
+void VgCapsCache::probeInBackground( const QString& vgExec )
+{
+   QString vgPath = VgCapabilities::resolvePath( vgExec );
+   VgCapabilities caps;
+   if ( vgPath.isEmpty() || m_probing.contains( vgPath ) || lookup( vgPath, caps ) ) {
+      return;
+   }
+
+   m_probing.insert( vgPath );
+   QThreadPool::globalInstance()->start( new VgCapsProber( this, vgPath ) );
+}
+
+
+/*!
+  As lookup(), else probe vgExec here and now.
+*/
+bool VgCapsCache::probeNow( const QString& vgExec, VgCapabilities& caps,
+                            QString& errMsg )
+{
+   if ( lookup( vgExec, caps ) ) {
+      return true;
+   }
+
+   QString vgPath = VgCapabilities::resolvePath( vgExec );
+   if ( vgPath.isEmpty() ) {
+      errMsg = "No valgrind found: '" + vgExec + "'";
+      return false;
+   }
+   if ( !VgCapabilities::probe( vgPath, caps, errMsg ) ) {
+      return false;
+   }
+
+   QString saveErr;
+   if ( !caps.save( saveErr ) ) {
+      vkPrintErr( "%s", qPrintable( saveErr ) );
+   }
+   m_caps.insert( vgPath, caps );
+   return true;
+}
+
+
+void VgCapsCache::proberDone( QString vgPath, bool ok, QString errMsg )
+{
+   m_probing.remove( vgPath );
+
+   if ( ok ) {
+      // the prober left it on disk
+      VgCapabilities caps;
+      ok = lookup( vgPath, caps );
+      if ( !ok ) {
+         errMsg = "Valgrind '" + vgPath + "' changed while being probed";
+      }
+   }
+   emit probed( vgPath, ok, errMsg );
+}
+
+
+/*!
+  Does vgExec's tool take flag (sans "--")? Yes, unless we know otherwise.
+*/
+bool VgCapsCache::supportsFlag( const QString& vgExec, const QString& tool,
+                                const QString& flag )
+{
+   VgCapabilities caps;
+   if ( !lookup( vgExec, caps ) ) {
+      return true;
+   }
+   return caps.supportsFlag( tool, flag );
+}
+
+
+/*!
+  Drop the flags vgExec's tool doesn't take, returning them:
+  better to run without them than to have valgrind refuse to run.
+*/
+QStringList VgCapsCache::filterFlags( const QString& vgExec, const QString& tool,
+                                      QStringList& flags )
+{
+   QStringList dropped;
+   VgCapabilities caps;
+   if ( !lookup( vgExec, caps ) ) {
+      return dropped;
+   }
+
+   QStringList kept;
+   foreach ( QString flag, flags ) {
+      QString name = flag.section( '=', 0, 0 ).mid( 2 );
+      if ( flag.startsWith( "--" ) && !caps.supportsFlag( tool, name ) ) {
+         dropped << flag;
+      }
+      else {
+         kept << flag;
+      }
+   }
+   flags = kept;
+   return dropped;
+}
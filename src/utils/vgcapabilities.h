@@ -0,0 +1,135 @@
+/****************************************************************************
+** VgCapabilities definition
+**  - what an installed valgrind can do: version, tools, their flags
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGCAPABILITIES_H
+#define __VGCAPABILITIES_H
+
+#include <QHash>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+
+// ============================================================
+/*!
+  VgCapabilities: what one valgrind binary can do, as found by
+  running it: its version, which tools it has, and the flags each
+  tool takes (core + tool, from '--tool=<tool> --help-debug').
+
+  Probing takes a dozen valgrind runs, so the result is cached on
+  disk, keyed by the binary's path, and only trusted while the
+  binary's mtime is unchanged.
+*/
+class VgCapabilities
+{
+public:
+   VgCapabilities() : mtime( 0 ), versionHex( -1 ) {}
+
+   bool isValid() const {
+      return versionHex != -1;
+   }
+   bool hasTool( const QString& tool ) const {
+      return toolFlags.contains( tool );
+   }
+   bool supportsFlag( const QString& tool, const QString& flag ) const;
+
+   static QString resolvePath( const QString& vgExec );
+   static qint64 binaryMtime( const QString& vgPath );
+   bool isFresh() const;
+
+   static bool probe( const QString& vgPath, VgCapabilities& caps,
+                      QString& errMsg );
+   bool load( const QString& vgPath );
+   bool save( QString& errMsg ) const;
+   static QString cacheFile( const QString& vgPath );
+
+public:
+   QString vgPath;          // absolute
+   qint64  mtime;           // of the binary, when probed
+   QString version;         // "valgrind-3.6.1"
+   int     versionHex;      // see strVersion2hex()
+   QHash<QString, QSet<QString> > toolFlags;   // tool -> flags, sans "--"
+};
+
+
+
+// ============================================================
+class VgCapsCache;
+
+/*!
+  VgCapsProber: probes one valgrind on a pool thread, saves the
+  result to the disk cache, and tells the cache it's done.
+*/
+class VgCapsProber : public QRunnable
+{
+public:
+   VgCapsProber( VgCapsCache* cache, const QString& vgPath );
+
+   void run();
+
+private:
+   VgCapsCache* m_cache;    // we don't own this
+   QString m_vgPath;
+};
+
+
+
+// ============================================================
+/*!
+  VgCapsCache: the capabilities of the valgrinds we've met, for the
+  gui thread to consult without ever running valgrind itself.
+
+  lookup() only gives fresh capabilities, from memory or disk.
+  probeInBackground() (re)probes a valgrind if there are none,
+  signalling probed() when done; probeNow() does the same in the
+  calling thread, for when there's no gui to keep responsive.
+*/
+class VgCapsCache : public QObject
+{
+   Q_OBJECT
+public:
+   static VgCapsCache* instance();
+
+   bool lookup( const QString& vgExec, VgCapabilities& caps );
+   void probeInBackground( const QString& vgExec );
+   bool probeNow( const QString& vgExec, VgCapabilities& caps, QString& errMsg );
+
+   bool supportsFlag( const QString& vgExec, const QString& tool,
+                      const QString& flag );
+   QStringList filterFlags( const QString& vgExec, const QString& tool,
+                            QStringList& flags );
+
+signals:
+   void probed( QString vgPath, bool ok, QString errMsg );
+
+private slots:
+   void proberDone( QString vgPath, bool ok, QString errMsg );
+
+private:
+   VgCapsCache();
+
+private:
+   QHash<QString, VgCapabilities> m_caps;   // vgPath -> caps
+   QSet<QString> m_probing;                 // vgPaths being probed
+};
+
+#endif // #ifndef __VGCAPABILITIES_H
@@ -0,0 +1,515 @@
+/****************************************************************************
+** VgJobQueue implementation
+**  - runs many valgrind jobs (one per target) concurrently
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgjobqueue.h"
+#include "utils/vk_config.h"
+#include "utils/vk_procsampler.h"
+#include "utils/vk_utils.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QProcess>
+#include <QSet>
+#include <QThread>
+
+#include <stdio.h>
+
+// how often a running job checks for cancellation
+#define JOB_POLL_MS 100
+
+
+/**********************************************************************/
+/* VgJob */
+QString VgJob::stateName( VGJOB::JobState state )
+{
+   switch ( state ) {
+   case VGJOB::QUEUED:    return "queued";
+   case VGJOB::RUNNING:   return "running";
+   case VGJOB::DONE:      return "done";
+   case VGJOB::FAILED:    return "failed";
+   case VGJOB::CANCELLED: return "cancelled";
+   default:
+      vk_assert_never_reached();
+   }
+   return QString();
+}
+
+
+
+
+/**********************************************************************/
+/* VgJobRunner */
+VgJobRunner::VgJobRunner( VgJobQueue* queue, int idx )
+   : m_queue( queue ), m_idx( idx )
+{ }
+
+
+void VgJobRunner::run()
+{
+   VgJob* job = m_queue->m_jobData + m_idx;
+
+   if ( m_queue->m_cancel.load() ) {
+      job->endState = VGJOB::CANCELLED;
+      QMetaObject::invokeMethod( m_queue, "runnerFinished",
+                                 Qt::QueuedConnection, Q_ARG( int, m_idx ) );
+      return;
+   }
+   QMetaObject::invokeMethod( m_queue, "runnerStarted",
+                              Qt::QueuedConnection, Q_ARG( int, m_idx ) );
+
+   // the job's own flags replace any the queue has for the same option
+   QStringList args;
+   foreach ( QString flag, m_queue->m_vgFlags.mid( 1 ) ) {
+      QString opt = flag.section( '=', 0, 0 ) + "=";
+      bool overridden = false;
+      foreach ( QString jobFlag, job->flags ) {
+         if ( jobFlag.startsWith( opt ) ) {
+            overridden = true;
+            break;
+         }
+      }
+      if ( !overridden ) {
+         args << flag;
+      }
+   }
+   args += job->flags;
+   args << "--xml=yes" << "--xml-file=" + job->logPattern;
+   args += job->target;
+
+   QProcess proc;
+   proc.setWorkingDirectory( m_queue->m_workingDir );
+   proc.setProcessChannelMode( QProcess::MergedChannels );
+   proc.setStandardOutputFile( job->outFile );
+
+   QElapsedTimer timer;
+   timer.start();
+   proc.start( m_queue->m_vgFlags.first(), args );
+
+   bool cancelled = false;
+   if ( proc.waitForStarted( -1 ) ) {
+      // the peak only grows: the last reading before exit is it
+      bool haveProc = VkProcSampler::isSupported();
+      while ( !proc.waitForFinished( JOB_POLL_MS ) &&
+              proc.state() != QProcess::NotRunning ) {
+         if ( haveProc ) {
+            job->peakRssKB = qMax( job->peakRssKB,
+                                   VkProcSampler::peakRssKB( proc.pid() ) );
+         }
+         if ( m_queue->m_cancel.load() ) {
+            proc.kill();
+            proc.waitForFinished( -1 );
+            cancelled = true;
+            break;
+         }
+      }
+   }
+   job->elapsedMs = timer.elapsed();
+   job->exitCode = proc.exitCode();
+
+   if ( cancelled ) {
+      job->endState = VGJOB::CANCELLED;
+   }
+   else if ( proc.error() == QProcess::FailedToStart ) {
+      job->errMsg = "Failed to start '" + m_queue->m_vgFlags.first() + "'";
+      job->endState = VGJOB::FAILED;
+   }
+   else if ( proc.exitStatus() != QProcess::NormalExit ) {
+      job->errMsg = "Valgrind crashed or was killed";
+      job->endState = VGJOB::FAILED;
+   }
+   else {
+      // the target's exit code is its own business: the logs say it all.
+      digestLogs( job );
+      job->endState = job->errMsg.isEmpty() ? VGJOB::DONE : VGJOB::FAILED;
+   }
+
+   QMetaObject::invokeMethod( m_queue, "runnerFinished",
+                              Qt::QueuedConnection, Q_ARG( int, m_idx ) );
+}
+
+
+/*!
+  Find the logs valgrind wrote for this job: just the one,
+  unless tracing children - then one per process - and digest them.
+*/
+void VgJobRunner::digestLogs( VgJob* job )
+{
+   QFileInfo fi( job->logPattern );
+   if ( job->logPattern.contains( "%p" ) ) {
+      QString glob = fi.fileName().replace( "%p", "*" );
+      foreach ( QString log, fi.absoluteDir().entryList( QStringList( glob ),
+                                                          QDir::Files, QDir::Name ) ) {
+         job->logFiles << fi.absoluteDir().absoluteFilePath( log );
+      }
+   }
+   else if ( fi.exists() ) {
+      job->logFiles << job->logPattern;
+   }
+
+   if ( job->logFiles.isEmpty() ) {
+      job->errMsg = "Valgrind wrote no log: see '" + job->outFile + "'";
+      return;
+   }
+
+   QHash<QString, int> suppCounts;
+   foreach ( QString log, job->logFiles ) {
+      QString errMsg;
+      if ( !VgLogDiff::digestLog( log, job->digests, job->toolName,
+                                  errMsg, &suppCounts ) ) {
+         job->errMsg = errMsg;
+         return;
+      }
+   }
+
+   foreach ( VgErrorDigest dgst, job->digests ) {
+      job->numErrors += dgst.count;
+   }
+   foreach ( int count, suppCounts ) {
+      job->numSuppressed += count;
+   }
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgJobQueue
+   - vgFlags: valgrind and its options, as for a single run, minus the
+     target: each job adds its own log flags, and target.
+   - maxJobs: how many valgrinds to run at once; 0: one per core.
+*/
+VgJobQueue::VgJobQueue( const QStringList& vgFlags, int maxJobs, QObject* parent )
+   : QObject( parent ), m_vgFlags( vgFlags ), m_cancel( 0 ),
+     m_jobData( 0 ), m_started( false ), m_numFinished( 0 ),
+     m_startMs( 0 ), m_endMs( 0 )
+{
+   vk_assert( !m_vgFlags.isEmpty() );
+
+   if ( maxJobs <= 0 ) {
+      maxJobs = qMax( 1, QThread::idealThreadCount() );
+   }
+   m_pool.setMaxThreadCount( maxJobs );
+   // valgrind runs can be long: don't let idle threads linger on
+   m_pool.setExpiryTimeout( 1000 );
+
+   m_workingDir = vkCfgProj->value( "valkyrie/working-dir" ).toString();
+
+   // as for a single run: each process needs its own log
+   if ( m_vgFlags.contains( "--trace-children=yes" ) &&
+        !m_vgFlags.contains( "--child-silent-after-fork=yes" ) ) {
+      m_vgFlags << "--child-silent-after-fork=yes";
+   }
+}
+
+VgJobQueue::~VgJobQueue()
+{
+   // the runners use us: they must be done first
+   cancel();
+   m_pool.waitForDone();
+}
+
+
+/*!
+  Read a job list: one target per line, binary then args.
+  Args are split on whitespace; "double quotes" keep one together.
+  Empty lines and '#' comments are skipped.
+  A relative binary path is taken as relative to the job list.
+*/
+bool VgJobQueue::readJobList( const QString& jobList, QList<QStringList>& targets,
+                              QString& errMsg )
+{
+   QFile file( jobList );
+   if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
+      errMsg = "Failed to open job list: '" + jobList + "'";
+      return false;
+   }
+
+   QDir dir = QFileInfo( jobList ).absoluteDir();
+   QTextStream strm( &file );
+   int lineNum = 0;
+   while ( !strm.atEnd() ) {
+      QString line = strm.readLine().trimmed();
+      lineNum++;
+      if ( line.isEmpty() || line.startsWith( '#' ) ) {
+         continue;
+      }
+
+      QStringList target;
+      QString arg;
+      bool inQuotes = false, haveArg = false;
+      for ( int i = 0; i < line.length(); ++i ) {
+         QChar c = line.at( i );
+         if ( c == '"' ) {
+            inQuotes = !inQuotes;
+            haveArg = true;
+         }
+         else if ( c.isSpace() && !inQuotes ) {
+            if ( haveArg ) {
+               target << arg;
+               arg.clear();
+               haveArg = false;
+            }
+         }
+         else {
+            arg += c;
+            haveArg = true;
+         }
+      }
+      if ( inQuotes ) {
+         errMsg = QString( "Unmatched quote in job list '%1', line %2" )
+                  .arg( jobList ).arg( lineNum );
+         return false;
+      }
+      if ( haveArg ) {
+         target << arg;
+      }
+
+      if ( target.first().contains( '/' ) ) {
+         target[0] = QDir::cleanPath( dir.absoluteFilePath( target.first() ) );
+      }
+      targets << target;
+   }
+
+   if ( targets.isEmpty() ) {
+      errMsg = "No jobs listed in '" + jobList + "'";
+      return false;
+   }
+   return true;
+}
+
+
+void VgJobQueue::addJob( const QStringList& target, const QStringList& flags,
+                         const QString& label )
+{
+   vk_assert( !m_started );
+   vk_assert( !target.isEmpty() );
+
+   VgJob job;
+   job.target = target;
+   job.flags  = flags;
+   job.label  = label;
+   m_jobs.append( job );
+}
+
+
+/*!
+  Make the queue's log dir, and set all the jobs going:
+  the pool only runs maxJobs() of them at once.
+*/
+bool VgJobQueue::start( QString& errMsg )
+{
+   vk_assert( !m_started );
+   if ( m_jobs.isEmpty() ) {
+      errMsg = "No jobs to run";
+      return false;
+   }
+
+   // one dir per queue: the jobs' logs are kept there
+   QString base = VkCfg::tmpDir() + "jobs_" +
+                  QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" );
+   m_logDir = base + "/";
+   for ( int i = 1; QFileInfo( m_logDir ).exists(); ++i ) {
+      m_logDir = base + "_" + QString::number( i ) + "/";
+   }
+   if ( !QDir().mkpath( m_logDir ) ) {
+      errMsg = "Failed to create job log dir: '" + m_logDir + "'";
+      return false;
+   }
+
+   bool traceChildren = m_vgFlags.contains( "--trace-children=yes" );
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      VgJob& job = m_jobs[i];
+      QString name = m_logDir + QString( "job_%1" ).arg( i + 1, 4, 10, QChar( '0' ) );
+      job.logPattern = name + ( traceChildren ? "_%p.xml" : ".xml" );
+      job.outFile = name + ".out";
+   }
+
+   m_started = true;
+   m_startMs = QDateTime::currentMSecsSinceEpoch();
+
+   // the runners write straight into the jobs: never via m_jobs,
+   // which mustn't be copied (so detached) from now on
+   m_jobData = m_jobs.data();
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      m_pool.start( new VgJobRunner( this, i ) );
+   }
+   return true;
+}
+
+
+/*!
+  Stop the queue: running jobs are killed, queued jobs don't start.
+  The jobs still report back, as cancelled.
+*/
+void VgJobQueue::cancel()
+{
+   m_cancel.store( 1 );
+}
+
+
+void VgJobQueue::runnerStarted( int idx )
+{
+   // cancelled before we got here? then it's already done.
+   if ( m_jobs.at( idx ).state == VGJOB::QUEUED ) {
+      m_jobData[idx].state = VGJOB::RUNNING;
+      emit jobStarted( idx );
+   }
+}
+
+
+void VgJobQueue::runnerFinished( int idx )
+{
+   m_jobData[idx].state = m_jobs.at( idx ).endState;
+   m_numFinished++;
+   emit jobFinished( idx );
+
+   if ( m_numFinished == m_jobs.count() ) {
+      m_endMs = QDateTime::currentMSecsSinceEpoch();
+      emit finished();
+   }
+}
+
+
+int VgJobQueue::numInState( VGJOB::JobState state )
+{
+   int num = 0;
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      if ( m_jobs.at( i ).state == state ) {
+         num++;
+      }
+   }
+   return num;
+}
+
+
+qint64 VgJobQueue::elapsedMs()
+{
+   if ( !m_started ) {
+      return 0;
+   }
+   return ( ( m_endMs != 0 ) ? m_endMs : QDateTime::currentMSecsSinceEpoch() )
+          - m_startMs;
+}
+
+
+/*!
+  Totals: over the finished jobs only.
+*/
+int VgJobQueue::totalErrors()
+{
+   int num = 0;
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      if ( m_jobs.at( i ).state == VGJOB::DONE ) {
+         num += m_jobs.at( i ).numErrors;
+      }
+   }
+   return num;
+}
+
+int VgJobQueue::totalSuppressed()
+{
+   int num = 0;
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      if ( m_jobs.at( i ).state == VGJOB::DONE ) {
+         num += m_jobs.at( i ).numSuppressed;
+      }
+   }
+   return num;
+}
+
+/*!
+  Distinct errors over all jobs: the same error in many targets
+  (e.g. in a shared library) counts once.
+*/
+int VgJobQueue::numErrorKinds()
+{
+   QSet<quint64> fingerprints;
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      const VgJob& job = m_jobs.at( i );
+      if ( job.state == VGJOB::DONE ) {
+         VgErrorDigestHash::const_iterator it = job.digests.constBegin();
+         for ( ; it != job.digests.constEnd(); ++it ) {
+            fingerprints.insert( it.key() );
+         }
+      }
+   }
+   return fingerprints.count();
+}
+
+
+void VgJobQueue::writeReport( QTextStream& strm )
+{
+   strm << "Jobs: " << m_jobs.count() << " (" << maxJobs() << " at a time), "
+        << elapsedMs() / 1000 << "s" << endl;
+   strm << "   done: " << numInState( VGJOB::DONE )
+        << "   failed: " << numInState( VGJOB::FAILED )
+        << "   cancelled: " << numInState( VGJOB::CANCELLED ) << endl;
+   strm << "Errors: " << totalErrors() << " (" << numErrorKinds() << " distinct)"
+        << "   suppressed: " << totalSuppressed() << endl;
+   strm << "Logs: " << m_logDir << endl << endl;
+
+   strm << qSetFieldWidth( 6 ) << right << "job"
+        << qSetFieldWidth( 11 ) << "state" << "time (s)" << "peak RSS"
+        << "errors" << "suppressed"
+        << qSetFieldWidth( 0 ) << "   target" << endl;
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      const VgJob& job = m_jobs.at( i );
+      strm << qSetFieldWidth( 6 ) << right << i + 1
+           << qSetFieldWidth( 11 ) << VgJob::stateName( job.state )
+           << QString::number( job.elapsedMs / 1000.0, 'f', 1 )
+           << ( job.peakRssKB ? VkProcSampler::bytesString( job.peakRssKB * 1024 ) : "-" )
+           << job.numErrors << job.numSuppressed
+           << qSetFieldWidth( 0 ) << "   " << job.description() << endl;
+      if ( !job.errMsg.isEmpty() ) {
+         strm << "         " << job.errMsg << endl;
+      }
+   }
+}
+
+
+/*!
+  Write the report to reportFile, or stdout if "-" (or none).
+*/
+bool VgJobQueue::write( const QString& reportFile, QString& errMsg )
+{
+   QFile file;
+   bool ok;
+   if ( reportFile.isEmpty() || reportFile == "-" ) {
+      ok = file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+   }
+   else {
+      file.setFileName( reportFile );
+      ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text );
+   }
+   if ( !ok ) {
+      errMsg = "Failed to open report file: '" + reportFile + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   writeReport( strm );
+   strm.flush();
+   return true;
+}
@@ -0,0 +1,195 @@
+/****************************************************************************
+** VgJobQueue definition
+**  - runs many valgrind jobs (one per target) concurrently
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGJOBQUEUE_H
+#define __VGJOBQUEUE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVector>
+
+#include "utils/vglogdiff.h"
+
+
+// ============================================================
+namespace VGJOB {
+   enum JobState { QUEUED = 0, RUNNING, DONE, FAILED, CANCELLED, NUM_STATES };
+}
+
+
+// ============================================================
+/*!
+  One valgrind job: one target (binary + args), with its own
+  xml log(s), output file and digested results.
+   - flags: valgrind options of this job only, overriding the queue's
+   - label: what's special about this job (e.g. its flags), for reports
+   - logPattern: as given to --xml-file, may hold %p if tracing children
+   - logFiles: the logs valgrind actually wrote
+   - digests: the job's errors, by fingerprint (see VgLogDiff)
+*/
+class VgJob
+{
+public:
+   VgJob()
+      : state( VGJOB::QUEUED ), endState( VGJOB::QUEUED ),
+        exitCode( 0 ), elapsedMs( 0 ), peakRssKB( 0 ),
+        numErrors( 0 ), numSuppressed( 0 ) {}
+
+   QString targetString() const {
+      return target.join( " " );
+   }
+   QString description() const {
+      return label.isEmpty() ? targetString() : label + ":  " + targetString();
+   }
+   static QString stateName( VGJOB::JobState state );
+
+   QStringList target;
+   QStringList flags;
+   QString label;
+   QString logPattern;
+   QString outFile;              // valgrind's + the target's stdout/stderr
+   QStringList logFiles;
+
+   VGJOB::JobState state;        // only ever set by the queue's thread
+   VGJOB::JobState endState;     // set by the job's runner, when done
+   int     exitCode;
+   qint64  elapsedMs;
+   qint64  peakRssKB;            // valgrind's, where /proc has it
+   int     numErrors;            // summed errorcounts
+   int     numSuppressed;        // summed suppcounts
+   QString toolName;
+   QString errMsg;
+   VgErrorDigestHash digests;
+};
+
+
+
+// ============================================================
+class VgJobQueue;
+
+/*!
+  VgJobRunner: runs one job on one of the queue's pool threads:
+  valgrind is run to completion (or cancellation), then its logs
+  are digested, all off the main thread.
+*/
+class VgJobRunner : public QRunnable
+{
+public:
+   VgJobRunner( VgJobQueue* queue, int idx );
+
+   void run();
+
+private:
+   void digestLogs( VgJob* job );
+
+private:
+   VgJobQueue* m_queue;     // we don't own this
+   int m_idx;
+};
+
+
+
+// ============================================================
+/*!
+  VgJobQueue: runs valgrind on many targets, up to maxJobs at a time.
+
+  Each job runs on a thread of the queue's own pool: the pool size is
+  what bounds the number of valgrinds running at once.
+  The runners tell the queue of their progress by queued calls, so the
+  queue's signals are always emitted from the queue's thread:
+  a job's results may be read once jobFinished() has been emitted for it.
+
+  The jobs' logs are kept, one dir per queue, for viewing afterwards.
+*/
+class VgJobQueue : public QObject
+{
+   Q_OBJECT
+   friend class VgJobRunner;
+
+public:
+   VgJobQueue( const QStringList& vgFlags, int maxJobs = 0, QObject* parent = 0 );
+   ~VgJobQueue();
+
+   static bool readJobList( const QString& jobList, QList<QStringList>& targets,
+                            QString& errMsg );
+
+   void addJob( const QStringList& target,
+                const QStringList& flags = QStringList(),
+                const QString& label = QString() );
+   bool start( QString& errMsg );
+   void cancel();
+   bool isRunning() {
+      return m_numFinished < m_jobs.count() && m_started;
+   }
+
+   int maxJobs() {
+      return m_pool.maxThreadCount();
+   }
+   int numJobs() {
+      return m_jobs.count();
+   }
+   int numFinished() {
+      return m_numFinished;
+   }
+   int numInState( VGJOB::JobState state );
+   const VgJob& job( int idx ) {
+      return m_jobs.at( idx );
+   }
+   QString logDir() {
+      return m_logDir;
+   }
+   qint64 elapsedMs();
+
+   int totalErrors();
+   int totalSuppressed();
+   int numErrorKinds();
+
+   void writeReport( QTextStream& strm );
+   bool write( const QString& reportFile, QString& errMsg );
+
+signals:
+   void jobStarted( int idx );
+   void jobFinished( int idx );
+   void finished();
+
+private slots:
+   void runnerStarted( int idx );
+   void runnerFinished( int idx );
+
+private:
+   QStringList m_vgFlags;       // valgrind + its options, no target
+   QVector<VgJob> m_jobs;       // not resized, nor copied, once started
+   VgJob* m_jobData;            // m_jobs' data: where the jobs are written
+   QThreadPool m_pool;
+   QAtomicInt m_cancel;
+   QString m_logDir;
+   QString m_workingDir;
+   bool m_started;
+   int m_numFinished;
+   qint64 m_startMs, m_endMs;
+};
+
+#endif // #ifndef __VGJOBQUEUE_H
@@ -0,0 +1,441 @@
+/****************************************************************************
+** VgLogDiff implementation
+**  - run-to-run comparison of valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogdiff.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QXmlInputSource>
+#include <QXmlParseException>
+#include <QXmlSimpleReader>
+
+#include <algorithm>
+
+
+/**********************************************************************/
+/* VgLogDigestHandler */
+VgLogDigestHandler::VgLogDigestHandler( VgErrorDigestHash* digests,
+                                        QHash<QString, int>* suppCounts )
+   : m_digests( digests ), m_suppCounts( suppCounts ),
+     m_inStack( false ), m_haveStack( false ),
+     m_numErrors( 0 )
+{
+   vk_assert( m_digests != 0 );
+}
+
+VgLogDigestHandler::~VgLogDigestHandler()
+{ }
+
+bool VgLogDigestHandler::startElement( const QString&, const QString&,
+                                       const QString& tag,
+                                       const QXmlAttributes& )
+{
+   m_path.append( tag );
+   m_chars = QString();
+   int depth = m_path.count();
+
+   if ( depth == 2 && tag == "error" ) {
+      m_inStack = m_haveStack = false;
+      m_unique = m_kind = m_what = m_topFrame = QString();
+      m_stackSig = QString();
+   }
+   else if ( depth == 3 && tag == "stack" && m_path.at( 1 ) == "error" ) {
+      // only the first (i.e. the error's own) stack is fingerprinted:
+      // aux stacks (e.g. alloc'd at) vary too much from run to run.
+      m_inStack = !m_haveStack;
+   }
+   else if ( depth == 4 && tag == "frame" && m_inStack ) {
+      m_frameFn = m_frameObj = m_frameFile = QString();
+   }
+   else if ( depth == 2 && tag == "suppcounts" ) {
+      // suppcounts are cumulative: last one wins.
+      m_supps.clear();
+   }
+
+   return true;
+}
+
+bool VgLogDigestHandler::endElement( const QString&, const QString&,
+                                     const QString& tag )
+{
+   int depth = m_path.count();
+   if ( depth == 0 ) {
+      return false;
+   }
+
+   QString text = m_chars.simplified();
+   m_chars = QString();
+
+   if ( depth == 2 && tag == "protocoltool" ) {
+      m_tool = text;
+   }
+   else if ( depth >= 2 && m_path.at( 1 ) == "error" ) {
+      QString parent = m_path.at( depth - 2 );
+
+      if ( depth == 3 ) {
+         // ignore <tid>: thread ids are not stable between runs
+         if ( tag == "unique" ) {
+            m_unique = text;
+         }
+         else if ( tag == "kind" ) {
+            m_kind = text;
+         }
+         else if ( tag == "what" ) {
+            m_what = text;
+         }
+         else if ( tag == "stack" && m_inStack ) {
+            m_inStack = false;
+            m_haveStack = true;
+         }
+      }
+      else if ( depth == 4 && tag == "text" && parent == "xwhat" ) {
+         if ( m_what.isEmpty() ) {
+            m_what = text;
+         }
+      }
+      else if ( m_inStack && depth == 5 ) {
+         // frame details: ignore <ip>, <dir>, <line>
+         if ( tag == "fn" ) {
+            m_frameFn = text;
+         }
+         else if ( tag == "obj" ) {
+            m_frameObj = text;
+         }
+         else if ( tag == "file" ) {
+            m_frameFile = text;
+         }
+      }
+      else if ( m_inStack && depth == 4 && tag == "frame" ) {
+         QString frame = VgLogDiff::frameSignature( m_frameFn, m_frameObj,
+                                                    m_frameFile );
+         if ( m_topFrame.isEmpty() ) {
+            m_topFrame = frame;
+         }
+         m_stackSig += '\n' + frame;
+      }
+      else if ( depth == 2 && tag == "error" ) {
+         // error complete: fingerprint it
+         quint64 fp = VgLogDiff::fingerprint( m_kind + m_stackSig );
+
+         VgErrorDigestHash::iterator it = m_digests->find( fp );
+         if ( it == m_digests->end() ) {
+            VgErrorDigest digest;
+            digest.fingerprint = fp;
+            digest.kind        = m_kind;
+            digest.what        = m_what;
+            digest.topFrame    = m_topFrame;
+            m_digests->insert( fp, digest );
+         }
+
+         // until told otherwise by errorcounts, each error counts once
+         UniqueCount uc;
+         uc.fingerprint = fp;
+         uc.count = 1;
+         m_uniques.insert( m_unique, uc );
+         m_numErrors++;
+      }
+   }
+   else if ( depth >= 3 && m_path.at( 1 ) == "errorcounts" ) {
+      if ( depth == 4 && tag == "count" ) {
+         m_pairCount = text;
+      }
+      else if ( depth == 4 && tag == "unique" ) {
+         m_pairUnique = text;
+      }
+      else if ( depth == 3 && tag == "pair" ) {
+         // errorcounts may be output more than once: last one wins.
+         QHash<QString, UniqueCount>::iterator it = m_uniques.find( m_pairUnique );
+         if ( it != m_uniques.end() ) {
+            it.value().count = m_pairCount.toInt();
+         }
+         m_pairCount = m_pairUnique = QString();
+      }
+   }
+   else if ( depth >= 3 && m_path.at( 1 ) == "suppcounts" && m_suppCounts ) {
+      if ( depth == 4 && tag == "count" ) {
+         m_pairCount = text;
+      }
+      else if ( depth == 4 && tag == "name" ) {
+         m_pairName = text;
+      }
+      else if ( depth == 3 && tag == "pair" ) {
+         m_supps.insert( m_pairName, m_pairCount.toInt() );
+         m_pairCount = m_pairName = QString();
+      }
+   }
+
+   m_path.removeLast();
+   return true;
+}
+
+bool VgLogDigestHandler::characters( const QString& ch )
+{
+   m_chars += ch;
+   return true;
+}
+
+bool VgLogDigestHandler::startDocument()
+{
+   m_path.clear();
+   m_uniques.clear();
+   m_supps.clear();
+   m_tool = m_fatalMsg = QString();
+   m_numErrors = 0;
+   return true;
+}
+
+/*!
+  Fold the per-unique counts into the per-fingerprint digests
+*/
+bool VgLogDigestHandler::endDocument()
+{
+   QHash<QString, UniqueCount>::const_iterator it = m_uniques.constBegin();
+   for ( ; it != m_uniques.constEnd(); ++it ) {
+      VgErrorDigestHash::iterator dit = m_digests->find( it.value().fingerprint );
+      vk_assert( dit != m_digests->end() );
+      dit.value().count += it.value().count;
+   }
+   m_uniques.clear();
+
+   if ( m_suppCounts ) {
+      QHash<QString, int>::const_iterator sit = m_supps.constBegin();
+      for ( ; sit != m_supps.constEnd(); ++sit ) {
+         ( *m_suppCounts )[sit.key()] += sit.value();
+      }
+   }
+   m_supps.clear();
+
+   return m_path.isEmpty();
+}
+
+bool VgLogDigestHandler::fatalError( const QXmlParseException& exception )
+{
+   m_fatalMsg = exception.message() +
+                " (line: " + QString::number( exception.lineNumber() ) +
+                ", col: " + QString::number( exception.columnNumber() ) + ")";
+   return false;
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgLogDiff
+*/
+VgLogDiff::VgLogDiff()
+{
+   for ( int i = 0; i < VGLOGDIFF::NUM_STATES; ++i ) {
+      m_numEntries[i] = 0;
+   }
+}
+
+VgLogDiff::~VgLogDiff()
+{ }
+
+
+/*!
+  64bit FNV-1a hash: cheap, and wide enough not to worry about
+  collisions between a few million error fingerprints.
+*/
+quint64 VgLogDiff::fingerprint( const QString& str )
+{
+   quint64 hash = Q_UINT64_C( 14695981039346656037 );
+   const ushort* p = str.utf16();
+   for ( int i = 0; i < str.length(); ++i ) {
+      hash ^= p[i];
+      hash *= Q_UINT64_C( 1099511628211 );
+   }
+   return hash;
+}
+
+
+/*!
+  Normalised frame: function (else object basename) and source file.
+  Addresses and line numbers are left out: they move between builds.
+*/
+QString VgLogDiff::frameSignature( const QString& fn, const QString& obj,
+                                   const QString& file )
+{
+   QString frame = fn.isEmpty() ? "obj:" + obj.mid( obj.lastIndexOf( '/' ) + 1 )
+                                : "fun:" + fn;
+   if ( !file.isEmpty() ) {
+      frame += " (" + file + ")";
+   }
+   return frame;
+}
+
+
+/*!
+  Fingerprint of an already-parsed <error> element.
+  Must match the fingerprint given by VgLogDigestHandler.
+*/
+quint64 VgLogDiff::fingerprint( const QDomElement& err )
+{
+   QString sig = err.firstChildElement( "kind" ).text().simplified();
+
+   QDomElement frame = err.firstChildElement( "stack" ).firstChildElement( "frame" );
+   for ( ; !frame.isNull(); frame = frame.nextSiblingElement( "frame" ) ) {
+      sig += '\n' + frameSignature(
+                frame.firstChildElement( "fn" ).text().simplified(),
+                frame.firstChildElement( "obj" ).text().simplified(),
+                frame.firstChildElement( "file" ).text().simplified() );
+   }
+   return fingerprint( sig );
+}
+
+
+/*!
+  Digest a valgrind xml log into a hash of fingerprinted errors.
+  If suppCounts is given, the log's suppression counts are added to it.
+  Returns false (with errMsg set) if the log could not be fully parsed.
+*/
+bool VgLogDiff::digestLog( const QString& logFile, VgErrorDigestHash& digests,
+                           QString& toolName, QString& errMsg,
+                           QHash<QString, int>* suppCounts )
+{
+   QFile file( logFile );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      errMsg = "Failed to open log file: '" + logFile + "'";
+      return false;
+   }
+
+   VgLogDigestHandler handler( &digests, suppCounts );
+   QXmlSimpleReader reader;
+   reader.setContentHandler( &handler );
+   reader.setErrorHandler( &handler );
+
+   QXmlInputSource source( &file );
+   bool ok = reader.parse( &source );
+
+   if ( !ok ) {
+      errMsg = "Failed to parse '" + logFile + "'";
+      if ( !handler.fatalMsg().isEmpty() ) {
+         errMsg += ":\n" + handler.fatalMsg();
+      }
+   }
+
+   toolName = handler.toolName();
+   return ok;
+}
+
+
+static bool diffEntryLessThan( const VgLogDiffEntry& e1, const VgLogDiffEntry& e2 )
+{
+   if ( e1.state != e2.state ) {
+      return e1.state < e2.state;
+   }
+   // biggest changes first
+   int d1 = qAbs( e1.delta() ), d2 = qAbs( e2.delta() );
+   if ( d1 != d2 ) {
+      return d1 > d2;
+   }
+   return e1.countNew > e2.countNew;
+}
+
+
+/*!
+  Compare baseLog (e.g. last night's run) with newLog.
+  Digests are hash-joined on the fingerprint: O(N+M).
+*/
+bool VgLogDiff::diff( const QString& baseLog, const QString& newLog,
+                      QString& errMsg )
+{
+   m_entries.clear();
+   for ( int i = 0; i < VGLOGDIFF::NUM_STATES; ++i ) {
+      m_numEntries[i] = 0;
+   }
+   m_baseLog = baseLog;
+   m_newLog  = newLog;
+
+   VgErrorDigestHash baseDigests, newDigests;
+   QString baseTool, newTool;
+
+   if ( !digestLog( baseLog, baseDigests, baseTool, errMsg ) ||
+        !digestLog( newLog,  newDigests,  newTool,  errMsg ) ) {
+      return false;
+   }
+
+   if ( baseTool != newTool ) {
+      errMsg = "Logs are from different tools (" + baseTool +
+               " -v- " + newTool + ")";
+      return false;
+   }
+
+   compare( baseDigests, newDigests );
+   return true;
+}
+
+
+/*!
+  Compare already-digested logs.
+  Note: baseDigests is consumed.
+*/
+void VgLogDiff::compare( VgErrorDigestHash& baseDigests,
+                         const VgErrorDigestHash& newDigests )
+{
+   m_entries.clear();
+   for ( int i = 0; i < VGLOGDIFF::NUM_STATES; ++i ) {
+      m_numEntries[i] = 0;
+   }
+
+   // probe: every error class in the new log
+   VgErrorDigestHash::const_iterator it = newDigests.constBegin();
+   for ( ; it != newDigests.constEnd(); ++it ) {
+      const VgErrorDigest& dgst = it.value();
+
+      VgLogDiffEntry entry;
+      entry.countNew = dgst.count;
+      entry.kind     = dgst.kind;
+      entry.what     = dgst.what;
+      entry.topFrame = dgst.topFrame;
+
+      VgErrorDigestHash::iterator bit = baseDigests.find( it.key() );
+      if ( bit == baseDigests.end() ) {
+         entry.state    = VGLOGDIFF::NEW;
+         entry.countOld = 0;
+      }
+      else {
+         entry.state    = VGLOGDIFF::PERSISTING;
+         entry.countOld = bit.value().count;
+         baseDigests.erase( bit );
+      }
+      m_entries.append( entry );
+      m_numEntries[entry.state]++;
+   }
+
+   // whatever's left in the baseline has gone away
+   it = baseDigests.constBegin();
+   for ( ; it != baseDigests.constEnd(); ++it ) {
+      const VgErrorDigest& dgst = it.value();
+
+      VgLogDiffEntry entry;
+      entry.state    = VGLOGDIFF::FIXED;
+      entry.countOld = dgst.count;
+      entry.countNew = 0;
+      entry.kind     = dgst.kind;
+      entry.what     = dgst.what;
+      entry.topFrame = dgst.topFrame;
+      m_entries.append( entry );
+      m_numEntries[entry.state]++;
+   }
+
+   std::sort( m_entries.begin(), m_entries.end(), diffEntryLessThan );
+}
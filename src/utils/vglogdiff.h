@@ -0,0 +1,196 @@
+/****************************************************************************
+** VgLogDiff definition
+**  - run-to-run comparison of valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGDIFF_H
+#define __VGLOGDIFF_H
+
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <QXmlAttributes>
+#include <QXmlDefaultHandler>
+
+
+// ============================================================
+/*!
+  One error 'class', as identified by its fingerprint:
+   - fingerprint: hash of error kind + normalised first stack
+   - count: sum of the errorcounts over all errors with this fingerprint
+   - kind/what/topFrame are kept from the first error seen, for display
+*/
+class VgErrorDigest
+{
+public:
+   VgErrorDigest() : fingerprint( 0 ), count( 0 ) {}
+
+   quint64 fingerprint;
+   int     count;
+   QString kind;
+   QString what;
+   QString topFrame;
+};
+
+typedef QHash<quint64, VgErrorDigest> VgErrorDigestHash;
+
+
+
+// ============================================================
+/*
+  Light-weight xml handler for valgrind logs:
+  - does _not_ build a QDomDocument: only keeps what it needs to
+    fingerprint each error, so even huge logs can be digested
+    in a single streaming pass.
+  - errorcounts are applied per error 'unique', then folded into
+    the per-fingerprint digests at the end of the document.
+  - suppcounts are only collected if asked for.
+*/
+class VgLogDigestHandler : public QXmlDefaultHandler
+{
+public:
+   VgLogDigestHandler( VgErrorDigestHash* digests,
+                       QHash<QString, int>* suppCounts = 0 );
+   ~VgLogDigestHandler();
+
+   // content handler
+   bool startElement( const QString& nsURI,
+                      const QString& localName,
+                      const QString& qName,
+                      const QXmlAttributes& atts );
+   bool endElement( const QString& nsURI,
+                    const QString& localName,
+                    const QString& qName );
+   bool characters( const QString& ch );
+   bool startDocument();
+   bool endDocument();
+
+   // reimplement error handlers
+   bool fatalError( const QXmlParseException& exception );
+
+   QString fatalMsg() {
+      return m_fatalMsg;
+   }
+   QString toolName() {
+      return m_tool;
+   }
+   int numErrors() {
+      return m_numErrors;
+   }
+
+private:
+   struct UniqueCount {
+      quint64 fingerprint;
+      int     count;
+   };
+
+   VgErrorDigestHash* m_digests;   // we don't own this
+   QHash<QString, int>* m_suppCounts; // nor this: may be null
+   QHash<QString, UniqueCount> m_uniques;
+
+   QStringList m_path;             // open element tags
+   QString m_chars;                // text of the current element
+
+   // current error
+   bool m_inStack, m_haveStack;
+   QString m_unique, m_kind, m_what, m_topFrame;
+   QString m_stackSig;
+   QString m_frameFn, m_frameObj, m_frameFile;
+
+   // current errorcounts / suppcounts pair
+   QString m_pairCount, m_pairUnique, m_pairName;
+   QHash<QString, int> m_supps;    // from the last <suppcounts>
+
+   QString m_tool;
+   QString m_fatalMsg;
+   int m_numErrors;
+};
+
+
+
+// ============================================================
+namespace VGLOGDIFF {
+   enum DiffState { NEW = 0, FIXED, PERSISTING, NUM_STATES };
+}
+
+// One row of the diff: an error class present in one or both logs.
+class VgLogDiffEntry
+{
+public:
+   VGLOGDIFF::DiffState state;
+   int countOld, countNew;
+   QString kind, what, topFrame;
+
+   int delta() const {
+      return countNew - countOld;
+   }
+};
+
+
+
+// ============================================================
+/*!
+  VgLogDiff: compares a baseline log with a current log.
+
+  Each log is digested independently (no DOM, no view items), then
+  the digests are hash-joined on the error fingerprint:
+  - in current only   => NEW
+  - in baseline only  => FIXED
+  - in both           => PERSISTING, with count delta
+*/
+class VgLogDiff
+{
+public:
+   VgLogDiff();
+   ~VgLogDiff();
+
+   bool diff( const QString& baseLog, const QString& newLog, QString& errMsg );
+   void compare( VgErrorDigestHash& baseDigests,
+                 const VgErrorDigestHash& newDigests );
+
+   const QList<VgLogDiffEntry>& entries() {
+      return m_entries;
+   }
+   int numEntries( VGLOGDIFF::DiffState state ) {
+      return m_numEntries[state];
+   }
+   QString baseLog() {
+      return m_baseLog;
+   }
+   QString newLog() {
+      return m_newLog;
+   }
+
+   static bool digestLog( const QString& logFile, VgErrorDigestHash& digests,
+                          QString& toolName, QString& errMsg,
+                          QHash<QString, int>* suppCounts = 0 );
+   static quint64 fingerprint( const QString& str );
+   static quint64 fingerprint( const QDomElement& err );
+   static QString frameSignature( const QString& fn, const QString& obj,
+                                  const QString& file );
+
+private:
+   QList<VgLogDiffEntry> m_entries;
+   int m_numEntries[VGLOGDIFF::NUM_STATES];
+   QString m_baseLog, m_newLog;
+};
+
+#endif // #ifndef __VGLOGDIFF_H
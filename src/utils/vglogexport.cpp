@@ -0,0 +1,806 @@
+/****************************************************************************
+** VgLogExport implementation
+**  - streaming export of valgrind xml logs to JSON Lines, CSV and SARIF
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogexport.h"
+#include "utils/vglogdiff.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+#include <QXmlInputSource>
+#include <QXmlParseException>
+#include <QXmlSimpleReader>
+
+#include <stdio.h>
+
+
+/**********************************************************************/
+/* VgLogExportWriter */
+VgLogExportWriter::VgLogExportWriter( QTextStream* strm )
+   : m_strm( strm )
+{
+   vk_assert( m_strm != 0 );
+}
+
+VgLogExportWriter::~VgLogExportWriter()
+{ }
+
+
+VgLogExportWriter* VgLogExportWriter::create( VGLOGEXPORT::Format format,
+                                              QTextStream* strm )
+{
+   switch ( format ) {
+   case VGLOGEXPORT::FMT_JSONL: return new VgJsonLinesWriter( strm );
+   case VGLOGEXPORT::FMT_CSV:   return new VgCsvWriter( strm );
+   case VGLOGEXPORT::FMT_SARIF: return new VgSarifWriter( strm );
+   default:
+      vk_assert_never_reached();
+   }
+   return 0;
+}
+
+
+/*!
+  Quoted json string, with the necessary escapes.
+*/
+QString VgLogExportWriter::jsonString( const QString& str )
+{
+   QString res;
+   res.reserve( str.length() + 2 );
+   res += '"';
+   for ( int i = 0; i < str.length(); ++i ) {
+      QChar ch = str.at( i );
+      switch ( ch.unicode() ) {
+      case '"':  res += "\\\""; break;
+      case '\\': res += "\\\\"; break;
+      case '\n': res += "\\n";  break;
+      case '\r': res += "\\r";  break;
+      case '\t': res += "\\t";  break;
+      default:
+         if ( ch.unicode() < 0x20 ) {
+            res += QString( "\\u%1" ).arg( ch.unicode(), 4, 16, QChar( '0' ) );
+         }
+         else {
+            res += ch;
+         }
+      }
+   }
+   res += '"';
+   return res;
+}
+
+
+/*!
+  Short, readable frame location: 'fn (file:line)', else the object.
+*/
+QString VgLogExportWriter::frameLocation( const VgExportFrame& frame )
+{
+   QString loc = frame.fn.isEmpty() ? frame.obj : frame.fn;
+   if ( !frame.file.isEmpty() ) {
+      loc += " (" + frame.file;
+      if ( !frame.line.isEmpty() ) {
+         loc += ":" + frame.line;
+      }
+      loc += ")";
+   }
+   return loc;
+}
+
+
+
+/**********************************************************************/
+/* VgJsonLinesWriter */
+VgJsonLinesWriter::VgJsonLinesWriter( QTextStream* strm )
+   : VgLogExportWriter( strm )
+{ }
+
+void VgJsonLinesWriter::beginRun( const QString& tool, const QString& pid,
+                                  const QString& logFile )
+{
+   m_tool = tool;
+   m_pid  = pid;
+   m_logFile = logFile;
+
+   *m_strm << "{\"type\":\"run\",\"tool\":" << jsonString( m_tool )
+           << ",\"pid\":" << jsonString( m_pid )
+           << ",\"log\":" << jsonString( m_logFile ) << "}\n";
+}
+
+void VgJsonLinesWriter::writeError( const VgExportError& err )
+{
+   QTextStream& s = *m_strm;
+   s << "{\"type\":\"error\",\"tool\":" << jsonString( m_tool )
+     << ",\"pid\":" << jsonString( m_pid )
+     << ",\"unique\":" << jsonString( err.unique )
+     << ",\"fingerprint\":\"" << QString::number( err.fingerprint, 16 ) << "\""
+     << ",\"kind\":" << jsonString( err.kind )
+     << ",\"what\":" << jsonString( err.what );
+   if ( !err.tid.isEmpty() ) {
+      s << ",\"tid\":" << err.tid.toInt();
+   }
+   if ( !err.leakedBytes.isEmpty() ) {
+      s << ",\"leakedbytes\":" << err.leakedBytes.toULongLong()
+        << ",\"leakedblocks\":" << err.leakedBlocks.toULongLong();
+   }
+
+   s << ",\"stack\":[";
+   for ( int i = 0; i < err.stack.count(); ++i ) {
+      const VgExportFrame& frame = err.stack.at( i );
+      if ( i > 0 ) {
+         s << ",";
+      }
+      s << "{\"ip\":" << jsonString( frame.ip )
+        << ",\"obj\":" << jsonString( frame.obj )
+        << ",\"fn\":" << jsonString( frame.fn )
+        << ",\"dir\":" << jsonString( frame.dir )
+        << ",\"file\":" << jsonString( frame.file );
+      if ( !frame.line.isEmpty() ) {
+         s << ",\"line\":" << frame.line.toInt();
+      }
+      s << "}";
+   }
+   s << "]}\n";
+}
+
+void VgJsonLinesWriter::writeErrorCount( const QString& unique, int count )
+{
+   *m_strm << "{\"type\":\"errorcount\",\"tool\":" << jsonString( m_tool )
+           << ",\"pid\":" << jsonString( m_pid )
+           << ",\"unique\":" << jsonString( unique )
+           << ",\"count\":" << count << "}\n";
+}
+
+void VgJsonLinesWriter::writeSuppCount( const QString& name, int count )
+{
+   *m_strm << "{\"type\":\"suppcount\",\"tool\":" << jsonString( m_tool )
+           << ",\"pid\":" << jsonString( m_pid )
+           << ",\"name\":" << jsonString( name )
+           << ",\"count\":" << count << "}\n";
+}
+
+
+
+/**********************************************************************/
+/* VgCsvWriter */
+
+// one column per field: unused fields are left empty.
+enum CsvColumn {
+   COL_TYPE = 0, COL_TOOL, COL_PID, COL_UNIQUE, COL_FINGERPRINT, COL_KIND,
+   COL_TID, COL_WHAT, COL_LEAKEDBYTES, COL_LEAKEDBLOCKS, COL_COUNT, COL_NAME,
+   COL_FN, COL_FILE, COL_LINE, COL_OBJ, COL_STACK, NUM_COLS
+};
+
+static const char* csvHeader[NUM_COLS] = {
+   "type", "tool", "pid", "unique", "fingerprint", "kind",
+   "tid", "what", "leakedbytes", "leakedblocks", "count", "name",
+   "fn", "file", "line", "obj", "stack"
+};
+
+VgCsvWriter::VgCsvWriter( QTextStream* strm )
+   : VgLogExportWriter( strm )
+{ }
+
+void VgCsvWriter::beginDoc()
+{
+   QStringList row;
+   for ( int i = 0; i < NUM_COLS; ++i ) {
+      row << csvHeader[i];
+   }
+   writeRow( row );
+}
+
+void VgCsvWriter::beginRun( const QString& tool, const QString& pid,
+                            const QString& logFile )
+{
+   m_tool = tool;
+   m_pid  = pid;
+   m_logFile = logFile;
+
+   QStringList row;
+   for ( int i = 0; i < NUM_COLS; ++i ) {
+      row << QString();
+   }
+   row[COL_TYPE] = "run";
+   row[COL_TOOL] = m_tool;
+   row[COL_PID]  = m_pid;
+   row[COL_NAME] = m_logFile;
+   writeRow( row );
+}
+
+void VgCsvWriter::writeError( const VgExportError& err )
+{
+   QStringList row;
+   for ( int i = 0; i < NUM_COLS; ++i ) {
+      row << QString();
+   }
+   row[COL_TYPE]   = "error";
+   row[COL_TOOL]   = m_tool;
+   row[COL_PID]    = m_pid;
+   row[COL_UNIQUE] = err.unique;
+   row[COL_FINGERPRINT] = QString::number( err.fingerprint, 16 );
+   row[COL_KIND]   = err.kind;
+   row[COL_TID]    = err.tid;
+   row[COL_WHAT]   = err.what;
+   row[COL_LEAKEDBYTES]  = err.leakedBytes;
+   row[COL_LEAKEDBLOCKS] = err.leakedBlocks;
+
+   if ( !err.stack.isEmpty() ) {
+      const VgExportFrame& top = err.stack.first();
+      row[COL_FN]   = top.fn;
+      row[COL_FILE] = top.file;
+      row[COL_LINE] = top.line;
+      row[COL_OBJ]  = top.obj;
+
+      QStringList frames;
+      foreach ( VgExportFrame frame, err.stack ) {
+         frames << frameLocation( frame );
+      }
+      row[COL_STACK] = frames.join( " | " );
+   }
+   writeRow( row );
+}
+
+void VgCsvWriter::writeErrorCount( const QString& unique, int count )
+{
+   QStringList row;
+   for ( int i = 0; i < NUM_COLS; ++i ) {
+      row << QString();
+   }
+   row[COL_TYPE]   = "errorcount";
+   row[COL_TOOL]   = m_tool;
+   row[COL_PID]    = m_pid;
+   row[COL_UNIQUE] = unique;
+   row[COL_COUNT]  = QString::number( count );
+   writeRow( row );
+}
+
+void VgCsvWriter::writeSuppCount( const QString& name, int count )
+{
+   QStringList row;
+   for ( int i = 0; i < NUM_COLS; ++i ) {
+      row << QString();
+   }
+   row[COL_TYPE]  = "suppcount";
+   row[COL_TOOL]  = m_tool;
+   row[COL_PID]   = m_pid;
+   row[COL_NAME]  = name;
+   row[COL_COUNT] = QString::number( count );
+   writeRow( row );
+}
+
+void VgCsvWriter::writeRow( const QStringList& fields )
+{
+   for ( int i = 0; i < fields.count(); ++i ) {
+      if ( i > 0 ) {
+         *m_strm << ",";
+      }
+      *m_strm << csvField( fields.at( i ) );
+   }
+   *m_strm << "\n";
+}
+
+/*!
+  Quote the field only if it has to be (as RFC 4180):
+  it holds a separator, a quote or a line break.
+*/
+QString VgCsvWriter::csvField( const QString& str )
+{
+   if ( !str.contains( ',' ) && !str.contains( '"' ) &&
+        !str.contains( '\n' ) && !str.contains( '\r' ) ) {
+      return str;
+   }
+   QString res = str;
+   res.replace( "\"", "\"\"" );
+   return "\"" + res + "\"";
+}
+
+
+
+/**********************************************************************/
+/* VgSarifWriter */
+VgSarifWriter::VgSarifWriter( QTextStream* strm )
+   : VgLogExportWriter( strm ), m_numRuns( 0 ),
+     m_section( SECT_RESULTS ), m_firstInSection( true )
+{ }
+
+void VgSarifWriter::beginDoc()
+{
+   *m_strm << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+           << "\"version\":\"2.1.0\",\"runs\":[\n";
+}
+
+void VgSarifWriter::beginRun( const QString& tool, const QString& pid,
+                              const QString& logFile )
+{
+   m_tool = tool;
+   m_pid  = pid;
+   m_logFile = logFile;
+
+   if ( m_numRuns++ > 0 ) {
+      *m_strm << ",\n";
+   }
+   *m_strm << "{\"tool\":{\"driver\":{\"name\":" << jsonString( m_tool )
+           << ",\"informationUri\":\"http://www.valgrind.org/\"}},"
+           << "\"results\":[\n";
+
+   m_section = SECT_RESULTS;
+   m_firstInSection = true;
+}
+
+void VgSarifWriter::writeError( const VgExportError& err )
+{
+   vk_assert( m_section == SECT_RESULTS );
+   QTextStream& s = *m_strm;
+
+   if ( !m_firstInSection ) {
+      s << ",\n";
+   }
+   m_firstInSection = false;
+
+   s << "{\"ruleId\":" << jsonString( err.kind )
+     << ",\"level\":\"" << level( err.kind ) << "\""
+     << ",\"message\":{\"text\":"
+     << jsonString( err.what.isEmpty() ? err.kind : err.what ) << "}";
+
+   // primary location: the first frame we have source for
+   foreach ( VgExportFrame frame, err.stack ) {
+      if ( !frame.file.isEmpty() ) {
+         s << ",\"locations\":[{\"physicalLocation\":" << physicalLocation( frame );
+         if ( !frame.fn.isEmpty() ) {
+            s << ",\"logicalLocations\":[{\"fullyQualifiedName\":"
+              << jsonString( frame.fn ) << "}]";
+         }
+         s << "}]";
+         break;
+      }
+   }
+
+   if ( !err.stack.isEmpty() ) {
+      s << ",\"stacks\":[{\"frames\":[";
+      for ( int i = 0; i < err.stack.count(); ++i ) {
+         const VgExportFrame& frame = err.stack.at( i );
+         if ( i > 0 ) {
+            s << ",";
+         }
+         s << "{\"location\":{";
+         if ( !frame.file.isEmpty() ) {
+            s << "\"physicalLocation\":" << physicalLocation( frame ) << ",";
+         }
+         s << "\"logicalLocations\":[{\"fullyQualifiedName\":"
+           << jsonString( frame.fn.isEmpty() ? frame.ip : frame.fn ) << "}]}";
+         if ( !frame.obj.isEmpty() ) {
+            s << ",\"module\":" << jsonString( frame.obj );
+         }
+         s << "}";
+      }
+      s << "]}]";
+   }
+
+   s << ",\"partialFingerprints\":{\"valkyrieFingerprint/v1\":\""
+     << QString::number( err.fingerprint, 16 ) << "\"}"
+     << ",\"properties\":{\"unique\":" << jsonString( err.unique );
+   if ( !err.tid.isEmpty() ) {
+      s << ",\"tid\":" << err.tid.toInt();
+   }
+   if ( !err.leakedBytes.isEmpty() ) {
+      s << ",\"leakedbytes\":" << err.leakedBytes.toULongLong()
+        << ",\"leakedblocks\":" << err.leakedBlocks.toULongLong();
+   }
+   s << "}}";
+}
+
+void VgSarifWriter::writeErrorCount( const QString& unique, int count )
+{
+   enterSection( SECT_ERRORCOUNTS );
+   if ( !m_firstInSection ) {
+      *m_strm << ",";
+   }
+   m_firstInSection = false;
+   *m_strm << jsonString( unique ) << ":" << count;
+}
+
+void VgSarifWriter::writeSuppCount( const QString& name, int count )
+{
+   enterSection( SECT_SUPPCOUNTS );
+   if ( !m_firstInSection ) {
+      *m_strm << ",";
+   }
+   m_firstInSection = false;
+   *m_strm << jsonString( name ) << ":" << count;
+}
+
+void VgSarifWriter::endRun()
+{
+   enterSection( SECT_SUPPCOUNTS );
+   *m_strm << "}}}";   // suppcounts, properties, run
+}
+
+void VgSarifWriter::endDoc()
+{
+   *m_strm << "\n]}\n";
+}
+
+/*!
+  The counts come after the results: they go in the run's properties.
+  Sections only ever move forward: results, errorcounts, suppcounts.
+*/
+void VgSarifWriter::enterSection( Section sect )
+{
+   if ( sect == m_section ) {
+      return;
+   }
+   vk_assert( sect > m_section );
+
+   if ( m_section == SECT_RESULTS ) {
+      *m_strm << "\n],\"properties\":{\"pid\":" << jsonString( m_pid )
+              << ",\"log\":" << jsonString( m_logFile )
+              << ",\"errorcounts\":{";
+      m_section = SECT_ERRORCOUNTS;
+   }
+   if ( sect == SECT_SUPPCOUNTS ) {
+      *m_strm << "},\"suppcounts\":{";
+      m_section = SECT_SUPPCOUNTS;
+   }
+   m_firstInSection = true;
+}
+
+QString VgSarifWriter::level( const QString& kind )
+{
+   if ( kind == "Leak_StillReachable" ) {
+      return "note";
+   }
+   if ( kind == "Leak_PossiblyLost" ) {
+      return "warning";
+   }
+   return "error";
+}
+
+QString VgSarifWriter::physicalLocation( const VgExportFrame& frame )
+{
+   QString path = frame.dir.isEmpty() ? frame.file : frame.dir + "/" + frame.file;
+   QString uri = path.startsWith( '/' ) ? QUrl::fromLocalFile( path ).toString()
+                                        : path;
+   QString loc = "{\"artifactLocation\":{\"uri\":" + jsonString( uri ) + "}";
+   if ( frame.line.toInt() > 0 ) {
+      loc += ",\"region\":{\"startLine\":" + frame.line + "}";
+   }
+   return loc + "}";
+}
+
+
+
+
+/**********************************************************************/
+/* VgLogExportHandler */
+VgLogExportHandler::VgLogExportHandler( VgLogExportWriter* writer,
+                                        const QString& logFile )
+   : m_writer( writer ), m_logFile( logFile ), m_runStarted( false ),
+     m_inStack( false ), m_haveStack( false ), m_numErrors( 0 )
+{
+   vk_assert( m_writer != 0 );
+}
+
+VgLogExportHandler::~VgLogExportHandler()
+{ }
+
+bool VgLogExportHandler::startElement( const QString&, const QString&,
+                                       const QString& tag,
+                                       const QXmlAttributes& )
+{
+   m_path.append( tag );
+   m_chars = QString();
+   int depth = m_path.count();
+
+   if ( depth == 2 && tag == "error" ) {
+      m_err = VgExportError();
+      m_inStack = m_haveStack = false;
+      m_stackSig = QString();
+   }
+   else if ( depth == 3 && tag == "stack" && m_path.at( 1 ) == "error" ) {
+      // only the error's own stack: aux stacks are left out.
+      m_inStack = !m_haveStack;
+   }
+   else if ( depth == 4 && tag == "frame" && m_inStack ) {
+      m_frame = VgExportFrame();
+   }
+   else if ( depth == 2 && tag == "errorcounts" ) {
+      m_errCounts.clear();
+   }
+   else if ( depth == 2 && tag == "suppcounts" ) {
+      m_suppCounts.clear();
+   }
+
+   return true;
+}
+
+bool VgLogExportHandler::endElement( const QString&, const QString&,
+                                     const QString& tag )
+{
+   int depth = m_path.count();
+   if ( depth == 0 ) {
+      return false;
+   }
+
+   QString text = m_chars.simplified();
+   m_chars = QString();
+
+   if ( depth == 2 && tag == "protocoltool" ) {
+      m_tool = text;
+   }
+   else if ( depth == 2 && tag == "pid" ) {
+      m_pid = text;
+   }
+   else if ( depth == 2 && tag == "status" ) {
+      // preamble done.
+      startRun();
+   }
+   else if ( depth >= 2 && m_path.at( 1 ) == "error" ) {
+      QString parent = m_path.at( depth - 2 );
+
+      if ( depth == 3 ) {
+         if ( tag == "unique" ) {
+            m_err.unique = text;
+         }
+         else if ( tag == "tid" ) {
+            m_err.tid = text;
+         }
+         else if ( tag == "kind" ) {
+            m_err.kind = text;
+         }
+         else if ( tag == "what" ) {
+            m_err.what = text;
+         }
+         else if ( tag == "stack" && m_inStack ) {
+            m_inStack = false;
+            m_haveStack = true;
+         }
+      }
+      else if ( depth == 4 && parent == "xwhat" ) {
+         if ( tag == "text" && m_err.what.isEmpty() ) {
+            m_err.what = text;
+         }
+         else if ( tag == "leakedbytes" ) {
+            m_err.leakedBytes = text;
+         }
+         else if ( tag == "leakedblocks" ) {
+            m_err.leakedBlocks = text;
+         }
+      }
+      else if ( m_inStack && depth == 5 ) {
+         if ( tag == "ip" ) {
+            m_frame.ip = text;
+         }
+         else if ( tag == "obj" ) {
+            m_frame.obj = text;
+         }
+         else if ( tag == "fn" ) {
+            m_frame.fn = text;
+         }
+         else if ( tag == "dir" ) {
+            m_frame.dir = text;
+         }
+         else if ( tag == "file" ) {
+            m_frame.file = text;
+         }
+         else if ( tag == "line" ) {
+            m_frame.line = text;
+         }
+      }
+      else if ( m_inStack && depth == 4 && tag == "frame" ) {
+         m_err.stack.append( m_frame );
+         m_stackSig += '\n' + VgLogDiff::frameSignature( m_frame.fn, m_frame.obj,
+                                                         m_frame.file );
+      }
+      else if ( depth == 2 && tag == "error" ) {
+         // error complete: write it out, and forget it.
+         m_err.fingerprint = VgLogDiff::fingerprint( m_err.kind + m_stackSig );
+         startRun();
+         m_writer->writeError( m_err );
+         m_err = VgExportError();
+         m_numErrors++;
+      }
+   }
+   else if ( depth >= 3 && ( m_path.at( 1 ) == "errorcounts" ||
+                             m_path.at( 1 ) == "suppcounts" ) ) {
+      if ( depth == 4 && tag == "count" ) {
+         m_pairCount = text;
+      }
+      else if ( depth == 4 && ( tag == "unique" || tag == "name" ) ) {
+         m_pairKey = text;
+      }
+      else if ( depth == 3 && tag == "pair" ) {
+         QPair<QString, int> pair( m_pairKey, m_pairCount.toInt() );
+         if ( m_path.at( 1 ) == "errorcounts" ) {
+            m_errCounts.append( pair );
+         }
+         else {
+            m_suppCounts.append( pair );
+         }
+         m_pairCount = m_pairKey = QString();
+      }
+   }
+
+   m_path.removeLast();
+   return true;
+}
+
+bool VgLogExportHandler::characters( const QString& ch )
+{
+   m_chars += ch;
+   return true;
+}
+
+bool VgLogExportHandler::startDocument()
+{
+   m_path.clear();
+   m_errCounts.clear();
+   m_suppCounts.clear();
+   m_tool = m_pid = m_fatalMsg = QString();
+   m_runStarted = false;
+   m_numErrors = 0;
+   return true;
+}
+
+bool VgLogExportHandler::endDocument()
+{
+   startRun();
+
+   for ( int i = 0; i < m_errCounts.count(); ++i ) {
+      m_writer->writeErrorCount( m_errCounts.at( i ).first,
+                                 m_errCounts.at( i ).second );
+   }
+   for ( int i = 0; i < m_suppCounts.count(); ++i ) {
+      m_writer->writeSuppCount( m_suppCounts.at( i ).first,
+                                m_suppCounts.at( i ).second );
+   }
+   m_writer->endRun();
+
+   m_errCounts.clear();
+   m_suppCounts.clear();
+   return m_path.isEmpty();
+}
+
+bool VgLogExportHandler::fatalError( const QXmlParseException& exception )
+{
+   m_fatalMsg = exception.message() +
+                " (line: " + QString::number( exception.lineNumber() ) +
+                ", col: " + QString::number( exception.columnNumber() ) + ")";
+   return false;
+}
+
+/*!
+  Start the writer's run for this log, once we know enough about it.
+*/
+void VgLogExportHandler::startRun()
+{
+   if ( !m_runStarted ) {
+      m_writer->beginRun( m_tool, m_pid, m_logFile );
+      m_runStarted = true;
+   }
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgLogExport
+*/
+
+/*!
+  Export format, from the file extension:
+  .jsonl/.ndjson/.json, .csv, .sarif/.sarif.json
+*/
+VGLOGEXPORT::Format VgLogExport::formatForFile( const QString& exportFile )
+{
+   QString fname = exportFile.toLower();
+   if ( fname.endsWith( ".sarif" ) || fname.endsWith( ".sarif.json" ) ) {
+      return VGLOGEXPORT::FMT_SARIF;
+   }
+   if ( fname.endsWith( ".jsonl" ) || fname.endsWith( ".ndjson" ) ||
+        fname.endsWith( ".json" ) ) {
+      return VGLOGEXPORT::FMT_JSONL;
+   }
+   if ( fname.endsWith( ".csv" ) ) {
+      return VGLOGEXPORT::FMT_CSV;
+   }
+   return VGLOGEXPORT::FMT_NONE;
+}
+
+
+bool VgLogExport::exportLogs( const QStringList& logFiles,
+                              const QString& exportFile,
+                              QString& errMsg )
+{
+   VGLOGEXPORT::Format format = formatForFile( exportFile );
+   if ( format == VGLOGEXPORT::FMT_NONE ) {
+      errMsg = "Unknown export format for '" + exportFile +
+               "': use .jsonl, .csv or .sarif";
+      return false;
+   }
+   return exportLogs( logFiles, exportFile, format, errMsg );
+}
+
+
+/*!
+  Export logFiles to exportFile ("-" for stdout), one run per log.
+  Each log is streamed straight through to the export file:
+  nothing is built in memory.
+*/
+bool VgLogExport::exportLogs( const QStringList& logFiles,
+                              const QString& exportFile,
+                              VGLOGEXPORT::Format format,
+                              QString& errMsg )
+{
+   bool to_stdout = ( exportFile == "-" );
+   QFile file;
+   bool ok;
+   if ( to_stdout ) {
+      ok = file.open( stdout, QIODevice::WriteOnly );
+   }
+   else {
+      file.setFileName( exportFile );
+      ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate );
+   }
+   if ( !ok ) {
+      errMsg = "Failed to open export file: '" + exportFile + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   strm.setCodec( "UTF-8" );
+   VgLogExportWriter* writer = VgLogExportWriter::create( format, &strm );
+
+   writer->beginDoc();
+   foreach ( QString logFile, logFiles ) {
+      QFile log( logFile );
+      if ( !log.open( QIODevice::ReadOnly ) ) {
+         errMsg = "Failed to open log file: '" + logFile + "'";
+         ok = false;
+         break;
+      }
+
+      VgLogExportHandler handler( writer, logFile );
+      QXmlSimpleReader reader;
+      reader.setContentHandler( &handler );
+      reader.setErrorHandler( &handler );
+
+      QXmlInputSource source( &log );
+      if ( !reader.parse( &source ) ) {
+         errMsg = "Failed to parse '" + logFile + "'";
+         if ( !handler.fatalMsg().isEmpty() ) {
+            errMsg += ":\n" + handler.fatalMsg();
+         }
+         ok = false;
+         break;
+      }
+   }
+   writer->endDoc();
+   strm.flush();
+   delete writer;
+
+   if ( !ok && !to_stdout ) {
+      // don't leave a half-written export lying around
+      file.close();
+      file.remove();
+   }
+   return ok;
+}
@@ -0,0 +1,242 @@
+/****************************************************************************
+** VgLogExport definition
+**  - streaming export of valgrind xml logs to JSON Lines, CSV and SARIF
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGEXPORT_H
+#define __VGLOGEXPORT_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include <QXmlAttributes>
+#include <QXmlDefaultHandler>
+
+
+// ============================================================
+namespace VGLOGEXPORT {
+   enum Format { FMT_NONE = -1, FMT_JSONL = 0, FMT_CSV, FMT_SARIF, NUM_FORMATS };
+}
+
+
+// one stack frame, as given in the log
+class VgExportFrame
+{
+public:
+   QString ip, obj, fn, dir, file, line;
+};
+
+// one <error>: only its own (first) stack is kept
+class VgExportError
+{
+public:
+   QString unique, tid, kind, what;
+   QString leakedBytes, leakedBlocks;
+   quint64 fingerprint;
+   QList<VgExportFrame> stack;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogExportWriter: writes export records to a text stream,
+  as they come. Nothing is kept, bar the odd state flag:
+  memory use doesn't depend on the size of the log.
+
+  A document holds one run per log:
+   beginDoc, { beginRun, error*, errorcount*, suppcount*, endRun }*, endDoc
+*/
+class VgLogExportWriter
+{
+public:
+   VgLogExportWriter( QTextStream* strm );
+   virtual ~VgLogExportWriter();
+
+   virtual void beginDoc() {}
+   virtual void beginRun( const QString& tool, const QString& pid,
+                          const QString& logFile ) = 0;
+   virtual void writeError( const VgExportError& err ) = 0;
+   virtual void writeErrorCount( const QString& unique, int count ) = 0;
+   virtual void writeSuppCount( const QString& name, int count ) = 0;
+   virtual void endRun() {}
+   virtual void endDoc() {}
+
+   static VgLogExportWriter* create( VGLOGEXPORT::Format format,
+                                     QTextStream* strm );
+
+protected:
+   static QString jsonString( const QString& str );
+   static QString frameLocation( const VgExportFrame& frame );
+
+protected:
+   QTextStream* m_strm;        // we don't own this
+   QString m_tool, m_pid, m_logFile;   // current run
+};
+
+
+// JSON Lines: one self-contained json object per line
+class VgJsonLinesWriter : public VgLogExportWriter
+{
+public:
+   VgJsonLinesWriter( QTextStream* strm );
+
+   void beginRun( const QString& tool, const QString& pid,
+                  const QString& logFile );
+   void writeError( const VgExportError& err );
+   void writeErrorCount( const QString& unique, int count );
+   void writeSuppCount( const QString& name, int count );
+};
+
+
+// CSV: one row per record, the first column giving its type
+class VgCsvWriter : public VgLogExportWriter
+{
+public:
+   VgCsvWriter( QTextStream* strm );
+
+   void beginDoc();
+   void beginRun( const QString& tool, const QString& pid,
+                  const QString& logFile );
+   void writeError( const VgExportError& err );
+   void writeErrorCount( const QString& unique, int count );
+   void writeSuppCount( const QString& name, int count );
+
+private:
+   void writeRow( const QStringList& fields );
+   static QString csvField( const QString& str );
+};
+
+
+// SARIF 2.1.0: one run per log, one result per error
+class VgSarifWriter : public VgLogExportWriter
+{
+public:
+   VgSarifWriter( QTextStream* strm );
+
+   void beginDoc();
+   void beginRun( const QString& tool, const QString& pid,
+                  const QString& logFile );
+   void writeError( const VgExportError& err );
+   void writeErrorCount( const QString& unique, int count );
+   void writeSuppCount( const QString& name, int count );
+   void endRun();
+   void endDoc();
+
+private:
+   enum Section { SECT_RESULTS, SECT_ERRORCOUNTS, SECT_SUPPCOUNTS };
+   void enterSection( Section sect );
+   static QString level( const QString& kind );
+   static QString physicalLocation( const VgExportFrame& frame );
+
+private:
+   int     m_numRuns;
+   Section m_section;
+   bool    m_firstInSection;
+};
+
+
+
+// ============================================================
+/*
+  Streaming xml handler for valgrind logs, feeding a VgLogExportWriter:
+  - each error is written out as soon as its closing tag is seen,
+    so only one error is ever held in memory.
+  - errorcounts / suppcounts may be output more than once: the pairs
+    of the last ones seen are held, and written at the end of the log.
+*/
+class VgLogExportHandler : public QXmlDefaultHandler
+{
+public:
+   VgLogExportHandler( VgLogExportWriter* writer, const QString& logFile );
+   ~VgLogExportHandler();
+
+   // content handler
+   bool startElement( const QString& nsURI,
+                      const QString& localName,
+                      const QString& qName,
+                      const QXmlAttributes& atts );
+   bool endElement( const QString& nsURI,
+                    const QString& localName,
+                    const QString& qName );
+   bool characters( const QString& ch );
+   bool startDocument();
+   bool endDocument();
+
+   // reimplement error handlers
+   bool fatalError( const QXmlParseException& exception );
+
+   QString fatalMsg() {
+      return m_fatalMsg;
+   }
+   int numErrors() {
+      return m_numErrors;
+   }
+
+private:
+   void startRun();
+
+private:
+   VgLogExportWriter* m_writer;    // we don't own this
+   QString m_logFile;
+   bool m_runStarted;
+
+   QStringList m_path;             // open element tags
+   QString m_chars;                // text of the current element
+
+   // current error
+   VgExportError m_err;
+   VgExportFrame m_frame;
+   bool m_inStack, m_haveStack;
+   QString m_stackSig;
+
+   // current errorcounts / suppcounts pair
+   QString m_pairCount, m_pairKey;
+   QList< QPair<QString, int> > m_errCounts;   // from the last <errorcounts>
+   QList< QPair<QString, int> > m_suppCounts;  // from the last <suppcounts>
+
+   QString m_tool, m_pid;
+   QString m_fatalMsg;
+   int m_numErrors;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogExport: exports valgrind xml logs, in a single streaming
+  pass per log, straight from the log files.
+*/
+class VgLogExport
+{
+public:
+   static VGLOGEXPORT::Format formatForFile( const QString& exportFile );
+
+   static bool exportLogs( const QStringList& logFiles,
+                           const QString& exportFile,
+                           QString& errMsg );
+   static bool exportLogs( const QStringList& logFiles,
+                           const QString& exportFile,
+                           VGLOGEXPORT::Format format,
+                           QString& errMsg );
+};
+
+#endif // #ifndef __VGLOGEXPORT_H
@@ -0,0 +1,327 @@
+/****************************************************************************
+** VgLogLoader implementation
+**  - loads a log on a thread of its own, into a view
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogloader.h"
+#include "utils/vglogreader.h"
+#include "utils/vk_stringpool.h"
+#include "utils/vk_utils.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+
+// Loading in the background:
+#define LOAD_QUEUE_MAX    2000 // elements parsed but not yet shown
+#define LOAD_TAKE_NODES   50   // elements taken from the queue at a time
+#define LOAD_CHUNK_MSECS  40   // gui time for each chunk, between events
+#define LOAD_IDLE_MSECS   20   // wait, when the parser's behind
+
+
+/**********************************************************************/
+/*!
+  VgLogQueue
+*/
+VgLogQueue::VgLogQueue()
+   : m_haveInit( false ), m_bytesRead( 0 ), m_fileSize( 0 ),
+     m_cancelled( false ), m_finished( false ), m_ok( false )
+{
+}
+
+void VgLogQueue::init( QDomDocument doc, QString insnTarget,
+                       QString insnData, QString doc_tag )
+{
+   QMutexLocker locker( &m_mutex );
+   m_doc = doc;
+   m_insnTarget = insnTarget;
+   m_insnData = insnData;
+   m_docTag = doc_tag;
+   m_haveInit = true;
+}
+
+/*!
+  Blocks while the queue's full.  False once cancelled: stop parsing.
+*/
+bool VgLogQueue::push( QDomNode node )
+{
+   QMutexLocker locker( &m_mutex );
+   while ( !m_cancelled && m_nodes.count() >= LOAD_QUEUE_MAX ) {
+      m_notFull.wait( &m_mutex );
+   }
+   if ( m_cancelled ) {
+      return false;
+   }
+   m_nodes.append( node );
+   return true;
+}
+
+void VgLogQueue::setProgress( qint64 bytesRead, qint64 fileSize )
+{
+   QMutexLocker locker( &m_mutex );
+   m_bytesRead = bytesRead;
+   m_fileSize = fileSize;
+}
+
+/*!
+  Last call from the parsing thread: after this, the queue may go.
+*/
+void VgLogQueue::finish( bool ok, QString errMsg )
+{
+   QMutexLocker locker( &m_mutex );
+   m_ok = ok;
+   m_errMsg = errMsg;
+   m_finished = true;
+   m_finishedCond.wakeAll();
+}
+
+bool VgLogQueue::isCancelled()
+{
+   QMutexLocker locker( &m_mutex );
+   return m_cancelled;
+}
+
+bool VgLogQueue::takeInit( QString& insnTarget, QString& insnData, QString& doc_tag )
+{
+   QMutexLocker locker( &m_mutex );
+   if ( !m_haveInit ) {
+      return false;
+   }
+   insnTarget = m_insnTarget;
+   insnData = m_insnData;
+   doc_tag = m_docTag;
+   return true;
+}
+
+QList<QDomNode> VgLogQueue::take( int max )
+{
+   QMutexLocker locker( &m_mutex );
+   QList<QDomNode> nodes;
+   if ( m_nodes.count() <= max ) {
+      nodes.swap( m_nodes );
+   }
+   else {
+      nodes = m_nodes.mid( 0, max );
+      m_nodes.erase( m_nodes.begin(), m_nodes.begin() + max );
+   }
+   if ( !nodes.isEmpty() ) {
+      m_notFull.wakeAll();
+   }
+   return nodes;
+}
+
+void VgLogQueue::progress( qint64& bytesRead, qint64& fileSize )
+{
+   QMutexLocker locker( &m_mutex );
+   bytesRead = m_bytesRead;
+   fileSize = m_fileSize;
+}
+
+bool VgLogQueue::drained( bool& ok, QString& errMsg )
+{
+   QMutexLocker locker( &m_mutex );
+   if ( !m_finished || !m_nodes.isEmpty() ) {
+      return false;
+   }
+   ok = m_ok;
+   errMsg = m_errMsg;
+   return true;
+}
+
+/*!
+  Stops the parse: drops what's queued, and frees a blocked push().
+*/
+void VgLogQueue::cancel()
+{
+   QMutexLocker locker( &m_mutex );
+   m_cancelled = true;
+   m_nodes.clear();
+   m_notFull.wakeAll();
+}
+
+void VgLogQueue::waitFinished()
+{
+   QMutexLocker locker( &m_mutex );
+   while ( !m_finished ) {
+      m_finishedCond.wait( &m_mutex );
+   }
+}
+
+
+
+/**********************************************************************/
+/*!
+  VgLogLoadJob
+*/
+VgLogLoadJob::VgLogLoadJob( VgLogQueue* queue, const QString& logFile )
+   : m_queue( queue ), m_logFile( logFile )
+{
+   // the loader deletes it: it may take it back, unstarted
+   setAutoDelete( false );
+}
+
+void VgLogLoadJob::run()
+{
+   bool ok;
+   QString errMsg;
+
+   {
+      VgLogReader reader( m_queue );
+      VgLogHandler* hnd = reader.handler();
+      int eofPasses = 0;
+
+      ok = reader.parse( m_logFile, true/*incremental*/ );
+      while ( ok && !hnd->finished() && !m_queue->isCancelled() ) {
+         ok = reader.parseContinue() && hnd->fatalMsg().isEmpty();
+         m_queue->setProgress( reader.bytesRead(), reader.fileSize() );
+
+         // all read, yet not finished: the log was cut short
+         if ( ok && !hnd->finished() && reader.atEnd() &&
+              ++eofPasses > LOAD_EOF_PASSES ) {
+            errMsg = "The log ends before its closing </valgrindoutput> tag";
+            ok = false;
+         }
+      }
+      m_queue->setProgress( reader.bytesRead(), reader.fileSize() );
+
+      if ( errMsg.isEmpty() ) {
+         errMsg = hnd->fatalMsg();
+      }
+   }
+
+   // the reader and its document are gone: the queue's owner, and
+   // this job, may go too
+   m_queue->finish( ok, errMsg );
+}
+
+
+
+/**********************************************************************/
+/*!
+  VgLogLoader
+*/
+VgLogLoader::VgLogLoader( VgLogView* logview, QObject* parent )
+   : QObject( parent ), m_logview( logview ), m_queue( 0 ),
+     m_pool( 0 ), m_job( 0 ), m_initDone( false ), m_running( false )
+{
+   m_timer.setSingleShot( true );
+   connect( &m_timer, SIGNAL( timeout() ), this, SLOT( appendChunk() ) );
+}
+
+VgLogLoader::~VgLogLoader()
+{
+   m_timer.stop();
+   if ( m_queue ) {
+      m_queue->cancel();
+      // not yet started, maybe behind other loads: never to start.
+      // Else wait for it: other loads hold the gui thread no longer.
+      if ( !m_pool->tryTake( m_job ) ) {
+         m_queue->waitFinished();
+      }
+      delete m_job;
+      m_job = 0;
+      delete m_queue;
+      m_queue = 0;
+   }
+   if ( m_running ) {
+      VkStringPool::instance()->release();
+   }
+}
+
+void VgLogLoader::start( QThreadPool* pool, const QString& logFile )
+{
+   vk_assert( m_queue == 0 );
+
+   VkStringPool::instance()->acquire();
+   m_running = true;
+   m_queue = new VgLogQueue();
+   m_pool = pool;
+   m_job = new VgLogLoadJob( m_queue, logFile );
+   pool->start( m_job );
+   m_timer.start( LOAD_IDLE_MSECS );
+}
+
+
+/*!
+  Append what's been parsed, for up to LOAD_CHUNK_MSECS:
+  between chunks, the user has the gui.
+*/
+void VgLogLoader::appendChunk()
+{
+   QElapsedTimer clock;
+   clock.start();
+
+   if ( !m_initDone ) {
+      QString target, data, doc_tag;
+      if ( m_queue->takeInit( target, data, doc_tag ) ) {
+         QDomProcessingInstruction xml_insn =
+            m_insnDoc.createProcessingInstruction( target, data );
+         m_insnDoc.appendChild( xml_insn );
+         if ( !m_logview->init( xml_insn, doc_tag ) ) {
+            fail( "Failed log initialisation" );
+            return;
+         }
+         m_initDone = true;
+      }
+   }
+
+   bool more = false;
+   while ( m_initDone && clock.elapsed() < LOAD_CHUNK_MSECS ) {
+      QList<QDomNode> nodes = m_queue->take( LOAD_TAKE_NODES );
+      if ( nodes.isEmpty() ) {
+         more = false;
+         break;
+      }
+      more = true;
+
+      QString errMsg;
+      foreach ( QDomNode node, nodes ) {
+         if ( !m_logview->appendNode( node, errMsg ) ) {
+            fail( errMsg );
+            return;
+         }
+      }
+   }
+
+   qint64 done, total;
+   m_queue->progress( done, total );
+   emit progress( done, total );
+
+   bool ok;
+   QString errMsg;
+   if ( m_queue->drained( ok, errMsg ) ) {
+      m_running = false;
+      VkStringPool::instance()->release();
+      emit finished( ok, errMsg );
+      return;
+   }
+
+   m_timer.start( more ? 0 : LOAD_IDLE_MSECS );
+}
+
+
+/*!
+  The view refused an element: stop the parse, keep what's shown.
+*/
+void VgLogLoader::fail( const QString& errMsg )
+{
+   m_queue->cancel();
+   m_running = false;
+   VkStringPool::instance()->release();
+   emit finished( false, errMsg );
+}
@@ -0,0 +1,153 @@
+/****************************************************************************
+** VgLogLoader definition
+**  - loads a log on a thread of its own, into a view
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGLOADER_H
+#define __VGLOGLOADER_H
+
+#include "toolview/vglogview.h"
+
+#include <QDomDocument>
+#include <QDomNode>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QWaitCondition>
+
+// reads at end of file, before a cut-short log is an error:
+// also for a run's child logs (see ToolObject)
+#define LOAD_EOF_PASSES   3
+
+
+// ============================================================
+/*!
+  VgLogQueue: a log's top-level elements, from the thread parsing it
+  to the gui thread that shows them.
+
+  The parsing thread blocks while the queue is full: a log loads no
+  faster than it's shown, so it's never all in memory twice.
+  Each element is taken out of the parser's document before it's
+  queued: the two threads never share a node.  The document itself
+  is kept until the queue goes, as detached nodes refer back to it.
+*/
+class VgLogQueue
+{
+public:
+   VgLogQueue();
+
+   // parsing thread
+   void init( QDomDocument doc, QString insnTarget, QString insnData,
+              QString doc_tag );
+   bool push( QDomNode node );   // false: cancelled
+   void setProgress( qint64 bytesRead, qint64 fileSize );
+   void finish( bool ok, QString errMsg );
+   bool isCancelled();
+
+   // gui thread
+   bool takeInit( QString& insnTarget, QString& insnData, QString& doc_tag );
+   QList<QDomNode> take( int max );
+   void progress( qint64& bytesRead, qint64& fileSize );
+   // all parsed, and all taken
+   bool drained( bool& ok, QString& errMsg );
+   void cancel();
+   void waitFinished();
+
+private:
+   QMutex         m_mutex;
+   QWaitCondition m_notFull;
+   QWaitCondition m_finishedCond;
+
+   QList<QDomNode> m_nodes;
+   QDomDocument    m_doc;   // queued nodes still point back to it
+   QString m_insnTarget, m_insnData;   // the <?xml...> element
+   QString m_docTag;
+   bool    m_haveInit;
+
+   qint64  m_bytesRead, m_fileSize;
+   bool    m_cancelled;
+   bool    m_finished;
+   bool    m_ok;
+   QString m_errMsg;
+};
+
+
+// ============================================================
+/*!
+  VgLogLoadJob: parses a log into its queue, on a pool's thread.
+*/
+class VgLogLoadJob : public QRunnable
+{
+public:
+   VgLogLoadJob( VgLogQueue* queue, const QString& logFile );
+
+   void run();
+
+private:
+   VgLogQueue* m_queue;
+   QString     m_logFile;
+};
+
+
+// ============================================================
+/*!
+  VgLogLoader: loads a log into a logview, in the background.
+
+  The file is parsed on a thread of the given pool (VgLogLoadJob).
+  Its elements are appended to the logview here, on the gui thread,
+  a time slice at a time: only the gui thread may make the view's
+  items.  Several loaders, on several logs, run at once.
+
+  Deleting the loader stops the parse, and waits for its thread.
+*/
+class VgLogLoader : public QObject
+{
+   Q_OBJECT
+public:
+   VgLogLoader( VgLogView* logview, QObject* parent );
+   ~VgLogLoader();
+
+   void start( QThreadPool* pool, const QString& logFile );
+
+signals:
+   // bytes parsed, of total
+   void progress( qint64 done, qint64 total );
+   void finished( bool ok, QString errMsg );
+
+private slots:
+   void appendChunk();
+
+private:
+   void fail( const QString& errMsg );
+
+private:
+   VgLogView*  m_logview;   // not ours
+   VgLogQueue* m_queue;
+   QThreadPool*  m_pool;
+   VgLogLoadJob* m_job;     // ours: not auto-deleted
+   QDomDocument m_insnDoc;  // owns the gui thread's <?xml...> element
+   QTimer      m_timer;
+   bool        m_initDone;
+   bool        m_running;
+};
+
+#endif // #ifndef __VGLOGLOADER_H
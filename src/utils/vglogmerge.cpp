@@ -0,0 +1,559 @@
+/****************************************************************************
+** VgLogMerge implementation
+**  - merges several valgrind xml logs into one logview
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogmerge.h"
+#include "utils/vglogdiff.h"
+#include "utils/vk_utils.h"
+#include "toolview/vglogview.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QTextStream>
+#include <QThreadPool>
+
+
+/**********************************************************************/
+/* VgLogMergeJob */
+VgLogMergeJob::VgLogMergeJob( const QString& file )
+   : logFile( file ), lastLeakCheck( -1 ), maxThreadId( 0 ), ok( false )
+{
+   // we collect the results after the pool is done.
+   setAutoDelete( false );
+}
+
+void VgLogMergeJob::run()
+{
+   QFile file( logFile );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      errMsg = "Failed to open log file: '" + logFile + "'";
+      return;
+   }
+
+   QString parseMsg;
+   int line, col;
+   if ( !doc.setContent( &file, &parseMsg, &line, &col ) ) {
+      errMsg = QString( "Failed to parse '%1':\n%2 (line: %3, col: %4)" )
+               .arg( logFile ).arg( parseMsg ).arg( line ).arg( col );
+      return;
+   }
+
+   QDomElement root = doc.documentElement();
+   pid = root.firstChildElement( "pid" ).text();
+
+   // a leak check's loss records run in order, and are output together:
+   // a record not past the last, or after another error, starts a check.
+   QRegExp lossRecord( "loss record ([0-9,]+) of" );
+   bool prevLeak = false;
+   int prevRecord = 0;
+
+   QDomElement e = root.firstChildElement();
+   for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
+      if ( e.tagName() == "error" ) {
+         fingerprints.append( VgLogDiff::fingerprint( e ) );
+
+         if ( !e.firstChildElement( "kind" ).text().startsWith( "Leak_" ) ) {
+            leakChecks.append( -1 );
+            prevLeak = false;
+            continue;
+         }
+         QString what = e.firstChildElement( "xwhat" ).firstChildElement( "text" ).text();
+         int record = 0;
+         if ( lossRecord.indexIn( what ) != -1 ) {
+            record = lossRecord.cap( 1 ).remove( ',' ).toInt();
+         }
+         if ( !prevLeak || record <= prevRecord ) {
+            ++lastLeakCheck;
+         }
+         prevLeak = true;
+         prevRecord = record;
+         leakChecks.append( lastLeakCheck );
+      }
+      else if ( e.tagName() == "announcethread" ) {
+         int tid = e.firstChildElement( "hthreadid" ).text().toInt();
+         maxThreadId = qMax( maxThreadId, tid );
+      }
+      else if ( e.tagName() == "errorcounts" ) {
+         // errorcounts may be output more than once: last one wins.
+         QDomElement pair = e.firstChildElement( "pair" );
+         for ( ; !pair.isNull(); pair = pair.nextSiblingElement( "pair" ) ) {
+            QString unique = pair.firstChildElement( "unique" ).text().simplified();
+            int count = pair.firstChildElement( "count" ).text().toInt();
+            uniqueCounts.insert( unique, count );
+         }
+      }
+   }
+
+   ok = true;
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgLogMerge
+*/
+VgLogMerge::VgLogMerge()
+{ }
+
+VgLogMerge::~VgLogMerge()
+{
+   qDeleteAll( m_jobs );
+}
+
+
+/*!
+  Read a list of log files, one per line.
+  Relative paths are taken relative to the loglist's directory,
+  blank lines and lines starting with '#' are ignored.
+*/
+bool VgLogMerge::readLogList( const QString& loglist, QStringList& logFiles,
+                              QString& errMsg )
+{
+   QFile file( loglist );
+   if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
+      errMsg = "Failed to open log list: '" + loglist + "'";
+      return false;
+   }
+
+   QDir dir = QFileInfo( loglist ).absoluteDir();
+   QTextStream strm( &file );
+   while ( !strm.atEnd() ) {
+      QString line = strm.readLine().trimmed();
+      if ( line.isEmpty() || line.startsWith( '#' ) ) {
+         continue;
+      }
+      logFiles << QDir::cleanPath( dir.absoluteFilePath( line ) );
+   }
+
+   if ( logFiles.isEmpty() ) {
+      errMsg = "No log files listed in '" + loglist + "'";
+      return false;
+   }
+   return true;
+}
+
+
+/*!
+  Merge logFiles into logview.
+  Returns false (with errMsg set) if any log failed to load,
+  or the logs don't belong together.
+*/
+bool VgLogMerge::merge( const QStringList& logFiles, VgLogView* logview,
+                        QString& errMsg )
+{
+   vk_assert( logview != 0 );
+
+   qDeleteAll( m_jobs );
+   m_jobs.clear();
+   m_merged.clear();
+   m_doc = QDomDocument();
+
+   if ( logFiles.isEmpty() ) {
+      errMsg = "No log files to merge";
+      return false;
+   }
+
+   // parse all logs concurrently
+   QThreadPool* pool = QThreadPool::globalInstance();
+   foreach ( QString logFile, logFiles ) {
+      VgLogMergeJob* job = new VgLogMergeJob( logFile );
+      m_jobs.append( job );
+      pool->start( job );
+   }
+
+   // could be many large files, so keep the ui up-to-date meanwhile
+   while ( !pool->waitForDone( 100 ) ) {
+      qApp->processEvents( QEventLoop::ExcludeUserInputEvents );
+   }
+
+   if ( !checkLogs( errMsg ) ) {
+      return false;
+   }
+
+   mergeErrors();
+   return emitLog( logview, errMsg );
+}
+
+
+/*!
+  All logs must have loaded, and come from the same tool.
+*/
+bool VgLogMerge::checkLogs( QString& errMsg )
+{
+   QString tool;
+
+   for ( int i = 0; i < m_jobs.count(); ++i ) {
+      VgLogMergeJob* job = m_jobs.at( i );
+      if ( !job->ok ) {
+         errMsg = job->errMsg;
+         return false;
+      }
+
+      QDomElement root = job->doc.documentElement();
+
+      QString protocol = root.firstChildElement( "protocolversion" ).text().simplified();
+      if ( protocol != "4" ) {
+         errMsg = "Unsupported XML protocol version (" + protocol +
+                  ") in '" + job->logFile + "'";
+         return false;
+      }
+
+      QString jobTool = root.firstChildElement( "protocoltool" ).text().simplified();
+      if ( i == 0 ) {
+         tool = jobTool;
+      }
+      else if ( jobTool != tool ) {
+         errMsg = "Logs are from different tools (" + tool + " -v- " +
+                  jobTool + "): '" + job->logFile + "'";
+         return false;
+      }
+
+      if ( root.firstChildElement( "status" ).isNull() ) {
+         errMsg = "No status found in '" + job->logFile + "'";
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+/*!
+  Deduplicate errors over all logs, by fingerprint.
+  Leaks are taken from the last leak check in each log
+  (VALGRIND_DO_LEAK_CHECK repeats them), then summed over logs.
+  One check may hold several loss records of the same fingerprint
+  (same function, another line or caller): those are summed too.
+*/
+void VgLogMerge::mergeErrors()
+{
+   int numLogs = m_jobs.count();
+   QHash<quint64, int> index;   // fingerprint -> m_merged
+
+   for ( int i = 0; i < numLogs; ++i ) {
+      VgLogMergeJob* job = m_jobs.at( i );
+      QDomElement err = job->doc.documentElement().firstChildElement( "error" );
+
+      for ( int n = 0; !err.isNull(); err = err.nextSiblingElement( "error" ), ++n ) {
+         int leakCheck = job->leakChecks.at( n );
+         if ( leakCheck != -1 && leakCheck != job->lastLeakCheck ) {
+            continue;   // superseded by a later leak check
+         }
+         quint64 fp = job->fingerprints.at( n );
+
+         int idx = index.value( fp, -1 );
+         if ( idx == -1 ) {
+            MergedError me;
+            me.err      = err;
+            me.firstLog = i;
+            me.isLeak   = err.firstChildElement( "kind" ).text().startsWith( "Leak_" );
+            me.counts.fill( 0, numLogs );
+            me.bytes.fill( 0, numLogs );
+            me.blocks.fill( 0, numLogs );
+
+            idx = m_merged.count();
+            m_merged.append( me );
+            index.insert( fp, idx );
+         }
+
+         MergedError& me = m_merged[idx];
+         if ( me.isLeak ) {
+            QDomElement xwhat = err.firstChildElement( "xwhat" );
+            me.counts[i] += 1;
+            me.bytes[i]  += xwhat.firstChildElement( "leakedbytes" ).text().toULongLong();
+            me.blocks[i] += xwhat.firstChildElement( "leakedblocks" ).text().toULongLong();
+         }
+         else {
+            // no errorcounts entry => seen just the once
+            QString unique = err.firstChildElement( "unique" ).text().simplified();
+            me.counts[i] += job->uniqueCounts.value( unique, 1 );
+         }
+      }
+   }
+}
+
+
+/*!
+  Feed the merged log to the view, as if it were one log.
+*/
+bool VgLogMerge::emitLog( VgLogView* logview, QString& errMsg )
+{
+   int numLogs = m_jobs.count();
+
+   if ( !logview->init( m_doc.createProcessingInstruction( "xml", "version=\"1.0\"" ),
+                        "valgrindoutput" ) ) {
+      errMsg = "Failed to initialise the log view";
+      return false;
+   }
+
+   // preamble + RUNNING status: from the first log
+   QDomElement root0 = m_jobs.first()->doc.documentElement();
+   QDomElement e = root0.firstChildElement();
+   while ( !e.isNull() ) {
+      QDomElement next = e.nextSiblingElement();
+      QString tag = e.tagName();
+      if ( tag == "error" || tag == "announcethread" ||
+           tag == "errorcounts" || tag == "suppcounts" ) {
+         break;
+      }
+      if ( !appendNode( logview, e, errMsg ) ) {
+         return false;
+      }
+      e = next;
+      if ( tag == "status" ) {
+         break;
+      }
+   }
+
+   // summary of merged logs, with total error count per process
+   QDomElement mergedLogs = m_doc.createElement( "mergedlogs" );
+   for ( int i = 0; i < numLogs; ++i ) {
+      int count = 0;
+      for ( int j = 0; j < m_merged.count(); ++j ) {
+         count += m_merged.at( j ).counts.at( i );
+      }
+
+      QDomElement mergedLog = m_doc.createElement( "mergedlog" );
+      QDomElement pid = m_doc.createElement( "pid" );
+      pid.appendChild( m_doc.createTextNode( m_jobs.at( i )->pid ) );
+      mergedLog.appendChild( pid );
+      QDomElement cnt = m_doc.createElement( "count" );
+      cnt.appendChild( m_doc.createTextNode( QString::number( count ) ) );
+      mergedLog.appendChild( cnt );
+      QDomElement file = m_doc.createElement( "file" );
+      file.appendChild( m_doc.createTextNode( m_jobs.at( i )->logFile ) );
+      mergedLog.appendChild( file );
+      mergedLogs.appendChild( mergedLog );
+   }
+   if ( !appendNode( logview, mergedLogs, errMsg ) ) {
+      return false;
+   }
+
+   // per log: thread announcements, then the errors first seen in that log
+   QDomElement errorcounts = m_doc.createElement( "errorcounts" );
+   int idx = 0;
+   int threadBase = 0;   // past the previous logs' thread ids
+   for ( int i = 0; i < numLogs; ++i ) {
+      QDomElement root = m_jobs.at( i )->doc.documentElement();
+      e = root.firstChildElement( "announcethread" );
+      while ( !e.isNull() ) {
+         QDomElement next = e.nextSiblingElement( "announcethread" );
+         renumberThreads( e, threadBase );
+         if ( !appendNode( logview, e, errMsg ) ) {
+            return false;
+         }
+         e = next;
+      }
+
+      for ( ; idx < m_merged.count() && m_merged.at( idx ).firstLog == i; ++idx ) {
+         MergedError& me = m_merged[idx];
+         renumberThreads( me.err, threadBase );
+         QString unique = QString( "0x%1" ).arg( idx, 0, 16 );
+         setElemText( me.err.firstChildElement( "unique" ), unique );
+
+         QDomElement pidcounts = m_doc.createElement( "pidcounts" );
+         int total = 0, inLogs = 0;
+         qulonglong bytes = 0, blocks = 0;
+         for ( int j = 0; j < numLogs; ++j ) {
+            if ( me.counts.at( j ) == 0 ) {
+               continue;
+            }
+            inLogs++;
+            total  += me.counts.at( j );
+            bytes  += me.bytes.at( j );
+            blocks += me.blocks.at( j );
+            pidcounts.appendChild( createPair( QString::number( me.counts.at( j ) ),
+                                               "pid", m_jobs.at( j )->pid ) );
+         }
+         me.err.appendChild( pidcounts );
+
+         if ( me.isLeak ) {
+            QDomElement xwhat = me.err.firstChildElement( "xwhat" );
+            setElemText( xwhat.firstChildElement( "leakedbytes" ),
+                         QString::number( bytes ) );
+            setElemText( xwhat.firstChildElement( "leakedblocks" ),
+                         QString::number( blocks ) );
+            if ( inLogs > 1 ) {
+               setLeakText( xwhat.firstChildElement( "text" ), bytes, blocks );
+            }
+         }
+         else {
+            errorcounts.appendChild( createPair( QString::number( total ),
+                                                 "unique", unique ) );
+         }
+
+         if ( !appendNode( logview, me.err, errMsg ) ) {
+            return false;
+         }
+      }
+      threadBase += m_jobs.at( i )->maxThreadId;
+   }
+
+   if ( !errorcounts.firstChild().isNull() &&
+        !appendNode( logview, errorcounts, errMsg ) ) {
+      return false;
+   }
+
+   // suppcounts: last one in each log, summed by name
+   QStringList suppNames;
+   QHash<QString, int> suppCounts;
+   for ( int i = 0; i < numLogs; ++i ) {
+      QDomElement root = m_jobs.at( i )->doc.documentElement();
+      QDomElement sc = root.lastChildElement( "suppcounts" );
+      QDomElement pair = sc.firstChildElement( "pair" );
+      for ( ; !pair.isNull(); pair = pair.nextSiblingElement( "pair" ) ) {
+         QString name = pair.firstChildElement( "name" ).text();
+         if ( !suppCounts.contains( name ) ) {
+            suppNames << name;
+         }
+         suppCounts[name] += pair.firstChildElement( "count" ).text().toInt();
+      }
+   }
+   if ( !suppNames.isEmpty() ) {
+      QDomElement suppcounts = m_doc.createElement( "suppcounts" );
+      foreach ( QString name, suppNames ) {
+         suppcounts.appendChild( createPair( QString::number( suppCounts.value( name ) ),
+                                             "name", name ) );
+      }
+      if ( !appendNode( logview, suppcounts, errMsg ) ) {
+         return false;
+      }
+   }
+
+   // final status: from the first log
+   QDomElement status = root0.lastChildElement( "status" );
+   if ( !status.isNull() && !appendNode( logview, status, errMsg ) ) {
+      return false;
+   }
+
+   return true;
+}
+
+
+bool VgLogMerge::appendNode( VgLogView* logview, QDomNode node, QString& errMsg )
+{
+   if ( !logview->appendNode( node, errMsg ) ) {
+      errMsg = "Failed to merge logs: " + errMsg;
+      return false;
+   }
+   return true;
+}
+
+
+/*!
+  <pair><count>count</count><tag>value</tag></pair>
+  count first: VgLogView::updateErrorItems() depends on it.
+*/
+QDomElement VgLogMerge::createPair( const QString& count, const QString& tag,
+                                    const QString& value )
+{
+   QDomElement pair = m_doc.createElement( "pair" );
+   QDomElement cnt = m_doc.createElement( "count" );
+   cnt.appendChild( m_doc.createTextNode( count ) );
+   pair.appendChild( cnt );
+   QDomElement val = m_doc.createElement( tag );
+   val.appendChild( m_doc.createTextNode( value ) );
+   pair.appendChild( val );
+   return pair;
+}
+
+
+void VgLogMerge::setElemText( QDomElement elem, const QString& text )
+{
+   if ( elem.isNull() ) {
+      return;
+   }
+   QDomNode txt = elem.firstChild();
+   if ( txt.isText() ) {
+      txt.setNodeValue( text );
+   }
+   else {
+      elem.appendChild( elem.ownerDocument().createTextNode( text ) );
+   }
+}
+
+
+/*!
+  A leak's "N bytes in M blocks ..." text, for the amounts summed over
+  the logs.  The direct/indirect split of the first log's text goes:
+  the logs' splits aren't kept.
+*/
+void VgLogMerge::setLeakText( QDomElement text, qulonglong bytes, qulonglong blocks )
+{
+   QRegExp amounts( "^[0-9,]+ (\\([^)]*\\) )?bytes in [0-9,]+ blocks" );
+   QString str = text.text();
+   if ( amounts.indexIn( str ) == -1 ) {
+      return;
+   }
+   str.replace( 0, amounts.matchedLength(),
+                QString( "%1 bytes in %2 blocks" )
+                .arg( withCommas( bytes ) ).arg( withCommas( blocks ) ) );
+   setElemText( text, str );
+}
+
+
+/*!
+  n as valgrind prints it: 1,234,567
+*/
+QString VgLogMerge::withCommas( qulonglong n )
+{
+   QString str = QString::number( n );
+   for ( int pos = str.length() - 3; pos > 0; pos -= 3 ) {
+      str.insert( pos, ',' );
+   }
+   return str;
+}
+
+
+/*!
+  Add base to the Helgrind thread ids under elem: its <hthreadid>s,
+  and the "thread #n" of its texts.
+*/
+void VgLogMerge::renumberThreads( QDomElement elem, int base )
+{
+   if ( base == 0 ) {
+      return;
+   }
+
+   QRegExp threadRef( "([Tt]hread #)([0-9]+)" );
+   QDomElement e = elem.firstChildElement();
+   for ( ; !e.isNull(); e = e.nextSiblingElement() ) {
+      if ( e.tagName() == "hthreadid" ) {
+         setElemText( e, QString::number( e.text().toInt() + base ) );
+      }
+      else if ( e.tagName() == "text" ) {
+         QString text = e.text();
+         int pos = 0;
+         while ( ( pos = threadRef.indexIn( text, pos ) ) != -1 ) {
+            QString num = QString::number( threadRef.cap( 2 ).toInt() + base );
+            text.replace( pos + threadRef.cap( 1 ).length(), threadRef.cap( 2 ).length(), num );
+            pos += threadRef.cap( 1 ).length() + num.length();
+         }
+         setElemText( e, text );
+      }
+      else {
+         renumberThreads( e, base );
+      }
+   }
+}
@@ -0,0 +1,133 @@
+/****************************************************************************
+** VgLogMerge definition
+**  - merges several valgrind xml logs into one logview
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGMERGE_H
+#define __VGLOGMERGE_H
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QList>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// ============================================================
+// Forward decls
+class VgLogView;
+
+
+
+// ============================================================
+/*!
+  VgLogMergeJob: loads one log, off the gui thread.
+   - each job parses into its own QDomDocument, so jobs share nothing.
+   - errors are fingerprinted here too, that being the other
+     per-error cost that doesn't need the view.
+*/
+class VgLogMergeJob : public QRunnable
+{
+public:
+   VgLogMergeJob( const QString& logFile );
+
+   void run();
+
+   QString        logFile;
+   QDomDocument   doc;
+   QString        pid;
+   QList<quint64> fingerprints;   // one per <error>, in log order
+   QList<int>     leakChecks;     // one per <error>: its leak check, -1 if none
+   int            lastLeakCheck;  // -1: no leaks
+   int            maxThreadId;    // of the <announcethread>s: 0 if none
+   QHash<QString, int> uniqueCounts; // from the last <errorcounts>
+
+   bool    ok;
+   QString errMsg;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogMerge: merges the logs of several processes
+  (e.g. --trace-children=yes with --xml-file=log.%p.xml)
+  into one VgLogView.
+
+  All logs are parsed concurrently on the global thread pool;
+  the merge itself is done on the gui thread, as it feeds the view.
+
+  Errors are deduplicated by fingerprint (as VgLogDiff), keeping
+  the first instance seen, with a <pidcounts> child giving the count
+  per process. The view then gets a synthesised log:
+   - preamble and RUNNING status of the first log
+   - <mergedlogs>: one <mergedlog> per process
+   - per log: any thread announcements, then errors first seen in it.
+     Each log's Helgrind threads are renumbered past the previous
+     logs', as the same #HG_n is another thread in another process.
+   - errorcounts and suppcounts summed over all logs
+   - FINISHED status of the first log
+*/
+class VgLogMerge
+{
+public:
+   VgLogMerge();
+   ~VgLogMerge();
+
+   bool merge( const QStringList& logFiles, VgLogView* logview, QString& errMsg );
+
+   int numErrors() {
+      return m_merged.count();
+   }
+
+   static bool readLogList( const QString& loglist, QStringList& logFiles,
+                            QString& errMsg );
+
+private:
+   // one deduplicated error, across all logs
+   struct MergedError {
+      QDomElement err;             // first instance seen: displayed
+      int  firstLog;               // index of log err came from
+      bool isLeak;
+      QVector<int> counts;         // per log
+      QVector<qulonglong> bytes;   // per log, leaks only
+      QVector<qulonglong> blocks;  // per log, leaks only
+   };
+
+   bool checkLogs( QString& errMsg );
+   void mergeErrors();
+   bool emitLog( VgLogView* logview, QString& errMsg );
+
+   bool appendNode( VgLogView* logview, QDomNode node, QString& errMsg );
+   QDomElement createPair( const QString& count, const QString& tag,
+                           const QString& value );
+   static void setElemText( QDomElement elem, const QString& text );
+   static void renumberThreads( QDomElement elem, int base );
+   static void setLeakText( QDomElement text, qulonglong bytes, qulonglong blocks );
+   static QString withCommas( qulonglong n );
+
+private:
+   QList<VgLogMergeJob*> m_jobs;
+   QList<MergedError>    m_merged;
+   QDomDocument          m_doc;    // owns the synthesised elements
+};
+
+#endif // #ifndef __VGLOGMERGE_H
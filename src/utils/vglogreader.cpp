@@ -19,6 +19,9 @@
 ****************************************************************************/
 
 #include "utils/vglogreader.h"
+#include "utils/vglogloader.h"
+#include "utils/vk_stringpool.h"
+#include "utils/vk_trace.h"
 #include "utils/vk_utils.h"
 
 
@@ -26,10 +29,23 @@
 /*!
   VgLogReader
 */
-VgLogReader::VgLogReader( VgLogView* lv )
-   : vghandler( 0 ), source( 0 )
+VgLogReader::VgLogReader( VgLogView* lv, int stream/*=0*/ )
+   : vghandler( 0 ), source( 0 ), m_bytesRead( 0 ), m_backlog( 0 ),
+     m_traced( true )
 {
-   vghandler = new VgLogHandler( lv );
+   setHandler( new VgLogHandler( lv, stream ) );
+}
+
+VgLogReader::VgLogReader( VgLogQueue* queue )
+   : vghandler( 0 ), source( 0 ), m_bytesRead( 0 ), m_backlog( 0 ),
+     m_traced( false )
+{
+   setHandler( new VgLogHandler( queue ) );
+}
+
+void VgLogReader::setHandler( VgLogHandler* hnd )
+{
+   vghandler = hnd;
    setContentHandler( vghandler );
    setErrorHandler( vghandler );
    //  setLexicalHandler( vghandler );
@@ -52,6 +68,10 @@ VgLogReader::~VgLogReader()
    if ( file.isOpen() ) {
       file.close();
    }
+
+   if ( m_traced ) {
+      VkTrace::instance()->addCount( VKTRACE::BACKLOG, -m_backlog );
+   }
 }
 
 bool VgLogReader::parse( QString filepath, bool incremental/*=false*/ )
@@ -65,26 +85,81 @@ bool VgLogReader::parse( QString filepath, bool incremental/*=false*/ )
    }
    
    file.setFileName( filepath );
+   m_bytesRead = 0;
+
    source = new QXmlInputSource( &file );
-   return QXmlSimpleReader::parse( source, incremental );
+   if ( !m_traced ) {
+      bool ok = QXmlSimpleReader::parse( source, incremental );
+      m_bytesRead = file.isOpen() ? file.pos() : 0;
+      return ok;
+   }
+
+   VK_TRACE_SCOPE( VKTRACE::PARSE );
+   bool ok = QXmlSimpleReader::parse( source, incremental );
+   updateCounts();
+   return ok;
 }
 
 bool VgLogReader::parseContinue()
 {
+   if ( !m_traced ) {
+      if ( source ) {
+         source->fetchData();
+      }
+      bool ok = QXmlSimpleReader::parseContinue();
+      m_bytesRead = file.isOpen() ? file.pos() : m_bytesRead;
+      return ok;
+   }
+
+   VK_TRACE_SCOPE( VKTRACE::PARSE_CONTINUE );
    if ( source ) {
       source->fetchData();
    }
    
-   return QXmlSimpleReader::parseContinue();
+   bool ok = QXmlSimpleReader::parseContinue();
+   updateCounts();
+   return ok;
+}
+
+
+/*!
+  How far through the file we are, for the metrics:
+  the bytes read since last time, and those still to read.
+*/
+void VgLogReader::updateCounts()
+{
+   VkTrace* trace = VkTrace::instance();
+   qint64 pos = file.isOpen() ? file.pos() : m_bytesRead;
+   trace->addCount( VKTRACE::BYTES_READ, pos - m_bytesRead );
+   m_bytesRead = pos;
+
+   qint64 backlog = file.isOpen() ? qMax( ( qint64 )0, file.size() - pos ) : 0;
+   trace->addCount( VKTRACE::BACKLOG, backlog - m_backlog );
+   m_backlog = backlog;
 }
 
 
 /**********************************************************************/
 /* VgLogHandler */
-VgLogHandler::VgLogHandler( VgLogView* lv )
+VgLogHandler::VgLogHandler( VgLogView* lv, int stream/*=0*/ )
 {
    logview = lv;
+   queue = 0;
+   node = doc;
+   m_stream = stream;
+   m_finished = false;
+   m_started = false;
+}
+
+/* Loading thread: elements go to the queue, not to a logview.
+   Tag names and short texts are interned: the same few strings recur
+   across every error, and across every log loading alongside. */
+VgLogHandler::VgLogHandler( VgLogQueue* q )
+{
+   logview = 0;
+   queue = q;
    node = doc;
+   m_stream = 0;
    m_finished = false;
    m_started = false;
 }
@@ -106,11 +181,23 @@ bool VgLogHandler::startElement( const QString&, const QString&,
                                  const QXmlAttributes& )
 {
    //  vkPrintErr("VgLogHandler::startElement: '%s'", tag.latin1());
-   QDomNode n = doc.createElement( tag );
+   QDomNode n = doc.createElement( queue ? VkStringPool::instance()->intern( tag )
+                                         : tag );
    node.appendChild( n );
    node = n;
    
-   if ( node == doc.documentElement() ) {
+   if ( queue ) {
+      if ( node == doc.documentElement() ) {
+         // the gui thread makes its own <?xml...> element: no sharing
+         QDomProcessingInstruction xml_insn =
+            doc.firstChild().toProcessingInstruction();
+         queue->init( doc, xml_insn.target(), xml_insn.data(), tag );
+      }
+      return true;
+   }
+   
+   // child logs feed the main log's view: already initialised.
+   if ( node == doc.documentElement() && m_stream == 0 ) {
       QDomProcessingInstruction xml_insn =
          doc.firstChild().toProcessingInstruction();
       if ( ! logview->init( xml_insn, tag ) ) {
@@ -135,9 +222,20 @@ bool VgLogHandler::endElement( const QString&, const QString&,
    QDomNode prnt = node.parentNode();
    
    /* if closing a top-level tag, append to vglog */
-   if ( prnt == doc.documentElement() ) {
+   if ( prnt == doc.documentElement() && queue ) {
+      /* hand the whole branch over: it's no longer ours to touch */
+      QDomNode branch = node;
+      prnt.removeChild( branch );
+      if ( !queue->push( branch ) ) {
+         m_fatalMsg = "Loading cancelled.";
+         return false;
+      }
+   }
+   else if ( prnt == doc.documentElement() ) {
       QString errMsg;
-      if ( ! logview->appendNode( node, errMsg ) ) {
+      bool ok = ( m_stream == 0 ) ? logview->appendNode( node, errMsg )
+                                  : logview->appendChildNode( m_stream, node, errMsg );
+      if ( !ok ) {
          //VK_DEBUG("Failed to append node");
          m_fatalMsg = errMsg;
          return false;
@@ -176,6 +274,9 @@ bool VgLogHandler::characters( const QString&  ch )
    QString chars = ch.simplified();
    
    if ( !chars.isEmpty() ) {
+      if ( queue ) {
+         chars = VkStringPool::instance()->intern( chars );
+      }
       node.appendChild( doc.createTextNode( chars ) );
       //    vkPrintErr("chars: '%s'", chars.latin1());
    }
@@ -187,7 +288,7 @@ bool VgLogHandler::characters( const QString&  ch )
 bool VgLogHandler::startDocument()
 {
    //   vkPrintErr("VgLogHandler::startDocument()\n");
-   vk_assert( logview != 0 );
+   vk_assert( logview != 0 || queue != 0 );
    
    doc = QDomDocument();
    node = doc;
@@ -43,6 +43,8 @@
 #define QXmlParseException VkXmlParseException
 #endif
 
+class VgLogQueue;
+
 
 // ============================================================
 /*
@@ -50,11 +52,13 @@
   - creates node tree from input
   - hands off complete top-level branches to VgLog
   (e.g. preamble, error etc)
+  - or, on a loading thread, queues them for the gui thread
 */
 class VgLogHandler : public QXmlDefaultHandler
 {
 public:
-   VgLogHandler( VgLogView* lv );
+   VgLogHandler( VgLogView* lv, int stream = 0 );
+   VgLogHandler( VgLogQueue* q );
    ~VgLogHandler();
    
    // content handler
@@ -91,7 +95,9 @@ public:
 private:
    QDomDocument doc;
    VgLogView* logview;
+   VgLogQueue* queue;   // set: no logview, from a loading thread
    QDomNode node;
+   int m_stream;     // 0: main log, else a child process' log
    
    QString m_fatalMsg;
    bool m_finished;
@@ -108,7 +114,9 @@ private:
 class VgLogReader : public QXmlSimpleReader
 {
 public:
-   VgLogReader( VgLogView* lv );
+   VgLogReader( VgLogView* lv, int stream = 0 );
+   // for a loading thread: untraced, as VkTrace is gui-thread only
+   VgLogReader( VgLogQueue* queue );
    ~VgLogReader();
    
    bool parse( QString filepath, bool incremental = false );
@@ -117,11 +125,29 @@ public:
    VgLogHandler* handler() {
       return vghandler;
    }
+
+   // how far through the file: as of the last parse()/parseContinue()
+   qint64 bytesRead() {
+      return m_bytesRead;
+   }
+   qint64 fileSize() {
+      return file.size();
+   }
+   bool atEnd() {
+      return file.isOpen() && file.atEnd();
+   }
    
+private:
+   void setHandler( VgLogHandler* hnd );
+   void updateCounts();
+
 private:
    VgLogHandler* vghandler;
    QXmlInputSource* source;
    QFile file;
+   qint64 m_bytesRead;    // of file, so far
+   qint64 m_backlog;      // of file, still to read
+   bool m_traced;
 };
 
 #endif // #ifndef __VGLOGREADER_H
@@ -0,0 +1,309 @@
+/****************************************************************************
+** VgLogReport implementation
+**  - headless summary of valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vglogreport.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QThreadPool>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <stdio.h>
+
+
+/**********************************************************************/
+/* VgLogReportJob */
+VgLogReportJob::VgLogReportJob( const QString& file )
+   : logFile( file ), ok( false )
+{
+   // we collect the results after the pool is done.
+   setAutoDelete( false );
+}
+
+void VgLogReportJob::run()
+{
+   ok = VgLogDiff::digestLog( logFile, digests, toolName, errMsg, &suppCounts );
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgLogReport
+*/
+VgLogReport::VgLogReport()
+   : m_haveBaseline( false )
+{ }
+
+VgLogReport::~VgLogReport()
+{ }
+
+
+/*!
+  Digest logFiles, and fold them into this report.
+  Returns false (with errMsg set) if any log failed to load,
+  or the logs don't belong together.
+*/
+bool VgLogReport::addLogs( const QStringList& logFiles, QString& errMsg )
+{
+   if ( logFiles.isEmpty() ) {
+      errMsg = "No log files to report on";
+      return false;
+   }
+
+   // digest all logs concurrently
+   QList<VgLogReportJob*> jobs;
+   QThreadPool* pool = QThreadPool::globalInstance();
+   foreach ( QString logFile, logFiles ) {
+      VgLogReportJob* job = new VgLogReportJob( logFile );
+      jobs.append( job );
+      pool->start( job );
+   }
+   // no ui to keep up-to-date: just wait.
+   pool->waitForDone();
+
+   bool ok = true;
+   foreach ( VgLogReportJob* job, jobs ) {
+      if ( !job->ok ) {
+         errMsg = job->errMsg;
+         ok = false;
+         break;
+      }
+      if ( m_tool.isEmpty() ) {
+         m_tool = job->toolName;
+      }
+      else if ( job->toolName != m_tool ) {
+         errMsg = "Logs are from different tools (" + m_tool + " -v- " +
+                  job->toolName + "): '" + job->logFile + "'";
+         ok = false;
+         break;
+      }
+
+      // same fingerprint in several logs: counts add up,
+      // the first log seen gives the description.
+      VgErrorDigestHash::const_iterator it = job->digests.constBegin();
+      for ( ; it != job->digests.constEnd(); ++it ) {
+         VgErrorDigestHash::iterator dit = m_digests.find( it.key() );
+         if ( dit == m_digests.end() ) {
+            m_digests.insert( it.key(), it.value() );
+         }
+         else {
+            dit.value().count += it.value().count;
+         }
+      }
+
+      QHash<QString, int>::const_iterator sit = job->suppCounts.constBegin();
+      for ( ; sit != job->suppCounts.constEnd(); ++sit ) {
+         m_suppCounts[sit.key()] += sit.value();
+      }
+
+      m_logs << job->logFile;
+   }
+
+   qDeleteAll( jobs );
+   return ok;
+}
+
+
+/*!
+  Compare the logs added so far with baseLog.
+*/
+bool VgLogReport::setBaseline( const QString& baseLog, QString& errMsg )
+{
+   VgErrorDigestHash baseDigests;
+   QString baseTool;
+
+   if ( !VgLogDiff::digestLog( baseLog, baseDigests, baseTool, errMsg ) ) {
+      return false;
+   }
+
+   if ( baseTool != m_tool ) {
+      errMsg = "Logs are from different tools (" + baseTool +
+               " -v- " + m_tool + ")";
+      return false;
+   }
+
+   m_baseLog = baseLog;
+   m_diff.compare( baseDigests, m_digests );
+   m_haveBaseline = true;
+   return true;
+}
+
+
+/*!
+  Total no. of errors, over all error classes.
+*/
+int VgLogReport::numErrors()
+{
+   int num = 0;
+   foreach ( VgErrorDigest dgst, m_digests ) {
+      num += dgst.count;
+   }
+   return num;
+}
+
+
+/*!
+  Total no. of errors in error classes not found in the baseline.
+  With no baseline, all errors are new.
+*/
+int VgLogReport::numNewErrors()
+{
+   if ( !m_haveBaseline ) {
+      return numErrors();
+   }
+
+   int num = 0;
+   foreach ( VgLogDiffEntry entry, m_diff.entries() ) {
+      if ( entry.state == VGLOGDIFF::NEW ) {
+         num += entry.countNew;
+      }
+   }
+   return num;
+}
+
+
+VGLOGREPORT::ExitStatus VgLogReport::exitStatus()
+{
+   return ( numNewErrors() > 0 ) ? VGLOGREPORT::EXIT_ERRORS
+                                 : VGLOGREPORT::EXIT_CLEAN;
+}
+
+
+/*!
+  Write the report to reportFile: empty or "-" means stdout.
+*/
+bool VgLogReport::write( const QString& reportFile, QString& errMsg )
+{
+   QFile file;
+   bool ok;
+   if ( reportFile.isEmpty() || reportFile == "-" ) {
+      ok = file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+   }
+   else {
+      file.setFileName( reportFile );
+      ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text );
+   }
+   if ( !ok ) {
+      errMsg = "Failed to open report file: '" + reportFile + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   writeSummary( strm );
+   if ( m_haveBaseline ) {
+      writeDiff( strm );
+   }
+   strm.flush();
+   return true;
+}
+
+
+// one line of the per-kind breakdown
+struct KindCount {
+   QString kind;
+   int count, distinct;
+};
+
+static bool kindCountLessThan( const KindCount& k1, const KindCount& k2 )
+{
+   // most frequent first
+   if ( k1.count != k2.count ) {
+      return k1.count > k2.count;
+   }
+   return k1.kind < k2.kind;
+}
+
+
+void VgLogReport::writeSummary( QTextStream& strm )
+{
+   strm << "Tool: " << m_tool << endl;
+   strm << "Logs: " << m_logs.count() << endl;
+   foreach ( QString log, m_logs ) {
+      strm << "   " << log << endl;
+   }
+
+   // errors, by kind
+   QHash<QString, KindCount> kinds;
+   foreach ( VgErrorDigest dgst, m_digests ) {
+      KindCount& kc = kinds[dgst.kind];
+      if ( kc.kind.isEmpty() ) {
+         kc.kind = dgst.kind;
+         kc.count = kc.distinct = 0;
+      }
+      kc.count += dgst.count;
+      kc.distinct++;
+   }
+   QList<KindCount> kindList = kinds.values();
+   std::sort( kindList.begin(), kindList.end(), kindCountLessThan );
+
+   strm << endl << "Errors: " << numErrors()
+        << " (" << m_digests.count() << " distinct)" << endl;
+   foreach ( KindCount kc, kindList ) {
+      strm << "   " << qSetFieldWidth( 30 ) << left << kc.kind
+           << qSetFieldWidth( 8 ) << right << kc.count
+           << qSetFieldWidth( 0 ) << "  (" << kc.distinct << " distinct)" << endl;
+   }
+
+   // suppressions: these were applied by valgrind, at run-time.
+   int numSupp = 0;
+   foreach ( int count, m_suppCounts ) {
+      numSupp += count;
+   }
+   QStringList names = m_suppCounts.keys();
+   std::sort( names.begin(), names.end() );
+
+   strm << endl << "Suppressed: " << numSupp
+        << " (" << names.count() << " suppressions used)" << endl;
+   foreach ( QString name, names ) {
+      strm << "   " << qSetFieldWidth( 30 ) << left << name
+           << qSetFieldWidth( 8 ) << right << m_suppCounts.value( name )
+           << qSetFieldWidth( 0 ) << endl;
+   }
+}
+
+
+void VgLogReport::writeDiff( QTextStream& strm )
+{
+   strm << endl << "Baseline: " << m_baseLog << endl;
+   strm << "   New:        " << m_diff.numEntries( VGLOGDIFF::NEW ) << " distinct" << endl;
+   strm << "   Fixed:      " << m_diff.numEntries( VGLOGDIFF::FIXED ) << " distinct" << endl;
+   strm << "   Persisting: " << m_diff.numEntries( VGLOGDIFF::PERSISTING ) << " distinct" << endl;
+
+   if ( m_diff.numEntries( VGLOGDIFF::NEW ) == 0 ) {
+      return;
+   }
+
+   // entries are sorted by state, then biggest change first
+   strm << endl << "New errors: " << numNewErrors() << endl;
+   foreach ( VgLogDiffEntry entry, m_diff.entries() ) {
+      if ( entry.state != VGLOGDIFF::NEW ) {
+         continue;
+      }
+      strm << qSetFieldWidth( 8 ) << right << entry.countNew
+           << qSetFieldWidth( 0 ) << "  " << entry.kind
+           << "  " << entry.topFrame << endl;
+      if ( !entry.what.isEmpty() ) {
+         strm << "          " << entry.what << endl;
+      }
+   }
+}
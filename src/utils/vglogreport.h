@@ -0,0 +1,109 @@
+/****************************************************************************
+** VgLogReport definition
+**  - headless summary of valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGLOGREPORT_H
+#define __VGLOGREPORT_H
+
+#include <QHash>
+#include <QList>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "utils/vglogdiff.h"
+
+
+// ============================================================
+namespace VGLOGREPORT {
+   // exit status of a --batch run
+   enum ExitStatus {
+      EXIT_CLEAN  = 0,   // no (new) errors
+      EXIT_FAILED = 1,   // couldn't read/parse the log(s): same as EXIT_FAILURE
+      EXIT_ERRORS = 2    // (new) errors found
+   };
+}
+
+
+
+// ============================================================
+/*!
+  VgLogReportJob: digests one log, off the main thread.
+*/
+class VgLogReportJob : public QRunnable
+{
+public:
+   VgLogReportJob( const QString& logFile );
+
+   void run();
+
+   QString             logFile;
+   QString             toolName;
+   VgErrorDigestHash   digests;
+   QHash<QString, int> suppCounts;
+
+   bool    ok;
+   QString errMsg;
+};
+
+
+
+// ============================================================
+/*!
+  VgLogReport: summarises one or more logs, without a view.
+
+  The logs are digested (as VgLogDiff: no DOM, no view items)
+  concurrently on the global thread pool, and folded into one
+  set of error digests. The report gives the error counts per
+  kind, and the suppression counts.
+
+  If a baseline log is given, the digests are compared with it,
+  and the report also lists the new error classes.
+*/
+class VgLogReport
+{
+public:
+   VgLogReport();
+   ~VgLogReport();
+
+   bool addLogs( const QStringList& logFiles, QString& errMsg );
+   bool setBaseline( const QString& baseLog, QString& errMsg );
+   bool write( const QString& reportFile, QString& errMsg );
+
+   int numErrors();
+   int numNewErrors();
+   VGLOGREPORT::ExitStatus exitStatus();
+
+private:
+   void writeSummary( QTextStream& strm );
+   void writeDiff( QTextStream& strm );
+
+private:
+   QStringList         m_logs;
+   QString             m_baseLog;
+   QString             m_tool;
+   VgErrorDigestHash   m_digests;
+   QHash<QString, int> m_suppCounts;
+
+   bool      m_haveBaseline;
+   VgLogDiff m_diff;
+};
+
+#endif // #ifndef __VGLOGREPORT_H
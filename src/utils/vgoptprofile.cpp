@@ -0,0 +1,315 @@
+/****************************************************************************
+** VgOptProfile implementation
+**  - the run-time cost vs. diagnostic value of memcheck's options
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgoptprofile.h"
+#include "utils/vk_procsampler.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+
+#include <stdio.h>
+
+
+/*!
+  The options profiled, cheapest value first.
+  The defaults are valgrind's own: used when the project doesn't set one.
+*/
+QList<VgOptAxis> VgOptProfile::allAxes()
+{
+   QList<VgOptAxis> axes;
+   // memcheck
+   axes << VgOptAxis( "undef-value-errors", "no|yes",           "yes" );
+   axes << VgOptAxis( "track-origins",      "no|yes",           "no" );
+   axes << VgOptAxis( "leak-check",         "no|summary|full",  "summary" );
+   axes << VgOptAxis( "leak-resolution",    "low|high",         "high" );
+   axes << VgOptAxis( "freelist-vol",       "2000000|20000000|200000000", "20000000" );
+   axes << VgOptAxis( "partial-loads-ok",   "yes|no",           "no" );
+   // core
+   axes << VgOptAxis( "num-callers",        "4|12|50",          "12" );
+   return axes;
+}
+
+QStringList VgOptProfile::axisNames()
+{
+   QStringList names;
+   foreach ( VgOptAxis axis, allAxes() ) {
+      names << axis.option;
+   }
+   return names;
+}
+
+
+/*!
+  vgFlags: valgrind and its options, as given to VgJobQueue.
+*/
+VgOptProfile::VgOptProfile( const QStringList& vgFlags, QObject* parent )
+   : QObject( parent ), m_vgFlags( vgFlags ), m_queue( 0 )
+{
+   m_axes = allAxes();
+}
+
+
+/*!
+  Which options to profile: "all", or a comma-separated list of them.
+*/
+bool VgOptProfile::setAxes( const QString& axes, QString& errMsg )
+{
+   if ( axes.isEmpty() || axes == "all" ) {
+      m_axes = allAxes();
+      return true;
+   }
+
+   QList<VgOptAxis> all = allAxes();
+   m_axes.clear();
+   foreach ( QString name, axes.split( ',', QString::SkipEmptyParts ) ) {
+      name = name.trimmed();
+      if ( name.startsWith( "--" ) ) {
+         name = name.mid( 2 );
+      }
+      int idx = axisNames().indexOf( name );
+      if ( idx == -1 ) {
+         errMsg = "Can't profile option '" + name + "': choose from "
+                  + axisNames().join( ", " ) + ", or all";
+         return false;
+      }
+      m_axes << all.at( idx );
+   }
+   return !m_axes.isEmpty();
+}
+
+
+/*!
+  The baseline's value: the last the flags give, else valgrind's default.
+*/
+QString VgOptProfile::baseValue( const VgOptAxis& axis )
+{
+   QString flag = "--" + axis.option + "=";
+   QString val = axis.dfltValue;
+   foreach ( QString vgFlag, m_vgFlags ) {
+      if ( vgFlag.startsWith( flag ) ) {
+         val = vgFlag.mid( flag.length() );
+      }
+   }
+   return val;
+}
+
+
+/*!
+  Queue the matrix of runs of target.
+*/
+void VgOptProfile::addJobs( VgJobQueue* queue, const QStringList& target )
+{
+   vk_assert( queue != 0 );
+   m_queue  = queue;
+   m_target = target;
+   connect( m_queue, SIGNAL( finished() ), this, SLOT( queueFinished() ) );
+
+   queue->addJob( target, QStringList(), "baseline" );
+
+   // one option at a time
+   QStringList cheapest, dearest, baseline;
+   foreach ( VgOptAxis axis, m_axes ) {
+      QString base = baseValue( axis );
+      baseline << "--" + axis.option + "=" + base;
+      cheapest << "--" + axis.option + "=" + axis.values.first();
+      dearest  << "--" + axis.option + "=" + axis.values.last();
+
+      foreach ( QString val, axis.values ) {
+         if ( val != base ) {
+            QString flag = "--" + axis.option + "=" + val;
+            queue->addJob( target, QStringList( flag ), flag );
+         }
+      }
+   }
+
+   // all at once: only if that's not a run we have already
+   if ( cheapest != baseline && m_axes.count() > 1 ) {
+      queue->addJob( target, cheapest, "cheapest: " + cheapest.join( " " ) );
+   }
+   if ( dearest != baseline && m_axes.count() > 1 ) {
+      queue->addJob( target, dearest, "dearest: " + dearest.join( " " ) );
+   }
+}
+
+
+/*!
+  A run's bugs: distinct errors by kind and top frame.
+*/
+QSet<QString> VgOptProfile::bugs( const VgJob& job )
+{
+   QSet<QString> found;
+   foreach ( VgErrorDigest dgst, job.digests ) {
+      found.insert( dgst.kind + "\n" + dgst.topFrame );
+   }
+   return found;
+}
+
+
+/*!
+  The quickest finished run finding all of mustFind (peak RSS breaks
+  ties), or -1 if there's none.
+*/
+int VgOptProfile::cheapestRun( const QSet<QString>& mustFind )
+{
+   int best = -1;
+   for ( int i = 0; i < m_queue->numJobs(); ++i ) {
+      const VgJob& job = m_queue->job( i );
+      if ( job.state != VGJOB::DONE || !bugs( job ).contains( mustFind ) ) {
+         continue;
+      }
+      if ( best == -1 ) {
+         best = i;
+         continue;
+      }
+      const VgJob& bestJob = m_queue->job( best );
+      if ( job.elapsedMs < bestJob.elapsedMs ||
+           ( job.elapsedMs == bestJob.elapsedMs && job.peakRssKB < bestJob.peakRssKB ) ) {
+         best = i;
+      }
+   }
+   return best;
+}
+
+
+static QString ratio( qint64 val, qint64 base )
+{
+   if ( val <= 0 || base <= 0 ) {
+      return "-";
+   }
+   return QString::number( ( double )val / base, 'f', 2 );
+}
+
+
+void VgOptProfile::writeReport( QTextStream& strm )
+{
+   vk_assert( m_queue != 0 );
+
+   QSet<QString> allBugs;
+   for ( int i = 0; i < m_queue->numJobs(); ++i ) {
+      if ( m_queue->job( i ).state == VGJOB::DONE ) {
+         allBugs += bugs( m_queue->job( i ) );
+      }
+   }
+
+   const VgJob& base = m_queue->job( 0 );
+   bool haveBase = ( base.state == VGJOB::DONE );
+
+   strm << "Option cost profile: " << m_target.join( " " ) << endl;
+   strm << "Baseline: " << m_vgFlags.mid( 1 ).join( " " ) << endl;
+   strm << "Runs: " << m_queue->numJobs() << " (" << m_queue->maxJobs()
+        << " at a time), " << m_queue->elapsedMs() / 1000 << "s" << endl;
+   strm << "Bugs (distinct errors, by kind and top frame): "
+        << allBugs.count() << ", over all runs" << endl;
+   strm << "Logs: " << m_queue->logDir() << endl << endl;
+
+   strm << qSetFieldWidth( 10 ) << right << "time (s)" << "x base"
+        << "peak RSS" << "x base" << "errors" << "bugs" << "found"
+        << qSetFieldWidth( 0 ) << "   options" << endl;
+   for ( int i = 0; i < m_queue->numJobs(); ++i ) {
+      const VgJob& job = m_queue->job( i );
+      if ( job.state != VGJOB::DONE ) {
+         strm << qSetFieldWidth( 70 ) << right << VgJob::stateName( job.state )
+              << qSetFieldWidth( 0 ) << "   " << job.label << endl;
+         if ( !job.errMsg.isEmpty() ) {
+            strm << "         " << job.errMsg << endl;
+         }
+         continue;
+      }
+
+      int numBugs = bugs( job ).count();
+      QString found = allBugs.isEmpty() ? QString( "-" ) :
+                      QString( "%1%" ).arg( numBugs * 100 / allBugs.count() );
+      strm << qSetFieldWidth( 10 ) << right
+           << QString::number( job.elapsedMs / 1000.0, 'f', 1 )
+           << ( haveBase ? ratio( job.elapsedMs, base.elapsedMs ) : QString( "-" ) )
+           << ( job.peakRssKB ? VkProcSampler::bytesString( job.peakRssKB * 1024 )
+                              : QString( "-" ) )
+           << ( haveBase ? ratio( job.peakRssKB, base.peakRssKB ) : QString( "-" ) )
+           << job.numErrors << numBugs << found
+           << qSetFieldWidth( 0 ) << "   " << job.label << endl;
+   }
+   strm << endl;
+
+   // the verdicts
+   if ( haveBase ) {
+      int best = cheapestRun( bugs( base ) );
+      vk_assert( best != -1 );   // the baseline itself, at worst
+      const VgJob& job = m_queue->job( best );
+      strm << "Cheapest run finding all the baseline's bugs: " << job.label
+           << " (time x" << ratio( job.elapsedMs, base.elapsedMs )
+           << ", peak RSS x" << ratio( job.peakRssKB, base.peakRssKB ) << ")" << endl;
+   }
+   int best = cheapestRun( allBugs );
+   if ( best != -1 ) {
+      const VgJob& job = m_queue->job( best );
+      strm << "Cheapest run finding all the bugs any run found: " << job.label;
+      if ( haveBase ) {
+         strm << " (time x" << ratio( job.elapsedMs, base.elapsedMs )
+              << ", peak RSS x" << ratio( job.peakRssKB, base.peakRssKB ) << ")";
+      }
+      strm << endl;
+   }
+   else if ( !allBugs.isEmpty() ) {
+      strm << "No one run found all the bugs: combine the runs' options" << endl;
+   }
+   strm << "Note: --track-origins finds no more bugs, but says where "
+           "uninitialised values came from." << endl;
+}
+
+
+/*!
+  Write the report to reportFile, or stdout if "-" (or none).
+*/
+bool VgOptProfile::write( const QString& reportFile, QString& errMsg )
+{
+   QFile file;
+   bool ok;
+   if ( reportFile.isEmpty() || reportFile == "-" ) {
+      ok = file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+   }
+   else {
+      file.setFileName( reportFile );
+      ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text );
+   }
+   if ( !ok ) {
+      errMsg = "Failed to open report file: '" + reportFile + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   writeReport( strm );
+   strm.flush();
+   return true;
+}
+
+
+/*!
+  All runs done: keep the report with the runs' logs.
+*/
+void VgOptProfile::queueFinished()
+{
+   QString reportFile = m_queue->logDir() + "option_profile.txt";
+   QString errMsg;
+   if ( !write( reportFile, errMsg ) ) {
+      vkPrintErr( "%s", qPrintable( errMsg ) );
+      return;
+   }
+   emit reportReady( reportFile );
+}
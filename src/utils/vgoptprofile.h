@@ -0,0 +1,103 @@
+/****************************************************************************
+** VgOptProfile definition
+**  - the run-time cost vs. diagnostic value of memcheck's options
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGOPTPROFILE_H
+#define __VGOPTPROFILE_H
+
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "utils/vgjobqueue.h"
+
+
+// ============================================================
+/*!
+  One option to profile: its values, cheapest first, and
+  valgrind's default for it.
+*/
+class VgOptAxis
+{
+public:
+   VgOptAxis( const QString& opt = QString(), const QString& vals = QString(),
+              const QString& dflt = QString() )
+      : option( opt ), values( vals.split( '|' ) ), dfltValue( dflt ) {}
+
+   QString option;         // long flag, without the "--"
+   QStringList values;
+   QString dfltValue;
+};
+
+
+
+// ============================================================
+/*!
+  VgOptProfile: runs one target under a matrix of memcheck (and
+  core) option settings, as jobs on a VgJobQueue, and tabulates
+  each run's cost (wall time, peak RSS) against what it found.
+
+  The matrix is one-at-a-time around the baseline - the project's own
+  settings - so each option's cost shows on its own: the baseline,
+  a run per other value of each option, then all options at their
+  cheapest, and all at their dearest.
+
+  What a run found is counted in 'bugs': distinct errors, by kind and
+  top frame, so runs with different --num-callers still compare.
+  Once the queue's finished, the report is written to its log dir.
+  The report picks the cheapest run that finds all the bugs the
+  baseline finds, and the cheapest that finds all any run found.
+*/
+class VgOptProfile : public QObject
+{
+   Q_OBJECT
+public:
+   VgOptProfile( const QStringList& vgFlags, QObject* parent = 0 );
+
+   static QStringList axisNames();
+   bool setAxes( const QString& axes, QString& errMsg );
+
+   void addJobs( VgJobQueue* queue, const QStringList& target );
+
+   void writeReport( QTextStream& strm );
+   bool write( const QString& reportFile, QString& errMsg );
+
+signals:
+   void reportReady( QString reportFile );
+
+public slots:
+   void queueFinished();
+
+private:
+   static QList<VgOptAxis> allAxes();
+   QString baseValue( const VgOptAxis& axis );
+   QSet<QString> bugs( const VgJob& job );
+   int cheapestRun( const QSet<QString>& mustFind );
+
+private:
+   QStringList m_vgFlags;     // valgrind + the project's options
+   VgJobQueue* m_queue;       // we don't own this
+   QStringList m_target;
+   QList<VgOptAxis> m_axes;
+};
+
+#endif // #ifndef __VGOPTPROFILE_H
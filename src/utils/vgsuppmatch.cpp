@@ -0,0 +1,901 @@
+/****************************************************************************
+** VgSuppMatcher implementation
+**  - offline matching of suppressions against valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vgsuppmatch.h"
+#include "utils/vk_utils.h"
+
+#include <QFile>
+#include <QRegExp>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <QXmlInputSource>
+#include <QXmlParseException>
+#include <QXmlSimpleReader>
+
+#include <algorithm>
+#include <stdio.h>
+
+
+// errors per match job: small slices just cost more in overhead
+#define SUPP_MATCH_MIN_SLICE 256
+
+
+/*!
+  Suppression kind for an error without valgrind's own suppression,
+  e.g. InvalidRead "Invalid read of size 4" => "memcheck:addr4".
+  Sets kaux for the kinds that have one.
+*/
+static QString suppKindFor( const QString& tool, const QString& kind,
+                            const QString& what, QString& kaux )
+{
+   QString skind = kind.toLower();
+
+   if ( tool == "memcheck" ) {
+      QRegExp reSize( "of size (\\d+)" );
+
+      if ( kind == "InvalidRead" || kind == "InvalidWrite" ) {
+         skind = "addr";
+         if ( reSize.indexIn( what ) != -1 ) {
+            skind += reSize.cap( 1 );
+         }
+      }
+      else if ( kind == "UninitValue" ) {
+         skind = "value";
+         if ( reSize.indexIn( what ) != -1 ) {
+            skind += reSize.cap( 1 );
+         }
+      }
+      else if ( kind == "UninitCondition" ) {
+         skind = "cond";
+      }
+      else if ( kind == "SyscallParam" ) {
+         // e.g. "Syscall param write(buf) points to uninitialised byte(s)"
+         skind = "param";
+         QRegExp reParam( "^Syscall param (\\S+)" );
+         if ( reParam.indexIn( what ) != -1 ) {
+            kaux = reParam.cap( 1 );
+         }
+      }
+      else if ( kind == "InvalidFree" || kind == "MismatchedFree" ) {
+         skind = "free";
+      }
+      else if ( kind == "InvalidJump" ) {
+         skind = "jump";
+      }
+      else if ( kind.startsWith( "Leak_" ) ) {
+         skind = "leak";
+      }
+   }
+
+   return tool + ":" + skind;
+}
+
+
+/*!
+  Leak kind, as given by match-leak-kinds, for a Leak_* error kind.
+*/
+static QString leakKindFor( const QString& kind )
+{
+   if ( kind == "Leak_DefinitelyLost" ) {
+      return "definite";
+   }
+   else if ( kind == "Leak_IndirectlyLost" ) {
+      return "indirect";
+   }
+   else if ( kind == "Leak_PossiblyLost" ) {
+      return "possible";
+   }
+   else if ( kind == "Leak_StillReachable" ) {
+      return "reachable";
+   }
+   return QString();
+}
+
+
+
+
+/**********************************************************************/
+/* VgSuppLogHandler */
+VgSuppLogHandler::VgSuppLogHandler( QList<VgSuppMatchError>* errors,
+                                    QHash<QString, int>* suppCounts )
+   : m_errors( errors ), m_suppCounts( suppCounts ),
+     m_inStack( false ), m_haveStack( false )
+{
+   vk_assert( m_errors != 0 );
+   vk_assert( m_suppCounts != 0 );
+}
+
+VgSuppLogHandler::~VgSuppLogHandler()
+{ }
+
+bool VgSuppLogHandler::startElement( const QString&, const QString&,
+                                     const QString& tag,
+                                     const QXmlAttributes& )
+{
+   m_path.append( tag );
+   m_chars = QString();
+   int depth = m_path.count();
+
+   if ( depth == 2 && tag == "error" ) {
+      m_err = VgSuppMatchError();
+      m_inStack = m_haveStack = false;
+      m_skind = m_skaux = QString();
+      m_sframes.clear();
+   }
+   else if ( depth == 3 && tag == "stack" && m_path.at( 1 ) == "error" ) {
+      // only the error's own stack: not aux stacks (e.g. alloc'd at)
+      m_inStack = !m_haveStack;
+   }
+   else if ( depth == 4 && tag == "frame" && m_inStack ) {
+      m_frameFn = m_frameObj = QString();
+   }
+   else if ( depth == 2 && tag == "errorcounts" ) {
+      // counts are cumulative: last one wins.
+      m_counts.clear();
+   }
+   else if ( depth == 2 && tag == "suppcounts" ) {
+      m_supps.clear();
+   }
+
+   return true;
+}
+
+bool VgSuppLogHandler::endElement( const QString&, const QString&,
+                                   const QString& tag )
+{
+   int depth = m_path.count();
+   if ( depth == 0 ) {
+      return false;
+   }
+
+   QString text = m_chars.simplified();
+   m_chars = QString();
+
+   if ( depth == 2 && tag == "protocoltool" ) {
+      m_tool = text.toLower();
+   }
+   else if ( depth >= 2 && m_path.at( 1 ) == "error" ) {
+      QString parent = m_path.at( depth - 2 );
+
+      if ( depth == 3 ) {
+         if ( tag == "unique" ) {
+            m_err.unique = text;
+         }
+         else if ( tag == "kind" ) {
+            m_err.kind = text;
+         }
+         else if ( tag == "what" ) {
+            m_err.what = text;
+         }
+         else if ( tag == "stack" && m_inStack ) {
+            m_inStack = false;
+            m_haveStack = true;
+         }
+      }
+      else if ( depth == 4 && tag == "text" && parent == "xwhat" ) {
+         if ( m_err.what.isEmpty() ) {
+            m_err.what = text;
+         }
+      }
+      else if ( depth == 4 && parent == "suppression" ) {
+         if ( tag == "skind" ) {
+            m_skind = text;
+         }
+         else if ( tag == "skaux" ) {
+            m_skaux = text;
+         }
+      }
+      else if ( depth == 5 && parent == "sframe" ) {
+         if ( tag == "fun" || tag == "obj" ) {
+            m_sframes.append( tag + ":" + text );
+         }
+      }
+      else if ( m_inStack && depth == 5 ) {
+         if ( tag == "fn" ) {
+            m_frameFn = text;
+         }
+         else if ( tag == "obj" ) {
+            m_frameObj = text;
+         }
+      }
+      else if ( m_inStack && depth == 4 && tag == "frame" ) {
+         // as valgrind: unknown names are "???"
+         m_err.funs.append( m_frameFn.isEmpty() ? "???" : m_frameFn );
+         m_err.objs.append( m_frameObj.isEmpty() ? "???" : m_frameObj );
+      }
+      else if ( depth == 2 && tag == "error" ) {
+         finishError();
+      }
+   }
+   else if ( depth >= 3 && m_path.at( 1 ) == "errorcounts" ) {
+      if ( depth == 4 && tag == "count" ) {
+         m_pairCount = text;
+      }
+      else if ( depth == 4 && tag == "unique" ) {
+         m_pairUnique = text;
+      }
+      else if ( depth == 3 && tag == "pair" ) {
+         m_counts.insert( m_pairUnique, m_pairCount.toInt() );
+         m_pairCount = m_pairUnique = QString();
+      }
+   }
+   else if ( depth >= 3 && m_path.at( 1 ) == "suppcounts" ) {
+      if ( depth == 4 && tag == "count" ) {
+         m_pairCount = text;
+      }
+      else if ( depth == 4 && tag == "name" ) {
+         m_pairName = text;
+      }
+      else if ( depth == 3 && tag == "pair" ) {
+         m_supps.insert( m_pairName, m_pairCount.toInt() );
+         m_pairCount = m_pairName = QString();
+      }
+   }
+
+   m_path.removeLast();
+   return true;
+}
+
+
+/*!
+  Error complete: settle its suppression kind and frames.
+*/
+void VgSuppLogHandler::finishError()
+{
+   if ( m_skind.isEmpty() ) {
+      m_err.suppKind = suppKindFor( m_tool, m_err.kind, m_err.what, m_err.kaux );
+   }
+   else {
+      m_err.suppKind = m_skind.toLower();
+      m_err.kaux = m_skaux;
+   }
+   if ( m_err.kind.startsWith( "Leak_" ) ) {
+      m_err.kaux = leakKindFor( m_err.kind );
+   }
+
+   // valgrind's suppression frames give the names valgrind itself
+   // matches against (e.g. mangled), frame for frame with the stack.
+   for ( int i = 0; i < m_sframes.count(); ++i ) {
+      const QString& sframe = m_sframes.at( i );
+      if ( i == m_err.funs.count() ) {
+         m_err.funs.append( "???" );
+         m_err.objs.append( "???" );
+      }
+      if ( sframe.startsWith( "fun:" ) ) {
+         m_err.funs[i] = sframe.mid( 4 );
+      }
+      else {
+         m_err.funs[i] = "???";
+         m_err.objs[i] = sframe.mid( 4 );
+      }
+   }
+
+   m_errors->append( m_err );
+}
+
+bool VgSuppLogHandler::characters( const QString& ch )
+{
+   m_chars += ch;
+   return true;
+}
+
+bool VgSuppLogHandler::startDocument()
+{
+   m_path.clear();
+   m_counts.clear();
+   m_supps.clear();
+   m_tool = m_fatalMsg = QString();
+   return true;
+}
+
+/*!
+  Apply the errorcounts: each error counts once until told otherwise.
+*/
+bool VgSuppLogHandler::endDocument()
+{
+   QList<VgSuppMatchError>::iterator it = m_errors->begin();
+   for ( ; it != m_errors->end(); ++it ) {
+      it->count = m_counts.value( it->unique, 1 );
+   }
+   m_counts.clear();
+
+   QHash<QString, int>::const_iterator sit = m_supps.constBegin();
+   for ( ; sit != m_supps.constEnd(); ++sit ) {
+      ( *m_suppCounts )[sit.key()] += sit.value();
+   }
+   m_supps.clear();
+
+   return m_path.isEmpty();
+}
+
+bool VgSuppLogHandler::fatalError( const QXmlParseException& exception )
+{
+   m_fatalMsg = exception.message() +
+                " (line: " + QString::number( exception.lineNumber() ) +
+                ", col: " + QString::number( exception.columnNumber() ) + ")";
+   return false;
+}
+
+
+
+
+/**********************************************************************/
+/* VgSuppLogJob */
+VgSuppLogJob::VgSuppLogJob( const QString& file )
+   : logFile( file ), ok( false )
+{
+   // we collect the results after the pool is done.
+   setAutoDelete( false );
+}
+
+void VgSuppLogJob::run()
+{
+   QFile file( logFile );
+   if ( !file.open( QIODevice::ReadOnly ) ) {
+      errMsg = "Failed to open log file: '" + logFile + "'";
+      return;
+   }
+
+   VgSuppLogHandler handler( &errors, &suppCounts );
+   QXmlSimpleReader reader;
+   reader.setContentHandler( &handler );
+   reader.setErrorHandler( &handler );
+
+   QXmlInputSource source( &file );
+   ok = reader.parse( &source );
+   toolName = handler.toolName();
+
+   if ( !ok ) {
+      errMsg = "Failed to parse '" + logFile + "'";
+      if ( !handler.fatalMsg().isEmpty() ) {
+         errMsg += ":\n" + handler.fatalMsg();
+      }
+   }
+}
+
+
+
+
+/**********************************************************************/
+/* VgSuppMatchJob */
+VgSuppMatchJob::VgSuppMatchJob( const VgSuppMatcher* matcher,
+                                const VgSuppMatchError* errors, int* matches,
+                                int begin, int end )
+   : m_matcher( matcher ), m_errors( errors ), m_matches( matches ),
+     m_begin( begin ), m_end( end )
+{ }
+
+void VgSuppMatchJob::run()
+{
+   for ( int i = m_begin; i < m_end; ++i ) {
+      m_matches[i] = m_matcher->findMatch( m_errors[i] );
+   }
+}
+
+
+
+
+/**********************************************************************/
+/*!
+  VgSuppMatcher
+*/
+VgSuppMatcher::VgSuppMatcher()
+   : m_matched( false )
+{ }
+
+VgSuppMatcher::~VgSuppMatcher()
+{ }
+
+
+/*!
+  Glob match, as valgrind's: '*' matches any run of chars, '?' any one.
+  Backtracks only to the last '*', so is linear for most patterns.
+*/
+bool VgSuppMatcher::globMatch( const QString& pattern, const QString& str )
+{
+   const QChar* p = pattern.constData();
+   const QChar* s = str.constData();
+   int np = pattern.length(), ns = str.length();
+   int pi = 0, si = 0;
+   int starP = -1, starS = 0;
+
+   while ( si < ns ) {
+      if ( pi < np && p[pi] == '*' ) {
+         starP = pi++;
+         starS = si;
+      }
+      else if ( pi < np && ( p[pi] == '?' || p[pi] == s[si] ) ) {
+         ++pi;
+         ++si;
+      }
+      else if ( starP >= 0 ) {
+         pi = starP + 1;
+         si = ++starS;
+      }
+      else {
+         return false;
+      }
+   }
+
+   while ( pi < np && p[pi] == '*' ) {
+      ++pi;
+   }
+   return pi == np;
+}
+
+
+/*!
+  "Memcheck:Value0" => "memcheck:cond": Value0 being the old name for Cond.
+*/
+QString VgSuppMatcher::normaliseKind( const QString& kind )
+{
+   QString nkind = kind.simplified().toLower();
+   if ( nkind.endsWith( ":value0" ) ) {
+      nkind.replace( nkind.length() - 6, 6, "cond" );
+   }
+   return nkind;
+}
+
+
+/*!
+  Read suppFile, and compile its suppressions.
+  Suppressions that don't parse are skipped (and reported on stderr).
+*/
+bool VgSuppMatcher::addSuppFile( const QString& suppFile, QString& errMsg )
+{
+   SuppList supplist;
+   QString fname = suppFile;
+   if ( !supplist.readSuppFile( fname, false ) ) {
+      errMsg = "Failed to read suppressions file: '" + suppFile + "'";
+      return false;
+   }
+   addSupps( supplist.supps(), suppFile );
+   return true;
+}
+
+
+/*!
+  Compile supps, and add them to the kind / first-frame index.
+*/
+void VgSuppMatcher::addSupps( const QList<Suppression>& supps,
+                              const QString& suppFile )
+{
+   foreach ( Suppression supp, supps ) {
+      CompiledSupp cs;
+      cs.name = supp.getName();
+      cs.file = suppFile;
+      cs.kind = normaliseKind( supp.getKind() );
+      cs.numErrors = cs.numHits = 0;
+
+      QString kaux = supp.getKAux();
+      if ( kaux.startsWith( "match-leak-kinds:" ) ) {
+         QStringList kinds = kaux.mid( 17 ).split( ',', QString::SkipEmptyParts );
+         foreach ( QString kind, kinds ) {
+            cs.leakKinds << kind.trimmed();
+         }
+         if ( cs.leakKinds.contains( "all" ) ) {
+            cs.leakKinds.clear();
+         }
+      }
+      else {
+         cs.kaux = kaux;
+      }
+
+      foreach ( QString frame, supp.getFrames() ) {
+         CompiledFrame cf;
+         if ( frame == "..." ) {
+            cf.type = FRAME_DOTS;
+            cf.isGlob = true;
+         }
+         else {
+            cf.type = frame.startsWith( "fun:", Qt::CaseInsensitive ) ? FRAME_FUN
+                                                                      : FRAME_OBJ;
+            cf.pattern = frame.mid( 4 );
+            cf.isGlob = cf.pattern.contains( '*' ) || cf.pattern.contains( '?' );
+         }
+         cs.frames.append( cf );
+      }
+      if ( cs.frames.isEmpty() ) {
+         // can't happen for a parsed suppression
+         continue;
+      }
+
+      int idx = m_supps.count();
+      m_supps.append( cs );
+
+      KindIndex& kindIdx = m_index[cs.kind];
+      const CompiledFrame& first = cs.frames.first();
+      if ( first.isGlob ) {
+         kindIdx.wildFirst.append( idx );
+      }
+      else {
+         QString key = ( first.type == FRAME_FUN ? "fun:" : "obj:" ) + first.pattern;
+         kindIdx.byFirstFrame[key].append( idx );
+      }
+   }
+
+   m_matched = false;
+}
+
+
+/*!
+  Read logFiles concurrently, and add their errors.
+  Returns false (with errMsg set) if any log failed to load,
+  or the logs are from different tools.
+*/
+bool VgSuppMatcher::addLogs( const QStringList& logFiles, QString& errMsg )
+{
+   if ( logFiles.isEmpty() ) {
+      errMsg = "No log files to match against";
+      return false;
+   }
+
+   QList<VgSuppLogJob*> jobs;
+   QThreadPool* pool = QThreadPool::globalInstance();
+   foreach ( QString logFile, logFiles ) {
+      VgSuppLogJob* job = new VgSuppLogJob( logFile );
+      jobs.append( job );
+      pool->start( job );
+   }
+   pool->waitForDone();
+
+   bool ok = true;
+   foreach ( VgSuppLogJob* job, jobs ) {
+      if ( !job->ok ) {
+         errMsg = job->errMsg;
+         ok = false;
+         break;
+      }
+      if ( m_tool.isEmpty() ) {
+         m_tool = job->toolName;
+      }
+      else if ( job->toolName != m_tool ) {
+         errMsg = "Logs are from different tools (" + m_tool + " -v- " +
+                  job->toolName + "): '" + job->logFile + "'";
+         ok = false;
+         break;
+      }
+
+      int logIdx = m_logs.count();
+      m_errors.reserve( m_errors.count() + job->errors.count() );
+      foreach ( VgSuppMatchError err, job->errors ) {
+         err.log = logIdx;
+         m_errors.append( err );
+      }
+
+      QHash<QString, int>::const_iterator sit = job->suppCounts.constBegin();
+      for ( ; sit != job->suppCounts.constEnd(); ++sit ) {
+         m_suppCounts[sit.key()] += sit.value();
+      }
+
+      m_logs << job->logFile;
+   }
+
+   qDeleteAll( jobs );
+   m_matched = false;
+   return ok;
+}
+
+
+bool VgSuppMatcher::frameMatch( const CompiledFrame& frame,
+                                const VgSuppMatchError& err, int idx )
+{
+   const QString& name = ( frame.type == FRAME_FUN ) ? err.funs.at( idx )
+                                                     : err.objs.at( idx );
+   return frame.isGlob ? globMatch( frame.pattern, name )
+                       : frame.pattern == name;
+}
+
+
+bool VgSuppMatcher::kauxMatch( const CompiledSupp& supp,
+                               const VgSuppMatchError& err )
+{
+   if ( !supp.leakKinds.isEmpty() ) {
+      return supp.leakKinds.contains( err.kaux );
+   }
+   if ( !supp.kaux.isEmpty() && supp.kind.endsWith( ":param" ) ) {
+      return globMatch( supp.kaux, err.kaux );
+   }
+   return true;
+}
+
+
+/*!
+  Does supp match err: kind already known to be the same.
+  The frames must match a prefix of the stack, a '...' matching
+  zero or more frames. As globMatch, '...' backtracking only goes
+  back to the last '...'.
+*/
+bool VgSuppMatcher::suppMatch( const CompiledSupp& supp,
+                               const VgSuppMatchError& err ) const
+{
+   if ( !kauxMatch( supp, err ) ) {
+      return false;
+   }
+
+   const QVector<CompiledFrame>& frames = supp.frames;
+   int nf = frames.count(), ns = err.funs.count();
+   int fi = 0, si = 0;
+   int starF = -1, starS = 0;
+
+   while ( fi < nf ) {
+      if ( frames.at( fi ).type == FRAME_DOTS ) {
+         starF = fi++;
+         starS = si;
+      }
+      else if ( si < ns && frameMatch( frames.at( fi ), err, si ) ) {
+         ++fi;
+         ++si;
+      }
+      else if ( starF >= 0 && starS < ns ) {
+         fi = starF + 1;
+         si = ++starS;
+      }
+      else {
+         return false;
+      }
+   }
+   return true;
+}
+
+
+/*!
+  Index of the first suppression matching err, or -1.
+  Only the candidates for err's kind and top frame are tried,
+  in file order, stopping at the first match.
+*/
+int VgSuppMatcher::findMatch( const VgSuppMatchError& err ) const
+{
+   QHash<QString, KindIndex>::const_iterator kit = m_index.constFind( err.suppKind );
+   if ( kit == m_index.constEnd() || err.funs.isEmpty() ) {
+      return -1;
+   }
+   const KindIndex& kindIdx = kit.value();
+
+   QList<const QList<int>*> candidates;
+   candidates << &kindIdx.wildFirst;
+   QHash<QString, QList<int> >::const_iterator fit =
+      kindIdx.byFirstFrame.constFind( "fun:" + err.funs.first() );
+   if ( fit != kindIdx.byFirstFrame.constEnd() ) {
+      candidates << &fit.value();
+   }
+   fit = kindIdx.byFirstFrame.constFind( "obj:" + err.objs.first() );
+   if ( fit != kindIdx.byFirstFrame.constEnd() ) {
+      candidates << &fit.value();
+   }
+
+   // each list is in file order: only need to beat the best so far
+   int best = -1;
+   foreach ( const QList<int>* list, candidates ) {
+      foreach ( int idx, *list ) {
+         if ( best != -1 && idx >= best ) {
+            break;
+         }
+         if ( suppMatch( m_supps.at( idx ), err ) ) {
+            best = idx;
+            break;
+         }
+      }
+   }
+   return best;
+}
+
+
+/*!
+  Match all errors, concurrently, then tally the matches per suppression.
+*/
+void VgSuppMatcher::match()
+{
+   int num = m_errors.count();
+   m_matches.fill( -1, num );
+
+   int nThreads = qMax( 1, QThread::idealThreadCount() );
+   int slice = qMax( SUPP_MATCH_MIN_SLICE, ( num + nThreads - 1 ) / nThreads );
+
+   // jobs write straight into the results, a slice each
+   const VgSuppMatchError* errors = m_errors.constData();
+   int* matches = m_matches.data();
+
+   QThreadPool* pool = QThreadPool::globalInstance();
+   for ( int begin = 0; begin < num; begin += slice ) {
+      pool->start( new VgSuppMatchJob( this, errors, matches, begin,
+                                       qMin( begin + slice, num ) ) );
+   }
+   pool->waitForDone();
+
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      m_supps[i].numErrors = m_supps[i].numHits = 0;
+   }
+   for ( int i = 0; i < num; ++i ) {
+      if ( m_matches.at( i ) != -1 ) {
+         CompiledSupp& cs = m_supps[m_matches.at( i )];
+         cs.numErrors++;
+         cs.numHits += m_errors.at( i ).count;
+      }
+   }
+
+   m_matched = true;
+}
+
+
+int VgSuppMatcher::numSuppressed()
+{
+   if ( !m_matched ) {
+      match();
+   }
+   int num = 0;
+   foreach ( int idx, m_matches ) {
+      if ( idx != -1 ) {
+         num++;
+      }
+   }
+   return num;
+}
+
+
+/*!
+  Suppressions matching no logged error, and not used at run time either.
+*/
+int VgSuppMatcher::numUnusedSupps()
+{
+   if ( !m_matched ) {
+      match();
+   }
+   int num = 0;
+   foreach ( CompiledSupp cs, m_supps ) {
+      if ( cs.numErrors == 0 && !m_suppCounts.contains( cs.name ) ) {
+         num++;
+      }
+   }
+   return num;
+}
+
+
+/*!
+  Write the report to reportFile: empty or "-" means stdout.
+*/
+bool VgSuppMatcher::write( const QString& reportFile, QString& errMsg )
+{
+   QFile file;
+   bool ok;
+   if ( reportFile.isEmpty() || reportFile == "-" ) {
+      ok = file.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+   }
+   else {
+      file.setFileName( reportFile );
+      ok = file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text );
+   }
+   if ( !ok ) {
+      errMsg = "Failed to open report file: '" + reportFile + "'";
+      return false;
+   }
+
+   QTextStream strm( &file );
+   writeReport( strm );
+   strm.flush();
+   return true;
+}
+
+
+// most errors matched first, then file order
+struct SuppHits {
+   int idx, numErrors, numHits;
+};
+
+static bool suppHitsLessThan( const SuppHits& h1, const SuppHits& h2 )
+{
+   if ( h1.numHits != h2.numHits ) {
+      return h1.numHits > h2.numHits;
+   }
+   return h1.idx < h2.idx;
+}
+
+
+void VgSuppMatcher::writeReport( QTextStream& strm )
+{
+   if ( !m_matched ) {
+      match();
+   }
+
+   QStringList files;
+   foreach ( CompiledSupp cs, m_supps ) {
+      if ( !files.contains( cs.file ) ) {
+         files << cs.file;
+      }
+   }
+   strm << "Suppressions: " << m_supps.count() << endl;
+   foreach ( QString file, files ) {
+      strm << "   " << file << endl;
+   }
+   strm << "Logs: " << m_logs.count() << "  (" << m_tool << ")" << endl;
+   foreach ( QString log, m_logs ) {
+      strm << "   " << log << endl;
+   }
+
+   int numSupp = numSuppressed();
+   strm << endl << "Errors: " << m_errors.count()
+        << "  (" << numSupp << " would be suppressed, "
+        << m_errors.count() - numSupp << " not)" << endl;
+
+   // matches per suppression
+   QList<SuppHits> hits;
+   for ( int i = 0; i < m_supps.count(); ++i ) {
+      const CompiledSupp& cs = m_supps.at( i );
+      if ( cs.numErrors > 0 ) {
+         SuppHits h = { i, cs.numErrors, cs.numHits };
+         hits << h;
+      }
+   }
+   std::sort( hits.begin(), hits.end(), suppHitsLessThan );
+
+   strm << endl << "Matching suppressions: " << hits.count()
+        << "  (errors, occurrences, suppressed at run time)" << endl;
+   foreach ( SuppHits h, hits ) {
+      const CompiledSupp& cs = m_supps.at( h.idx );
+      strm << "   " << qSetFieldWidth( 40 ) << left << cs.name
+           << qSetFieldWidth( 8 ) << right << h.numErrors << h.numHits
+           << m_suppCounts.value( cs.name )
+           << qSetFieldWidth( 0 ) << endl;
+   }
+
+   // run-time hits only: errors suppressed when the log was made
+   QStringList runTime;
+   foreach ( CompiledSupp cs, m_supps ) {
+      if ( cs.numErrors == 0 && m_suppCounts.contains( cs.name ) ) {
+         runTime << cs.name;
+      }
+   }
+   if ( !runTime.isEmpty() ) {
+      strm << endl << "Used at run time only: " << runTime.count() << endl;
+      foreach ( QString name, runTime ) {
+         strm << "   " << qSetFieldWidth( 40 ) << left << name
+              << qSetFieldWidth( 8 ) << right << m_suppCounts.value( name )
+              << qSetFieldWidth( 0 ) << endl;
+      }
+   }
+
+   strm << endl << "Unused suppressions: " << numUnusedSupps() << endl;
+   foreach ( CompiledSupp cs, m_supps ) {
+      if ( cs.numErrors == 0 && !m_suppCounts.contains( cs.name ) ) {
+         strm << "   " << cs.name << "  (" << cs.file << ")" << endl;
+      }
+   }
+
+   if ( numSupp == 0 ) {
+      return;
+   }
+
+   strm << endl << "Suppressed errors: " << numSupp << endl;
+   for ( int i = 0; i < m_errors.count(); ++i ) {
+      if ( m_matches.at( i ) == -1 ) {
+         continue;
+      }
+      const VgSuppMatchError& err = m_errors.at( i );
+      QString top = ( err.funs.first() != "???" ) ? "fun:" + err.funs.first()
+                                                  : "obj:" + err.objs.first();
+      strm << qSetFieldWidth( 8 ) << right << err.count
+           << qSetFieldWidth( 0 ) << "  " << err.kind << "  " << top << endl;
+      if ( m_logs.count() > 1 ) {
+         strm << "          log:  " << m_logs.at( err.log ) << endl;
+      }
+      strm << "          by:   " << m_supps.at( m_matches.at( i ) ).name << endl;
+   }
+}
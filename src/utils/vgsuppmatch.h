@@ -0,0 +1,264 @@
+/****************************************************************************
+** VgSuppMatcher definition
+**  - offline matching of suppressions against valgrind xml logs
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef __VGSUPPMATCH_H
+#define __VGSUPPMATCH_H
+
+#include <QHash>
+#include <QList>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <QXmlAttributes>
+#include <QXmlDefaultHandler>
+
+#include "options/suppressions.h"
+
+
+// ============================================================
+/*!
+  One logged error, reduced to what a suppression can match on:
+   - suppKind: "tool:kind", lowercased, e.g. "memcheck:addr4"
+   - kaux: syscall param (Param), or leak kind (Leak)
+   - funs/objs: one per frame, top frame first
+  If the error carries valgrind's own suppression (--gen-suppressions),
+  its kind and frames are used: those are exactly what valgrind matches.
+  Else they're worked out from the error kind and its first stack.
+*/
+class VgSuppMatchError
+{
+public:
+   VgSuppMatchError() : count( 1 ), log( 0 ) {}
+
+   QString unique, kind, what;
+   QString suppKind, kaux;
+   QStringList funs, objs;
+   int count;                   // from errorcounts
+   int log;                     // index of the log it came from
+};
+
+
+
+// ============================================================
+/*
+  Light-weight xml handler: as VgLogDigestHandler, no QDomDocument,
+  just a VgSuppMatchError per <error>, plus the last errorcounts
+  and suppcounts.
+*/
+class VgSuppLogHandler : public QXmlDefaultHandler
+{
+public:
+   VgSuppLogHandler( QList<VgSuppMatchError>* errors,
+                     QHash<QString, int>* suppCounts );
+   ~VgSuppLogHandler();
+
+   // content handler
+   bool startElement( const QString& nsURI,
+                      const QString& localName,
+                      const QString& qName,
+                      const QXmlAttributes& atts );
+   bool endElement( const QString& nsURI,
+                    const QString& localName,
+                    const QString& qName );
+   bool characters( const QString& ch );
+   bool startDocument();
+   bool endDocument();
+
+   // reimplement error handlers
+   bool fatalError( const QXmlParseException& exception );
+
+   QString fatalMsg() {
+      return m_fatalMsg;
+   }
+   QString toolName() {
+      return m_tool;
+   }
+
+private:
+   void finishError();
+
+private:
+   QList<VgSuppMatchError>* m_errors;      // we don't own this
+   QHash<QString, int>*     m_suppCounts;  // nor this
+
+   QStringList m_path;             // open element tags
+   QString m_chars;                // text of the current element
+
+   // current error
+   VgSuppMatchError m_err;
+   bool m_inStack, m_haveStack;
+   QString m_frameFn, m_frameObj;
+   QString m_skind, m_skaux;
+   QStringList m_sframes;          // "fun:..." / "obj:..."
+
+   // current errorcounts / suppcounts pair
+   QString m_pairCount, m_pairUnique, m_pairName;
+   QHash<QString, int> m_counts;   // from the last <errorcounts>
+   QHash<QString, int> m_supps;    // from the last <suppcounts>
+
+   QString m_tool;
+   QString m_fatalMsg;
+};
+
+
+
+// ============================================================
+/*!
+  VgSuppLogJob: reads one log, off the main thread.
+*/
+class VgSuppLogJob : public QRunnable
+{
+public:
+   VgSuppLogJob( const QString& logFile );
+
+   void run();
+
+   QString                 logFile;
+   QString                 toolName;
+   QList<VgSuppMatchError> errors;
+   QHash<QString, int>     suppCounts;
+
+   bool    ok;
+   QString errMsg;
+};
+
+
+
+// ============================================================
+class VgSuppMatcher;
+
+/*!
+  VgSuppMatchJob: matches a slice of the errors.
+  Each job only writes the results for its own slice.
+*/
+class VgSuppMatchJob : public QRunnable
+{
+public:
+   VgSuppMatchJob( const VgSuppMatcher* matcher,
+                   const VgSuppMatchError* errors, int* matches,
+                   int begin, int end );
+
+   void run();
+
+private:
+   const VgSuppMatcher*    m_matcher;
+   const VgSuppMatchError* m_errors;    // we don't own these
+   int* m_matches;
+   int  m_begin, m_end;
+};
+
+
+
+// ============================================================
+/*!
+  VgSuppMatcher: tests suppressions against logged errors,
+  without re-running valgrind.
+
+  Each suppression is compiled once: its kind is normalised, and each
+  frame becomes a fun:/obj: glob ('*', '?'), or a '...' frame wildcard.
+  The compiled suppressions are indexed by kind, then by first frame:
+   - a literal first frame is looked up directly from the error's top frame
+   - a first frame with a glob, or a '...', goes in a per-kind list
+     that every error of that kind is tried against.
+  As valgrind, the first suppression (in file order) that matches an
+  error suppresses it.
+
+  The logs are read concurrently, and the errors matched concurrently,
+  both on the global thread pool.
+
+  The logs' own suppcounts are kept too: errors valgrind suppressed
+  at run time aren't in the log to be matched, so a suppression with
+  run-time hits isn't unused.
+*/
+class VgSuppMatcher
+{
+   friend class VgSuppMatchJob;
+
+public:
+   VgSuppMatcher();
+   ~VgSuppMatcher();
+
+   bool addSuppFile( const QString& suppFile, QString& errMsg );
+   void addSupps( const QList<Suppression>& supps, const QString& suppFile );
+   bool addLogs( const QStringList& logFiles, QString& errMsg );
+   void match();
+   bool write( const QString& reportFile, QString& errMsg );
+   void writeReport( QTextStream& strm );
+
+   int numSupps() {
+      return m_supps.count();
+   }
+   int numErrors() {
+      return m_errors.count();
+   }
+   int numSuppressed();
+   int numUnusedSupps();
+
+   static bool globMatch( const QString& pattern, const QString& str );
+
+private:
+   enum FrameType { FRAME_FUN, FRAME_OBJ, FRAME_DOTS };
+
+   struct CompiledFrame {
+      FrameType type;
+      QString   pattern;
+      bool      isGlob;        // has '*' or '?'
+   };
+
+   struct CompiledSupp {
+      QString name, file;
+      QString kind;            // normalised, as VgSuppMatchError::suppKind
+      QString kaux;            // Param: glob
+      QStringList leakKinds;   // Leak: from match-leak-kinds (empty: any)
+      QVector<CompiledFrame> frames;
+      int numErrors;           // errors matched
+      int numHits;             // sum of their errorcounts
+   };
+
+   // per-kind index
+   struct KindIndex {
+      QHash<QString, QList<int> > byFirstFrame;   // "fun:x" / "obj:x"
+      QList<int> wildFirst;
+   };
+
+   static QString normaliseKind( const QString& kind );
+   static bool frameMatch( const CompiledFrame& frame,
+                           const VgSuppMatchError& err, int idx );
+   static bool kauxMatch( const CompiledSupp& supp,
+                          const VgSuppMatchError& err );
+   bool suppMatch( const CompiledSupp& supp, const VgSuppMatchError& err ) const;
+   int  findMatch( const VgSuppMatchError& err ) const;
+
+private:
+   QList<CompiledSupp>      m_supps;
+   QHash<QString, KindIndex> m_index;
+
+   QStringList             m_logs;
+   QString                 m_tool;
+   QVector<VgSuppMatchError> m_errors;
+   QVector<int>            m_matches;     // per error: supp index, or -1
+   QHash<QString, int>     m_suppCounts;  // run-time, from the logs
+   bool                    m_matched;
+};
+
+#endif // #ifndef __VGSUPPMATCH_H
@@ -32,6 +32,7 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFileInfoList>
+#include <QHash>
 #include <QPoint>
 #include <QSize>
 #include <QStringList>
@@ -42,8 +43,8 @@
 /*!
   Initialise static data: Basic configuration setup
 */
-const unsigned int VkCfg::_projCfgVersion = 1;   // @@@ increment if project config keys change @@@
-const unsigned int VkCfg::_glblCfgVersion = 2;   // @@@ increment if  global config keys change @@@
+const unsigned int VkCfg::_projCfgVersion = 13;   // @@@ increment if project config keys change @@@
+const unsigned int VkCfg::_glblCfgVersion = 4;   // @@@ increment if  global config keys change @@@
 
 const QString VkCfg::_email       = "info@open-works.net"; // bug-reports
 const QString VkCfg::_copyright   = "Valkyrie is Copyright (C) 2003-2011 by OpenWorks GbR";
@@ -420,6 +421,10 @@ void VkCfgGlbl::writeConfigDefaults()
    // - dflt key = <list key>-default
    setValue( "filefilters/valkyrie_view-log", "XML Files (*.xml);;Log Files (*.log.*);;All Files (*)" );
    setValue( "filefilters/valkyrie_view-log-default", "" );
+   setValue( "filefilters/valkyrie_diff-log", "XML Files (*.xml);;Log Files (*.log.*);;All Files (*)" );
+   setValue( "filefilters/valkyrie_diff-log-default", "" );
+   setValue( "filefilters/valkyrie_export", "JSON Lines (*.jsonl);;CSV Files (*.csv);;SARIF Files (*.sarif);;All Files (*)" );
+   setValue( "filefilters/valkyrie_export-default", "" );
    setValue( "filefilters/handbook_docdir", "Html Files (*.html *.htm);;All Files (*)" );
    setValue( "filefilters/handbook_docdir-default", "" );
    setValue( "filefilters/project_path", "Valkyrie Projects (*." + VkCfg::filetype() + ")" );
@@ -462,7 +467,7 @@ void VkCfgGlbl::writeConfigDefaults()
        The settings themselves are further defined and wrapped in the VkOption classes.
 */
 VkCfgProj::VkCfgProj( Valkyrie* valkyrie, const QString& cfg_fname )
-   : vk( valkyrie)
+   : vk( valkyrie), batchDepth( 0 ), syncPending( false )
 {
    currentCfg = new QSettings( cfg_fname, QSettings::IniFormat );
 }
@@ -617,14 +622,53 @@ bool VkCfgProj::contains( const QString& key ) const
    return currentCfg->contains( key );
 }
 
+/*!
+  Interface function to QSettings::fileName()
+*/
+QString VkCfgProj::fileName() const
+{
+   return currentCfg->fileName();
+}
+
 /*!
   Interface function to QSettings::sync()
+   - in a batch, once at the end of it
 */
 void VkCfgProj::sync()
 {
+   if ( batchDepth > 0 ) {
+      syncPending = true;
+      return;
+   }
    currentCfg->sync();
 }
 
+
+/*!
+  Start a batch of updates.
+  Each VkOption update syncs the whole config to disk: with every
+  option updated at once (loading a config, the command line), that's
+  the file rewritten once per option.  In a batch, it's done once.
+  Batches nest: only the outermost counts.
+*/
+void VkCfgProj::beginBatch()
+{
+   batchDepth++;
+}
+
+
+/*!
+  End a batch of updates: sync, if anyone asked for it.
+*/
+void VkCfgProj::endBatch()
+{
+   vk_assert( batchDepth > 0 );
+   if ( --batchDepth == 0 && syncPending ) {
+      syncPending = false;
+      currentCfg->sync();
+   }
+}
+
 /*!
   Interface function to QSettings::clear()
 */
@@ -845,8 +889,17 @@ bool VkCfgProj::loadDefaultConfig()
    default_keys.removeAll( "config_proj_version" );   // not-a-VkOption
    currentCfg->setValue( "config_proj_version", VkCfg::projCfgVersion() );
 
+   // look the options up by key once, not each key with a search
+   QHash<QString, VkOption*> optsByKey;
+   foreach( VkObject* obj, vk->vkObjList() ) {
+      foreach( VkOption* opt, obj->getOptions() ) {
+         optsByKey.insert( opt->configKey(), opt );
+      }
+   }
+
+   beginBatch();
    foreach( QString key, default_keys ) {
-      VkOption* opt = vk->findOption( key );
+      VkOption* opt = optsByKey.value( key );
       if ( !opt ) {
          vkPrintErr( "Error in VkCfgProj::loadDefaultConfig(): Key not found in VkOption: '%s':'%s'",
                      qPrintable( VkCfg::projDfltPath() ), qPrintable( key ) );
@@ -857,6 +910,7 @@ bool VkCfgProj::loadDefaultConfig()
          opt->updateConfig( defaultCfg->value( key ) );
       }
    }
+   endBatch();
 
    // force write to disk, before anything horrible happens!
    currentCfg->sync();
@@ -917,9 +971,11 @@ void VkCfgProj::writeConfigDefaults()
 
    // Call each object and have it set its config defaults.
    // TODO: horrible. currently VkOption needs to signal that an option has changed. FIXME!
+   beginBatch();
    foreach( VkObject* obj, vk->vkObjList() ) {
       obj->resetOptsToFactoryDefault();
    }
+   endBatch();
    currentCfg->sync();
 
    // Copy the loaded settings to the default config file
@@ -140,9 +140,13 @@ private:
 public:
    QVariant value( const QString& key, const QVariant& defaultValue = QVariant() ) const;
    bool contains ( const QString & key ) const;
+   QString fileName() const;
    void setValue ( const QString& key, const QVariant& value );
    void sync();
    void clear();
+   // sync() is put off to the end of a batch of updates
+   void beginBatch();
+   void endBatch();
    void createNewProject(const  QString& proj_filename );
    void openProject( const QString& proj_filename );
    void saveProjectAs( const QString proj_filename, bool replace=true );
@@ -159,6 +163,8 @@ private:
 private:
    Valkyrie* vk;
    QSettings* currentCfg;
+   int  batchDepth;    // > 0: in a batch
+   bool syncPending;   // sync() called in the batch
 };
 
 
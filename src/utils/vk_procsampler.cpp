@@ -0,0 +1,443 @@
+/****************************************************************************
+** VkProcSampler implementation
+**  - samples the resource usage of a process tree, from /proc
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_procsampler.h"
+#include "utils/vk_utils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMultiHash>
+
+#include <unistd.h>
+
+// summary verdicts
+#define PROC_CPU_BOUND_PERCENT   90     // mean cpu use: cpu-bound above this
+#define PROC_CPU_IDLE_PERCENT    50     //   waiting on something below this
+#define PROC_MEM_BOUND_PERCENT   80     // peak rss, of physical memory
+#define PROC_THRASH_FAULT_RATE   100.0  // major faults / sec, at peak
+
+
+/***************************************************************************/
+VkProcSampler::VkProcSampler( QObject* parent )
+   : QObject( parent ), m_pid( 0 ), m_numSamples( 0 ),
+     m_peakRssKB( 0 ), m_maxThreads( 0 ), m_maxProcs( 0 ),
+     m_peakCpuPercent( 0 ), m_peakFaultRate( 0 )
+{
+   this->setObjectName( "procsampler" );
+
+   m_ticksPerSec = sysconf( _SC_CLK_TCK );
+   if ( m_ticksPerSec <= 0 ) {
+      m_ticksPerSec = 100;
+   }
+   m_pageKB = sysconf( _SC_PAGESIZE ) / 1024;
+   if ( m_pageKB <= 0 ) {
+      m_pageKB = 4;
+   }
+
+   timer = new QTimer( this );
+   connect( timer, SIGNAL( timeout() ),
+            this,  SLOT( sample() ) );
+}
+
+
+VkProcSampler::~VkProcSampler()
+{
+   // timer deleted by it's parent: this
+}
+
+
+bool VkProcSampler::isSupported()
+{
+   return QFile::exists( "/proc/self/stat" );
+}
+
+
+/*!
+  Peak, and current, rss of one process, from its status: 0 if it's gone.
+  Safe to call from any thread.
+*/
+qint64 VkProcSampler::peakRssKB( qint64 pid )
+{
+   return statusKB( pid, "VmHWM:" );
+}
+
+qint64 VkProcSampler::currentRssKB( qint64 pid )
+{
+   return statusKB( pid, "VmRSS:" );
+}
+
+qint64 VkProcSampler::statusKB( qint64 pid, const QByteArray& field )
+{
+   QFile file( QString( "/proc/%1/status" ).arg( pid ) );
+   if ( file.open( QIODevice::ReadOnly ) ) {
+      foreach ( QByteArray line, file.readAll().split( '\n' ) ) {
+         if ( line.startsWith( field ) ) {
+            return line.mid( field.length() ).simplified().split( ' ' ).first().toLongLong();
+         }
+      }
+   }
+   return 0;
+}
+
+
+/*!
+  Start sampling pid (and its descendants) every interval msecs.
+  The first sample is taken straight away.
+*/
+void VkProcSampler::start( qint64 pid, int interval )
+{
+   vk_assert( pid > 0 && interval > 0 );
+
+   m_pid = pid;
+   m_procs.clear();
+   m_recent.clear();
+   m_first = m_last = VkProcSample();
+   m_numSamples = 0;
+   m_peakRssKB = 0;
+   m_maxThreads = m_maxProcs = 0;
+   m_peakCpuPercent = m_peakFaultRate = 0;
+
+   m_clock.start();
+   sample();
+   timer->start( interval );
+}
+
+
+/*!
+  Stop sampling: the process tree has most likely gone,
+  so there's no last sample to take.
+*/
+void VkProcSampler::stop()
+{
+   if ( timer->isActive() ) {
+      timer->stop();
+   }
+}
+
+
+bool VkProcSampler::isActive()
+{
+   return timer->isActive();
+}
+
+
+/*!
+  pid and all its descendants.
+  The kernel lists each thread's children, if configured to:
+  else all of /proc is read, to find them by their parent.
+*/
+QList<qint64> VkProcSampler::processTree()
+{
+   QList<qint64> tree;
+   tree << m_pid;
+
+   QString childrenFile = QString( "/proc/%1/task/%1/children" ).arg( m_pid );
+   if ( QFile::exists( childrenFile ) ) {
+      for ( int i = 0; i < tree.count(); ++i ) {
+         // any thread may have forked
+         QDir taskDir( QString( "/proc/%1/task" ).arg( tree.at( i ) ) );
+         foreach ( QString tid, taskDir.entryList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+            QFile file( taskDir.absoluteFilePath( tid + "/children" ) );
+            if ( !file.open( QIODevice::ReadOnly ) ) {
+               continue;
+            }
+            foreach ( QByteArray child, file.readAll().simplified().split( ' ' ) ) {
+               bool ok;
+               qint64 cpid = child.toLongLong( &ok );
+               if ( ok && !tree.contains( cpid ) ) {
+                  tree << cpid;
+               }
+            }
+         }
+      }
+      return tree;
+   }
+
+   QMultiHash<qint64, qint64> children;
+   foreach ( QString entry, QDir( "/proc" ).entryList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+      bool ok;
+      qint64 pid = entry.toLongLong( &ok );
+      if ( !ok ) {
+         continue;
+      }
+      QFile file( "/proc/" + entry + "/stat" );
+      if ( !file.open( QIODevice::ReadOnly ) ) {
+         continue;
+      }
+      QByteArray stat = file.readAll();
+      int rparen = stat.lastIndexOf( ')' );
+      QList<QByteArray> fields = stat.mid( rparen + 2 ).split( ' ' );
+      if ( rparen != -1 && fields.count() > 1 ) {
+         children.insert( fields.at( 1 ).toLongLong(), pid );
+      }
+   }
+   for ( int i = 0; i < tree.count(); ++i ) {
+      tree += children.values( tree.at( i ) );
+   }
+   return tree;
+}
+
+
+/*!
+  Read one process: see proc(5) for the fields.
+  Returns false if it's gone (or isn't ours to read).
+*/
+bool VkProcSampler::readProcess( qint64 pid, ProcCounters& counters,
+                                 qint64& rssKB, int& threads )
+{
+   QString dir = QString( "/proc/%1/" ).arg( pid );
+
+   // stat: one line; the command name, in (), may hold spaces
+   QFile statFile( dir + "stat" );
+   if ( !statFile.open( QIODevice::ReadOnly ) ) {
+      return false;
+   }
+   QByteArray stat = statFile.readAll();
+   int rparen = stat.lastIndexOf( ')' );
+   if ( rparen == -1 ) {
+      return false;
+   }
+   // fields[0] is field 3 (state)
+   QList<QByteArray> fields = stat.mid( rparen + 2 ).split( ' ' );
+   if ( fields.count() < 22 ) {
+      return false;
+   }
+   counters.majFaults = fields.at( 9 ).toLongLong();
+   counters.cpuTicks  = fields.at( 11 ).toLongLong() + fields.at( 12 ).toLongLong();
+   threads = fields.at( 17 ).toInt();
+   rssKB   = fields.at( 21 ).toLongLong() * m_pageKB;
+
+   // status: the peak rss, which we can't miss between samples
+   counters.peakRssKB = qMax( counters.peakRssKB, peakRssKB( pid ) );
+
+   // io: not there without task io accounting
+   QFile ioFile( dir + "io" );
+   if ( ioFile.open( QIODevice::ReadOnly ) ) {
+      foreach ( QByteArray line, ioFile.readAll().split( '\n' ) ) {
+         if ( line.startsWith( "read_bytes:" ) ) {
+            counters.readBytes = line.mid( 11 ).trimmed().toLongLong();
+         }
+         else if ( line.startsWith( "write_bytes:" ) ) {
+            counters.writeBytes = line.mid( 12 ).trimmed().toLongLong();
+         }
+      }
+   }
+   return true;
+}
+
+
+void VkProcSampler::sample()
+{
+   VkProcSample smpl;
+   smpl.timeMs = m_clock.elapsed();
+
+   foreach ( qint64 pid, processTree() ) {
+      ProcCounters counters = m_procs.value( pid );
+      qint64 rssKB;
+      int threads;
+      if ( readProcess( pid, counters, rssKB, threads ) ) {
+         m_procs.insert( pid, counters );
+         smpl.rssKB   += rssKB;
+         smpl.threads += threads;
+         smpl.procs++;
+      }
+   }
+   if ( smpl.procs == 0 ) {
+      // all gone: nothing new to add
+      return;
+   }
+
+   // counters: the processes that have exited still count
+   qint64 ticks = 0;
+   foreach ( const ProcCounters& counters, m_procs ) {
+      ticks += counters.cpuTicks;
+      smpl.readBytes  += counters.readBytes;
+      smpl.writeBytes += counters.writeBytes;
+      smpl.majFaults  += counters.majFaults;
+   }
+   smpl.cpuMs = ticks * 1000 / m_ticksPerSec;
+
+   if ( m_numSamples == 0 ) {
+      m_first = smpl;
+   }
+   else {
+      qint64 dt = smpl.timeMs - m_last.timeMs;
+      if ( dt > 0 ) {
+         m_peakCpuPercent = qMax( m_peakCpuPercent,
+                                  ( smpl.cpuMs - m_last.cpuMs ) * 100.0 / dt );
+         m_peakFaultRate = qMax( m_peakFaultRate,
+                                 ( smpl.majFaults - m_last.majFaults ) * 1000.0 / dt );
+      }
+   }
+   m_peakRssKB  = qMax( m_peakRssKB, smpl.rssKB );
+   m_maxThreads = qMax( m_maxThreads, smpl.threads );
+   m_maxProcs   = qMax( m_maxProcs, smpl.procs );
+
+   m_last = smpl;
+   m_recent.append( smpl );
+   // one more than we show: rates need a sample before them
+   while ( m_recent.count() > PROC_SPARK_SAMPLES + 1 ) {
+      m_recent.removeFirst();
+   }
+   m_numSamples++;
+
+   emit sampled();
+}
+
+
+/*!
+  Unicode block sparkline, scaled to the largest value.
+*/
+QString VkProcSampler::sparkline( const QList<double>& values )
+{
+   static const ushort bars[] = { 0x2581, 0x2582, 0x2583, 0x2584,
+                                  0x2585, 0x2586, 0x2587, 0x2588 };
+   double max = 0;
+   foreach ( double val, values ) {
+      max = qMax( max, val );
+   }
+
+   QString line;
+   foreach ( double val, values ) {
+      int bar = ( max > 0 ) ? qRound( val / max * 7 ) : 0;
+      line += QChar( bars[qBound( 0, bar, 7 )] );
+   }
+   return line;
+}
+
+
+QString VkProcSampler::bytesString( qint64 bytes )
+{
+   if ( bytes < 1024 ) {
+      return QString( "%1 B" ).arg( bytes );
+   }
+   if ( bytes < 1024 * 1024 ) {
+      return QString( "%1 KB" ).arg( bytes / 1024.0, 0, 'f', 1 );
+   }
+   if ( bytes < 1024LL * 1024 * 1024 ) {
+      return QString( "%1 MB" ).arg( bytes / ( 1024.0 * 1024 ), 0, 'f', 1 );
+   }
+   return QString( "%1 GB" ).arg( bytes / ( 1024.0 * 1024 * 1024 ), 0, 'f', 2 );
+}
+
+
+/*!
+  One line for the live status: recent cpu, rss and major faults
+  as sparklines, with the latest values.
+*/
+QString VkProcSampler::liveText()
+{
+   if ( m_recent.count() < 2 ) {
+      return QString();
+   }
+
+   QList<double> cpu, rss, faults;
+   for ( int i = 1; i < m_recent.count(); ++i ) {
+      const VkProcSample& prev = m_recent.at( i - 1 );
+      const VkProcSample& smpl = m_recent.at( i );
+      qint64 dt = qMax( ( qint64 )1, smpl.timeMs - prev.timeMs );
+      cpu    << ( smpl.cpuMs - prev.cpuMs ) * 100.0 / dt;
+      rss    << smpl.rssKB;
+      faults << ( smpl.majFaults - prev.majFaults ) * 1000.0 / dt;
+   }
+   // cpu: scaled to at least one core
+   cpu.prepend( 100 );
+   QString cpuLine = sparkline( cpu ).mid( 1 );
+
+   return QString( "CPU %1 %2%   RSS %3 %4   Threads: %5   "
+                   "I/O: read %6, written %7   Page faults %8 %9/s" )
+          .arg( cpuLine )
+          .arg( qRound( cpu.last() ) )
+          .arg( sparkline( rss ) )
+          .arg( bytesString( m_last.rssKB * 1024 ) )
+          .arg( m_last.threads )
+          .arg( bytesString( m_last.readBytes ) )
+          .arg( bytesString( m_last.writeBytes ) )
+          .arg( sparkline( faults ) )
+          .arg( qRound( faults.last() ) );
+}
+
+
+static qint64 physicalMemKB()
+{
+   QFile file( "/proc/meminfo" );
+   if ( file.open( QIODevice::ReadOnly ) ) {
+      foreach ( QByteArray line, file.readAll().split( '\n' ) ) {
+         if ( line.startsWith( "MemTotal:" ) ) {
+            return line.mid( 9 ).simplified().split( ' ' ).first().toLongLong();
+         }
+      }
+   }
+   return 0;
+}
+
+
+/*!
+  Summary of the whole run, one line per resource, plus
+  a verdict on what held the run back, if it's clear.
+*/
+QStringList VkProcSampler::summary()
+{
+   QStringList lines;
+   if ( m_numSamples == 0 ) {
+      return lines;
+   }
+
+   qint64 peakProcKB = 0;
+   foreach ( const ProcCounters& counters, m_procs ) {
+      peakProcKB = qMax( peakProcKB, counters.peakRssKB );
+   }
+   double secs = qMax( ( qint64 )1, m_last.timeMs ) / 1000.0;
+   double meanCpu = m_last.cpuMs / 10.0 / secs;
+
+   lines << QString( "Sampled %1 times, every %2 ms, over %3 s" )
+            .arg( m_numSamples ).arg( timer->interval() ).arg( secs, 0, 'f', 1 );
+   lines << QString( "CPU time: %1 s (user + system), mean %2% of one core, peak %3%" )
+            .arg( m_last.cpuMs / 1000.0, 0, 'f', 1 )
+            .arg( qRound( meanCpu ) ).arg( qRound( m_peakCpuPercent ) );
+   lines << QString( "Memory: peak RSS %1 (all processes, sampled); largest process peak %2" )
+            .arg( bytesString( m_peakRssKB * 1024 ) )
+            .arg( bytesString( peakProcKB * 1024 ) );
+   lines << QString( "Threads: %1 at most, in %2 process(es)" )
+            .arg( m_maxThreads ).arg( m_maxProcs );
+   lines << QString( "Disk I/O: read %1, written %2" )
+            .arg( bytesString( m_last.readBytes ) )
+            .arg( bytesString( m_last.writeBytes ) );
+   lines << QString( "Major page faults: %1, peak %2/s" )
+            .arg( m_last.majFaults ).arg( qRound( m_peakFaultRate ) );
+
+   // verdicts
+   qint64 memKB = physicalMemKB();
+   if ( m_peakFaultRate >= PROC_THRASH_FAULT_RATE ) {
+      lines << "=> Thrashing: pages were being read back in from disk; "
+               "the run needs more memory than it had";
+   }
+   if ( memKB > 0 && m_peakRssKB * 100 >= memKB * PROC_MEM_BOUND_PERCENT ) {
+      lines << QString( "=> Memory-bound: peak RSS was %1% of physical memory" )
+               .arg( m_peakRssKB * 100 / memKB );
+   }
+   if ( meanCpu >= PROC_CPU_BOUND_PERCENT ) {
+      lines << "=> CPU-bound";
+   }
+   else if ( meanCpu < PROC_CPU_IDLE_PERCENT ) {
+      lines << "=> Mostly waiting: on I/O, paging, or the program's own sleeps";
+   }
+   return lines;
+}
@@ -0,0 +1,140 @@
+/****************************************************************************
+** VkProcSampler definition
+**  - samples the resource usage of a process tree, from /proc
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef VK_PROCSAMPLER_H
+#define VK_PROCSAMPLER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+// samples kept for the sparklines: older ones are only in the totals
+#define PROC_SPARK_SAMPLES  24
+
+
+// ============================================================
+/*!
+  One sample of a process tree, totalled over its processes.
+  Counters (cpu, i/o, faults) are cumulative, and include the
+  processes that have since exited.
+*/
+class VkProcSample
+{
+public:
+   VkProcSample()
+      : timeMs( 0 ), cpuMs( 0 ), rssKB( 0 ), threads( 0 ), procs( 0 ),
+        readBytes( 0 ), writeBytes( 0 ), majFaults( 0 ) {}
+
+   qint64 timeMs;          // since sampling started
+   qint64 cpuMs;           // user + system
+   qint64 rssKB;
+   int    threads;
+   int    procs;
+   qint64 readBytes, writeBytes;   // storage i/o
+   qint64 majFaults;               // pages read in from disk
+};
+
+
+
+// ============================================================
+/*!
+  VkProcSampler: polls /proc/<pid>/{stat,status,io} for a process
+  and its descendants (valgrind, and with --trace-children, the
+  valgrinds it forks), every interval msecs.
+
+  Gives a live one-liner, with sparklines of the recent samples,
+  and a summary of the whole run: that's enough to see if valgrind
+  is cpu-bound, memory-bound, or thrashing.
+
+  Only Linux has /proc as read here: elsewhere, isSupported() is false
+  and the sampler does nothing.
+*/
+class VkProcSampler : public QObject
+{
+   Q_OBJECT
+public:
+   VkProcSampler( QObject* parent );
+   ~VkProcSampler();
+
+   static bool isSupported();
+   static qint64 peakRssKB( qint64 pid );
+   static qint64 currentRssKB( qint64 pid );
+
+   void start( qint64 pid, int interval );   // msec
+   void stop();
+   bool isActive();
+   int  numSamples() {
+      return m_numSamples;
+   }
+
+   QString liveText();
+   QStringList summary();
+
+   static QString sparkline( const QList<double>& values );
+   static QString bytesString( qint64 bytes );
+
+signals:
+   void sampled();
+
+private slots:
+   void sample();
+
+private:
+   // last seen counters of one process
+   struct ProcCounters {
+      ProcCounters() : cpuTicks( 0 ), readBytes( 0 ), writeBytes( 0 ),
+                       majFaults( 0 ), peakRssKB( 0 ) {}
+      qint64 cpuTicks;
+      qint64 readBytes, writeBytes;
+      qint64 majFaults;
+      qint64 peakRssKB;
+   };
+
+   static qint64 statusKB( qint64 pid, const QByteArray& field );
+   QList<qint64> processTree();
+   bool readProcess( qint64 pid, ProcCounters& counters,
+                     qint64& rssKB, int& threads );
+
+private:
+   QTimer* timer;
+   qint64 m_pid;
+   QElapsedTimer m_clock;
+
+   QHash<qint64, ProcCounters> m_procs;   // every process seen
+   QList<VkProcSample> m_recent;          // last PROC_SPARK_SAMPLES
+   VkProcSample m_first, m_last;
+   int m_numSamples;
+
+   // run maxima
+   qint64 m_peakRssKB;         // of the tree total
+   int m_maxThreads, m_maxProcs;
+   double m_peakCpuPercent, m_peakFaultRate;
+
+   long m_ticksPerSec;
+   long m_pageKB;
+};
+
+#endif // VK_PROCSAMPLER_H
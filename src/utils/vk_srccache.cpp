@@ -0,0 +1,82 @@
+/****************************************************************************
+** VkSrcCache implementation
+**  - source files, read once for all the logs shown
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_srccache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+
+// the most source kept: some hundreds of typical files
+static const int srcCacheBytes = 16 * 1024 * 1024;
+
+
+VkSrcCache* VkSrcCache::instance()
+{
+   static VkSrcCache cache;
+   return &cache;
+}
+
+
+VkSrcCache::VkSrcCache()
+{
+   m_files.setMaxCost( srcCacheBytes );
+}
+
+
+bool VkSrcCache::lines( const QString& path, int firstLine, int lastLine,
+                        QStringList& result )
+{
+   QFileInfo fi( path );
+   SrcFile* src = m_files.object( path );
+   if ( src == 0 || src->modified != fi.lastModified() ) {
+      QFile file( path );
+      if ( !file.open( QIODevice::ReadOnly ) ) {
+         m_files.remove( path );
+         return false;
+      }
+
+      src = new SrcFile;
+      src->modified = fi.lastModified();
+      int bytes = 0;
+      QTextStream stream( &file );
+      while ( !stream.atEnd() ) {
+         QString line = stream.readLine();
+         bytes += line.size() * sizeof( QChar );
+         src->lines << line;
+      }
+      file.close();
+
+      // too big for the cache: it's deleted, so copy out first
+      result = src->lines.mid( firstLine - 1, lastLine - firstLine + 1 );
+      m_files.insert( path, src, qMax( bytes, 1 ) );
+      return true;
+   }
+
+   result = src->lines.mid( firstLine - 1, lastLine - firstLine + 1 );
+   return true;
+}
+
+
+void VkSrcCache::clear()
+{
+   m_files.clear();
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+** VkSrcCache definition
+**  - source files, read once for all the logs shown
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef VK_SRCCACHE_H
+#define VK_SRCCACHE_H
+
+#include <QCache>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+
+// ============================================================
+/*!
+  VkSrcCache: the lines of the source files that errors' frames point
+  into, kept within a budget, least recently used going first.
+
+  Every source item of every log (and log tab) used to read its file
+  from the top, for each opening: the same few files, over and over.
+  A file changed since it was read is read again.
+
+  Gui thread only: source items are made there.
+*/
+class VkSrcCache
+{
+public:
+   static VkSrcCache* instance();
+
+   // lines [firstLine, lastLine], 1-based, as far as the file goes.
+   // False: not readable.
+   bool lines( const QString& path, int firstLine, int lastLine,
+               QStringList& result );
+
+   void clear();
+
+private:
+   VkSrcCache();
+
+   struct SrcFile {
+      QStringList lines;
+      QDateTime   modified;
+   };
+
+private:
+   QCache<QString, SrcFile> m_files;   // cost: bytes
+};
+
+#endif // #ifndef VK_SRCCACHE_H
@@ -0,0 +1,87 @@
+/****************************************************************************
+** VkStringPool implementation
+**  - one copy of each string the loaded logs share
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_stringpool.h"
+
+#include <QMutexLocker>
+
+
+// longer strings rarely repeat: not worth the lookup
+static const int maxPooledLength = 256;
+
+// past this many, new strings aren't pooled: the pool stays bounded
+static const int maxPooledStrings = 500000;
+
+
+VkStringPool* VkStringPool::instance()
+{
+   static VkStringPool pool;
+   return &pool;
+}
+
+
+VkStringPool::VkStringPool()
+   : m_users( 0 )
+{
+}
+
+
+/*!
+  The pooled copy of str: str itself, when new (or not worth pooling).
+*/
+QString VkStringPool::intern( const QString& str )
+{
+   if ( str.isEmpty() || str.length() > maxPooledLength ) {
+      return str;
+   }
+
+   QMutexLocker locker( &m_mutex );
+   QSet<QString>::const_iterator it = m_strings.constFind( str );
+   if ( it != m_strings.constEnd() ) {
+      return *it;
+   }
+   if ( m_strings.count() < maxPooledStrings ) {
+      m_strings.insert( str );
+   }
+   return str;
+}
+
+
+void VkStringPool::acquire()
+{
+   QMutexLocker locker( &m_mutex );
+   m_users++;
+}
+
+
+void VkStringPool::release()
+{
+   QMutexLocker locker( &m_mutex );
+   if ( --m_users == 0 ) {
+      m_strings = QSet<QString>();   // frees its table, not just its entries
+   }
+}
+
+
+int VkStringPool::count()
+{
+   QMutexLocker locker( &m_mutex );
+   return m_strings.count();
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+** VkStringPool definition
+**  - one copy of each string the loaded logs share
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef VK_STRINGPOOL_H
+#define VK_STRINGPOOL_H
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+
+// ============================================================
+/*!
+  VkStringPool: one copy of each short string, for all the logs being
+  loaded.  A log's function, file and object names repeat in every
+  frame, and again in the next log: QString's implicit sharing makes
+  each repeat a reference to the pooled copy, not a copy of its own.
+
+  Used from the loading threads: intern() locks.  The pool only holds
+  references: strings live on in the logs that use them.  Loaders
+  acquire() it while they run; once none do, the pool is emptied.
+*/
+class VkStringPool
+{
+public:
+   static VkStringPool* instance();
+
+   QString intern( const QString& str );
+
+   void acquire();
+   void release();
+
+   int count();
+
+private:
+   VkStringPool();
+
+private:
+   QMutex        m_mutex;
+   QSet<QString> m_strings;
+   int           m_users;
+};
+
+#endif // #ifndef VK_STRINGPOOL_H
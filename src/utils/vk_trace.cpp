@@ -0,0 +1,219 @@
+/****************************************************************************
+** VkTrace implementation
+**  - scoped timers and counters on the log-loading hot paths
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "utils/vk_trace.h"
+#include "utils/vk_config.h"
+#include "utils/vk_utils.h"
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QTextStream>
+
+
+// events kept for the trace file: ~32MB worth
+static const int maxTraceEvents = 1000000;
+
+// a counter's trace events: no more than one per msec
+static const qint64 countEventGapNs = 1000000;
+
+
+VkTrace* VkTrace::instance()
+{
+   static VkTrace trace;
+   return &trace;
+}
+
+
+VkTrace::VkTrace()
+   : m_resetNs( 0 ), m_dropped( 0 )
+{
+   for ( int i = 0; i < VKTRACE::NUM_SECTIONS; ++i ) {
+      m_depth[i] = 0;
+   }
+   for ( int i = 0; i < VKTRACE::NUM_COUNTERS; ++i ) {
+      m_counters[i] = 0;
+      m_lastCountNs[i] = -countEventGapNs;
+   }
+   m_clock.start();
+}
+
+
+const char* VkTrace::sectionName( VKTRACE::Section section )
+{
+   static const char* names[VKTRACE::NUM_SECTIONS] = {
+      "parse", "parseContinue", "appendNode", "appendNodeTool",
+      "updateErrorItems", "openChildren", "source snippet",
+      "filter refresh", "expand all", "sort errors", "order errors"
+   };
+   return names[section];
+}
+
+
+const char* VkTrace::counterName( VKTRACE::Counter counter )
+{
+   static const char* names[VKTRACE::NUM_COUNTERS] = {
+      "bytes read", "records", "backlog (bytes)", "items alive"
+   };
+   return names[counter];
+}
+
+
+void VkTrace::leave( VKTRACE::Section section, bool outermost, qint64 startNs )
+{
+   m_depth[section]--;
+   if ( !outermost ) {
+      return;
+   }
+
+   qint64 durNs = now() - startNs;
+   VkTraceStats& stats = m_stats[section];
+   stats.calls++;
+   stats.totalNs += durNs;
+   if ( durNs > stats.maxNs ) {
+      stats.maxNs = durNs;
+   }
+
+   if ( isTracing() ) {
+      addEvent( startNs, durNs, 0, section );
+   }
+}
+
+
+void VkTrace::addCount( VKTRACE::Counter counter, qint64 delta )
+{
+   m_counters[counter] += delta;
+
+   if ( isTracing() ) {
+      qint64 nowNs = now();
+      if ( nowNs - m_lastCountNs[counter] >= countEventGapNs ) {
+         m_lastCountNs[counter] = nowNs;
+         addEvent( nowNs, -1, m_counters[counter], counter );
+      }
+   }
+}
+
+
+void VkTrace::addEvent( qint64 startNs, qint64 durNs, qint64 value, int id )
+{
+   if ( m_events.count() >= maxTraceEvents ) {
+      m_dropped++;
+      return;
+   }
+   Event ev;
+   ev.startNs = startNs;
+   ev.durNs   = durNs;
+   ev.value   = value;
+   ev.id      = id;
+   m_events.append( ev );
+}
+
+
+/*!
+  Zero the sections and the running totals: not the levels
+  (backlog, items alive), which are still true.
+*/
+void VkTrace::reset()
+{
+   for ( int i = 0; i < VKTRACE::NUM_SECTIONS; ++i ) {
+      m_stats[i] = VkTraceStats();
+   }
+   m_counters[VKTRACE::BYTES_READ] = 0;
+   m_counters[VKTRACE::RECORDS] = 0;
+   m_resetNs = now();
+}
+
+
+/*!
+  Keep every section's calls from now, for writeTrace().
+*/
+bool VkTrace::startTrace( const QString& traceFile, QString& errMsg )
+{
+   if ( traceFile.isEmpty() ) {
+      errMsg = "No trace file given";
+      return false;
+   }
+   m_traceFile = traceFile;
+   m_events.clear();
+   m_events.reserve( 64 * 1024 );
+   m_dropped = 0;
+   return true;
+}
+
+
+static QString usecs( qint64 ns )
+{
+   return QString::number( ns / 1000.0, 'f', 3 );
+}
+
+
+/*!
+  Write the trace: Chrome's trace-event format, json object flavour.
+  Sections are complete ('X') events, counters counter ('C') events.
+*/
+bool VkTrace::writeTrace( QString& errMsg )
+{
+   if ( !isTracing() ) {
+      errMsg = "Not tracing";
+      return false;
+   }
+
+   QSaveFile file( m_traceFile );
+   if ( !file.open( QIODevice::WriteOnly | QIODevice::Text ) ) {
+      errMsg = "Failed to open trace file: '" + m_traceFile + "'";
+      return false;
+   }
+
+   qint64 pid = QCoreApplication::applicationPid();
+   QString ids = QString( "\"pid\":%1,\"tid\":1" ).arg( pid );
+
+   QTextStream strm( &file );
+   strm << "{\"displayTimeUnit\":\"ms\",\n"
+        << "\"otherData\":{\"valkyrie\":\"" << VkCfg::appVersion() << "\","
+        << "\"droppedEvents\":" << m_dropped << "},\n"
+        << "\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\"," << ids
+        << ",\"args\":{\"name\":\"" << VkCfg::appName() << "\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\"," << ids
+        << ",\"args\":{\"name\":\"gui\"}}";
+
+   foreach ( const Event& ev, m_events ) {
+      if ( ev.durNs >= 0 ) {
+         strm << ",\n{\"name\":\"" << sectionName( ( VKTRACE::Section )ev.id )
+              << "\",\"cat\":\"valkyrie\",\"ph\":\"X\",\"ts\":" << usecs( ev.startNs )
+              << ",\"dur\":" << usecs( ev.durNs ) << "," << ids << "}";
+      }
+      else {
+         strm << ",\n{\"name\":\"" << counterName( ( VKTRACE::Counter )ev.id )
+              << "\",\"cat\":\"valkyrie\",\"ph\":\"C\",\"ts\":" << usecs( ev.startNs )
+              << "," << ids << ",\"args\":{\"value\":" << ev.value << "}}";
+      }
+   }
+   strm << "\n]}\n";
+
+   strm.flush();
+   if ( strm.status() != QTextStream::Ok || !file.commit() ) {
+      errMsg = "Failed to write trace file: '" + m_traceFile + "'";
+      return false;
+   }
+   if ( m_dropped > 0 ) {
+      vkPrintErr( "Trace full: the last %lld events were dropped.", m_dropped );
+   }
+   return true;
+}
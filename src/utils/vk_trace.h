@@ -0,0 +1,177 @@
+/****************************************************************************
+** VkTrace definition
+**  - scoped timers and counters on the log-loading hot paths
+** --------------------------------------------------------------------------
+**
+** Copyright (C) 2000-2011, OpenWorks LLP. All rights reserved.
+** <info@open-works.co.uk>
+**
+** This file is part of Valkyrie, a front-end for Valgrind.
+**
+** This file may be used under the terms of the GNU General Public
+** License version 2.0 as published by the Free Software Foundation
+** and appearing in the file COPYING included in the packaging of
+** this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef VK_TRACE_H
+#define VK_TRACE_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+
+// ============================================================
+namespace VKTRACE
+{
+/*!
+  The timed sections: VK_TRACE_SCOPE() in each.
+*/
+enum Section {
+   PARSE,            // VgLogReader::parse()
+   PARSE_CONTINUE,   // VgLogReader::parseContinue()
+   APPEND_NODE,      // VgLogView::appendNode(), appendChildNode()
+   APPEND_NODE_TOOL, // ... the tool logview's part
+   UPDATE_ERRORS,    // VgLogView::updateErrorItems()
+   OPEN_ITEM,        // VgOutputItem::openChildren(): making child items
+   SRC_IO,           // SrcItem: reading a source snippet
+   FILTER_REFRESH,   // LogViewFilterMC::updateView()
+   EXPAND_ALL,       // the views' opencloseAllItems()
+   SORT_ERRORS,      // VgLogView::sortErrors(): the keys
+   ORDER_ERRORS,     // VgLogView::applyErrorOrder(): the view's items
+   NUM_SECTIONS
+};
+
+/*!
+  The counters: running totals, or levels.
+*/
+enum Counter {
+   BYTES_READ,       // of logs, by the parsers
+   RECORDS,          // top-level log elements appended to a logview
+   BACKLOG,          // bytes of the logs being read, not yet parsed
+   ITEMS_ALIVE,      // VgOutputItems
+   NUM_COUNTERS
+};
+}
+
+
+// ============================================================
+/*!
+  One section's totals: outermost calls only, so a section that
+  recurses (opening an item opens its children) isn't counted twice.
+*/
+class VkTraceStats
+{
+public:
+   VkTraceStats() : calls( 0 ), totalNs( 0 ), maxNs( 0 ) {}
+   qint64 calls;
+   qint64 totalNs;
+   qint64 maxNs;
+};
+
+
+// ============================================================
+/*!
+  VkTrace: the session's section timings and counters, always on:
+  a section costs two clock reads, a counter an add.
+
+  With a trace file (--trace-out), each section's calls are kept
+  too, and written at exit in Chrome's trace-event format (json),
+  for chrome://tracing or Perfetto. Counters go in as counter events.
+
+  The hot paths are all on the gui thread: so is this.
+*/
+class VkTrace
+{
+public:
+   static VkTrace* instance();
+   static const char* sectionName( VKTRACE::Section section );
+   static const char* counterName( VKTRACE::Counter counter );
+
+   // nsecs since the session started; since the last reset()
+   qint64 now() const {
+      return m_clock.nsecsElapsed();
+   }
+   qint64 sinceResetNs() const {
+      return now() - m_resetNs;
+   }
+
+   bool enter( VKTRACE::Section section ) {
+      return m_depth[section]++ == 0;
+   }
+   void leave( VKTRACE::Section section, bool outermost, qint64 startNs );
+
+   void addCount( VKTRACE::Counter counter, qint64 delta );
+   qint64 count( VKTRACE::Counter counter ) const {
+      return m_counters[counter];
+   }
+   const VkTraceStats& stats( VKTRACE::Section section ) const {
+      return m_stats[section];
+   }
+   void reset();
+
+   bool startTrace( const QString& traceFile, QString& errMsg );
+   bool isTracing() const {
+      return !m_traceFile.isEmpty();
+   }
+   QString traceFile() const {
+      return m_traceFile;
+   }
+   bool writeTrace( QString& errMsg );
+
+private:
+   VkTrace();
+
+   struct Event {
+      qint64 startNs;
+      qint64 durNs;      // -1: a counter event
+      qint64 value;      // the counter's new value
+      int    id;         // section or counter
+   };
+   void addEvent( qint64 startNs, qint64 durNs, qint64 value, int id );
+
+private:
+   QElapsedTimer m_clock;
+   qint64        m_resetNs;
+   int           m_depth[VKTRACE::NUM_SECTIONS];
+   VkTraceStats  m_stats[VKTRACE::NUM_SECTIONS];
+   qint64        m_counters[VKTRACE::NUM_COUNTERS];
+
+   QString         m_traceFile;
+   QVector<Event>  m_events;
+   qint64          m_dropped;    // events past the cap
+   qint64          m_lastCountNs[VKTRACE::NUM_COUNTERS];
+};
+
+
+// ============================================================
+/*!
+  VkTraceScope: times its own lifetime, as the given section.
+*/
+class VkTraceScope
+{
+public:
+   VkTraceScope( VKTRACE::Section section )
+      : m_section( section ) {
+      VkTrace* trace = VkTrace::instance();
+      m_outermost = trace->enter( section );
+      m_startNs = trace->now();
+   }
+   ~VkTraceScope() {
+      VkTrace::instance()->leave( m_section, m_outermost, m_startNs );
+   }
+
+private:
+   VKTRACE::Section m_section;
+   bool   m_outermost;
+   qint64 m_startNs;
+};
+
+#define VK_TRACE_SCOPE( section ) VkTraceScope vk_trace_scope_( section )
+
+#endif // #ifndef VK_TRACE_H
@@ -8,6 +8,7 @@
 include( vk_config.pri )
 
 TEMPLATE = subdirs
-SUBDIRS  = src
+SUBDIRS  = src benchmarks
+CONFIG  += ordered   # benchmarks/ needs src/'s generated vk_defines.h
 
 